@@ -0,0 +1,691 @@
+unit Main;
+
+interface
+
+uses
+    System.SysUtils,
+    System.Classes,
+    System.Types,
+    System.Math,
+    System.IOUtils,
+    System.SyncObjs,
+    System.Diagnostics,
+    System.Generics.Collections,
+    Vcl.Graphics,
+    Vcl.Imaging.PngImage,
+    Winapi.ActiveX,
+    UTWHelpers,
+    UTWSmartPointer,
+    UTWControlRenderer,
+    UTWSVG,
+    UTWSVGRasterizer,
+    UTWSVGGDIPlusRasterizer;
+
+type
+    {**
+     Headless batch rasterizer, converts a set of SVG files to PNG or raw BGRA images, at several
+     sizes and animation positions, using a pool of worker threads
+     @br @bold(NOTE) No window and no message loop are required, each worker uses its own
+                     rasterizer and GDI+ renderer
+    }
+    TBatchRasterizer = class
+        public type
+            {**
+             Output format
+            }
+            IEFormat =
+            (
+                IE_F_PNG,
+                IE_F_BGRA
+            );
+
+        private type
+            {**
+             Result of a file conversion
+            }
+            IFileResult = record
+                m_FileName:   UnicodeString;
+                m_Error:      UnicodeString;
+                m_ParseTime:  Double; // in milliseconds
+                m_RenderTime: Double; // in milliseconds
+                m_SaveTime:   Double; // in milliseconds
+                m_Images:     Integer;
+                m_Success:    Boolean;
+            end;
+
+            IFileResults = array of IFileResult;
+
+            {**
+             Worker thread, converts the files until no file remains
+            }
+            IWorker = class(TThread)
+                private
+                    m_pOwner:      TBatchRasterizer;
+                    m_pRasterizer: TWSVGGDIPlusRasterizer;
+                    m_pBitmap:     Vcl.Graphics.TBitmap;
+
+                    {**
+                     Convert a file
+                     @param(fileName File to convert)
+                     @param(outputName Output image base name, without directory and extension)
+                     @param(fileResult @bold([in, out]) Conversion result)
+                    }
+                    procedure Convert(const fileName, outputName: UnicodeString; var fileResult: IFileResult);
+
+                    {**
+                     Save the rendered image
+                     @param(fileName Image file name)
+                    }
+                    procedure Save(const fileName: UnicodeString);
+
+                protected
+                    {**
+                     Thread main loop
+                    }
+                    procedure Execute; override;
+
+                public
+                    {**
+                     Constructor
+                     @param(pOwner Batch rasterizer owning the worker)
+                    }
+                    constructor Create(pOwner: TBatchRasterizer); reintroduce;
+
+                    {**
+                     Destructor
+                    }
+                    destructor Destroy; override;
+            end;
+
+        private
+            m_Files:        TStringList;
+            m_OutputNames:  TStringList;
+            m_Sizes:        TList<Integer>;
+            m_Positions:    TList<Double>;
+            m_Results:      IFileResults;
+            m_OutputDir:    UnicodeString;
+            m_Format:       IEFormat;
+            m_Workers:      Integer;
+            m_NextFile:     Integer;
+            m_Proportional: Boolean;
+
+            {**
+             Add the files to convert
+             @param(path SVG file, directory containing SVG files, or file list prefixed by @)
+             @returns(@true on success, otherwise @false)
+            }
+            function AddInput(const path: UnicodeString): Boolean;
+
+            {**
+             Parse a comma separated list of sizes
+             @param(value Value to parse)
+             @returns(@true on success, otherwise @false)
+            }
+            function ParseSizes(const value: UnicodeString): Boolean;
+
+            {**
+             Parse a comma separated list of animation positions, between 0 and 1
+             @param(value Value to parse)
+             @returns(@true on success, otherwise @false)
+            }
+            function ParsePositions(const value: UnicodeString): Boolean;
+
+            {**
+             Build the output image base names. The files sharing the same name, e.g. read from
+             several directories, get a numeric suffix, so their images don't overwrite each other
+            }
+            procedure BuildOutputNames;
+
+            {**
+             Get the next file to convert
+             @returns(File index, -1 if no file remains)
+            }
+            function NextFile: Integer;
+
+            {**
+             Print the per-file and aggregate report
+             @param(wallTime Total conversion time in milliseconds)
+            }
+            procedure Report(wallTime: Double);
+
+        public
+            {**
+             Constructor
+            }
+            constructor Create; virtual;
+
+            {**
+             Destructor
+            }
+            destructor Destroy; override;
+
+            {**
+             Read the command line
+             @returns(@true on success, otherwise @false)
+            }
+            function ParseCommandLine: Boolean; virtual;
+
+            {**
+             Convert all the files and print the report
+             @returns(@true if all the files were converted, otherwise @false)
+            }
+            function Run: Boolean; virtual;
+
+            {**
+             Print the command line usage
+            }
+            class procedure PrintUsage; static;
+    end;
+
+implementation
+
+//---------------------------------------------------------------------------
+// TBatchRasterizer.IWorker
+//---------------------------------------------------------------------------
+constructor TBatchRasterizer.IWorker.Create(pOwner: TBatchRasterizer);
+begin
+    m_pOwner := pOwner;
+
+    // the rasterizer caches and the global GDI+ renderer aren't thread safe, so each worker uses
+    // its own rasterizer and renderer
+    m_pRasterizer                 := TWSVGGDIPlusRasterizer.Create(TWControlRenderer.GetGDIPlusToken);
+    m_pRasterizer.PrivateRenderer := True;
+    m_pRasterizer.EnableAnimation(m_pOwner.m_Positions.Count > 0);
+
+    m_pBitmap             := Vcl.Graphics.TBitmap.Create;
+    m_pBitmap.PixelFormat := pf32bit;
+    m_pBitmap.AlphaFormat := afPremultiplied;
+
+    inherited Create(False);
+end;
+//---------------------------------------------------------------------------
+destructor TBatchRasterizer.IWorker.Destroy;
+begin
+    inherited Destroy;
+
+    m_pBitmap.Free;
+    m_pRasterizer.Free;
+end;
+//---------------------------------------------------------------------------
+procedure TBatchRasterizer.IWorker.Convert(const fileName, outputName: UnicodeString; var fileResult: IFileResult);
+var
+    pSVG:               IWSmartPointer<TWSVG>;
+    stopwatch:          TStopwatch;
+    animation:          TWSVGRasterizer.IAnimation;
+    baseName, fullName: UnicodeString;
+    i, j, positions:    Integer;
+begin
+    fileResult.m_FileName := fileName;
+
+    // parse the file
+    stopwatch := TStopwatch.StartNew;
+    pSVG      := TWSmartPointer<TWSVG>.Create();
+
+    if (not pSVG.LoadFromFile(fileName)) then
+    begin
+        fileResult.m_Error := 'Could not parse the file';
+        Exit;
+    end;
+
+    fileResult.m_ParseTime := stopwatch.Elapsed.TotalMilliseconds;
+
+    baseName := TPath.Combine(m_pOwner.m_OutputDir, outputName);
+
+    // without animation, the only frame is drawn at the default position
+    positions := m_pOwner.m_Positions.Count;
+
+    if (positions = 0) then
+        positions := 1;
+
+    animation.m_pCustomData := nil;
+
+    for i := 0 to m_pOwner.m_Sizes.Count - 1 do
+        for j := 0 to positions - 1 do
+        begin
+            fullName := baseName + '_' + IntToStr(m_pOwner.m_Sizes[i]);
+
+            if (m_pOwner.m_Positions.Count > 0) then
+            begin
+                animation.m_Position := m_pOwner.m_Positions[j];
+                fullName             := fullName + '_' + IntToStr(Round(animation.m_Position * 100.0));
+            end
+            else
+                animation.m_Position := 0.0;
+
+            // the bitmap canvas should be locked while used outside the main thread
+            m_pBitmap.Canvas.Lock;
+
+            try
+                // render the image
+                stopwatch := TStopwatch.StartNew;
+
+                m_pBitmap.SetSize(m_pOwner.m_Sizes[i], m_pOwner.m_Sizes[i]);
+                TWGDIHelper.Clear(m_pBitmap);
+
+                if (not m_pRasterizer.Draw(pSVG, TRect.Create(0, 0, m_pBitmap.Width, m_pBitmap.Height),
+                        m_pOwner.m_Proportional, True, animation, m_pBitmap.Canvas))
+                then
+                begin
+                    fileResult.m_Error := 'Could not render the file at size ' + IntToStr(m_pOwner.m_Sizes[i]);
+                    Exit;
+                end;
+
+                fileResult.m_RenderTime := fileResult.m_RenderTime + stopwatch.Elapsed.TotalMilliseconds;
+
+                // save it
+                stopwatch := TStopwatch.StartNew;
+
+                Save(fullName);
+
+                fileResult.m_SaveTime := fileResult.m_SaveTime + stopwatch.Elapsed.TotalMilliseconds;
+            finally
+                m_pBitmap.Canvas.Unlock;
+            end;
+
+            Inc(fileResult.m_Images);
+        end;
+
+    fileResult.m_Success := True;
+end;
+//---------------------------------------------------------------------------
+procedure TBatchRasterizer.IWorker.Save(const fileName: UnicodeString);
+var
+    pPng:    TPngImage;
+    pStream: IWSmartPointer<TFileStream>;
+    y:       Integer;
+begin
+    case (m_pOwner.m_Format) of
+        IE_F_PNG:
+        begin
+            pPng := TWImageHelper.BmpToPng_GDI(m_pBitmap);
+
+            if (not Assigned(pPng)) then
+                raise Exception.Create('Could not convert the image to PNG');
+
+            try
+                pPng.SaveToFile(fileName + '.png');
+            finally
+                pPng.Free;
+            end;
+        end;
+
+        IE_F_BGRA:
+        begin
+            // write the premultiplied pixels, from the top to the bottom row
+            pStream := TWSmartPointer<TFileStream>.Create(TFileStream.Create(fileName + '.bgra', fmCreate));
+
+            for y := 0 to m_pBitmap.Height - 1 do
+                pStream.WriteBuffer(m_pBitmap.ScanLine[y]^, m_pBitmap.Width * SizeOf(Cardinal));
+        end;
+    end;
+end;
+//---------------------------------------------------------------------------
+procedure TBatchRasterizer.IWorker.Execute;
+var
+    index: Integer;
+begin
+    // the XML parser may rely on COM, which should be initialized in each thread
+    CoInitialize(nil);
+
+    try
+        index := m_pOwner.NextFile;
+
+        while (index >= 0) do
+        begin
+            try
+                Convert(m_pOwner.m_Files[index], m_pOwner.m_OutputNames[index], m_pOwner.m_Results[index]);
+            except
+                on e: Exception do
+                begin
+                    m_pOwner.m_Results[index].m_Success := False;
+                    m_pOwner.m_Results[index].m_Error   := e.Message;
+                end;
+            end;
+
+            index := m_pOwner.NextFile;
+        end;
+    finally
+        CoUninitialize;
+    end;
+end;
+//---------------------------------------------------------------------------
+// TBatchRasterizer
+//---------------------------------------------------------------------------
+constructor TBatchRasterizer.Create;
+begin
+    inherited Create;
+
+    m_Files        := TStringList.Create;
+    m_OutputNames  := TStringList.Create;
+    m_Sizes        := TList<Integer>.Create;
+    m_Positions    := TList<Double>.Create;
+    m_OutputDir    := '.';
+    m_Format       := IE_F_PNG;
+    m_Workers      := TThread.ProcessorCount;
+    m_NextFile     := -1;
+    m_Proportional := True;
+end;
+//---------------------------------------------------------------------------
+destructor TBatchRasterizer.Destroy;
+begin
+    m_Positions.Free;
+    m_Sizes.Free;
+    m_OutputNames.Free;
+    m_Files.Free;
+
+    inherited Destroy;
+end;
+//---------------------------------------------------------------------------
+function TBatchRasterizer.AddInput(const path: UnicodeString): Boolean;
+var
+    pList:    IWSmartPointer<TStringList>;
+    fileName: UnicodeString;
+begin
+    // file list?
+    if (path.StartsWith('@')) then
+    begin
+        pList := TWSmartPointer<TStringList>.Create();
+        pList.LoadFromFile(path.Substring(1));
+
+        for fileName in pList do
+            if (not fileName.Trim.IsEmpty and not AddInput(fileName.Trim)) then
+                Exit(False);
+
+        Exit(True);
+    end;
+
+    // directory?
+    if (TDirectory.Exists(path)) then
+    begin
+        m_Files.AddStrings(TDirectory.GetFiles(path, '*.svg'));
+        Exit(True);
+    end;
+
+    if (not TFile.Exists(path)) then
+    begin
+        WriteLn(ErrOutput, 'File not found: ' + path);
+        Exit(False);
+    end;
+
+    m_Files.Add(path);
+    Result := True;
+end;
+//---------------------------------------------------------------------------
+function TBatchRasterizer.ParseSizes(const value: UnicodeString): Boolean;
+var
+    item: UnicodeString;
+    size: Integer;
+begin
+    for item in value.Split([',']) do
+    begin
+        if (not TryStrToInt(item.Trim, size) or (size <= 0)) then
+            Exit(False);
+
+        m_Sizes.Add(size);
+    end;
+
+    Result := True;
+end;
+//---------------------------------------------------------------------------
+function TBatchRasterizer.ParsePositions(const value: UnicodeString): Boolean;
+var
+    item:     UnicodeString;
+    position: Double;
+begin
+    for item in value.Split([',']) do
+    begin
+        if (not TryStrToFloat(item.Trim, position, TFormatSettings.Invariant) or (position < 0.0)
+                or (position > 1.0))
+        then
+            Exit(False);
+
+        m_Positions.Add(position);
+    end;
+
+    Result := True;
+end;
+//---------------------------------------------------------------------------
+function TBatchRasterizer.NextFile: Integer;
+begin
+    Result := TInterlocked.Increment(m_NextFile);
+
+    if (Result >= m_Files.Count) then
+        Result := -1;
+end;
+//---------------------------------------------------------------------------
+procedure TBatchRasterizer.Report(wallTime: Double);
+var
+    i, images, failed:     Integer;
+    parseTime, renderTime: Double;
+begin
+    images     := 0;
+    failed     := 0;
+    parseTime  := 0.0;
+    renderTime := 0.0;
+
+    WriteLn(Format('%-40s %10s %10s %10s %7s', ['File', 'Parse ms', 'Render ms', 'Save ms', 'Images']));
+
+    for i := 0 to Length(m_Results) - 1 do
+    begin
+        if (m_Results[i].m_Success) then
+            WriteLn(Format('%-40s %10.2f %10.2f %10.2f %7d', [ExtractFileName(m_Results[i].m_FileName),
+                    m_Results[i].m_ParseTime, m_Results[i].m_RenderTime, m_Results[i].m_SaveTime,
+                    m_Results[i].m_Images]))
+        else
+        begin
+            WriteLn(Format('%-40s FAILED - %s', [ExtractFileName(m_Results[i].m_FileName),
+                    m_Results[i].m_Error]));
+            Inc(failed);
+        end;
+
+        Inc(images, m_Results[i].m_Images);
+        parseTime  := parseTime  + m_Results[i].m_ParseTime;
+        renderTime := renderTime + m_Results[i].m_RenderTime;
+    end;
+
+    WriteLn;
+    WriteLn(Format('Files:       %d (%d failed)', [Length(m_Results), failed]));
+    WriteLn(Format('Images:      %d', [images]));
+    WriteLn(Format('Workers:     %d', [m_Workers]));
+    WriteLn(Format('Parse time:  %.2f ms', [parseTime]));
+    WriteLn(Format('Render time: %.2f ms', [renderTime]));
+    WriteLn(Format('Wall time:   %.2f ms', [wallTime]));
+
+    if (wallTime > 0.0) then
+        WriteLn(Format('Throughput:  %.2f images/s', [images / (wallTime / 1000.0)]));
+end;
+//---------------------------------------------------------------------------
+function TBatchRasterizer.ParseCommandLine: Boolean;
+var
+    i, workers: Integer;
+    param:      UnicodeString;
+begin
+    i := 1;
+
+    while (i <= ParamCount) do
+    begin
+        param := ParamStr(i);
+
+        // options expecting a value?
+        if (((param = '-o') or (param = '-s') or (param = '-p') or (param = '-f') or (param = '-j'))
+                and (i = ParamCount))
+        then
+        begin
+            WriteLn(ErrOutput, 'Missing value for ' + param);
+            Exit(False);
+        end;
+
+        if (param = '-o') then
+        begin
+            Inc(i);
+            m_OutputDir := ParamStr(i);
+        end
+        else
+        if (param = '-s') then
+        begin
+            Inc(i);
+
+            if (not ParseSizes(ParamStr(i))) then
+            begin
+                WriteLn(ErrOutput, 'Invalid sizes: ' + ParamStr(i));
+                Exit(False);
+            end;
+        end
+        else
+        if (param = '-p') then
+        begin
+            Inc(i);
+
+            if (not ParsePositions(ParamStr(i))) then
+            begin
+                WriteLn(ErrOutput, 'Invalid animation positions: ' + ParamStr(i));
+                Exit(False);
+            end;
+        end
+        else
+        if (param = '-f') then
+        begin
+            Inc(i);
+
+            if (SameText(ParamStr(i), 'png')) then
+                m_Format := IE_F_PNG
+            else
+            if (SameText(ParamStr(i), 'bgra')) then
+                m_Format := IE_F_BGRA
+            else
+            begin
+                WriteLn(ErrOutput, 'Invalid format: ' + ParamStr(i));
+                Exit(False);
+            end;
+        end
+        else
+        if (param = '-j') then
+        begin
+            Inc(i);
+
+            if (not TryStrToInt(ParamStr(i), workers) or (workers <= 0)) then
+            begin
+                WriteLn(ErrOutput, 'Invalid worker count: ' + ParamStr(i));
+                Exit(False);
+            end;
+
+            m_Workers := workers;
+        end
+        else
+        if (param = '--stretch') then
+            m_Proportional := False
+        else
+        if (not AddInput(param)) then
+            Exit(False);
+
+        Inc(i);
+    end;
+
+    if (m_Files.Count = 0) then
+    begin
+        WriteLn(ErrOutput, 'No SVG file to convert');
+        Exit(False);
+    end;
+
+    // by default, render the icons at their most common sizes
+    if (m_Sizes.Count = 0) then
+        m_Sizes.AddRange([16, 32, 48]);
+
+    Result := True;
+end;
+//---------------------------------------------------------------------------
+procedure TBatchRasterizer.BuildOutputNames;
+var
+    pUsed:      IWSmartPointer<TDictionary<UnicodeString, Integer>>;
+    name, key:  UnicodeString;
+    i, counter: Integer;
+begin
+    m_OutputNames.Clear;
+
+    // the names are compared case insensitively, as the file system does
+    pUsed := TWSmartPointer<TDictionary<UnicodeString, Integer>>.Create();
+
+    for i := 0 to m_Files.Count - 1 do
+    begin
+        name    := TPath.GetFileNameWithoutExtension(m_Files[i]);
+        key     := name.ToLower;
+        counter := 1;
+
+        // name already used by a previous file? Add a suffix, which should also be free
+        while (pUsed.ContainsKey(key)) do
+        begin
+            Inc(counter);
+            key := (name + '-' + IntToStr(counter)).ToLower;
+        end;
+
+        if (counter > 1) then
+            name := name + '-' + IntToStr(counter);
+
+        pUsed.Add(key, i);
+        m_OutputNames.Add(name);
+    end;
+end;
+//---------------------------------------------------------------------------
+function TBatchRasterizer.Run: Boolean;
+var
+    pWorkers:   IWSmartPointer<TObjectList<IWorker>>;
+    stopwatch:  TStopwatch;
+    i:          Integer;
+begin
+    ForceDirectories(m_OutputDir);
+
+    BuildOutputNames;
+
+    SetLength(m_Results, m_Files.Count);
+
+    for i := 0 to Length(m_Results) - 1 do
+        m_Results[i] := Default(IFileResult);
+
+    m_NextFile := -1;
+
+    // initialize GDI+ before the workers start
+    TWControlRenderer.GetGDIPlusToken;
+
+    stopwatch := TStopwatch.StartNew;
+
+    // start the workers, they are released (and thus waited for) once all the files were converted
+    pWorkers := TWSmartPointer<TObjectList<IWorker>>.Create();
+
+    for i := 0 to Min(m_Workers, m_Files.Count) - 1 do
+        pWorkers.Add(IWorker.Create(Self));
+
+    for i := 0 to pWorkers.Count - 1 do
+        pWorkers[i].WaitFor;
+
+    Report(stopwatch.Elapsed.TotalMilliseconds);
+
+    Result := True;
+
+    for i := 0 to Length(m_Results) - 1 do
+        if (not m_Results[i].m_Success) then
+            Exit(False);
+end;
+//---------------------------------------------------------------------------
+class procedure TBatchRasterizer.PrintUsage;
+begin
+    WriteLn('Usage: BatchRasterizer [options] <input> [<input>...]');
+    WriteLn;
+    WriteLn('Inputs:');
+    WriteLn('  <file.svg>       SVG file to convert');
+    WriteLn('  <directory>      Directory containing the SVG files to convert');
+    WriteLn('  @<list.txt>      Text file listing the inputs, one per line');
+    WriteLn;
+    WriteLn('The images are named after the input files, e.g. icon_16.png. The next files sharing');
+    WriteLn('the same name get a numeric suffix, e.g. icon-2_16.png.');
+    WriteLn;
+    WriteLn('Options:');
+    WriteLn('  -o <directory>   Output directory (default: current directory)');
+    WriteLn('  -s <sizes>       Comma separated image sizes in pixels (default: 16,32,48)');
+    WriteLn('  -p <positions>   Comma separated animation positions, between 0 and 1');
+    WriteLn('  -f png|bgra      Output format, raw BGRA is premultiplied (default: png)');
+    WriteLn('  -j <count>       Worker count (default: processor count)');
+    WriteLn('  --stretch        Stretch the images instead of keeping their proportions');
+end;
+//---------------------------------------------------------------------------
+
+end.
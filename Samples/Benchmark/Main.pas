@@ -0,0 +1,1517 @@
+unit Main;
+
+interface
+
+uses
+    System.SysUtils,
+    System.Classes,
+    System.Types,
+    System.Math,
+    System.IOUtils,
+    System.JSON,
+    System.DateUtils,
+    System.Diagnostics,
+    System.Generics.Collections,
+    System.Generics.Defaults,
+    Vcl.Graphics,
+    Winapi.Windows,
+    Winapi.ActiveX,
+    UTWHelpers,
+    UTWSmartPointer,
+    UTWControlRenderer,
+    UTWSVG,
+    UTWSVGItems,
+    UTWSVGElements,
+    UTWSVGRasterizer,
+    UTWSVGGDIPlusRasterizer,
+    UTWSVGGraphic,
+    UTWSVGImageList;
+
+type
+    {**
+     Performance benchmark for the parse, serialize, optimize, rasterize and animate phases. Each
+     phase is measured separately on a fixed corpus, made of the sample images and of generated
+     stress documents, with warm-up runs and repetitions. The static frame is rasterized at common
+     icon sizes, in full and draft quality, to compare the render time per icon. It is also
+     rasterized from the optimized tree, to measure the render time saved by the optimizer, directly
+     in a memory buffer, to measure the cost of the intermediate bitmap, and from several threads at
+     once, each drawing with its own render context, to stress the concurrent drawing. The hit test
+     cost, the draw cost of the document as an image list icon, the time spent to load an image list
+     as while a form is created, with and without the lazy loading, and the time spent to load the
+     document asynchronously, are also measured. The animation is also measured frame by frame, to
+     separate the first frame, which compiles the animations, from the next ones, and the processor
+     time spent to animate many copies of the document is measured with and without frame cache, and
+     the time spent to draw an animation cycle is measured with and without the partial redraw. The
+     results are written as JSON, to be compared between commits
+    }
+    TBenchmark = class
+        private type
+            {**
+             Benchmarked document
+            }
+            IDocument = record
+                m_Name:   UnicodeString;
+                m_Source: UnicodeString;
+                m_Data:   TBytes;
+            end;
+
+            IDocuments = TList<IDocument>;
+            ISamples   = array of Double;
+
+            {**
+             Measured phase, returns the time spent in the measured code, in milliseconds
+            }
+            ITfPhase = reference to function: Double;
+
+        private
+            m_pDocuments:  IDocuments;
+            m_pResults:    TJSONArray;
+            m_Dirs:        TStringList;
+            m_OutputFile:  UnicodeString;
+            m_Warmup:      Integer;
+            m_Repetitions: Integer;
+            m_Size:        Integer;
+            m_Frames:      Integer;
+            m_Threads:     Integer;
+            m_IconSize:    Integer;
+            m_Seed:        Cardinal;
+
+            {**
+             Get the next pseudo-random number. The generator is implemented here, to get the same
+             documents whatever the compiler and runtime version
+             @param(range Number range)
+             @returns(Number between 0 and range - 1)
+            }
+            function NextRandom(range: Integer): Integer;
+
+            {**
+             Format a float value for the SVG data
+             @param(value Value to format)
+             @returns(Formatted value)
+            }
+            function Fmt(value: Double): UnicodeString;
+
+            {**
+             Add a document to the corpus
+             @param(name Document name)
+             @param(source Document source, either file or generated)
+             @param(data Document data)
+            }
+            procedure AddDocument(const name, source: UnicodeString; const data: TBytes);
+
+            {**
+             Add the generated stress documents to the corpus
+            }
+            procedure AddGeneratedDocuments;
+
+            {**
+             Generate a document containing deeply nested groups
+             @param(depth Nesting depth)
+             @returns(SVG data)
+            }
+            function GenerateDeepNesting(depth: Integer): UnicodeString;
+
+            {**
+             Generate a document containing a long path
+             @param(segments Path segment count)
+             @returns(SVG data)
+            }
+            function GenerateLongPath(segments: Integer): UnicodeString;
+
+            {**
+             Generate a document containing many gradients
+             @param(count Gradient count)
+             @returns(SVG data)
+            }
+            function GenerateGradients(count: Integer): UnicodeString;
+
+            {**
+             Generate a document containing blurred elements
+             @param(count Blurred element count)
+             @returns(SVG data)
+            }
+            function GenerateBlurs(count: Integer): UnicodeString;
+
+            {**
+             Generate a document containing many animations
+             @param(count Animated element count)
+             @returns(SVG data)
+            }
+            function GenerateAnimations(count: Integer): UnicodeString;
+
+            {**
+             Measure a phase and add its result
+             @param(document Benchmarked document)
+             @param(phase Phase name)
+             @param(frames Frame count drawn per run, 0 if not applicable)
+             @param(fPhase Phase to measure)
+             @returns(Phase result, owned by the result list)
+            }
+            function Measure(const document: IDocument; const phase: UnicodeString; frames: Integer;
+                    fPhase: ITfPhase): TJSONObject;
+
+            {**
+             Check if two 32 bit bitmaps contain the same pixels
+             @param(pFirst First bitmap to compare)
+             @param(pSecond Second bitmap to compare)
+             @returns(@true if the bitmaps are identical, otherwise @false)
+            }
+            function SameBitmap(pFirst, pSecond: Vcl.Graphics.TBitmap): Boolean;
+
+            {**
+             Create a thread drawing the static frame of a document
+             @param(pSVG Document to draw)
+             @param(pRasterizer Rasterizer to draw with)
+             @param(pContext Render context to draw with, only used by the created thread)
+             @param(pBitmap Bitmap to draw on, only used by the created thread)
+             @param(drawRect Draw rect)
+             @returns(Suspended thread, which belongs to the caller)
+            }
+            function CreateDrawThread(pSVG: TWSVG; pRasterizer: TWSVGRasterizer;
+                    pContext: TWSVGRasterizer.IRenderContext; pBitmap: Vcl.Graphics.TBitmap;
+                    drawRect: TRect): TThread;
+
+            {**
+             Measure the static frame drawn from several threads at once, and check that each thread
+             draws the same frame as a single threaded draw
+             @param(document Benchmarked document)
+             @param(pSVG Parsed document, shared by all the threads)
+             @param(pRasterizer Rasterizer, shared by all the threads)
+            }
+            procedure MeasureConcurrent(const document: IDocument; pSVG: TWSVG; pRasterizer: TWSVGRasterizer);
+
+            {**
+             Measure the time spent to draw each frame of an animation cycle. The first frame of each
+             cycle compiles the animation timelines, the next ones only evaluate them
+             @param(document Benchmarked document)
+             @param(pSVG Parsed document)
+             @param(pRasterizer Rasterizer to draw with)
+            }
+            procedure MeasureFrames(const document: IDocument; pSVG: TWSVG; pRasterizer: TWSVGRasterizer);
+
+            {**
+             Get the processor time consumed by the process, in all its threads
+             @returns(Processor time, in milliseconds)
+            }
+            function GetProcessorTime: Double;
+
+            {**
+             Measure the processor time spent to animate many copies of a document, drawn live, then
+             through the frame cache while it is filled, and once it is complete
+             @param(document Benchmarked document)
+            }
+            procedure MeasureFrameCache(const document: IDocument);
+
+            {**
+             Measure the time spent to draw an animation cycle of the document, with and without the
+             partial redraw. The partial redraw time includes the measure of the changed regions
+             @param(document Benchmarked document)
+            }
+            procedure MeasurePartialRedraw(const document: IDocument);
+
+            {**
+             Measure the hit index build of a document, then the hit-testing on a grid of points
+             @param(document Benchmarked document)
+             @param(pSVG Parsed document)
+             @param(pRasterizer Rasterizer to hit-test with)
+            }
+            procedure MeasureHitTest(const document: IDocument; pSVG: TWSVG; pRasterizer: TWSVGRasterizer);
+
+            {**
+             Measure the time spent to rasterize the static frame as an icon of a given size
+             @param(document Benchmarked document)
+             @param(pSVG Parsed document)
+             @param(pRasterizer Rasterizer to draw with)
+             @param(size Icon size in pixels)
+             @param(quality Render quality)
+            }
+            procedure MeasureIcon(const document: IDocument; pSVG: TWSVG; pRasterizer: TWSVGRasterizer;
+                    size: Integer; quality: TWSVGRasterizer.IERenderQuality);
+
+            {**
+             Measure the time spent to read an image list containing many copies of a document from
+             a stream, as while a form is created
+             @param(document Benchmarked document)
+             @param(pGraphic Document graphic to add in the image list)
+             @param(lazy If @true, the pictures are kept as raw data while the list is read)
+            }
+            procedure MeasureImageListLoad(const document: IDocument; pGraphic: TWSVGGraphic; lazy: Boolean);
+
+            {**
+             Measure the time spent until a document loaded asynchronously is ready to be shown, and
+             the time the caller is blocked meanwhile
+             @param(document Benchmarked document)
+            }
+            procedure MeasureAsyncLoad(const document: IDocument);
+
+            {**
+             Run the benchmark on a document
+             @param(document Document to benchmark)
+            }
+            procedure RunDocument(document: IDocument);
+
+        public
+            {**
+             Constructor
+            }
+            constructor Create; virtual;
+
+            {**
+             Destructor
+            }
+            destructor Destroy; override;
+
+            {**
+             Read the command line
+             @returns(@true on success, otherwise @false)
+            }
+            function ParseCommandLine: Boolean; virtual;
+
+            {**
+             Run the benchmark and write the results
+             @returns(@true on success, otherwise @false)
+            }
+            function Run: Boolean; virtual;
+
+            {**
+             Print the command line usage
+            }
+            class procedure PrintUsage; static;
+    end;
+
+implementation
+
+//---------------------------------------------------------------------------
+// TBenchmark
+//---------------------------------------------------------------------------
+constructor TBenchmark.Create;
+begin
+    inherited Create;
+
+    m_pDocuments  := IDocuments.Create;
+    m_pResults    := TJSONArray.Create;
+    m_Dirs        := TStringList.Create;
+    m_OutputFile  := '';
+    m_Warmup      := 3;
+    m_Repetitions := 10;
+    m_Size        := 512;
+    m_Frames      := 30;
+    m_Threads     := 4;
+    m_IconSize    := 32;
+    m_Seed        := 1;
+end;
+//---------------------------------------------------------------------------
+destructor TBenchmark.Destroy;
+begin
+    m_Dirs.Free;
+    m_pResults.Free;
+    m_pDocuments.Free;
+
+    inherited Destroy;
+end;
+//---------------------------------------------------------------------------
+function TBenchmark.NextRandom(range: Integer): Integer;
+begin
+    m_Seed := Cardinal((UInt64(m_Seed) * 1103515245 + 12345) and $7FFFFFFF);
+    Result := Integer(m_Seed mod Cardinal(range));
+end;
+//---------------------------------------------------------------------------
+function TBenchmark.Fmt(value: Double): UnicodeString;
+begin
+    Result := FormatFloat('0.##', value, TFormatSettings.Invariant);
+end;
+//---------------------------------------------------------------------------
+procedure TBenchmark.AddDocument(const name, source: UnicodeString; const data: TBytes);
+var
+    document: IDocument;
+begin
+    document.m_Name   := name;
+    document.m_Source := source;
+    document.m_Data   := data;
+
+    m_pDocuments.Add(document);
+end;
+//---------------------------------------------------------------------------
+procedure TBenchmark.AddGeneratedDocuments;
+begin
+    // always generate the same documents
+    m_Seed := 1;
+
+    AddDocument('deep-nesting', 'generated', TEncoding.UTF8.GetBytes(GenerateDeepNesting(250)));
+    AddDocument('long-path',    'generated', TEncoding.UTF8.GetBytes(GenerateLongPath(20000)));
+    AddDocument('gradients',    'generated', TEncoding.UTF8.GetBytes(GenerateGradients(400)));
+    AddDocument('blur-filters', 'generated', TEncoding.UTF8.GetBytes(GenerateBlurs(40)));
+    AddDocument('animations',   'generated', TEncoding.UTF8.GetBytes(GenerateAnimations(200)));
+end;
+//---------------------------------------------------------------------------
+function TBenchmark.GenerateDeepNesting(depth: Integer): UnicodeString;
+var
+    pBuilder: IWSmartPointer<TStringBuilder>;
+    i:        Integer;
+begin
+    pBuilder := TWSmartPointer<TStringBuilder>.Create();
+    pBuilder.Append('<svg xmlns="http://www.w3.org/2000/svg" width="512" height="512" viewBox="0 0 512 512">');
+
+    // each group slightly transforms and restyles its content
+    for i := 0 to depth - 1 do
+        pBuilder.Append('<g transform="translate(1,1) rotate(' + Fmt(NextRandom(10) / 10.0) + ')" opacity="0.99">')
+                .Append('<rect x="' + IntToStr(i) + '" y="' + IntToStr(i) + '" width="8" height="8" fill="#'
+                        + IntToHex(NextRandom($1000000), 6) + '"/>');
+
+    for i := 0 to depth - 1 do
+        pBuilder.Append('</g>');
+
+    pBuilder.Append('</svg>');
+    Result := pBuilder.ToString;
+end;
+//---------------------------------------------------------------------------
+function TBenchmark.GenerateLongPath(segments: Integer): UnicodeString;
+var
+    pBuilder: IWSmartPointer<TStringBuilder>;
+    i:        Integer;
+begin
+    pBuilder := TWSmartPointer<TStringBuilder>.Create();
+    pBuilder.Append('<svg xmlns="http://www.w3.org/2000/svg" width="512" height="512" viewBox="0 0 512 512">')
+            .Append('<path fill="none" stroke="#204080" stroke-width="0.5" d="M256,256');
+
+    // mix the line and curve segments
+    for i := 0 to segments - 1 do
+        if ((i mod 3) = 0) then
+            pBuilder.Append(' C' + IntToStr(NextRandom(512)) + ',' + IntToStr(NextRandom(512)) + ' '
+                    + IntToStr(NextRandom(512)) + ',' + IntToStr(NextRandom(512)) + ' '
+                    + IntToStr(NextRandom(512)) + ',' + IntToStr(NextRandom(512)))
+        else
+            pBuilder.Append(' L' + IntToStr(NextRandom(512)) + ',' + IntToStr(NextRandom(512)));
+
+    pBuilder.Append('"/></svg>');
+    Result := pBuilder.ToString;
+end;
+//---------------------------------------------------------------------------
+function TBenchmark.GenerateGradients(count: Integer): UnicodeString;
+var
+    pBuilder: IWSmartPointer<TStringBuilder>;
+    i:        Integer;
+begin
+    pBuilder := TWSmartPointer<TStringBuilder>.Create();
+    pBuilder.Append('<svg xmlns="http://www.w3.org/2000/svg" width="512" height="512" viewBox="0 0 512 512">')
+            .Append('<defs>');
+
+    // alternate the linear and radial gradients
+    for i := 0 to count - 1 do
+        if ((i mod 2) = 0) then
+            pBuilder.Append('<linearGradient id="g' + IntToStr(i) + '" x1="0" y1="0" x2="1" y2="1">')
+                    .Append('<stop offset="0" stop-color="#' + IntToHex(NextRandom($1000000), 6) + '"/>')
+                    .Append('<stop offset="0.5" stop-color="#' + IntToHex(NextRandom($1000000), 6) + '"/>')
+                    .Append('<stop offset="1" stop-color="#' + IntToHex(NextRandom($1000000), 6) + '"/>')
+                    .Append('</linearGradient>')
+        else
+            pBuilder.Append('<radialGradient id="g' + IntToStr(i) + '" cx="0.5" cy="0.5" r="0.5">')
+                    .Append('<stop offset="0" stop-color="#' + IntToHex(NextRandom($1000000), 6) + '"/>')
+                    .Append('<stop offset="1" stop-color="#' + IntToHex(NextRandom($1000000), 6)
+                            + '" stop-opacity="0.5"/>')
+                    .Append('</radialGradient>');
+
+    pBuilder.Append('</defs>');
+
+    for i := 0 to count - 1 do
+        pBuilder.Append('<rect x="' + IntToStr(NextRandom(480)) + '" y="' + IntToStr(NextRandom(480))
+                + '" width="32" height="32" fill="url(#g' + IntToStr(i) + ')"/>');
+
+    pBuilder.Append('</svg>');
+    Result := pBuilder.ToString;
+end;
+//---------------------------------------------------------------------------
+function TBenchmark.GenerateBlurs(count: Integer): UnicodeString;
+var
+    pBuilder: IWSmartPointer<TStringBuilder>;
+    i:        Integer;
+begin
+    pBuilder := TWSmartPointer<TStringBuilder>.Create();
+    pBuilder.Append('<svg xmlns="http://www.w3.org/2000/svg" width="512" height="512" viewBox="0 0 512 512">')
+            .Append('<defs>');
+
+    for i := 0 to count - 1 do
+        pBuilder.Append('<filter id="b' + IntToStr(i) + '" x="-50%" y="-50%" width="200%" height="200%">')
+                .Append('<feGaussianBlur stdDeviation="' + IntToStr(1 + NextRandom(8)) + '"/>')
+                .Append('</filter>');
+
+    pBuilder.Append('</defs>');
+
+    for i := 0 to count - 1 do
+        pBuilder.Append('<circle cx="' + IntToStr(32 + NextRandom(448)) + '" cy="' + IntToStr(32 + NextRandom(448))
+                + '" r="' + IntToStr(8 + NextRandom(24)) + '" fill="#' + IntToHex(NextRandom($1000000), 6)
+                + '" filter="url(#b' + IntToStr(i) + ')"/>');
+
+    pBuilder.Append('</svg>');
+    Result := pBuilder.ToString;
+end;
+//---------------------------------------------------------------------------
+function TBenchmark.GenerateAnimations(count: Integer): UnicodeString;
+var
+    pBuilder: IWSmartPointer<TStringBuilder>;
+    i, x, y:  Integer;
+begin
+    pBuilder := TWSmartPointer<TStringBuilder>.Create();
+    pBuilder.Append('<svg xmlns="http://www.w3.org/2000/svg" width="512" height="512" viewBox="0 0 512 512">');
+
+    // mix the value, transform and color animations, with linear and spline timings
+    for i := 0 to count - 1 do
+    begin
+        x := NextRandom(480);
+        y := NextRandom(480);
+
+        pBuilder.Append('<rect x="' + IntToStr(x) + '" y="' + IntToStr(y) + '" width="24" height="24" fill="#'
+                + IntToHex(NextRandom($1000000), 6) + '">');
+
+        case (i mod 3) of
+            0: pBuilder.Append('<animate attributeName="x" values="' + IntToStr(x) + ';' + IntToStr(480 - x)
+                    + ';' + IntToStr(x) + '" dur="2s" repeatCount="indefinite"/>');
+            1: pBuilder.Append('<animateTransform attributeName="transform" type="rotate" from="0 '
+                    + IntToStr(x + 12) + ' ' + IntToStr(y + 12) + '" to="360 ' + IntToStr(x + 12) + ' '
+                    + IntToStr(y + 12) + '" dur="2s" repeatCount="indefinite"/>');
+            2: pBuilder.Append('<animate attributeName="fill" values="#ff0000;#00ff00;#0000ff" keyTimes="0;0.5;1" '
+                    + 'calcMode="spline" keySplines="0.42 0 0.58 1;0.42 0 0.58 1" dur="2s" repeatCount="indefinite"/>');
+        end;
+
+        pBuilder.Append('<animate attributeName="opacity" values="1;0.2;1" dur="1s" repeatCount="indefinite"/>')
+                .Append('</rect>');
+    end;
+
+    pBuilder.Append('</svg>');
+    Result := pBuilder.ToString;
+end;
+//---------------------------------------------------------------------------
+function TBenchmark.Measure(const document: IDocument; const phase: UnicodeString; frames: Integer;
+        fPhase: ITfPhase): TJSONObject;
+var
+    samples:                ISamples;
+    i:                      Integer;
+    mean, variance, median: Double;
+    pResult:                TJSONObject;
+begin
+    // warm up the caches
+    for i := 0 to m_Warmup - 1 do
+        fPhase();
+
+    SetLength(samples, m_Repetitions);
+
+    for i := 0 to m_Repetitions - 1 do
+        samples[i] := fPhase();
+
+    TArray.Sort<Double>(samples);
+
+    mean     := System.Math.Mean(samples);
+    variance := 0.0;
+
+    for i := 0 to Length(samples) - 1 do
+        variance := variance + Sqr(samples[i] - mean);
+
+    if (Length(samples) > 1) then
+        variance := variance / (Length(samples) - 1);
+
+    if ((Length(samples) mod 2) = 0) then
+        median := (samples[(Length(samples) div 2) - 1] + samples[Length(samples) div 2]) / 2.0
+    else
+        median := samples[Length(samples) div 2];
+
+    pResult := TJSONObject.Create;
+    pResult.AddPair('document',    document.m_Name);
+    pResult.AddPair('source',      document.m_Source);
+    pResult.AddPair('bytes',       TJSONNumber.Create(Length(document.m_Data)));
+    pResult.AddPair('phase',       phase);
+    pResult.AddPair('repetitions', TJSONNumber.Create(m_Repetitions));
+    pResult.AddPair('min_ms',      TJSONNumber.Create(samples[0]));
+    pResult.AddPair('median_ms',   TJSONNumber.Create(median));
+    pResult.AddPair('mean_ms',     TJSONNumber.Create(mean));
+    pResult.AddPair('max_ms',      TJSONNumber.Create(samples[Length(samples) - 1]));
+    pResult.AddPair('stddev_ms',   TJSONNumber.Create(Sqrt(variance)));
+
+    if (frames > 0) then
+    begin
+        pResult.AddPair('frames',          TJSONNumber.Create(frames));
+        pResult.AddPair('median_frame_ms', TJSONNumber.Create(median / frames));
+    end;
+
+    m_pResults.AddElement(pResult);
+
+    WriteLn(ErrOutput, Format('%-32s %-20s %10.3f ms', [document.m_Name, phase, median]));
+
+    Result := pResult;
+end;
+//---------------------------------------------------------------------------
+function TBenchmark.SameBitmap(pFirst, pSecond: Vcl.Graphics.TBitmap): Boolean;
+var
+    y: Integer;
+begin
+    if ((pFirst.Width <> pSecond.Width) or (pFirst.Height <> pSecond.Height)) then
+        Exit(False);
+
+    for y := 0 to pFirst.Height - 1 do
+        if (not CompareMem(pFirst.ScanLine[y], pSecond.ScanLine[y], pFirst.Width * SizeOf(Cardinal))) then
+            Exit(False);
+
+    Result := True;
+end;
+//---------------------------------------------------------------------------
+function TBenchmark.CreateDrawThread(pSVG: TWSVG; pRasterizer: TWSVGRasterizer;
+        pContext: TWSVGRasterizer.IRenderContext; pBitmap: Vcl.Graphics.TBitmap; drawRect: TRect): TThread;
+begin
+    Result := TThread.CreateAnonymousThread(
+            procedure
+            var
+                animation: TWSVGRasterizer.IAnimation;
+            begin
+                animation.m_Position    := 0.0;
+                animation.m_pCustomData := nil;
+
+                // the VCL canvases aren't thread safe, so the canvas is locked while the thread draws
+                pBitmap.Canvas.Lock;
+
+                try
+                    TWGDIHelper.Clear(pBitmap);
+
+                    if (not pRasterizer.Draw(pSVG, drawRect, True, True, animation, pBitmap.Canvas,
+                            pContext))
+                    then
+                        raise Exception.Create('Could not draw the document');
+                finally
+                    pBitmap.Canvas.Unlock;
+                end;
+            end);
+
+    // the thread is waited and deleted by the caller
+    Result.FreeOnTerminate := False;
+end;
+//---------------------------------------------------------------------------
+procedure TBenchmark.MeasureConcurrent(const document: IDocument; pSVG: TWSVG; pRasterizer: TWSVGRasterizer);
+var
+    pContexts:  IWSmartPointer<TObjectList<TWSVGRasterizer.IRenderContext>>;
+    pBitmaps:   IWSmartPointer<TObjectList<Vcl.Graphics.TBitmap>>;
+    pThread:    IWSmartPointer<TThread>;
+    pBitmap:    Vcl.Graphics.TBitmap;
+    pResult:    TJSONObject;
+    drawRect:   TRect;
+    identical:  Boolean;
+    i:          Integer;
+begin
+    pContexts := TWSmartPointer<TObjectList<TWSVGRasterizer.IRenderContext>>.Create();
+    pBitmaps  := TWSmartPointer<TObjectList<Vcl.Graphics.TBitmap>>.Create();
+    drawRect  := TRect.Create(0, 0, m_Size, m_Size);
+
+    // create one context and one bitmap per thread, the document and the rasterizer are shared
+    for i := 0 to m_Threads do
+    begin
+        pContexts.Add(pRasterizer.CreateContext);
+
+        pBitmap             := Vcl.Graphics.TBitmap.Create;
+        pBitmap.PixelFormat := pf32bit;
+        pBitmap.AlphaFormat := afPremultiplied;
+        pBitmap.SetSize(m_Size, m_Size);
+        pBitmaps.Add(pBitmap);
+    end;
+
+    // draw the reference frame with the last context and bitmap, alone, before the measured threads run
+    pThread := TWSmartPointer<TThread>.Create(CreateDrawThread(pSVG, pRasterizer, pContexts[m_Threads],
+            pBitmaps[m_Threads], drawRect));
+    pThread.Start;
+    pThread.WaitFor;
+
+    if (Assigned(pThread.FatalException)) then
+        raise Exception.Create('Could not draw the reference frame of ' + document.m_Name);
+
+    pResult := Measure(document, 'concurrent', 0,
+            function: Double
+            var
+                pThreads:  TObjectList<TThread>;
+                stopwatch: TStopwatch;
+                j:         Integer;
+            begin
+                pThreads := TObjectList<TThread>.Create;
+
+                try
+                    // create the threads outside the measure
+                    for j := 0 to m_Threads - 1 do
+                        pThreads.Add(CreateDrawThread(pSVG, pRasterizer, pContexts[j], pBitmaps[j],
+                                drawRect));
+
+                    stopwatch := TStopwatch.StartNew;
+
+                    for j := 0 to m_Threads - 1 do
+                        pThreads[j].Start;
+
+                    for j := 0 to m_Threads - 1 do
+                        pThreads[j].WaitFor;
+
+                    Result := stopwatch.Elapsed.TotalMilliseconds;
+
+                    for j := 0 to m_Threads - 1 do
+                        if (Assigned(pThreads[j].FatalException)) then
+                            raise Exception.Create('Could not draw ' + document.m_Name + ' from thread '
+                                    + IntToStr(j));
+                finally
+                    pThreads.Free;
+                end;
+            end);
+
+    // check that each thread drew the same frame as the reference
+    identical := True;
+
+    for i := 0 to m_Threads - 1 do
+        if (not SameBitmap(pBitmaps[m_Threads], pBitmaps[i])) then
+        begin
+            identical := False;
+            WriteLn(ErrOutput, Format('%-32s concurrent frame %d differs from the reference',
+                    [document.m_Name, i]));
+        end;
+
+    pResult.AddPair('threads', TJSONNumber.Create(m_Threads));
+
+    if (identical) then
+        pResult.AddPair('identical', TJSONTrue.Create)
+    else
+        pResult.AddPair('identical', TJSONFalse.Create);
+end;
+//---------------------------------------------------------------------------
+procedure TBenchmark.MeasureFrames(const document: IDocument; pSVG: TWSVG; pRasterizer: TWSVGRasterizer);
+var
+    pBitmap:             IWSmartPointer<Vcl.Graphics.TBitmap>;
+    pContext:            IWSmartPointer<TWSVGRasterizer.IRenderContext>;
+    pResult:             TJSONObject;
+    firstFrames, frames: ISamples;
+    animation:           TWSVGRasterizer.IAnimation;
+    drawRect:            TRect;
+    stopwatch:           TStopwatch;
+    i, j:                Integer;
+begin
+    // nothing to measure?
+    if (m_Frames < 2) then
+        Exit;
+
+    pBitmap             := TWSmartPointer<Vcl.Graphics.TBitmap>.Create();
+    pBitmap.PixelFormat := pf32bit;
+    pBitmap.AlphaFormat := afPremultiplied;
+    pBitmap.SetSize(m_Size, m_Size);
+
+    drawRect                := TRect.Create(0, 0, m_Size, m_Size);
+    animation.m_pCustomData := nil;
+
+    SetLength(firstFrames, m_Repetitions);
+    SetLength(frames,      m_Repetitions * (m_Frames - 1));
+
+    // each cycle is drawn with a new render context, so its first frame compiles the animations
+    for i := 0 to m_Repetitions - 1 do
+    begin
+        pContext := TWSmartPointer<TWSVGRasterizer.IRenderContext>.Create(pRasterizer.CreateContext);
+
+        for j := 0 to m_Frames - 1 do
+        begin
+            animation.m_Position := j / m_Frames;
+
+            TWGDIHelper.Clear(pBitmap);
+
+            stopwatch := TStopwatch.StartNew;
+            pRasterizer.Draw(pSVG, drawRect, True, True, animation, pBitmap.Canvas, pContext);
+
+            if (j = 0) then
+                firstFrames[i] := stopwatch.Elapsed.TotalMilliseconds
+            else
+                frames[(i * (m_Frames - 1)) + j - 1] := stopwatch.Elapsed.TotalMilliseconds;
+        end;
+    end;
+
+    TArray.Sort<Double>(firstFrames);
+    TArray.Sort<Double>(frames);
+
+    pResult := TJSONObject.Create;
+    pResult.AddPair('document',        document.m_Name);
+    pResult.AddPair('source',          document.m_Source);
+    pResult.AddPair('bytes',           TJSONNumber.Create(Length(document.m_Data)));
+    pResult.AddPair('phase',           'animate-frames');
+    pResult.AddPair('repetitions',     TJSONNumber.Create(m_Repetitions));
+    pResult.AddPair('frames',          TJSONNumber.Create(m_Frames));
+    pResult.AddPair('first_frame_ms',  TJSONNumber.Create(firstFrames[Length(firstFrames) div 2]));
+    pResult.AddPair('median_frame_ms', TJSONNumber.Create(frames[Length(frames) div 2]));
+    pResult.AddPair('p95_frame_ms',    TJSONNumber.Create(frames[Min(Length(frames) - 1,
+            Trunc(Length(frames) * 0.95))]));
+    pResult.AddPair('max_frame_ms',    TJSONNumber.Create(frames[Length(frames) - 1]));
+
+    m_pResults.AddElement(pResult);
+
+    WriteLn(ErrOutput, Format('%-32s %-20s %10.3f ms', [document.m_Name, 'animate-frames',
+            frames[Length(frames) div 2]]));
+end;
+//---------------------------------------------------------------------------
+function TBenchmark.GetProcessorTime: Double;
+var
+    creationTime, exitTime, kernelTime, userTime: TFileTime;
+begin
+    if (not GetProcessTimes(GetCurrentProcess, creationTime, exitTime, kernelTime, userTime)) then
+        Exit(0.0);
+
+    // the times are expressed in 100 nanoseconds units
+    Result := ((Int64(kernelTime.dwHighDateTime) shl 32) + kernelTime.dwLowDateTime
+            + (Int64(userTime.dwHighDateTime) shl 32) + userTime.dwLowDateTime) / 10000.0;
+end;
+//---------------------------------------------------------------------------
+procedure TBenchmark.MeasureFrameCache(const document: IDocument);
+const
+    C_Frame_Cache_Images = 16;
+var
+    pGraphics:  IWSmartPointer<TObjectList<TWSVGGraphic>>;
+    pBitmap:    IWSmartPointer<Vcl.Graphics.TBitmap>;
+    pResult:    TJSONObject;
+    fCreate:    TFunc<Boolean, TObjectList<TWSVGGraphic>>;
+    fDrawCycle: TProc<TObjectList<TWSVGGraphic>>;
+    i:          Integer;
+begin
+    pBitmap             := TWSmartPointer<Vcl.Graphics.TBitmap>.Create();
+    pBitmap.PixelFormat := pf32bit;
+    pBitmap.AlphaFormat := afPremultiplied;
+    pBitmap.SetSize(m_Size, m_Size);
+
+    // create the copies of the document, with or without frame cache
+    fCreate := function(frameCache: Boolean): TObjectList<TWSVGGraphic>
+            var
+                pGraphic: TWSVGGraphic;
+                pStream:  IWSmartPointer<TBytesStream>;
+                j:        Integer;
+            begin
+                Result := TObjectList<TWSVGGraphic>.Create(True);
+
+                for j := 0 to C_Frame_Cache_Images - 1 do
+                begin
+                    pGraphic := TWSVGGraphic.Create;
+                    Result.Add(pGraphic);
+
+                    pStream := TWSmartPointer<TBytesStream>.Create(TBytesStream.Create(document.m_Data));
+                    pGraphic.LoadFromStream(pStream);
+                    pGraphic.FrameCache := frameCache;
+                    pGraphic.Animate    := True;
+                end;
+            end;
+
+    // draw one animation cycle of each copy, as while they are shown on the same form
+    fDrawCycle := procedure(pList: TObjectList<TWSVGGraphic>)
+            var
+                pGraphic: TWSVGGraphic;
+                j:        Integer;
+            begin
+                for j := 0 to m_Frames - 1 do
+                    for pGraphic in pList do
+                    begin
+                        pGraphic.Position := j / m_Frames;
+                        TWGDIHelper.Clear(pBitmap);
+                        pBitmap.Canvas.StretchDraw(TRect.Create(0, 0, m_Size, m_Size), pGraphic);
+                    end;
+            end;
+
+    // frame cache live phase, the copies are animated without frame cache
+    pGraphics := TWSmartPointer<TObjectList<TWSVGGraphic>>.Create(fCreate(False));
+    pResult   := Measure(document, 'framecache-live', m_Frames,
+            function: Double
+            var
+                start: Double;
+            begin
+                start := GetProcessorTime;
+                fDrawCycle(pGraphics);
+                Result := GetProcessorTime - start;
+            end);
+    pResult.AddPair('images', TJSONNumber.Create(C_Frame_Cache_Images));
+
+    // frame cache fill phase, the first cycle of new copies, during which their cache is filled
+    pResult := Measure(document, 'framecache-fill', m_Frames,
+            function: Double
+            var
+                pFilled: IWSmartPointer<TObjectList<TWSVGGraphic>>;
+                start:   Double;
+            begin
+                pFilled := TWSmartPointer<TObjectList<TWSVGGraphic>>.Create(fCreate(True));
+                start   := GetProcessorTime;
+                fDrawCycle(pFilled);
+                Result := GetProcessorTime - start;
+            end);
+    pResult.AddPair('images', TJSONNumber.Create(C_Frame_Cache_Images));
+
+    // fill the cache completely, at least one frame is added on each draw
+    pGraphics := TWSmartPointer<TObjectList<TWSVGGraphic>>.Create(fCreate(True));
+
+    for i := 0 to C_TWSVGGraphic_Frame_Cache_Frames - 1 do
+        fDrawCycle(pGraphics);
+
+    // frame cache playback phase, the copies are played back from their complete cache
+    pResult := Measure(document, 'framecache-playback', m_Frames,
+            function: Double
+            var
+                start: Double;
+            begin
+                start := GetProcessorTime;
+                fDrawCycle(pGraphics);
+                Result := GetProcessorTime - start;
+            end);
+    pResult.AddPair('images', TJSONNumber.Create(C_Frame_Cache_Images));
+end;
+//---------------------------------------------------------------------------
+procedure TBenchmark.MeasurePartialRedraw(const document: IDocument);
+var
+    pGraphic: IWSmartPointer<TWSVGGraphic>;
+    pBitmap:  IWSmartPointer<Vcl.Graphics.TBitmap>;
+    pStream:  IWSmartPointer<TBytesStream>;
+    fCycle:   ITfPhase;
+begin
+    pBitmap             := TWSmartPointer<Vcl.Graphics.TBitmap>.Create();
+    pBitmap.PixelFormat := pf32bit;
+    pBitmap.AlphaFormat := afPremultiplied;
+    pBitmap.SetSize(m_Size, m_Size);
+
+    pGraphic := TWSmartPointer<TWSVGGraphic>.Create();
+    pStream  := TWSmartPointer<TBytesStream>.Create(TBytesStream.Create(document.m_Data));
+    pGraphic.LoadFromStream(pStream);
+    pGraphic.Animate := True;
+
+    // draw one animation cycle. NOTE the target isn't cleared, because the partial redraw only
+    // updates the changed regions of its own buffer, which is always copied whole
+    fCycle := function: Double
+            var
+                stopwatch: TStopwatch;
+                i:         Integer;
+            begin
+                Result := 0.0;
+
+                for i := 0 to m_Frames - 1 do
+                begin
+                    pGraphic.Position := i / m_Frames;
+
+                    stopwatch := TStopwatch.StartNew;
+                    pBitmap.Canvas.StretchDraw(TRect.Create(0, 0, m_Size, m_Size), pGraphic);
+                    Result := Result + stopwatch.Elapsed.TotalMilliseconds;
+                end;
+            end;
+
+    // full redraw phase, each frame is rasterized whole
+    pGraphic.PartialRedraw := False;
+    Measure(document, 'partial-full', m_Frames, fCycle);
+
+    // partial redraw phase, only the regions changed since the previous frame are rasterized
+    pGraphic.PartialRedraw := True;
+    Measure(document, 'partial-redraw', m_Frames, fCycle);
+end;
+//---------------------------------------------------------------------------
+procedure TBenchmark.MeasureHitTest(const document: IDocument; pSVG: TWSVG; pRasterizer: TWSVGRasterizer);
+const
+    C_Hit_Grid = 32;
+var
+    pContext:   IWSmartPointer<TWSVGRasterizer.IRenderContext>;
+    pAncestors: IWSmartPointer<TList<TWSVGElement>>;
+    pResult:    TJSONObject;
+    animation:  TWSVGRasterizer.IAnimation;
+    drawRect:   TRect;
+    center:     TPoint;
+begin
+    animation.m_Position    := 0.0;
+    animation.m_pCustomData := nil;
+
+    drawRect   := TRect.Create(0, 0, m_Size, m_Size);
+    center     := TPoint.Create(m_Size div 2, m_Size div 2);
+    pAncestors := TWSmartPointer<TList<TWSVGElement>>.Create();
+
+    // hit index phase, the first query measures the frame and indexes the element bounds
+    Measure(document, 'hittest-index', 0,
+            function: Double
+            var
+                pIndexContext: IWSmartPointer<TWSVGRasterizer.IRenderContext>;
+                stopwatch:     TStopwatch;
+            begin
+                pIndexContext := TWSmartPointer<TWSVGRasterizer.IRenderContext>.Create(pRasterizer.CreateContext);
+                stopwatch     := TStopwatch.StartNew;
+
+                pRasterizer.HitTest(pSVG, drawRect, True, animation, center, pAncestors, pIndexContext);
+
+                Result := stopwatch.Elapsed.TotalMilliseconds;
+            end);
+
+    pContext := TWSmartPointer<TWSVGRasterizer.IRenderContext>.Create(pRasterizer.CreateContext);
+
+    // build the hit index once for the next phase
+    pRasterizer.HitTest(pSVG, drawRect, True, animation, center, pAncestors, pContext);
+
+    // hit test phase, the points of a regular grid covering the draw rect are queried, as while the
+    // mouse moves above the drawing
+    pResult := Measure(document, 'hittest', 0,
+            function: Double
+            var
+                stopwatch: TStopwatch;
+                x, y:      Integer;
+            begin
+                stopwatch := TStopwatch.StartNew;
+
+                for y := 0 to C_Hit_Grid - 1 do
+                    for x := 0 to C_Hit_Grid - 1 do
+                        pRasterizer.HitTest(pSVG, drawRect, True, animation,
+                                TPoint.Create((x * m_Size) div C_Hit_Grid, (y * m_Size) div C_Hit_Grid),
+                                pAncestors, pContext);
+
+                Result := stopwatch.Elapsed.TotalMilliseconds;
+            end);
+
+    pResult.AddPair('queries', TJSONNumber.Create(C_Hit_Grid * C_Hit_Grid));
+end;
+//---------------------------------------------------------------------------
+procedure TBenchmark.MeasureIcon(const document: IDocument; pSVG: TWSVG; pRasterizer: TWSVGRasterizer;
+        size: Integer; quality: TWSVGRasterizer.IERenderQuality);
+var
+    pBitmap:     IWSmartPointer<Vcl.Graphics.TBitmap>;
+    pResult:     TJSONObject;
+    phase:       UnicodeString;
+    prevQuality: TWSVGRasterizer.IERenderQuality;
+begin
+    pBitmap             := TWSmartPointer<Vcl.Graphics.TBitmap>.Create();
+    pBitmap.PixelFormat := pf32bit;
+    pBitmap.AlphaFormat := afPremultiplied;
+    pBitmap.SetSize(size, size);
+
+    phase := 'icon-' + IntToStr(size);
+
+    if (quality = TWSVGRasterizer.IERenderQuality.IE_RQ_Draft) then
+        phase := phase + '-draft';
+
+    prevQuality         := pRasterizer.Quality;
+    pRasterizer.Quality := quality;
+
+    try
+        // icon phase, static frame rasterized at the icon size
+        pResult := Measure(document, phase, 0,
+                function: Double
+                var
+                    animation: TWSVGRasterizer.IAnimation;
+                    stopwatch: TStopwatch;
+                begin
+                    animation.m_Position    := 0.0;
+                    animation.m_pCustomData := nil;
+
+                    TWGDIHelper.Clear(pBitmap);
+
+                    stopwatch := TStopwatch.StartNew;
+                    pRasterizer.Draw(pSVG, TRect.Create(0, 0, size, size), True, True, animation,
+                            pBitmap.Canvas);
+                    Result := stopwatch.Elapsed.TotalMilliseconds;
+                end);
+    finally
+        pRasterizer.Quality := prevQuality;
+    end;
+
+    pResult.AddPair('size', TJSONNumber.Create(size));
+end;
+//---------------------------------------------------------------------------
+procedure TBenchmark.MeasureImageListLoad(const document: IDocument; pGraphic: TWSVGGraphic; lazy: Boolean);
+const
+    C_Icon_Count = 100;
+var
+    pSource:  IWSmartPointer<TWSVGImageList>;
+    pForm:    IWSmartPointer<TMemoryStream>;
+    pResult:  TJSONObject;
+    phase:    UnicodeString;
+    i:        Integer;
+begin
+    // build an image list containing many icons, and stream it as it would be stored in a DFM
+    pSource := TWSmartPointer<TWSVGImageList>.Create(TWSVGImageList.Create(nil));
+    pSource.SetSize(m_IconSize, m_IconSize);
+    pSource.LazyLoad := lazy;
+
+    for i := 0 to C_Icon_Count - 1 do
+        pSource.AddSVG(pGraphic);
+
+    pSource.RasterizePending;
+
+    pForm := TWSmartPointer<TMemoryStream>.Create();
+    pForm.WriteComponent(pSource);
+
+    if (lazy) then
+        phase := 'imagelist-load-lazy'
+    else
+        phase := 'imagelist-load';
+
+    // image list load phase, the list is read back from the stream, as while the form is created
+    pResult := Measure(document, phase, 0,
+            function: Double
+            var
+                pLoaded:   IWSmartPointer<TWSVGImageList>;
+                stopwatch: TStopwatch;
+            begin
+                pLoaded        := TWSmartPointer<TWSVGImageList>.Create(TWSVGImageList.Create(nil));
+                pForm.Position := 0;
+                stopwatch      := TStopwatch.StartNew;
+
+                pForm.ReadComponent(pLoaded);
+
+                Result := stopwatch.Elapsed.TotalMilliseconds;
+            end);
+
+    pResult.AddPair('icons', TJSONNumber.Create(C_Icon_Count));
+end;
+//---------------------------------------------------------------------------
+procedure TBenchmark.MeasureAsyncLoad(const document: IDocument);
+var
+    pResult: TJSONObject;
+    blocked: Double;
+    runs:    Integer;
+begin
+    blocked := 0.0;
+    runs    := 0;
+
+    // async load phase, the document is parsed and its first frame is rasterized in a worker thread,
+    // until the graphic is ready to be shown. NOTE compare with the parse and rasterize phases to get
+    // the cost of the worker, and with the blocked time to get the time the caller stays responsive
+    pResult := Measure(document, 'load-async', 0,
+            function: Double
+            var
+                pLoaded:   IWSmartPointer<TWSVGGraphic>;
+                pStream:   IWSmartPointer<TBytesStream>;
+                stopwatch: TStopwatch;
+            begin
+                pLoaded   := TWSmartPointer<TWSVGGraphic>.Create();
+                pStream   := TWSmartPointer<TBytesStream>.Create(TBytesStream.Create(document.m_Data));
+                stopwatch := TStopwatch.StartNew;
+
+                pLoaded.LoadFromStreamAsync(pStream, m_Size, m_Size);
+
+                blocked := blocked + stopwatch.Elapsed.TotalMilliseconds;
+                Inc(runs);
+
+                // process the completion notification, as the application message loop would do
+                while (pLoaded.Loading) do
+                    CheckSynchronize(1);
+
+                Result := stopwatch.Elapsed.TotalMilliseconds;
+            end);
+
+    pResult.AddPair('blocked_ms', TJSONNumber.Create(blocked / runs));
+end;
+//---------------------------------------------------------------------------
+procedure TBenchmark.RunDocument(document: IDocument);
+const
+    C_Icon_Sizes: array[0..5] of Integer = (16, 24, 32, 48, 64, 256);
+var
+    pSVG, pOptimized: IWSmartPointer<TWSVG>;
+    pStream:          IWSmartPointer<TBytesStream>;
+    pRasterizer:      IWSmartPointer<TWSVGGDIPlusRasterizer>;
+    pBitmap:          IWSmartPointer<Vcl.Graphics.TBitmap>;
+    pIcons:           IWSmartPointer<Vcl.Graphics.TBitmap>;
+    pImageList:       IWSmartPointer<TWSVGImageList>;
+    pGraphic:         IWSmartPointer<TWSVGGraphic>;
+    pResult:          TJSONObject;
+    report:           TWSVGOptimizer.IReport;
+    drawRect:         TRect;
+    pixels:           TBytes;
+    buffer:           TWSVGRasterizer.IRenderBuffer;
+    i:                Integer;
+begin
+    // parse phase, the document is loaded from memory to exclude the disk access
+    Measure(document, 'parse', 0,
+            function: Double
+            var
+                pParsed:   IWSmartPointer<TWSVG>;
+                pStream:   IWSmartPointer<TBytesStream>;
+                stopwatch: TStopwatch;
+            begin
+                pParsed   := TWSmartPointer<TWSVG>.Create();
+                pStream   := TWSmartPointer<TBytesStream>.Create(TBytesStream.Create(document.m_Data));
+                stopwatch := TStopwatch.StartNew;
+
+                if (not pParsed.LoadFromStream(pStream)) then
+                    raise Exception.Create('Could not parse ' + document.m_Name);
+
+                Result := stopwatch.Elapsed.TotalMilliseconds;
+            end);
+
+    // parse the document once for the next phases
+    pSVG    := TWSmartPointer<TWSVG>.Create();
+    pStream := TWSmartPointer<TBytesStream>.Create(TBytesStream.Create(document.m_Data));
+
+    if (not pSVG.LoadFromStream(pStream)) then
+        raise Exception.Create('Could not parse ' + document.m_Name);
+
+    // serialize phase, the parsed tree is written back to memory as minified xml
+    Measure(document, 'serialize', 0,
+            function: Double
+            var
+                pOutput:   IWSmartPointer<TMemoryStream>;
+                stopwatch: TStopwatch;
+            begin
+                pOutput   := TWSmartPointer<TMemoryStream>.Create();
+                stopwatch := TStopwatch.StartNew;
+
+                pSVG.SaveToStream(pOutput, False);
+
+                Result := stopwatch.Elapsed.TotalMilliseconds;
+            end);
+
+    // optimize phase, the document is parsed again before each run, outside the measure
+    pResult := Measure(document, 'optimize', 0,
+            function: Double
+            var
+                pParsed:   IWSmartPointer<TWSVG>;
+                pStream:   IWSmartPointer<TBytesStream>;
+                stopwatch: TStopwatch;
+            begin
+                pParsed := TWSmartPointer<TWSVG>.Create();
+                pStream := TWSmartPointer<TBytesStream>.Create(TBytesStream.Create(document.m_Data));
+
+                if (not pParsed.LoadFromStream(pStream)) then
+                    raise Exception.Create('Could not parse ' + document.m_Name);
+
+                stopwatch := TStopwatch.StartNew;
+                pParsed.Optimize;
+                Result := stopwatch.Elapsed.TotalMilliseconds;
+            end);
+
+    // parse and optimize the document once for the optimized rasterize phase
+    pOptimized := TWSmartPointer<TWSVG>.Create();
+    pStream    := TWSmartPointer<TBytesStream>.Create(TBytesStream.Create(document.m_Data));
+
+    if (not pOptimized.LoadFromStream(pStream)) then
+        raise Exception.Create('Could not parse ' + document.m_Name);
+
+    report := pOptimized.Optimize;
+
+    pResult.AddPair('elements_before', TJSONNumber.Create(Int64(report.m_ElementsBefore)));
+    pResult.AddPair('elements_after',  TJSONNumber.Create(Int64(report.m_ElementsAfter)));
+
+    pRasterizer := TWSmartPointer<TWSVGGDIPlusRasterizer>.Create
+            (TWSVGGDIPlusRasterizer.Create(TWControlRenderer.GetGDIPlusToken));
+
+    pBitmap             := TWSmartPointer<Vcl.Graphics.TBitmap>.Create();
+    pBitmap.PixelFormat := pf32bit;
+    pBitmap.AlphaFormat := afPremultiplied;
+    pBitmap.SetSize(m_Size, m_Size);
+
+    drawRect := TRect.Create(0, 0, m_Size, m_Size);
+
+    // rasterize phase, static frame
+    Measure(document, 'rasterize', 0,
+            function: Double
+            var
+                animation: TWSVGRasterizer.IAnimation;
+                stopwatch: TStopwatch;
+            begin
+                animation.m_Position    := 0.0;
+                animation.m_pCustomData := nil;
+
+                TWGDIHelper.Clear(pBitmap);
+
+                stopwatch := TStopwatch.StartNew;
+                pRasterizer.Draw(pSVG, drawRect, True, True, animation, pBitmap.Canvas);
+                Result := stopwatch.Elapsed.TotalMilliseconds;
+            end);
+
+    SetLength(pixels, m_Size * m_Size * 4);
+
+    buffer.m_pBits       := @pixels[0];
+    buffer.m_Width       := m_Size;
+    buffer.m_Height      := m_Size;
+    buffer.m_Stride      := m_Size * 4;
+    buffer.m_PixelFormat := TWSVGRasterizer.IEPixelFormat.IE_PF_PremultipliedBGRA;
+
+    // rasterize phase, static frame drawn directly in a memory buffer. NOTE compare with the rasterize
+    // phase to get the cost of the intermediate bitmap
+    Measure(document, 'rasterize-buffer', 0,
+            function: Double
+            var
+                animation: TWSVGRasterizer.IAnimation;
+                stopwatch: TStopwatch;
+            begin
+                animation.m_Position    := 0.0;
+                animation.m_pCustomData := nil;
+
+                FillChar(pixels[0], Length(pixels), 0);
+
+                stopwatch := TStopwatch.StartNew;
+                pRasterizer.DrawToBuffer(pSVG, drawRect, True, True, animation, buffer);
+                Result := stopwatch.Elapsed.TotalMilliseconds;
+            end);
+
+    // rasterize phase, static frame drawn from the optimized tree. NOTE compare with the rasterize
+    // phase to get the render time saved by the optimizer
+    Measure(document, 'rasterize-optimized', 0,
+            function: Double
+            var
+                animation: TWSVGRasterizer.IAnimation;
+                stopwatch: TStopwatch;
+            begin
+                animation.m_Position    := 0.0;
+                animation.m_pCustomData := nil;
+
+                TWGDIHelper.Clear(pBitmap);
+
+                stopwatch := TStopwatch.StartNew;
+                pRasterizer.Draw(pOptimized, drawRect, True, True, animation, pBitmap.Canvas);
+                Result := stopwatch.Elapsed.TotalMilliseconds;
+            end);
+
+    // icon phases, static frame at common icon sizes, in full then in draft quality. NOTE compare the
+    // sizes to get the render time per icon, and the qualities to get the time saved while the user
+    // interacts with the graphic
+    for i := 0 to Length(C_Icon_Sizes) - 1 do
+    begin
+        MeasureIcon(document, pSVG, pRasterizer, C_Icon_Sizes[i], TWSVGRasterizer.IERenderQuality.IE_RQ_Full);
+        MeasureIcon(document, pSVG, pRasterizer, C_Icon_Sizes[i], TWSVGRasterizer.IERenderQuality.IE_RQ_Draft);
+    end;
+
+    // hit test phases, index build and queries
+    MeasureHitTest(document, pSVG, pRasterizer);
+
+    pImageList := TWSmartPointer<TWSVGImageList>.Create(TWSVGImageList.Create(nil));
+    pImageList.SetSize(m_IconSize, m_IconSize);
+
+    pGraphic := TWSmartPointer<TWSVGGraphic>.Create();
+    pStream  := TWSmartPointer<TBytesStream>.Create(TBytesStream.Create(document.m_Data));
+    pGraphic.LoadFromStream(pStream);
+
+    pImageList.AddSVG(pGraphic);
+    pImageList.RasterizePending;
+
+    pIcons             := TWSmartPointer<Vcl.Graphics.TBitmap>.Create();
+    pIcons.PixelFormat := pf32bit;
+    pIcons.SetSize(m_IconSize, m_IconSize);
+
+    // image list phase, the document drawn as an icon several times per run, as a toolbar or a
+    // list view would do while painting. NOTE the first draw is excluded, to measure the steady cost
+    pImageList.Draw(pIcons.Canvas, 0, 0, 0);
+
+    Measure(document, 'imagelist-draw', m_Frames,
+            function: Double
+            var
+                stopwatch: TStopwatch;
+                i:         Integer;
+            begin
+                stopwatch := TStopwatch.StartNew;
+
+                for i := 0 to m_Frames - 1 do
+                    pImageList.Draw(pIcons.Canvas, 0, 0, 0);
+
+                Result := stopwatch.Elapsed.TotalMilliseconds;
+            end);
+
+    // image list load phases, with the pictures parsed while loading, then kept as raw data
+    MeasureImageListLoad(document, pGraphic, False);
+    MeasureImageListLoad(document, pGraphic, True);
+
+    // async load phase, parse and first frame in a worker thread
+    MeasureAsyncLoad(document);
+
+    // concurrent phase, static frame drawn from several threads at once
+    if (m_Threads > 0) then
+        MeasureConcurrent(document, pSVG, pRasterizer);
+
+    // nothing to animate?
+    if (pRasterizer.GetAnimationDuration(pSVG) = 0) then
+        Exit;
+
+    pRasterizer.EnableAnimation(True);
+
+    // animate phase, one full animation cycle
+    Measure(document, 'animate', m_Frames,
+            function: Double
+            var
+                animation: TWSVGRasterizer.IAnimation;
+                stopwatch: TStopwatch;
+                i:         Integer;
+            begin
+                animation.m_pCustomData := nil;
+                Result                  := 0.0;
+
+                for i := 0 to m_Frames - 1 do
+                begin
+                    animation.m_Position := i / m_Frames;
+
+                    TWGDIHelper.Clear(pBitmap);
+
+                    stopwatch := TStopwatch.StartNew;
+                    pRasterizer.Draw(pSVG, drawRect, True, True, animation, pBitmap.Canvas);
+                    Result := Result + stopwatch.Elapsed.TotalMilliseconds;
+                end;
+            end);
+
+    // animate frames phase, time of each frame, the first one compiling the animations
+    MeasureFrames(document, pSVG, pRasterizer);
+
+    // frame cache phases, processor time spent to animate many copies of the document
+    MeasureFrameCache(document);
+
+    // partial redraw phases, time spent to draw a cycle with and without the partial redraw
+    MeasurePartialRedraw(document);
+end;
+//---------------------------------------------------------------------------
+function TBenchmark.ParseCommandLine: Boolean;
+var
+    i, value: Integer;
+    param:    UnicodeString;
+    exeDir:   UnicodeString;
+begin
+    i := 1;
+
+    while (i <= ParamCount) do
+    begin
+        param := ParamStr(i);
+
+        if (param = '-o') then
+        begin
+            if (i = ParamCount) then
+                Exit(False);
+
+            Inc(i);
+            m_OutputFile := ParamStr(i);
+        end
+        else
+        if ((param = '-w') or (param = '-r') or (param = '-s') or (param = '-n') or (param = '-t')
+                or (param = '-i')) then
+        begin
+            if ((i = ParamCount) or not TryStrToInt(ParamStr(i + 1), value) or (value < 0)) then
+            begin
+                WriteLn(ErrOutput, 'Invalid value for ' + param);
+                Exit(False);
+            end;
+
+            Inc(i);
+
+            if (param = '-w') then
+                m_Warmup := value
+            else
+            if (param = '-r') then
+                m_Repetitions := Max(value, 1)
+            else
+            if (param = '-s') then
+                m_Size := Max(value, 1)
+            else
+            if (param = '-t') then
+                m_Threads := value
+            else
+            if (param = '-i') then
+                m_IconSize := Max(value, 1)
+            else
+                m_Frames := Max(value, 1);
+        end
+        else
+        if (TDirectory.Exists(param)) then
+            m_Dirs.Add(param)
+        else
+        begin
+            WriteLn(ErrOutput, 'Directory not found: ' + param);
+            Exit(False);
+        end;
+
+        Inc(i);
+    end;
+
+    // by default, use the sample and demo images, the executable being built in the
+    // Samples\Benchmark\<version>\<platform>\<config> directory
+    if (m_Dirs.Count = 0) then
+    begin
+        exeDir := ExtractFilePath(ParamStr(0));
+
+        if (TDirectory.Exists(exeDir + '..\..\..\..\Common\Images')) then
+            m_Dirs.Add(exeDir + '..\..\..\..\Common\Images');
+
+        if (TDirectory.Exists(exeDir + '..\..\..\..\..\demo\delphi\Images')) then
+            m_Dirs.Add(exeDir + '..\..\..\..\..\demo\delphi\Images');
+    end;
+
+    Result := True;
+end;
+//---------------------------------------------------------------------------
+function TBenchmark.Run: Boolean;
+var
+    pOutput:   IWSmartPointer<TJSONObject>;
+    pSettings: TJSONObject;
+    dir:       UnicodeString;
+    files:     TStringDynArray;
+    fileName:  UnicodeString;
+    document:  IDocument;
+begin
+    // the XML parser may rely on COM
+    CoInitialize(nil);
+
+    try
+        // build the corpus, sorted to always run the documents in the same order
+        for dir in m_Dirs do
+        begin
+            files := TDirectory.GetFiles(dir, '*.svg');
+            TArray.Sort<UnicodeString>(files);
+
+            for fileName in files do
+                AddDocument(ExtractFileName(fileName), 'file', TFile.ReadAllBytes(fileName));
+        end;
+
+        AddGeneratedDocuments;
+
+        for document in m_pDocuments do
+            try
+                RunDocument(document);
+            except
+                on e: Exception do
+                    WriteLn(ErrOutput, Format('%-32s FAILED - %s', [document.m_Name, e.Message]));
+            end;
+
+        pSettings := TJSONObject.Create;
+        pSettings.AddPair('warmup',      TJSONNumber.Create(m_Warmup));
+        pSettings.AddPair('repetitions', TJSONNumber.Create(m_Repetitions));
+        pSettings.AddPair('size',        TJSONNumber.Create(m_Size));
+        pSettings.AddPair('frames',      TJSONNumber.Create(m_Frames));
+        pSettings.AddPair('threads',     TJSONNumber.Create(m_Threads));
+        pSettings.AddPair('icon_size',   TJSONNumber.Create(m_IconSize));
+
+        pOutput := TWSmartPointer<TJSONObject>.Create();
+        pOutput.AddPair('timestamp',  DateToISO8601(Now, False));
+        pOutput.AddPair('compiler',   TJSONNumber.Create(CompilerVersion));
+        {$ifdef WIN64}
+            pOutput.AddPair('platform', 'Win64');
+        {$else}
+            pOutput.AddPair('platform', 'Win32');
+        {$endif}
+        pOutput.AddPair('processors', TJSONNumber.Create(TThread.ProcessorCount));
+        pOutput.AddPair('settings',   pSettings);
+
+        // the results are now owned by the output
+        pOutput.AddPair('results', m_pResults);
+        m_pResults := TJSONArray.Create;
+
+        if (m_OutputFile.IsEmpty) then
+            WriteLn(pOutput.Format)
+        else
+            TFile.WriteAllText(m_OutputFile, pOutput.Format, TEncoding.UTF8);
+    finally
+        CoUninitialize;
+    end;
+
+    Result := True;
+end;
+//---------------------------------------------------------------------------
+class procedure TBenchmark.PrintUsage;
+begin
+    WriteLn('Usage: Benchmark [options] [<directory>...]');
+    WriteLn;
+    WriteLn('Runs the parse, serialize, optimize, rasterize and animate phases on the SVG files of');
+    WriteLn('the directories (by default the sample and demo images) and on generated stress');
+    WriteLn('documents. The static frame is also rasterized directly in a memory buffer, from the');
+    WriteLn('optimized tree, and from several threads at once, each thread drawing with its own');
+    WriteLn('render context. The hit index build and the hit test queries, the draw cost of each');
+    WriteLn('document as an image list icon, the load time of an image list of 100 icons, with and');
+    WriteLn('without lazy loading, and the time until a document loaded asynchronously is ready,');
+    WriteLn('are also measured. The static frame is finally rasterized at common icon sizes, in');
+    WriteLn('full and in draft quality, to compare the render time per icon, and the animations');
+    WriteLn('are measured frame by frame, the first frame compiling the animations. The processor');
+    WriteLn('time spent to animate 16 copies of each document is measured without frame cache,');
+    WriteLn('while the frame cache is filled, and once it is complete, and an animation cycle is');
+    WriteLn('drawn with and without the partial redraw.');
+    WriteLn;
+    WriteLn('Options:');
+    WriteLn('  -o <file>    JSON result file (default: standard output)');
+    WriteLn('  -w <count>   Warm-up runs per phase (default: 3)');
+    WriteLn('  -r <count>   Measured runs per phase (default: 10)');
+    WriteLn('  -s <size>    Draw size in pixels (default: 512)');
+    WriteLn('  -n <count>   Frames per animation cycle (default: 30)');
+    WriteLn('  -t <count>   Threads of the concurrent phase, 0 to skip it (default: 4)');
+    WriteLn('  -i <size>    Icon size of the image list phase, in pixels (default: 32)');
+end;
+//---------------------------------------------------------------------------
+
+end.
@@ -521,6 +521,7 @@ void TMainForm::OpenBrowserPage()
 
     // configure the viewer events
     imViewer->OnAnimate = Browser_OnAnimate;
+    imViewer->OnLoaded  = Browser_OnLoaded;
 
     // configure the slideshow timer position
     tbSlideshowTimer->Position = tiSlideshow->Interval;
@@ -563,17 +564,21 @@ UnicodeString TMainForm::Browser_GetDefaultImgDir() const
 void TMainForm::Browser_ClearView()
 {
     // clear previous view
+    imViewer->CancelLoad();
+    Browser_ClearAnimation();
+    imViewer->Picture->Assign(NULL);
+}
+//---------------------------------------------------------------------------
+void TMainForm::Browser_ClearAnimation()
+{
     acAnimate->Enabled          = false;
     edBrowserAnimSpeed->Enabled = false;
     udBrowserAnimSpeed->Enabled = false;
     edBrowserAnimSpeed->Text    = L"0";
-    imViewer->Picture->Assign(NULL);
 }
 //---------------------------------------------------------------------------
 void TMainForm::Browser_OpenSVG(const UnicodeString& fileName)
 {
-    Browser_ClearView();
-
     // save the current directory
     m_CurrentDir = ::IncludeTrailingPathDelimiter(::ExtractFilePath(fileName));
 
@@ -614,14 +619,31 @@ void TMainForm::Browser_OpenSVG(const UnicodeString& fileName)
         lbDir->Invalidate();
     }
 
-    // load and configure the SVG file
-    std::unique_ptr<TWSVGGraphic> pSvg(new TWSVGGraphic());
-    pSvg->LoadFromFile(fileName);
-    pSvg->Proportional = true;
+    // load the SVG file in background, the previous SVG is shown until the new one is ready, and
+    // is configured in Browser_OnLoaded(). Browsing quickly cancels the loads still running. NOTE
+    // the SVG is loaded with the size and options it will be shown with, otherwise the first frame
+    // rendered in background could not be shown
+    if (acFitToView->Checked)
+        imViewer->LoadFromFileAsync(fileName, imViewer->Width, imViewer->Height, true);
+    else
+        imViewer->LoadFromFileAsync(fileName, 0, 0, true);
+}
+//---------------------------------------------------------------------------
+void __fastcall TMainForm::Browser_OnLoaded(TObject* pSender, bool success)
+{
+    TWSVGGraphic* pSvg = dynamic_cast<TWSVGGraphic*>(imViewer->Picture->Graphic);
+
+    // SVG could not be loaded? Keep the previous one
+    if (!success || !pSvg)
+        return;
+
+    // the animation interface is enabled again if the new SVG is animated
+    Browser_ClearAnimation();
 
+    // configure the SVG. NOTE it's already proportional, as requested while loading
     if (acFitToView->Checked)
     {
-        // set SVG size to fit the view
+        // set SVG size to fit the view, the same size was requested while loading
         pSvg->Width  = imViewer->Width;
         pSvg->Height = imViewer->Height;
     }
@@ -638,9 +660,6 @@ void TMainForm::Browser_OpenSVG(const UnicodeString& fileName)
         pSvg->Width  = svgSize.Width;
         pSvg->Height = svgSize.Height;
     }
-
-    // show it in viewer
-    imViewer->Picture->Assign(pSvg.get());
 }
 //---------------------------------------------------------------------------
 void TMainForm::Browser_OnResize()
@@ -427,6 +427,11 @@ class TMainForm : public TForm
         */
         void Browser_ClearView();
 
+        /**
+        * Clear the browser animation interface
+        */
+        void Browser_ClearAnimation();
+
         /**
         * Open a SVG file and show it on the view
         *@param fileName - SVG file name to open
@@ -448,6 +453,13 @@ class TMainForm : public TForm
         bool __fastcall Browser_OnAnimate(TObject* pSender, TWSVGAnimationDescriptor* pAnimDesc,
                 void* pCustomData);
 
+        /**
+        * Called when the SVG opened in the view is ready, or could not be loaded
+        *@param pSender - event sender
+        *@param success - if true, the SVG was loaded, otherwise the previous one is kept
+        */
+        void __fastcall Browser_OnLoaded(TObject* pSender, bool success);
+
         /**
         * Make a control with a rounded background
         *@param pControl - control to make rounded
@@ -404,6 +404,11 @@ type
             }
             procedure Browser_ClearView;
 
+            {**
+             Clear the browser animation interface
+            }
+            procedure Browser_ClearAnimation;
+
             {**
              Open a SVG file and show it on the view
              @param(fileName SVG file name to open)
@@ -425,6 +430,13 @@ type
             function Browser_OnAnimate(pSender: TObject; pAnimDesc: TWSVGAnimationDescriptor;
                     pCustomData: Pointer): Boolean;
 
+            {**
+             Called when the SVG opened in the view is ready, or could not be loaded
+             @param(pSender Event sender)
+             @param(success If @true, the SVG was loaded, otherwise the previous one is kept)
+            }
+            procedure Browser_OnLoaded(pSender: TObject; success: Boolean);
+
             {**
              Make a control with a rounded background
              @param(pControl Control to make rounded)
@@ -1002,6 +1014,7 @@ begin
 
     // configure the viewer events
     imViewer.OnAnimate := Browser_OnAnimate;
+    imViewer.OnLoaded  := Browser_OnLoaded;
 
     // configure the slideshow timer position
     tbSlideshowTimer.Position := tiSlideshow.Interval;
@@ -1046,22 +1059,24 @@ end;
 procedure TMainForm.Browser_ClearView;
 begin
     // clear previous view
+    imViewer.CancelLoad;
+    Browser_ClearAnimation;
+    imViewer.Picture.Assign(nil);
+end;
+//---------------------------------------------------------------------------
+procedure TMainForm.Browser_ClearAnimation;
+begin
     acAnimate.Enabled          := False;
     edBrowserAnimSpeed.Enabled := False;
     udBrowserAnimSpeed.Enabled := False;
     edBrowserAnimSpeed.Text    := '0';
-    imViewer.Picture.Assign(nil);
 end;
 //---------------------------------------------------------------------------
 procedure TMainForm.Browser_OpenSVG(fileName: UnicodeString);
 var
     svgName: UnicodeString;
     fileRec: TSearchRec;
-    pSvg:    IWSmartPointer<TWSVGGraphic>;
-    svgSize: TSize;
 begin
-    Browser_ClearView();
-
     // save the current directory
     m_CurrentDir := IncludeTrailingPathDelimiter(ExtractFilePath(fileName));
 
@@ -1095,14 +1110,34 @@ begin
         lbDir.Invalidate;
     end;
 
-    // load and configure the SVG file
-    pSvg              := TWSmartPointer<TWSVGGraphic>.Create();
-    pSvg.LoadFromFile(fileName);
-    pSvg.Proportional := true;
+    // load the SVG file in background, the previous SVG is shown until the new one is ready, and
+    // is configured in Browser_OnLoaded(). Browsing quickly cancels the loads still running. NOTE
+    // the SVG is loaded with the size and options it will be shown with, otherwise the first frame
+    // rendered in background could not be shown
+    if (acFitToView.Checked) then
+        imViewer.LoadFromFileAsync(fileName, imViewer.Width, imViewer.Height, True)
+    else
+        imViewer.LoadFromFileAsync(fileName, 0, 0, True);
+end;
+//---------------------------------------------------------------------------
+procedure TMainForm.Browser_OnLoaded(pSender: TObject; success: Boolean);
+var
+    pSvg:    TWSVGGraphic;
+    svgSize: TSize;
+begin
+    // SVG could not be loaded? Keep the previous one
+    if (not success or not(imViewer.Picture.Graphic is TWSVGGraphic)) then
+        Exit;
+
+    // the animation interface is enabled again if the new SVG is animated
+    Browser_ClearAnimation;
+
+    // configure the SVG. NOTE it's already proportional, as requested while loading
+    pSvg := imViewer.Picture.Graphic as TWSVGGraphic;
 
     if (acFitToView.Checked) then
     begin
-        // set SVG size to fit the view
+        // set SVG size to fit the view, the same size was requested while loading
         pSvg.Width  := imViewer.Width;
         pSvg.Height := imViewer.Height;
     end
@@ -1119,9 +1154,6 @@ begin
         pSvg.Width  := svgSize.Width;
         pSvg.Height := svgSize.Height;
     end;
-
-    // show it in viewer
-    imViewer.Picture.Assign(pSvg);
 end;
 //---------------------------------------------------------------------------
 procedure TMainForm.Browser_OnResize;
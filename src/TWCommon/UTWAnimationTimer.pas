@@ -9,10 +9,24 @@ interface
 
 uses System.Classes,
      System.SysUtils,
+     System.Generics.Collections,
+     System.Diagnostics,
+     System.Types,
      Vcl.ExtCtrls,
+     Vcl.Forms,
      Winapi.Windows,
      UTWDesignPatterns;
 
+const
+    //---------------------------------------------------------------------------
+    // Global constants
+    //---------------------------------------------------------------------------
+    C_TWAnimationTimer_Base_Interval      = 20;  // in milliseconds
+    C_TWAnimationTimer_Min_Interval       = 10;  // in milliseconds
+    C_TWAnimationTimer_Minimized_Interval = 250; // in milliseconds
+    C_TWAnimationTimer_Default_FPS        = 50;
+    //---------------------------------------------------------------------------
+
 type
     {**
      VCL animation timer message info
@@ -25,7 +39,73 @@ type
     end;
 
     {**
-     Global animation timer based on the VCL TTimer control
+     Monotonic clock used by the animation timer to measure the time
+    }
+    TWAnimationClock = class
+        public
+            {**
+             Constructor
+            }
+            constructor Create; virtual;
+
+            {**
+             Destructor
+            }
+            destructor Destroy; override;
+
+            {**
+             Get the current time
+             @returns(Current time in milliseconds, the origin is left to the implementation)
+             @br @bold(NOTE) The default implementation uses the high resolution performance counter
+            }
+            function GetTime: Double; virtual;
+    end;
+
+    {**
+     Animation clock which only advances on demand, e.g. to run the animations in a headless
+     environment, or to get a reproducible timing while testing
+    }
+    TWManualAnimationClock = class(TWAnimationClock)
+        private
+            m_Time: Double;
+
+        public
+            {**
+             Constructor
+            }
+            constructor Create; override;
+
+            {**
+             Get the current time
+             @returns(Current time in milliseconds)
+            }
+            function GetTime: Double; override;
+
+            {**
+             Advance the time
+             @param(elapsed Elapsed time in milliseconds)
+            }
+            procedure Advance(elapsed: Double); virtual;
+
+        public
+            {**
+             Get or set the current time in milliseconds
+            }
+            property Time: Double read m_Time write m_Time;
+    end;
+
+    {**
+     Global animation timer based on the VCL TTimer control. The timer acts as a frame scheduler:
+     each observer may run at its own frame rate, may be suspended by its owner while it has
+     nothing to animate or isn't visible, and may request a coalesced invalidation, which is sent
+     once after all the observers were notified. The windows invalidated while the observers are
+     notified are also batched, and each window is invalidated once per tick. While the application
+     is minimized, no frame is generated at all
+     @br @bold(NOTE) The ticker runs at 20 ms, the default frame interval, unless a running
+                     observer requires a shorter interval, in which case it runs at the observer
+                     interval, but not faster than 10 ms. So the idle wakeups are not increased
+                     for the observers running at the default frame rate. While the application is
+                     minimized, the ticker only runs every 250 ms, to detect when it is restored
     }
     TWAnimationTimer = class sealed (TInterfacedObject, IWSubject)
         public type
@@ -33,21 +113,64 @@ type
              Animation messages that can be sent to observers
              @value(IE_AM_Animate Message notifying that a new animation frame should be generated)
              @value(IE_AM_Destroying Message notifying that the animation timer is being destroyed)
+             @value(IE_AM_Invalidate Message notifying that the observer may repaint itself, sent
+                                     once per tick to the observers which called Invalidate())
              @br @bold(NOTE) These values begin on 0 to not interfere with other messages. The
                              allowed range for a new animation timer message is between 0 and 99
             }
             EWAnimationTimerMessages =
             (
                 IE_AM_Animate = 0,
-                IE_AM_Destroying
+                IE_AM_Destroying,
+                IE_AM_Invalidate
             );
 
+        private type
+            {**
+             Scheduled observer
+            }
+            IObserverItem = class
+                public
+                    m_pObserver:  Pointer;
+                    m_Interval:   Double;
+                    m_LastTime:   Double;
+                    m_Suspended:  Boolean;
+                    m_Invalidate: Boolean;
+
+                    {**
+                     Constructor
+                     @param(pObserver Observer)
+                     @param(time Current time in milliseconds)
+                    }
+                    constructor Create(pObserver: Pointer; time: Double); virtual;
+            end;
+
+            IObservers   = TObjectList<IObserverItem>;
+            IObserverMap = TDictionary<Pointer, IObserverItem>;
+
+            {**
+             Window invalidated while the observers are notified
+            }
+            IDirtyWindow = record
+                m_hRegion: HRGN;
+                m_Erase:   Boolean;
+            end;
+
+            IDirtyWindows = TDictionary<HWND, IDirtyWindow>;
+
         private
-            class var m_pInstance:    IWSubject;
-                      m_pTimer:       TTimer;
-                      m_pObservers:   TList;
-                      m_PreviousTime: Double;
-                      m_Info:         TWAnimationTimerMsgInfo;
+            class var m_pInstance: IWSubject;
+                      m_pTimer:    TWAnimationTimer;
+
+            m_pTicker:       TTimer;
+            m_pObservers:    IObservers;
+            m_pObserverMap:  IObserverMap;
+            m_pDirtyWindows: IDirtyWindows;
+            m_pClock:        TWAnimationClock;
+            m_Info:          TWAnimationTimerMsgInfo;
+            m_Notifying:     Boolean;
+            m_Purge:         Boolean;
+            m_Headless:      Boolean;
 
             {**
              Called when animation should be rendered
@@ -55,6 +178,43 @@ type
             }
             procedure OnAnimate(pSender: TObject);
 
+            {**
+             Find the scheduled item matching with an observer
+             @param(pObserver Observer to find)
+             @returns(Scheduled item, @nil if not found)
+            }
+            function Find(pObserver: IWObserver): IObserverItem; inline;
+
+            {**
+             Invalidate once each window batched while the observers were notified
+            }
+            procedure FlushWindows;
+
+            {**
+             Check if the application is minimized, in which case no animation is visible
+             @returns(@true if the application is minimized, otherwise @false)
+             @br @bold(NOTE) Always @false in headless mode, where the caller drives the animations
+            }
+            function IsMinimized: Boolean;
+
+            {**
+             Remove the detached observers from the list
+            }
+            procedure Purge;
+
+            {**
+             Enable the ticker if at least one observer is running, disable it otherwise, and adapt
+             its interval to the shortest running observer interval
+            }
+            procedure UpdateTicker;
+
+            {**
+             Set the headless mode
+             @param(value If @true, the ticker is never started and the Tick() function should be
+                          called by the caller)
+            }
+            procedure SetHeadless(value: Boolean);
+
         public
             {**
              Constructor
@@ -72,6 +232,14 @@ type
             }
             class function GetInstance: IWSubject; static;
 
+            {**
+             Gets animation timer, creates one if still not created
+             @return(Animation timer)
+             @br @bold(NOTE) The timer lifetime is controlled by the instance returned by
+                             GetInstance(), don't free it
+            }
+            class function GetTimer: TWAnimationTimer; static;
+
             {**
              Attaches observer
              @param(pObserver Observer to attach)
@@ -81,6 +249,8 @@ type
             {**
              Detaches observer
              @param(pObserver Observer to detach)
+             @br @bold(NOTE) An observer may safely detach itself, or another observer, while it
+                             is notified
             }
             procedure Detach(pObserver: IWObserver);
 
@@ -89,13 +259,132 @@ type
              @param(message Notification message)
             }
             procedure Notify(message: TWMessage);
+
+            {**
+             Set the frame rate at which an observer should be animated
+             @param(pObserver Observer for which the frame rate should be set)
+             @param(fps Frame rate, in frames per seconds)
+            }
+            procedure SetFrameRate(pObserver: IWObserver; fps: Cardinal);
+
+            {**
+             Suspend an observer, e.g. because it is hidden or its animation ended. A suspended
+             observer receives no animation message until it is resumed
+             @param(pObserver Observer to suspend)
+            }
+            procedure Suspend(pObserver: IWObserver);
+
+            {**
+             Resume a suspended observer
+             @param(pObserver Observer to resume)
+            }
+            procedure Resume(pObserver: IWObserver);
+
+            {**
+             Check if an observer is suspended
+             @param(pObserver Observer to check)
+             @returns(@true if the observer is suspended or not attached, otherwise @false)
+            }
+            function IsSuspended(pObserver: IWObserver): Boolean;
+
+            {**
+             Request an invalidation for an observer. All the requests received while the observers
+             are animated are coalesced, and the observer receives a single IE_AM_Invalidate
+             message once the tick is completed
+             @param(pObserver Observer requesting the invalidation)
+            }
+            procedure Invalidate(pObserver: IWObserver);
+
+            {**
+             Invalidate a window region. While the observers are notified, the regions are merged
+             by window, and each window is invalidated once after all the observers were notified
+             @param(hWnd Window to invalidate)
+             @param(rect Region to invalidate, in window client coordinates)
+             @param(erase If @true, the background is erased)
+             @br @bold(NOTE) If called outside the notification, the window is invalidated immediately
+            }
+            procedure InvalidateWindow(hWnd: HWND; const rect: TRect; erase: Boolean);
+
+            {**
+             Process one tick, i.e. animate the observers for which a new frame is due, then send
+             the pending invalidations
+            }
+            procedure Tick;
+
+            {**
+             Set the clock used to measure the time
+             @param(pClock Clock to use, @nil to restore the default clock)
+             @br @bold(NOTE) The timer takes the ownership of the clock
+            }
+            procedure SetClock(pClock: TWAnimationClock);
+
+        public
+            {**
+             Get the clock used to measure the time
+            }
+            property Clock: TWAnimationClock read m_pClock;
+
+            {**
+             Get or set the headless mode. In this mode the internal VCL timer is never started,
+             and the animations only advance when Tick() is called
+            }
+            property Headless: Boolean read m_Headless write SetHeadless;
     end;
 
 implementation
 
 uses
-  System.Types;
+  UTWHelpers;
 
+//---------------------------------------------------------------------------
+// TWAnimationClock
+//---------------------------------------------------------------------------
+constructor TWAnimationClock.Create;
+begin
+    inherited Create;
+end;
+//---------------------------------------------------------------------------
+destructor TWAnimationClock.Destroy;
+begin
+    inherited Destroy;
+end;
+//---------------------------------------------------------------------------
+function TWAnimationClock.GetTime: Double;
+begin
+    Result := (TStopwatch.GetTimeStamp * 1000.0) / TStopwatch.Frequency;
+end;
+//---------------------------------------------------------------------------
+// TWManualAnimationClock
+//---------------------------------------------------------------------------
+constructor TWManualAnimationClock.Create;
+begin
+    inherited Create;
+
+    m_Time := 0.0;
+end;
+//---------------------------------------------------------------------------
+function TWManualAnimationClock.GetTime: Double;
+begin
+    Result := m_Time;
+end;
+//---------------------------------------------------------------------------
+procedure TWManualAnimationClock.Advance(elapsed: Double);
+begin
+    m_Time := m_Time + elapsed;
+end;
+//---------------------------------------------------------------------------
+// TWAnimationTimer.IObserverItem
+//---------------------------------------------------------------------------
+constructor TWAnimationTimer.IObserverItem.Create(pObserver: Pointer; time: Double);
+begin
+    inherited Create;
+
+    m_pObserver  := pObserver;
+    m_Interval   := 1000.0 / C_TWAnimationTimer_Default_FPS;
+    m_LastTime   := time;
+    m_Suspended  := False;
+    m_Invalidate := False;
+end;
 //---------------------------------------------------------------------------
 // TWAnimationTimer
 //---------------------------------------------------------------------------
@@ -108,14 +397,21 @@ begin
     inherited Create;
 
     // configure internal variables
-    m_pObservers   := TList.Create;
-    m_PreviousTime := GetTickCount;
+    m_pObservers    := IObservers.Create;
+    m_pObserverMap  := IObserverMap.Create;
+    m_pDirtyWindows := IDirtyWindows.Create;
+    m_pClock        := TWAnimationClock.Create;
+    m_Notifying     := False;
+    m_Purge         := False;
+    m_Headless      := False;
 
-    // configure animation timer (an interval of 20 means ~50 fps)
-    m_pTimer          := TTimer.Create(nil);
-    m_pTimer.Interval := 20;
-    m_pTimer.OnTimer  := OnAnimate;
-    m_pTimer.Enabled  := True;
+    // configure the ticker. Its interval is only the scheduling resolution, each observer is
+    // animated at its own frame rate (50 fps by default). The ticker only runs while at least one
+    // observer is running
+    m_pTicker          := TTimer.Create(nil);
+    m_pTicker.Interval := C_TWAnimationTimer_Base_Interval;
+    m_pTicker.OnTimer  := OnAnimate;
+    m_pTicker.Enabled  := False;
 end;
 //---------------------------------------------------------------------------
 destructor TWAnimationTimer.Destroy;
@@ -129,31 +425,118 @@ begin
     // notify all observers about destruction
     Notify(message);
 
+    // release the regions which were never flushed, if any
+    FlushWindows;
+
     // clear memory
-    m_pTimer.Free;
+    m_pTicker.Free;
+    m_pDirtyWindows.Free;
+    m_pObserverMap.Free;
     m_pObservers.Free;
+    m_pClock.Free;
 
     inherited Destroy;
 
     m_pInstance := nil;
+    m_pTimer    := nil;
 end;
 //---------------------------------------------------------------------------
 procedure TWAnimationTimer.OnAnimate(pSender: TObject);
+begin
+    Tick;
+end;
+//---------------------------------------------------------------------------
+function TWAnimationTimer.Find(pObserver: IWObserver): IObserverItem;
+begin
+    // the observers are searched in a map, because many graphics may be attached at once, e.g. in
+    // a large image list or a gallery
+    if (not m_pObserverMap.TryGetValue(Pointer(pObserver), Result)) then
+        Result := nil;
+end;
+//---------------------------------------------------------------------------
+procedure TWAnimationTimer.FlushWindows;
 var
-    now:     NativeUInt;
-    message: TWMessage;
+    pair: TPair<HWND, IDirtyWindow>;
 begin
-    // calculate time interval
-    now                  :=  GetTickCount;
-    m_Info.m_ElapsedTime := (now - m_PreviousTime);
-    m_PreviousTime       :=  now;
+    for pair in m_pDirtyWindows do
+    begin
+        InvalidateRgn(pair.Key, pair.Value.m_hRegion, pair.Value.m_Erase);
+        DeleteObject(pair.Value.m_hRegion);
+    end;
 
-    // configure animation message
-    message.m_Type  := NativeUInt(IE_AM_Animate);
-    message.m_pInfo := @m_Info;
+    m_pDirtyWindows.Clear;
+end;
+//---------------------------------------------------------------------------
+function TWAnimationTimer.IsMinimized: Boolean;
+begin
+    if (m_Headless or not Assigned(Application)) then
+        Exit(False);
 
-    // notify all observers about animation
-    Notify(message);
+    // NOTE depending on the MainFormOnTaskBar option, either the application window or the main
+    // form is minimized
+    if (IsIconic(Application.Handle)) then
+        Exit(True);
+
+    Result := (Assigned(Application.MainForm) and Application.MainForm.HandleAllocated
+            and IsIconic(Application.MainForm.Handle));
+end;
+//---------------------------------------------------------------------------
+procedure TWAnimationTimer.Purge;
+var
+    i: Integer;
+begin
+    // nothing to purge?
+    if (not m_Purge) then
+        Exit;
+
+    m_Purge := False;
+
+    // remove the detached observers
+    for i := m_pObservers.Count - 1 downto 0 do
+        if (not Assigned(m_pObservers[i].m_pObserver)) then
+            m_pObservers.Delete(i);
+end;
+//---------------------------------------------------------------------------
+procedure TWAnimationTimer.UpdateTicker;
+var
+    pItem:    IObserverItem;
+    running:  Boolean;
+    interval: Double;
+begin
+    running  := False;
+    interval := C_TWAnimationTimer_Base_Interval;
+
+    // search for the running observers, or the observers waiting for their invalidation, and for
+    // the shortest interval they require
+    if (not m_Headless) then
+        for pItem in m_pObservers do
+            if (Assigned(pItem.m_pObserver) and ((not pItem.m_Suspended) or pItem.m_Invalidate)) then
+            begin
+                running := True;
+
+                if ((not pItem.m_Suspended) and (pItem.m_Interval < interval)) then
+                    interval := pItem.m_Interval;
+            end;
+
+    // nothing is visible while the application is minimized, so only poll until it is restored
+    if (running and IsMinimized) then
+        interval := C_TWAnimationTimer_Minimized_Interval;
+
+    // NOTE changing the interval restarts the timer, so only change it when required
+    if (interval < C_TWAnimationTimer_Min_Interval) then
+        interval := C_TWAnimationTimer_Min_Interval;
+
+    if (m_pTicker.Interval <> Cardinal(Round(interval))) then
+        m_pTicker.Interval := Round(interval);
+
+    m_pTicker.Enabled := running;
+end;
+//---------------------------------------------------------------------------
+procedure TWAnimationTimer.SetHeadless(value: Boolean);
+begin
+    m_Headless := value;
+
+    UpdateTicker;
 end;
 //---------------------------------------------------------------------------
 class function TWAnimationTimer.GetInstance: IWSubject;
@@ -164,45 +547,307 @@ begin
         Exit(m_pInstance);
 
     // create new singleton instance
-    m_pInstance := TWAnimationTimer.Create;
+    m_pTimer    := TWAnimationTimer.Create;
+    m_pInstance := m_pTimer;
     Result      := m_pInstance;
 end;
 //---------------------------------------------------------------------------
+class function TWAnimationTimer.GetTimer: TWAnimationTimer;
+begin
+    // create the singleton instance if still not done
+    GetInstance;
+
+    Result := m_pTimer;
+end;
+//---------------------------------------------------------------------------
 procedure TWAnimationTimer.Attach(pObserver: IWObserver);
+var
+    pItem: IObserverItem;
 begin
     // observer already exists in observers list?
-    if (m_pObservers.IndexOf(Pointer(pObserver)) <> -1) then
+    if (Assigned(Find(pObserver))) then
         Exit;
 
     // add observer to observers list
-    m_pObservers.Add(Pointer(pObserver));
+    pItem := IObserverItem.Create(Pointer(pObserver), m_pClock.GetTime);
+    m_pObservers.Add(pItem);
+    m_pObserverMap.Add(Pointer(pObserver), pItem);
+
+    UpdateTicker;
 end;
 //---------------------------------------------------------------------------
 procedure TWAnimationTimer.Detach(pObserver: IWObserver);
+var
+    pItem: IObserverItem;
 begin
-    // remove observer from observers list. NOTE observer list will check if observer exists before
-    // trying to remove it, so this check isn't necessary here
-    m_pObservers.Remove(Pointer(pObserver));
+    pItem := Find(pObserver);
+
+    // not attached?
+    if (not Assigned(pItem)) then
+        Exit;
+
+    m_pObserverMap.Remove(Pointer(pObserver));
+
+    // observers are being notified? If yes, the list cannot be modified now, so just mark the
+    // item as detached, it will be removed once the notification is done
+    if (m_Notifying) then
+    begin
+        pItem.m_pObserver := nil;
+        m_Purge           := True;
+    end
+    else
+        m_pObservers.Remove(pItem);
+
+    UpdateTicker;
 end;
 //---------------------------------------------------------------------------
 procedure TWAnimationTimer.Notify(message: TWMessage);
 var
-    pObject: Pointer;
-    pItem:   IWObserver;
+    i:            Integer;
+    pObserver:    Pointer;
+    wasNotifying: Boolean;
+begin
+    wasNotifying := m_Notifying;
+    m_Notifying  := True;
+
+    try
+        // iterate through observers to notify. NOTE the observers added while notifying are not
+        // notified
+        for i := 0 to m_pObservers.Count - 1 do
+        begin
+            // get observer
+            pObserver := m_pObservers[i].m_pObserver;
+
+            // found it?
+            if (not Assigned(pObserver)) then
+                continue;
+
+            // notify observer about message
+            IWObserver(pObserver).OnNotified(message);
+        end;
+    finally
+        m_Notifying := wasNotifying;
+    end;
+
+    if (not m_Notifying) then
+        Purge;
+end;
+//---------------------------------------------------------------------------
+procedure TWAnimationTimer.SetFrameRate(pObserver: IWObserver; fps: Cardinal);
+var
+    pItem: IObserverItem;
+begin
+    pItem := Find(pObserver);
+
+    // not attached?
+    if (not Assigned(pItem)) then
+        Exit;
+
+    if (fps = 0) then
+        fps := C_TWAnimationTimer_Default_FPS;
+
+    pItem.m_Interval := 1000.0 / fps;
+
+    UpdateTicker;
+end;
+//---------------------------------------------------------------------------
+procedure TWAnimationTimer.Suspend(pObserver: IWObserver);
+var
+    pItem: IObserverItem;
+begin
+    pItem := Find(pObserver);
+
+    // not attached or already suspended?
+    if (not Assigned(pItem) or pItem.m_Suspended) then
+        Exit;
+
+    pItem.m_Suspended := True;
+
+    UpdateTicker;
+end;
+//---------------------------------------------------------------------------
+procedure TWAnimationTimer.Resume(pObserver: IWObserver);
+var
+    pItem: IObserverItem;
+begin
+    pItem := Find(pObserver);
+
+    // not attached or not suspended?
+    if (not Assigned(pItem) or not pItem.m_Suspended) then
+        Exit;
+
+    // restart the frame interval from now, the suspended time should not be reported as elapsed
+    pItem.m_Suspended := False;
+    pItem.m_LastTime  := m_pClock.GetTime;
+
+    UpdateTicker;
+end;
+//---------------------------------------------------------------------------
+function TWAnimationTimer.IsSuspended(pObserver: IWObserver): Boolean;
+var
+    pItem: IObserverItem;
+begin
+    pItem := Find(pObserver);
+
+    if (not Assigned(pItem)) then
+        Exit(True);
+
+    Result := pItem.m_Suspended;
+end;
+//---------------------------------------------------------------------------
+procedure TWAnimationTimer.Invalidate(pObserver: IWObserver);
+var
+    pItem: IObserverItem;
 begin
-    // iterate through observers to notify
-    for pObject in m_pObservers do
+    pItem := Find(pObserver);
+
+    // not attached?
+    if (not Assigned(pItem)) then
+        Exit;
+
+    pItem.m_Invalidate := True;
+
+    // if not called while animating, the invalidation should be sent on the next tick
+    if (not m_Notifying) then
+        m_pTicker.Enabled := not m_Headless;
+end;
+//---------------------------------------------------------------------------
+procedure TWAnimationTimer.InvalidateWindow(hWnd: HWND; const rect: TRect; erase: Boolean);
+var
+    dirty:   IDirtyWindow;
+    hRegion: HRGN;
+begin
+    // not notifying? Nothing to batch
+    if (not m_Notifying) then
     begin
-        // get observer
-        pItem := IWObserver(pObject);
+        InvalidateRect(hWnd, @rect, erase);
+        Exit;
+    end;
+
+    // merge the region with the previous ones of the same window
+    if (m_pDirtyWindows.TryGetValue(hWnd, dirty)) then
+    begin
+        hRegion := CreateRectRgnIndirect(rect);
 
-        // found it?
-        if (not Assigned(pItem)) then
-            continue;
+        try
+            CombineRgn(dirty.m_hRegion, dirty.m_hRegion, hRegion, RGN_OR);
+        finally
+            DeleteObject(hRegion);
+        end;
 
-        // notify observer about message
-        pItem.OnNotified(message);
+        dirty.m_Erase := dirty.m_Erase or erase;
+    end
+    else
+    begin
+        dirty.m_hRegion := CreateRectRgnIndirect(rect);
+        dirty.m_Erase   := erase;
     end;
+
+    m_pDirtyWindows.AddOrSetValue(hWnd, dirty);
+end;
+//---------------------------------------------------------------------------
+procedure TWAnimationTimer.Tick;
+var
+    i:          Integer;
+    now:        Double;
+    pItem:      IObserverItem;
+    message:    TWMessage;
+    traceStart: Int64;
+begin
+    // already ticking? (may happen if an observer processes the message queue while notified)
+    if (m_Notifying) then
+        Exit;
+
+    now := m_pClock.GetTime;
+
+    // application is minimized? No frame is generated, and the time spent while minimized isn't
+    // reported as elapsed once restored. NOTE the pending invalidations are kept until then
+    if (IsMinimized) then
+    begin
+        for pItem in m_pObservers do
+            pItem.m_LastTime := now;
+
+        UpdateTicker;
+        Exit;
+    end;
+
+    m_Notifying := True;
+    traceStart  := TWTraceHelper.Start;
+
+    try
+        // configure animation message
+        message.m_Type  := NativeUInt(IE_AM_Animate);
+        message.m_pInfo := @m_Info;
+
+        // animate the observers for which a frame is due. Half of the ticker interval is tolerated,
+        // otherwise an observer would often wait a whole additional tick
+        for i := 0 to m_pObservers.Count - 1 do
+        begin
+            pItem := m_pObservers[i];
+
+            if (not Assigned(pItem.m_pObserver) or pItem.m_Suspended) then
+                continue;
+
+            if ((now - pItem.m_LastTime) + (m_pTicker.Interval * 0.5) < pItem.m_Interval) then
+                continue;
+
+            // calculate time interval
+            m_Info.m_ElapsedTime := now - pItem.m_LastTime;
+            pItem.m_LastTime     := now;
+
+            // notify observer about animation
+            IWObserver(pItem.m_pObserver).OnNotified(message);
+        end;
+
+        // configure invalidation message
+        message.m_Type  := NativeUInt(IE_AM_Invalidate);
+        message.m_pInfo := nil;
+
+        // send the coalesced invalidations
+        for i := 0 to m_pObservers.Count - 1 do
+        begin
+            pItem := m_pObservers[i];
+
+            if (not Assigned(pItem.m_pObserver) or not pItem.m_Invalidate) then
+                continue;
+
+            pItem.m_Invalidate := False;
+
+            IWObserver(pItem.m_pObserver).OnNotified(message);
+        end;
+    finally
+        m_Notifying := False;
+
+        // invalidate each window once, with all the regions requested by its observers
+        FlushWindows;
+
+        TWTraceHelper.Stop('Timer tick', 'animation', traceStart);
+    end;
+
+    Purge;
+    UpdateTicker;
+end;
+//---------------------------------------------------------------------------
+procedure TWAnimationTimer.SetClock(pClock: TWAnimationClock);
+var
+    pItem: IObserverItem;
+    now:   Double;
+begin
+    if (pClock = m_pClock) then
+        Exit;
+
+    m_pClock.Free;
+
+    if (Assigned(pClock)) then
+        m_pClock := pClock
+    else
+        m_pClock := TWAnimationClock.Create;
+
+    now := m_pClock.GetTime;
+
+    // the previous times are meaningless with the new clock
+    for pItem in m_pObservers do
+        pItem.m_LastTime := now;
 end;
 //---------------------------------------------------------------------------
 
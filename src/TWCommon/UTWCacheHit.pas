@@ -17,9 +17,10 @@ type
     }
     TWCacheHit = class
         private
-            m_Name: UnicodeString;
-            m_Hit:  NativeUInt;
-            m_Miss: NativeUInt;
+            m_Name:         UnicodeString;
+            m_Hit:          NativeUInt;
+            m_Miss:         NativeUInt;
+            m_LogOnDestroy: Boolean;
 
         public
             {**
@@ -51,6 +52,11 @@ type
              Gets or sets the cache miss count
             }
             property Miss: NativeUInt read m_Miss write m_Miss;
+
+            {**
+             Gets or sets if the counters are logged when the object is destroyed
+            }
+            property LogOnDestroy: Boolean read m_LogOnDestroy write m_LogOnDestroy default True;
     end;
 
 implementation
@@ -59,13 +65,15 @@ constructor TWCacheHit.Create;
 begin
     inherited Create;
 
-    m_Hit  := 0;
-    m_Miss := 0;
+    m_Hit          := 0;
+    m_Miss         := 0;
+    m_LogOnDestroy := True;
 end;
 //---------------------------------------------------------------------------
 destructor TWCacheHit.Destroy;
 begin
-    Log;
+    if (m_LogOnDestroy) then
+        Log;
 
     inherited Destroy;
 end;
@@ -22,6 +22,7 @@ uses System.TypInfo,
      System.UITypes,
      System.Math,
      System.Generics.Collections,
+     System.Diagnostics,
      Vcl.Graphics,
      Vcl.Imaging.Jpeg,
      Vcl.Imaging.PngImage,
@@ -39,6 +40,7 @@ uses System.TypInfo,
      Winapi.GDIPObj,
      Winapi.Messages,
      Winapi.Windows,
+     Winapi.PsAPI,
      Usp10,
      UTWTypes,
      UTWCacheHit,
@@ -437,18 +439,71 @@ type
      Helper for memory
     }
     TWMemoryHelper = record
-        {**
-         Check if system on which program is executed is big endian
-         @returns(@true if system on which program is executed is big endian, @false if little endian)
-        }
-        class function IsSystemBE: Boolean; static;
+        public type
+            {**
+             Called when the memory retained by a structure is queried
+             @returns(Retained memory size, in bytes)
+            }
+            ITfGetMemorySize = reference to function: NativeUInt;
 
-        {**
-         Swap content of 2 variables with the same size
-         @param(left @bold([in, out]) First variable to swap)
-         @param(right @bold([in, out]) Second variable to swap)
-        }
-        class procedure Swap<T>(var left, right: T); static;
+        private type
+            IReporters = TDictionary<UnicodeString, ITfGetMemorySize>;
+
+        private
+            class var m_pReporters: IReporters;
+
+        public
+            {**
+             Check if system on which program is executed is big endian
+             @returns(@true if system on which program is executed is big endian, @false if little endian)
+            }
+            class function IsSystemBE: Boolean; static;
+
+            {**
+             Swap content of 2 variables with the same size
+             @param(left @bold([in, out]) First variable to swap)
+             @param(right @bold([in, out]) Second variable to swap)
+            }
+            class procedure Swap<T>(var left, right: T); static;
+
+            {**
+             Get the memory retained by a string
+             @param(str String to measure)
+             @returns(Retained memory size, in bytes, 0 for an empty string)
+             @br @bold(NOTE) A string shared by several owners is counted once per owner
+            }
+            class function GetStringSize(const str: UnicodeString): NativeUInt; static;
+
+            {**
+             Get the memory retained by a bitmap, including its pixels
+             @param(pBitmap Bitmap to measure)
+             @returns(Retained memory size, in bytes, 0 if bitmap is @nil)
+            }
+            class function GetBitmapSize(const pBitmap: Vcl.Graphics.TBitmap): NativeUInt; static;
+
+            {**
+             Register a memory reporter, which will be queried while the process summary is built
+             @param(name Reporter name, should be unique)
+             @param(fGetMemorySize Function returning the memory size retained by the reported structure)
+             @br @bold(NOTE) A reporter registered with an already existing name replaces it
+            }
+            class procedure RegisterReporter(const name: UnicodeString;
+                    fGetMemorySize: ITfGetMemorySize); static;
+
+            {**
+             Unregister a memory reporter
+             @param(name Reporter name)
+            }
+            class procedure UnregisterReporter(const name: UnicodeString); static;
+
+            {**
+             Get the process-wide memory summary
+             @param(pSummary String list to populate with name=value pairs, the values are in bytes)
+             @br @bold(NOTE) The summary contains the process working set and private bytes, the
+                             memory allocated by the memory manager, and the size reported by each
+                             registered reporter
+            }
+            class procedure GetSummary(pSummary: TStrings); static;
     end;
 
     {**
@@ -994,6 +1049,12 @@ type
             }
             destructor Destroy; override;
 
+            {**
+             Get the memory retained by the helper, including its cached bitmaps
+             @returns(Retained memory size, in bytes)
+            }
+            function GetMemorySize: NativeUInt; virtual;
+
             {**
              Draw a rectangle
              @param(rect Rect bounding rectangle to draw)
@@ -1338,6 +1399,22 @@ type
             }
             class function DrawTransparentImage(pGraphic: TGraphic; const pos: TPoint; opacity: Double;
                     pCanvas: TCanvas; pOverlay: Vcl.Graphics.TBitmap): Boolean; static;
+
+            {**
+             Blend a premultiplied 32 bit image above a canvas content
+             @param(pImage Premultiplied image to draw, read from its top left corner)
+             @param(srcWidth Width of the image area to draw)
+             @param(srcHeight Height of the image area to draw)
+             @param(pCanvas Destination canvas on which the image will be painted)
+             @param(x Destination x position)
+             @param(y Destination y position)
+             @param(width Destination width, the image is stretched if it differs from the source)
+             @param(height Destination height, the image is stretched if it differs from the source)
+             @param(alpha Global alpha to apply while blending, opaque by default)
+             @returns(@true on success, otherwise @false)
+            }
+            class function AlphaBlendImage(pImage: Vcl.Graphics.TBitmap; srcWidth, srcHeight: Integer;
+                    pCanvas: TCanvas; x, y, width, height: Integer; alpha: Byte = 255): Boolean; static;
     end;
 
     {**
@@ -1623,10 +1700,174 @@ type
         class procedure LogBlockToCompiler(const title: UnicodeString); static;
     end;
 
+    {**
+     Helper class to record a timeline of scoped events, which may be exported in the Chrome
+     trace-event format and opened in a trace viewer (e.g. chrome://tracing or Perfetto)
+     @br @bold(NOTE) The tracer is disabled by default, in this case the hooks only cost a test.
+                     Each thread records its events in its own ring buffer, thus recording never
+                     locks. When a buffer is full, its oldest events are overwritten
+    }
+    TWTraceHelper = record
+        private type
+            {**
+             Trace event
+             @br @bold(NOTE) The event contains no managed type, thus a reader may copy it while
+                             the owning thread overwrites it without corrupting the memory
+            }
+            IEvent = record
+                m_pName:     PWideChar;
+                m_Class:     TClass;
+                m_pCategory: PWideChar;
+                m_Phase:     WideChar;
+                m_Time:      Int64;
+                m_Duration:  Int64;
+            end;
+
+            {**
+             Per thread event ring buffer
+            }
+            IRingBuffer = class
+                private
+                    m_Events:   array of IEvent;
+                    m_Mask:     Integer;
+                    m_Written:  Integer;
+                    m_ThreadID: TThreadID;
+
+                public
+                    {**
+                     Constructor
+                     @param(capacity Buffer capacity, should be a power of 2)
+                    }
+                    constructor Create(capacity: Integer); virtual;
+
+                    {**
+                     Destructor
+                    }
+                    destructor Destroy; override;
+
+                    {**
+                     Add an event to the buffer, overwriting the oldest one if full
+                     @param(pName Event name, should be a static string, ignored if pClass is set)
+                     @param(pClass Class whose name is the event name, ignored if @nil)
+                     @param(pCategory Event category, should be a static string)
+                     @param(phase Event phase, as defined in the trace-event format)
+                     @param(time Event timestamp, in stopwatch ticks)
+                     @param(duration Event duration, in stopwatch ticks)
+                     @br @bold(NOTE) Should only be called from the thread owning the buffer
+                    }
+                    procedure Add(pName: PWideChar; pClass: TClass; pCategory: PWideChar;
+                            phase: WideChar; time, duration: Int64);
+            end;
+
+            IRingBuffers = TObjectList<IRingBuffer>;
+
+        private
+            class var m_Enabled:  Boolean;
+            class var m_Capacity: Integer;
+            class var m_pBuffers: IRingBuffers;
+
+            {**
+             Get the ring buffer owned by the calling thread, create it if still not exists
+             @returns(The calling thread ring buffer)
+            }
+            class function GetBuffer: IRingBuffer; static;
+
+            {**
+             Escape a string to write in a JSON document
+             @param(str String to escape)
+             @returns(Escaped string)
+            }
+            class function EscapeJSON(const str: UnicodeString): UnicodeString; static;
+
+            {**
+             Write a string to a stream as UTF-8
+             @param(str String to write)
+             @param(pStream Stream to write to)
+            }
+            class procedure WriteUTF8(const str: UnicodeString; pStream: TStream); static;
+
+        public
+            {**
+             Enable or disable the event recording
+             @param(value If @true, the events will be recorded)
+            }
+            class procedure SetEnabled(value: Boolean); static;
+
+            {**
+             Get if the event recording is enabled
+             @returns(@true if the events are recorded, otherwise @false)
+            }
+            class function IsEnabled: Boolean; static; inline;
+
+            {**
+             Set the number of events each thread may keep before overwriting the oldest ones
+             @param(value Event count, rounded up to the next power of 2)
+             @br @bold(NOTE) Only the buffers created after the call are affected
+            }
+            class procedure SetCapacity(value: Integer); static;
+
+            {**
+             Start a scoped event
+             @returns(Event start time, 0 if the recording is disabled)
+            }
+            class function Start: Int64; static; inline;
+
+            {**
+             Stop a scoped event and record it
+             @param(pName Event name, should be a static string)
+             @param(pCategory Event category, should be a static string)
+             @param(startTime Event start time, as returned by Start())
+            }
+            class procedure Stop(pName, pCategory: PWideChar; startTime: Int64); overload; static;
+
+            {**
+             Stop a scoped event and record it
+             @param(pClass Class whose name is the event name, e.g. the drawn element class)
+             @param(pCategory Event category, should be a static string)
+             @param(startTime Event start time, as returned by Start())
+            }
+            class procedure Stop(pClass: TClass; pCategory: PWideChar; startTime: Int64); overload; static;
+
+            {**
+             Record an instant event, e.g. a cache miss
+             @param(pName Event name, should be a static string)
+             @param(pCategory Event category, should be a static string)
+            }
+            class procedure Instant(pName, pCategory: PWideChar); static;
+
+            {**
+             Clear all the recorded events
+             @br @bold(NOTE) The recording should be disabled while the events are cleared
+            }
+            class procedure Clear; static;
+
+            {**
+             Save the recorded events in the Chrome trace-event JSON format
+             @param(pStream Stream to write to)
+             @br @bold(NOTE) The events may be saved while recording, however the events written
+                             concurrently by the other threads may be missing or partially updated,
+                             so the recording should preferably be disabled before
+            }
+            class procedure SaveToStream(pStream: TStream); static;
+
+            {**
+             Save the recorded events in a Chrome trace-event JSON file
+             @param(fileName File name to write to)
+            }
+            class procedure SaveToFile(const fileName: TFileName); static;
+    end;
+
 var
     g_GDICacheController: TWGDICacheController;
 
 implementation
+
+uses
+    UTWMajorSettings;
+
+threadvar
+    g_pTraceBuffer: TWTraceHelper.IRingBuffer;
+
 //---------------------------------------------------------------------------
 // TWStringHelper
 //---------------------------------------------------------------------------
@@ -2462,6 +2703,140 @@ begin
     right := value;
 end;
 //---------------------------------------------------------------------------
+class function TWMemoryHelper.GetStringSize(const str: UnicodeString): NativeUInt;
+const
+    // string header size, i.e. code page, element size, reference count and length (+ padding in 64 bit)
+    {$ifdef CPUX64}
+        C_Header_Size = 16;
+    {$else}
+        C_Header_Size = 12;
+    {$endif}
+begin
+    if (Length(str) = 0) then
+        Exit(0);
+
+    // NOTE + 1 for the null terminating char
+    Result := C_Header_Size + ((NativeUInt(Length(str)) + 1) * SizeOf(WideChar));
+end;
+//---------------------------------------------------------------------------
+class function TWMemoryHelper.GetBitmapSize(const pBitmap: Vcl.Graphics.TBitmap): NativeUInt;
+var
+    colorDepth: NativeUInt;
+begin
+    if (not Assigned(pBitmap)) then
+        Exit(0);
+
+    Result := pBitmap.InstanceSize;
+
+    // no pixels?
+    if ((pBitmap.Width <= 0) or (pBitmap.Height <= 0)) then
+        Exit;
+
+    // device dependent and custom bitmaps are measured as if they were 32 bit
+    case (pBitmap.PixelFormat) of
+        pfDevice, pfCustom: colorDepth := 32;
+    else
+        colorDepth := TWGDIHelper.PixelFormatToColorDepth(pBitmap.PixelFormat);
+    end;
+
+    Inc(Result, TWGDIHelper.CalculateStride(pBitmap.Width, colorDepth) * NativeUInt(pBitmap.Height));
+end;
+//---------------------------------------------------------------------------
+class procedure TWMemoryHelper.RegisterReporter(const name: UnicodeString;
+        fGetMemorySize: ITfGetMemorySize);
+begin
+    if (not Assigned(fGetMemorySize)) then
+        Exit;
+
+    TMonitor.Enter(m_pReporters);
+
+    try
+        m_pReporters.AddOrSetValue(name, fGetMemorySize);
+    finally
+        TMonitor.Exit(m_pReporters);
+    end;
+end;
+//---------------------------------------------------------------------------
+class procedure TWMemoryHelper.UnregisterReporter(const name: UnicodeString);
+begin
+    TMonitor.Enter(m_pReporters);
+
+    try
+        m_pReporters.Remove(name);
+    finally
+        TMonitor.Exit(m_pReporters);
+    end;
+end;
+//---------------------------------------------------------------------------
+class procedure TWMemoryHelper.GetSummary(pSummary: TStrings);
+var
+    counters:       TProcessMemoryCounters;
+    mmState:        TMemoryManagerState;
+    names:          TArray<UnicodeString>;
+    name:           UnicodeString;
+    fGetMemorySize: ITfGetMemorySize;
+    allocated:      UInt64;
+    size, total:    NativeUInt;
+    i:              NativeInt;
+begin
+    if (not Assigned(pSummary)) then
+        Exit;
+
+    pSummary.BeginUpdate;
+
+    try
+        pSummary.Clear;
+
+        counters    := Default(TProcessMemoryCounters);
+        counters.cb := SizeOf(TProcessMemoryCounters);
+
+        // get the process memory counters
+        if (GetProcessMemoryInfo(GetCurrentProcess, @counters, SizeOf(TProcessMemoryCounters))) then
+        begin
+            pSummary.Values['Process working set']   := IntToStr(UInt64(counters.WorkingSetSize));
+            pSummary.Values['Process private bytes'] := IntToStr(UInt64(counters.PagefileUsage));
+        end;
+
+        // get the memory allocated by the memory manager
+        GetMemoryManagerState(mmState);
+
+        allocated := mmState.TotalAllocatedMediumBlockSize + mmState.TotalAllocatedLargeBlockSize;
+
+        for i := Low(mmState.SmallBlockTypeStates) to High(mmState.SmallBlockTypeStates) do
+            Inc(allocated, UInt64(mmState.SmallBlockTypeStates[i].AllocatedBlockCount)
+                    * mmState.SmallBlockTypeStates[i].UseableBlockSize);
+
+        pSummary.Values['Memory manager allocated'] := IntToStr(allocated);
+
+        total := 0;
+
+        TMonitor.Enter(m_pReporters);
+
+        try
+            // sort the reporters by name, thus the summary remains readable between 2 calls
+            names := m_pReporters.Keys.ToArray;
+            TArray.Sort<UnicodeString>(names);
+
+            // query each reporter. NOTE the reporters are called while the registry is locked, so
+            // they should never register or unregister a reporter themselves
+            for name in names do
+            begin
+                fGetMemorySize := m_pReporters[name];
+                size           := fGetMemorySize();
+
+                pSummary.Values[name] := IntToStr(UInt64(size));
+                Inc(total, size);
+            end;
+        finally
+            TMonitor.Exit(m_pReporters);
+        end;
+
+        pSummary.Values['Reported total'] := IntToStr(UInt64(total));
+    finally
+        pSummary.EndUpdate;
+    end;
+end;
+//---------------------------------------------------------------------------
 // TWGDIHelper.IRectOptions
 //---------------------------------------------------------------------------
 class function TWGDIHelper.IRectOptions.GetDefault: IRectOptions;
@@ -2979,6 +3354,26 @@ begin
     inherited Destroy;
 end;
 //---------------------------------------------------------------------------
+function TWGDIHelper.GetMemorySize: NativeUInt;
+var
+    pBitmap:    Vcl.Graphics.TBitmap;
+    pDIBBitmap: IDIBBitmap;
+begin
+    Result := InstanceSize + m_pCache.InstanceSize;
+
+    for pBitmap in m_pCache.m_pBitmaps.Values do
+        Inc(Result, TWMemoryHelper.GetBitmapSize(pBitmap));
+
+    for pDIBBitmap in m_pCache.m_pDIBBitmaps.Values do
+    begin
+        Inc(Result, pDIBBitmap.InstanceSize);
+
+        if ((pDIBBitmap.m_Width > 0) and (pDIBBitmap.m_Height > 0)) then
+            Inc(Result, CalculateStride(pDIBBitmap.m_Width, pDIBBitmap.m_PixelFormat)
+                    * NativeUInt(pDIBBitmap.m_Height));
+    end;
+end;
+//---------------------------------------------------------------------------
 procedure TWGDIHelper.ConfigureGDIToDrawText(hDC: THandle; drawBg: Boolean; hFont: THandle;
         bgColor, textColor: TColorRef);
 begin
@@ -5066,7 +5461,6 @@ class function TWGDIHelper.DrawTransparentImage(pGraphic: TGraphic; const pos: T
 var
     imageWidth, imageHeight, x, y: Integer;
     pLine:                         PWRGBQuadArray;
-    blendFunction:                 TBlendFunction;
     localOverlay:                  Boolean;
 begin
     opacity := Min(Max(opacity, 0.0), 1.0);
@@ -5138,21 +5532,33 @@ begin
                     pLine[x].rgbReserved := 255;
             end;
 
-        // initialize blend operation
-        blendFunction.BlendOp             := AC_SRC_OVER;
-        blendFunction.BlendFlags          := 0;
-        blendFunction.SourceConstantAlpha := OpacityToAlpha(opacity);
-        blendFunction.AlphaFormat         := AC_SRC_ALPHA;
-
         // draw image on the final canvas and apply global opacity
-        Result := AlphaBlend(pCanvas.Handle, pos.X, pos.Y, imageWidth, imageHeight,
-                pOverlay.Canvas.Handle, 0, 0, imageWidth, imageHeight, blendFunction);
+        Result := AlphaBlendImage(pOverlay, imageWidth, imageHeight, pCanvas, pos.X, pos.Y, imageWidth,
+                imageHeight, OpacityToAlpha(opacity));
     finally
         if (localOverlay) then
             pOverlay.Free;
     end;
 end;
 //---------------------------------------------------------------------------
+class function TWGDIHelper.AlphaBlendImage(pImage: Vcl.Graphics.TBitmap; srcWidth, srcHeight: Integer;
+        pCanvas: TCanvas; x, y, width, height: Integer; alpha: Byte): Boolean;
+var
+    blendFunction: TBlendFunction;
+begin
+    if (not Assigned(pImage) or not Assigned(pCanvas)) then
+        Exit(False);
+
+    // initialize blend operation
+    blendFunction.BlendOp             := AC_SRC_OVER;
+    blendFunction.BlendFlags          := 0;
+    blendFunction.SourceConstantAlpha := alpha;
+    blendFunction.AlphaFormat         := AC_SRC_ALPHA;
+
+    Result := AlphaBlend(pCanvas.Handle, x, y, width, height, pImage.Canvas.Handle, 0, 0, srcWidth,
+            srcHeight, blendFunction);
+end;
+//---------------------------------------------------------------------------
 // TWGDIPlusHelper
 //---------------------------------------------------------------------------
 class function TWGDIPlusHelper.Clear(pBitmap: Vcl.Graphics.TBitmap; pGraphics: TGpGraphics): Boolean;
@@ -7077,6 +7483,264 @@ begin
     LogToCompiler(TWStringHelper.DelimitFillStr(title, 80, '-'));
 end;
 //---------------------------------------------------------------------------
+// TWTraceHelper.IRingBuffer
+//---------------------------------------------------------------------------
+constructor TWTraceHelper.IRingBuffer.Create(capacity: Integer);
+begin
+    inherited Create;
+
+    SetLength(m_Events, capacity);
+
+    m_Mask     := capacity - 1;
+    m_Written  := 0;
+    m_ThreadID := GetCurrentThreadId;
+end;
+//---------------------------------------------------------------------------
+destructor TWTraceHelper.IRingBuffer.Destroy;
+begin
+    SetLength(m_Events, 0);
+
+    inherited Destroy;
+end;
+//---------------------------------------------------------------------------
+procedure TWTraceHelper.IRingBuffer.Add(pName: PWideChar; pClass: TClass; pCategory: PWideChar;
+        phase: WideChar; time, duration: Int64);
+var
+    index: Integer;
+begin
+    // NOTE the counter may wrap, however the capacity is a power of 2, so the index remains valid
+    index := m_Written and m_Mask;
+
+    m_Events[index].m_pName     := pName;
+    m_Events[index].m_Class     := pClass;
+    m_Events[index].m_pCategory := pCategory;
+    m_Events[index].m_Phase     := phase;
+    m_Events[index].m_Time      := time;
+    m_Events[index].m_Duration  := duration;
+
+    // publish the event. NOTE the interlocked increment is also a full memory barrier, so the event
+    // content is visible to the other threads before the counter
+    InterlockedIncrement(m_Written);
+end;
+//---------------------------------------------------------------------------
+// TWTraceHelper
+//---------------------------------------------------------------------------
+class function TWTraceHelper.GetBuffer: IRingBuffer;
+begin
+    Result := g_pTraceBuffer;
+
+    if (Assigned(Result)) then
+        Exit;
+
+    Result := IRingBuffer.Create(m_Capacity);
+
+    // the buffers are owned by the helper and survive to their thread, thus the events recorded by
+    // a terminated thread can still be saved
+    TMonitor.Enter(m_pBuffers);
+
+    try
+        m_pBuffers.Add(Result);
+    finally
+        TMonitor.Exit(m_pBuffers);
+    end;
+
+    g_pTraceBuffer := Result;
+end;
+//---------------------------------------------------------------------------
+class function TWTraceHelper.EscapeJSON(const str: UnicodeString): UnicodeString;
+var
+    c: WideChar;
+begin
+    Result := '';
+
+    for c in str do
+        case c of
+            '"': Result := Result + '\"';
+            '\': Result := Result + '\\';
+        else
+            if (Ord(c) < 32) then
+                Result := Result + '\u' + IntToHex(Ord(c), 4)
+            else
+                Result := Result + c;
+        end;
+end;
+//---------------------------------------------------------------------------
+class procedure TWTraceHelper.WriteUTF8(const str: UnicodeString; pStream: TStream);
+var
+    bytes: TBytes;
+begin
+    bytes := TEncoding.UTF8.GetBytes(str);
+
+    if (Length(bytes) > 0) then
+        pStream.WriteBuffer(bytes[0], Length(bytes));
+end;
+//---------------------------------------------------------------------------
+class procedure TWTraceHelper.SetEnabled(value: Boolean);
+begin
+    m_Enabled := value;
+end;
+//---------------------------------------------------------------------------
+class function TWTraceHelper.IsEnabled: Boolean;
+begin
+    Result := m_Enabled;
+end;
+//---------------------------------------------------------------------------
+class procedure TWTraceHelper.SetCapacity(value: Integer);
+var
+    capacity: Integer;
+begin
+    capacity := 16;
+
+    // round up to the next power of 2, thus the ring index may be calculated with a mask
+    while ((capacity < value) and (capacity < (MaxInt shr 1))) do
+        capacity := capacity shl 1;
+
+    m_Capacity := capacity;
+end;
+//---------------------------------------------------------------------------
+class function TWTraceHelper.Start: Int64;
+begin
+    if (not m_Enabled) then
+        Exit(0);
+
+    Result := TStopwatch.GetTimeStamp;
+end;
+//---------------------------------------------------------------------------
+class procedure TWTraceHelper.Stop(pName, pCategory: PWideChar; startTime: Int64);
+begin
+    // the event was started while the recording was disabled?
+    if ((startTime = 0) or not m_Enabled) then
+        Exit;
+
+    GetBuffer.Add(pName, nil, pCategory, 'X', startTime, TStopwatch.GetTimeStamp - startTime);
+end;
+//---------------------------------------------------------------------------
+class procedure TWTraceHelper.Stop(pClass: TClass; pCategory: PWideChar; startTime: Int64);
+begin
+    // the event was started while the recording was disabled?
+    if ((startTime = 0) or not m_Enabled) then
+        Exit;
+
+    GetBuffer.Add(nil, pClass, pCategory, 'X', startTime, TStopwatch.GetTimeStamp - startTime);
+end;
+//---------------------------------------------------------------------------
+class procedure TWTraceHelper.Instant(pName, pCategory: PWideChar);
+begin
+    if (not m_Enabled) then
+        Exit;
+
+    GetBuffer.Add(pName, nil, pCategory, 'i', TStopwatch.GetTimeStamp, 0);
+end;
+//---------------------------------------------------------------------------
+class procedure TWTraceHelper.Clear;
+var
+    pBuffer: IRingBuffer;
+begin
+    TMonitor.Enter(m_pBuffers);
+
+    try
+        for pBuffer in m_pBuffers do
+            pBuffer.m_Written := 0;
+    finally
+        TMonitor.Exit(m_pBuffers);
+    end;
+end;
+//---------------------------------------------------------------------------
+class procedure TWTraceHelper.SaveToStream(pStream: TStream);
+var
+    pBuffer:            IRingBuffer;
+    event:              IEvent;
+    name, threadName:   UnicodeString;
+    processID:          Cardinal;
+    written, count, i:  Integer;
+    tickToMicroseconds: Double;
+    first:              Boolean;
+begin
+    if (not Assigned(pStream)) then
+        Exit;
+
+    processID          := GetCurrentProcessId;
+    tickToMicroseconds := 1000000.0 / TStopwatch.Frequency;
+    first              := True;
+
+    WriteUTF8('{"traceEvents":[', pStream);
+
+    TMonitor.Enter(m_pBuffers);
+
+    try
+        for pBuffer in m_pBuffers do
+        begin
+            // name the thread in the viewer
+            if (pBuffer.m_ThreadID = MainThreadID) then
+                threadName := 'Main thread'
+            else
+                threadName := 'Thread ' + IntToStr(pBuffer.m_ThreadID);
+
+            if (not first) then
+                WriteUTF8(',', pStream);
+
+            first := False;
+
+            WriteUTF8(#13#10 + '{"name":"thread_name","ph":"M","pid":' + IntToStr(processID)
+                    + ',"tid":' + IntToStr(pBuffer.m_ThreadID) + ',"args":{"name":"' + threadName
+                    + '"}}', pStream);
+
+            // get the readable events. NOTE the counter is read once, the events published after
+            // that will be ignored
+            written := pBuffer.m_Written;
+            count   := Length(pBuffer.m_Events);
+
+            if (Cardinal(written) < Cardinal(count)) then
+                count := written;
+
+            for i := written - count to written - 1 do
+            begin
+                event := pBuffer.m_Events[i and pBuffer.m_Mask];
+
+                if (Assigned(event.m_Class)) then
+                    name := event.m_Class.ClassName
+                else
+                if (Assigned(event.m_pName)) then
+                    name := event.m_pName
+                else
+                    name := '';
+
+                WriteUTF8(',' + #13#10 + '{"name":"' + EscapeJSON(name) + '","cat":"'
+                        + EscapeJSON(event.m_pCategory) + '","ph":"' + event.m_Phase + '","ts":'
+                        + FloatToStrF(event.m_Time * tickToMicroseconds, ffFixed, 18, 3,
+                                g_InternationalFormatSettings), pStream);
+
+                if (event.m_Phase = 'X') then
+                    WriteUTF8(',"dur":' + FloatToStrF(event.m_Duration * tickToMicroseconds, ffFixed,
+                            18, 3, g_InternationalFormatSettings), pStream)
+                else
+                    // instant events are scoped to their thread
+                    WriteUTF8(',"s":"t"', pStream);
+
+                WriteUTF8(',"pid":' + IntToStr(processID) + ',"tid":' + IntToStr(pBuffer.m_ThreadID)
+                        + '}', pStream);
+            end;
+        end;
+    finally
+        TMonitor.Exit(m_pBuffers);
+    end;
+
+    WriteUTF8(#13#10 + '],"displayTimeUnit":"ms"}' + #13#10, pStream);
+end;
+//---------------------------------------------------------------------------
+class procedure TWTraceHelper.SaveToFile(const fileName: TFileName);
+var
+    pStream: TFileStream;
+begin
+    pStream := TFileStream.Create(fileName, fmCreate);
+
+    try
+        SaveToStream(pStream);
+    finally
+        pStream.Free;
+    end;
+end;
+//---------------------------------------------------------------------------
 
 initialization
 //---------------------------------------------------------------------------
@@ -7094,6 +7758,24 @@ begin
 
     // get and cache the current Windows version
     TWOSWinHelper.m_WinVersion := TWOSWinHelper.GetWinVersion;
+
+    // create the memory reporter registry
+    TWMemoryHelper.m_pReporters := TWMemoryHelper.IReporters.Create;
+
+    // create the trace buffer list, the recording is disabled by default
+    TWTraceHelper.m_Enabled  := False;
+    TWTraceHelper.m_pBuffers := TWTraceHelper.IRingBuffers.Create(True);
+    TWTraceHelper.SetCapacity(16384);
+end;
+//---------------------------------------------------------------------------
+
+finalization
+//---------------------------------------------------------------------------
+// Global finalization procedure
+//---------------------------------------------------------------------------
+begin
+    TWMemoryHelper.m_pReporters.Free;
+    TWTraceHelper.m_pBuffers.Free;
 end;
 //---------------------------------------------------------------------------
 
@@ -1,5 +1,5 @@
 {**
- @abstract(@name provides a 3x3 matrix.)
+ @abstract(@name provides a 3x3 matrix and a 2x3 affine matrix.)
  @author(JMR)
  @created(2016-2021, by Ursa Minor)
 }
@@ -17,7 +17,8 @@ uses System.SysUtils,
      {$ifdef USE_VCL}
          Winapi.GDIPObj,
      {$endif}
-     UTWVector;
+     UTWVector,
+     UTWRect;
 
 type
     {**
@@ -223,7 +224,254 @@ type
 
     PWMatrix3x3 = ^TWMatrix3x3;
 
+    {**
+     2x3 affine matrix
+     @br @bold(NOTE) The matrix is stored in the same order as the GDI+ matrix elements, i.e.
+                     m_11, m_12 and m_21, m_22 contain the linear part and m_31, m_32 contain the
+                     translation. A point is transformed as a row vector:
+                     x' = x * m_11 + y * m_21 + m_31
+                     y' = x * m_12 + y * m_22 + m_32
+                     Because SVG transforms are always affine, this matrix contains the same
+                     information as TWMatrix3x3 at a fraction of the cost, and all its operations
+                     behave like their TWMatrix3x3 counterparts
+    }
+    TWMatrix2x3 = record
+        private
+            m_11, m_12: Double;
+            m_21, m_22: Double;
+            m_31, m_32: Double;
+
+        public
+            {**
+             Constructor
+             @param(_11 Horizontal scale or rotation value)
+             @param(_12 Vertical shear or rotation value)
+             @param(_21 Horizontal shear or rotation value)
+             @param(_22 Vertical scale or rotation value)
+             @param(_31 Horizontal translation)
+             @param(_32 Vertical translation)
+            }
+            constructor Create(const _11, _12, _21, _22, _31, _32: Double); overload;
+
+            {**
+             Constructor
+             @param(matrix Source 3x3 matrix to build from, its projective part is ignored)
+            }
+            constructor Create(const matrix: TWMatrix3x3); overload;
+
+            {**
+             Constructor
+             @param(matrix Source GDI+ matrix to build from)
+            }
+            {$ifdef USE_VCL}
+                constructor Create(const matrix: TGpMatrix); overload;
+            {$endif}
+
+            {**
+             Equality operator (allows operations on matrices like a = b)
+             @param(a First matrix to compare)
+             @param(b Second matrix to compare)
+             @returns(@true if matrices are equal, otherwise @false)
+            }
+            class operator Equal(const a, b: TWMatrix2x3): Boolean; inline;
+
+            {**
+             Not equality operator (allows operations on matrices like a <> b)
+             @param(a First matrix to compare)
+             @param(b Second matrix to compare)
+             @returns(@true if matrices are not equal, otherwise @false)
+            }
+            class operator NotEqual(const a, b: TWMatrix2x3): Boolean; inline;
+
+            {**
+             Get the default matrix
+             @returns(A new default identity matrix)
+            }
+            class function GetDefault: TWMatrix2x3; inline; static;
+
+            {**
+             Check if matrix content is equal to another matrix
+             @param(other Other matrix to compare with)
+             @returns(@true if matrices are equals, otherwise @false)
+            }
+            function IsEqual(const other: TWMatrix2x3): Boolean; inline;
+
+            {**
+             Check if matrix content differs from another matrix
+             @param(other Other matrix to compare with)
+             @returns(@true if matrices differ, otherwise @false)
+            }
+            function Differs(const other: TWMatrix2x3): Boolean; inline;
+
+            {**
+             Assign (i.e copy) matrix
+             @param(other Other matrix to copy from)
+            }
+            procedure Assign(const other: TWMatrix2x3); overload; inline;
+
+            {**
+             Assign (i.e copy) the affine part of a 3x3 matrix
+             @param(other Other matrix to copy from)
+            }
+            procedure Assign(const other: TWMatrix3x3); overload; inline;
+
+            {**
+             Set matrix as identity
+            }
+            procedure SetIdentity; inline;
+
+            {**
+             Check if matrix is the identity matrix (meaning thus this matrix is "empty")
+             @returns(@true if matrix is the identity matrix, otherwise @false)
+            }
+            function IsIdentity: Boolean; inline;
+
+            {**
+             Multiply a matrix by another matrix
+             @param(other Other matrix to multiply with)
+             @returns(multiplied resulting matrix)
+             @br @bold(NOTE) Same convention as TWMatrix3x3.Multiply(), i.e. to obtain Mc = Ma * Mb
+                             the Multiply function should be used as follow:
+                             Mc := Mb.Multiply(Ma);
+            }
+            function Multiply(const other: TWMatrix2x3): TWMatrix2x3; inline;
+
+            {**
+             Get the inverse matrix
+             @param(inverse @bold([out]) Inverse matrix)
+             @returns(@true on success, @false if the matrix cannot be inverted (e.g. a zero scale))
+            }
+            function Invert(out inverse: TWMatrix2x3): Boolean;
+
+            {**
+             Translate matrix
+             @param(t Translation vector)
+             @returns(Copy of translated matrix)
+            }
+            function Translate(const t: TWVector2): TWMatrix2x3; inline;
+
+            {**
+             Rotate matrix
+             @param(angle Rotation angle in radians)
+             @param(r Rotation direction (e.g. [0.0f, 1.0f] for a y-axis rotation))
+             @returns(Copy of rotated matrix)
+            }
+            function Rotate(angle: Single; const r: TWVector2): TWMatrix2x3;
+
+            {**
+             Rotate matrix based on a rotation center point
+             @param(angle Rotation angle in radians)
+             @param(center Rotation center point)
+             @returns(Copy of rotated matrix)
+            }
+            function RotateCenter(angle: Single; const center: TWVector2): TWMatrix2x3;
+
+            {**
+             Scale matrix
+             @param(s Scale vector)
+             @returns(Copy of scaled matrix)
+            }
+            function Scale(const s: TWVector2): TWMatrix2x3; inline;
+
+            {**
+             Shear matrix
+             @param(s Shear vector)
+             @returns(Copy of sheared matrix)
+            }
+            function Shear(const s: TWVector2): TWMatrix2x3;
+
+            {**
+             Append a scaling after the matrix transformation, like the GDI+ Scale() function
+             called with the MatrixOrderAppend flag
+             @param(sx Horizontal scale factor)
+             @param(sy Vertical scale factor)
+            }
+            procedure AppendScale(sx, sy: Double); inline;
+
+            {**
+             Append a translation after the matrix transformation, like the GDI+ Translate()
+             function called with the MatrixOrderAppend flag
+             @param(tx Horizontal translation)
+             @param(ty Vertical translation)
+            }
+            procedure AppendTranslate(tx, ty: Double); inline;
+
+            {**
+             Transform a vector using matrix
+             @param(vector Vector to transform)
+             @returns(transformed vector)
+            }
+            function Transform(const vector: TWVector2): TWVector2; inline;
+
+            {**
+             Transform a rectangle using matrix
+             @param(rect Rectangle to transform)
+             @returns(Bounding box surrounding the transformed rectangle)
+            }
+            function TransformRect(const rect: TWRectF): TWRectF;
+
+            {**
+             Convert matrix to 3x3 matrix
+             @returns(3x3 matrix)
+            }
+            function ToMatrix3x3: TWMatrix3x3; inline;
+
+            {**
+             Convert matrix to GDI+ matrix
+             @param(pMatrix GDI+ matrix to populate)
+            }
+            {$ifdef USE_VCL}
+                procedure ToGpMatrix(pMatrix: TGpMatrix); overload; inline;
+            {$endif}
+
+            {**
+             Create a GDI+ matrix from the matrix
+             @returns(GDI+ matrix, the caller is responsible to free it)
+             @br @bold(NOTE) Creating the GDI+ matrix with its elements requires a single GDI+ call
+            }
+            {$ifdef USE_VCL}
+                function ToGpMatrix: TGpMatrix; overload; inline;
+            {$endif}
+
+        public
+            {**
+             Gets or sets the horizontal scale or rotation value
+            }
+            property M11: Double read m_11 write m_11;
+
+            {**
+             Gets or sets the vertical shear or rotation value
+            }
+            property M12: Double read m_12 write m_12;
+
+            {**
+             Gets or sets the horizontal shear or rotation value
+            }
+            property M21: Double read m_21 write m_21;
+
+            {**
+             Gets or sets the vertical scale or rotation value
+            }
+            property M22: Double read m_22 write m_22;
+
+            {**
+             Gets or sets the horizontal translation
+            }
+            property M31: Double read m_31 write m_31;
+
+            {**
+             Gets or sets the vertical translation
+            }
+            property M32: Double read m_32 write m_32;
+    end;
+
+    PWMatrix2x3 = ^TWMatrix2x3;
+
 implementation
+
+uses
+    System.Math;
+
 //---------------------------------------------------------------------------
 constructor TWMatrix3x3.Create(const _11, _12, _13,
                                      _21, _22, _23,
@@ -433,5 +681,249 @@ end;
     end;
 {$endif}
 //---------------------------------------------------------------------------
+// TWMatrix2x3
+//---------------------------------------------------------------------------
+constructor TWMatrix2x3.Create(const _11, _12, _21, _22, _31, _32: Double);
+begin
+    m_11 := _11; m_12 := _12;
+    m_21 := _21; m_22 := _22;
+    m_31 := _31; m_32 := _32;
+end;
+//---------------------------------------------------------------------------
+constructor TWMatrix2x3.Create(const matrix: TWMatrix3x3);
+begin
+    Assign(matrix);
+end;
+//---------------------------------------------------------------------------
+{$ifdef USE_VCL}
+    constructor TWMatrix2x3.Create(const matrix: TGpMatrix);
+    var
+        elements: TMatrixArray;
+    begin
+        matrix.GetElements(elements);
+
+        m_11 := elements[0]; m_12 := elements[1];
+        m_21 := elements[2]; m_22 := elements[3];
+        m_31 := elements[4]; m_32 := elements[5];
+    end;
+{$endif}
+//---------------------------------------------------------------------------
+class operator TWMatrix2x3.Equal(const a, b: TWMatrix2x3): Boolean;
+begin
+    Result := a.IsEqual(b);
+end;
+//---------------------------------------------------------------------------
+class operator TWMatrix2x3.NotEqual(const a, b: TWMatrix2x3): Boolean;
+begin
+    Result := not a.IsEqual(b);
+end;
+//---------------------------------------------------------------------------
+class function TWMatrix2x3.GetDefault: TWMatrix2x3;
+begin
+    Result.SetIdentity;
+end;
+//---------------------------------------------------------------------------
+function TWMatrix2x3.IsEqual(const other: TWMatrix2x3): Boolean;
+begin
+    // NOTE don't use CompareMem here, for the same reasons as in TWMatrix3x3.IsEqual()
+    Result := (m_11 = other.m_11) and (m_12 = other.m_12) and
+              (m_21 = other.m_21) and (m_22 = other.m_22) and
+              (m_31 = other.m_31) and (m_32 = other.m_32);
+end;
+//---------------------------------------------------------------------------
+function TWMatrix2x3.Differs(const other: TWMatrix2x3): Boolean;
+begin
+    Result := not IsEqual(other);
+end;
+//---------------------------------------------------------------------------
+procedure TWMatrix2x3.Assign(const other: TWMatrix2x3);
+begin
+    Self := other;
+end;
+//---------------------------------------------------------------------------
+procedure TWMatrix2x3.Assign(const other: TWMatrix3x3);
+begin
+    m_11 := other.m_Table[0][0]; m_12 := other.m_Table[0][1];
+    m_21 := other.m_Table[1][0]; m_22 := other.m_Table[1][1];
+    m_31 := other.m_Table[2][0]; m_32 := other.m_Table[2][1];
+end;
+//---------------------------------------------------------------------------
+procedure TWMatrix2x3.SetIdentity;
+begin
+    m_11 := 1.0; m_12 := 0.0;
+    m_21 := 0.0; m_22 := 1.0;
+    m_31 := 0.0; m_32 := 0.0;
+end;
+//---------------------------------------------------------------------------
+function TWMatrix2x3.IsIdentity: Boolean;
+begin
+    Result := (m_11 = 1.0) and (m_12 = 0.0) and
+              (m_21 = 0.0) and (m_22 = 1.0) and
+              (m_31 = 0.0) and (m_32 = 0.0);
+end;
+//---------------------------------------------------------------------------
+function TWMatrix2x3.Multiply(const other: TWMatrix2x3): TWMatrix2x3;
+begin
+    // same result as the 3x3 multiplication, without the constant projective column
+    Result.m_11 := m_11 * other.m_11 + m_12 * other.m_21;
+    Result.m_12 := m_11 * other.m_12 + m_12 * other.m_22;
+    Result.m_21 := m_21 * other.m_11 + m_22 * other.m_21;
+    Result.m_22 := m_21 * other.m_12 + m_22 * other.m_22;
+    Result.m_31 := m_31 * other.m_11 + m_32 * other.m_21 + other.m_31;
+    Result.m_32 := m_31 * other.m_12 + m_32 * other.m_22 + other.m_32;
+end;
+//---------------------------------------------------------------------------
+function TWMatrix2x3.Invert(out inverse: TWMatrix2x3): Boolean;
+var
+    det, invDet: Double;
+begin
+    det := m_11 * m_22 - m_12 * m_21;
+
+    // matrix cannot be inverted?
+    if (IsZero(det)) then
+    begin
+        inverse.SetIdentity;
+        Exit(False);
+    end;
+
+    invDet := 1.0 / det;
+
+    inverse.m_11 :=  m_22 * invDet;
+    inverse.m_12 := -m_12 * invDet;
+    inverse.m_21 := -m_21 * invDet;
+    inverse.m_22 :=  m_11 * invDet;
+    inverse.m_31 := (m_21 * m_32 - m_22 * m_31) * invDet;
+    inverse.m_32 := (m_12 * m_31 - m_11 * m_32) * invDet;
+
+    Result := True;
+end;
+//---------------------------------------------------------------------------
+function TWMatrix2x3.Translate(const t: TWVector2): TWMatrix2x3;
+begin
+    m_31 := m_31 + (m_11 * t.X + m_21 * t.Y);
+    m_32 := m_32 + (m_12 * t.X + m_22 * t.Y);
+
+    Result := Self;
+end;
+//---------------------------------------------------------------------------
+function TWMatrix2x3.Rotate(angle: Single; const r: TWVector2): TWMatrix2x3;
+var
+    c, s:   Single;
+    matrix: TWMatrix2x3;
+begin
+    // calculate sinus and cosinus values
+    c := Cos(angle);
+    s := Sin(angle);
+
+    // create rotation matrix
+    matrix := TWMatrix2x3.Create(c * r.X, s * r.X, -s * r.Y, c * r.Y, 0.0, 0.0);
+
+    // combine current matrix with rotation matrix
+    Self := matrix.Multiply(Self);
+
+    Result := Self;
+end;
+//---------------------------------------------------------------------------
+function TWMatrix2x3.RotateCenter(angle: Single; const center: TWVector2): TWMatrix2x3;
+var
+    c, s:   Single;
+    matrix: TWMatrix2x3;
+begin
+    c := Cos(angle);
+    s := Sin(angle);
+
+    // equivalent to translate(center) * rotate(angle) * translate(-center)
+    matrix := TWMatrix2x3.Create(c, s, -s, c, center.X - center.X * c + center.Y * s,
+            center.Y - center.X * s - center.Y * c);
+
+    // combine current matrix with rotation matrix
+    Self := matrix.Multiply(Self);
+
+    Result := Self;
+end;
+//---------------------------------------------------------------------------
+function TWMatrix2x3.Scale(const s: TWVector2): TWMatrix2x3;
+begin
+    m_11 := m_11 * s.X; m_21 := m_21 * s.Y;
+    m_12 := m_12 * s.X; m_22 := m_22 * s.Y;
+
+    Result := Self;
+end;
+//---------------------------------------------------------------------------
+function TWMatrix2x3.Shear(const s: TWVector2): TWMatrix2x3;
+var
+    matrix: TWMatrix2x3;
+begin
+    // create shear matrix
+    matrix := TWMatrix2x3.Create(1.0, s.Y, s.X, 1.0, 0.0, 0.0);
+
+    // combine current matrix with shear matrix
+    Self := matrix.Multiply(Self);
+
+    Result := Self;
+end;
+//---------------------------------------------------------------------------
+procedure TWMatrix2x3.AppendScale(sx, sy: Double);
+begin
+    m_11 := m_11 * sx; m_12 := m_12 * sy;
+    m_21 := m_21 * sx; m_22 := m_22 * sy;
+    m_31 := m_31 * sx; m_32 := m_32 * sy;
+end;
+//---------------------------------------------------------------------------
+procedure TWMatrix2x3.AppendTranslate(tx, ty: Double);
+begin
+    m_31 := m_31 + tx;
+    m_32 := m_32 + ty;
+end;
+//---------------------------------------------------------------------------
+function TWMatrix2x3.Transform(const vector: TWVector2): TWVector2;
+begin
+    Result := TWVector2.Create((vector.X * m_11 + vector.Y * m_21 + m_31),
+                               (vector.X * m_12 + vector.Y * m_22 + m_32));
+end;
+//---------------------------------------------------------------------------
+function TWMatrix2x3.TransformRect(const rect: TWRectF): TWRectF;
+var
+    centerX, centerY, halfWidth, halfHeight, x, y, extentX, extentY: Double;
+begin
+    centerX    := (rect.Left   + rect.Right)  * 0.5;
+    centerY    := (rect.Top    + rect.Bottom) * 0.5;
+    halfWidth  := (rect.Right  - rect.Left)   * 0.5;
+    halfHeight := (rect.Bottom - rect.Top)    * 0.5;
+
+    // the bounding box of an affine transformed rectangle is centered on the transformed center,
+    // and its extent is the sum of the absolute linear part applied to the half size. This avoids
+    // to transform the 4 corners and to search their min and max values
+    extentX := Abs(m_11) * halfWidth + Abs(m_21) * halfHeight;
+    extentY := Abs(m_12) * halfWidth + Abs(m_22) * halfHeight;
+
+    // transform the center
+    x := centerX * m_11 + centerY * m_21 + m_31;
+    y := centerX * m_12 + centerY * m_22 + m_32;
+
+    Result := TWRectF.Create(x - extentX, y - extentY, x + extentX, y + extentY);
+end;
+//---------------------------------------------------------------------------
+function TWMatrix2x3.ToMatrix3x3: TWMatrix3x3;
+begin
+    Result := TWMatrix3x3.Create(m_11, m_21, m_31,
+                                 m_12, m_22, m_32,
+                                 0.0,  0.0,  1.0);
+end;
+//---------------------------------------------------------------------------
+{$ifdef USE_VCL}
+    procedure TWMatrix2x3.ToGpMatrix(pMatrix: TGpMatrix);
+    begin
+        pMatrix.SetElements(m_11, m_12, m_21, m_22, m_31, m_32);
+    end;
+{$endif}
+//---------------------------------------------------------------------------
+{$ifdef USE_VCL}
+    function TWMatrix2x3.ToGpMatrix: TGpMatrix;
+    begin
+        Result := TGpMatrix.Create(m_11, m_12, m_21, m_22, m_31, m_32);
+    end;
+{$endif}
+//---------------------------------------------------------------------------
 
 end.
@@ -15,7 +15,8 @@ uses System.SysUtils,
      Winapi.GDIPAPI,
      Winapi.GDIPOBJ,
      UTWSmartPointer,
-     UTWColor;
+     UTWColor,
+     UTWHelpers;
 
 type
     {**
@@ -243,6 +244,7 @@ var
     pBitmapData, pResultData:                      PByte;
     pixelCount, bitmapSize, pixelDelta, i, offset: NativeUInt;
     success:                                       Boolean;
+    traceStart:                                    Int64;
 begin
     Result := nil;
 
@@ -250,7 +252,8 @@ begin
     if (not Assigned(pBitmap)) then
         Exit;
 
-    success := False;
+    success    := False;
+    traceStart := TWTraceHelper.Start;
 
     try
         pBitmapData := nil;
@@ -354,6 +357,8 @@ begin
     finally
         if (not success) then
             FreeAndNil(Result);
+
+        TWTraceHelper.Stop('Blur', 'effect', traceStart);
     end;
 end;
 //---------------------------------------------------------------------------
@@ -368,6 +373,7 @@ var
     iMode:                                              InterpolationMode;
     smallImgWidth, smallImgHeight:                      Integer;
     success:                                            Boolean;
+    traceStart:                                         Int64;
 begin
     Result := nil;
 
@@ -416,6 +422,7 @@ begin
 
     pAttributes := nil;
     success     := False;
+    traceStart  := TWTraceHelper.Start;
 
     try
         // create final blur image
@@ -480,6 +487,8 @@ begin
             FreeAndNil(Result);
 
         pAttributes.Free;
+
+        TWTraceHelper.Stop('Blur', 'effect', traceStart);
     end;
 end;
 //---------------------------------------------------------------------------
@@ -294,6 +294,10 @@ type
     end;
 
 implementation
+
+uses
+  UTWHelpers;
+
 //---------------------------------------------------------------------------
 constructor TWControlRenderer.Create;
 begin
@@ -751,12 +755,34 @@ begin
     {$ifdef WTCONTROLS_USE_DIRECT2D}
         TWControlRenderer.m_pDirect2DRenderer := nil;
     {$endif}
+
+    // report the memory retained by the global renderers, if they were created
+    TWMemoryHelper.RegisterReporter('GDI renderer',
+        function: NativeUInt
+        begin
+            if (not Assigned(TWControlRenderer.m_pGDIRenderer)) then
+                Exit(0);
+
+            Result := TWControlRenderer.m_pGDIRenderer.GetMemorySize;
+        end);
+
+    TWMemoryHelper.RegisterReporter('GDI+ renderer',
+        function: NativeUInt
+        begin
+            if (not Assigned(TWControlRenderer.m_pGDIPlusRenderer)) then
+                Exit(0);
+
+            Result := TWControlRenderer.m_pGDIPlusRenderer.GetMemorySize;
+        end);
 end;
 //---------------------------------------------------------------------------
 
 finalization
 //---------------------------------------------------------------------------
 begin
+    TWMemoryHelper.UnregisterReporter('GDI renderer');
+    TWMemoryHelper.UnregisterReporter('GDI+ renderer');
+
     TWControlRenderer.m_pGDIRenderer.Free;
     TWControlRenderer.m_pGDIPlusRenderer.Free;
     {$ifdef WTCONTROLS_USE_DIRECT2D}
@@ -752,6 +752,12 @@ type
             }
             function GetCaps: IDrawCaps; virtual; abstract;
 
+            {**
+             Get the memory retained by the renderer, including its caches
+             @returns(Retained memory size, in bytes)
+            }
+            function GetMemorySize: NativeUInt; virtual;
+
             {**
              Add new custom font from file and set it available for applications opened in Windows session
              @param(name Font name to add)
@@ -1241,6 +1247,11 @@ begin
     inherited Destroy;
 end;
 //---------------------------------------------------------------------------
+function TWRenderer.GetMemorySize: NativeUInt;
+begin
+    Result := InstanceSize;
+end;
+//---------------------------------------------------------------------------
 procedure TWRenderer.GetBrushes(const pFill: TWFill; out pSolid: TWSolidBrush;
         out pLinear: TWLinearGradientBrush; out pRadial: TWRadialGradientBrush);
 begin
@@ -192,6 +192,12 @@ type
             }
             function GetCaps: TWRenderer.IDrawCaps; override;
 
+            {**
+             Get the memory retained by the renderer, including the bitmaps cached by its GDI helper
+             @returns(Retained memory size, in bytes)
+            }
+            function GetMemorySize: NativeUInt; override;
+
             {**
              Add new custom font from file and set it available for applications opened in Windows session
              @param(name Font name to add)
@@ -1067,6 +1073,14 @@ begin
     Result := [IE_DeviceSupported];
 end;
 //---------------------------------------------------------------------------
+function TWRenderer_GDI.GetMemorySize: NativeUInt;
+begin
+    Result := inherited GetMemorySize;
+
+    if (Assigned(m_pGDIHelper)) then
+        Inc(Result, m_pGDIHelper.GetMemorySize);
+end;
+//---------------------------------------------------------------------------
 function TWRenderer_GDI.AddFontToSession(const name, fileName: UnicodeString): Boolean;
 begin
     // add font in opened Windows session
@@ -919,6 +919,14 @@ type
             }
             procedure LinkGDIRenderer(pRenderer: TWRenderer_GDI); virtual;
 
+            {**
+             Get the cache hit counters
+             @param(pCounters List to which the counters should be added)
+             @br @bold(NOTE) The counters only exist if the cache logging is enabled, otherwise
+                             nothing is added to the list
+            }
+            procedure GetCacheCounters(pCounters: TList<TWCacheHit>); virtual;
+
             {**
              Begin a scene
              @param(hDC Device context to draw on)
@@ -1044,6 +1052,14 @@ type
             }
             function GetCaps: TWRenderer.IDrawCaps; override;
 
+            {**
+             Get the memory retained by the renderer, including its brush, pen and font caches
+             @returns(Retained memory size, in bytes)
+             @br @bold(NOTE) The GDI+ objects are opaque, so only their wrappers and their cache
+                             keys are measured, the memory GDI+ allocates internally is ignored
+            }
+            function GetMemorySize: NativeUInt; override;
+
             {**
              Add new custom font from file and set it available for applications opened in Windows session
              @param(name Font name to add)
@@ -5500,6 +5516,24 @@ begin
     m_pRenderer_GDI := pRenderer;
 end;
 //---------------------------------------------------------------------------
+procedure TWRenderer_GDIPlus.GetCacheCounters(pCounters: TList<TWCacheHit>);
+begin
+    if (not Assigned(pCounters)) then
+        Exit;
+
+    if (Assigned(m_pCache.m_pGraphics.m_pGraphicsCount)) then
+        pCounters.Add(m_pCache.m_pGraphics.m_pGraphicsCount);
+
+    if (Assigned(m_pCache.m_pBrushesCount)) then
+        pCounters.Add(m_pCache.m_pBrushesCount);
+
+    if (Assigned(m_pCache.m_pPensCount)) then
+        pCounters.Add(m_pCache.m_pPensCount);
+
+    if (Assigned(m_pCache.m_pFontsCount)) then
+        pCounters.Add(m_pCache.m_pFontsCount);
+end;
+//---------------------------------------------------------------------------
 procedure TWRenderer_GDIPlus.BeginScene(hDC: THandle);
 begin
 end;
@@ -6505,6 +6539,42 @@ begin
         Include(Result, IE_DeviceSupported);
 end;
 //---------------------------------------------------------------------------
+function TWRenderer_GDIPlus.GetMemorySize: NativeUInt;
+var
+    brushItem: TPair<ICachedBrush, TGpBrush>;
+    penItem:   TPair<ICachedPen, TGpPen>;
+    fontItem:  TPair<ICachedFont, TGpFont>;
+    name:      UnicodeString;
+begin
+    Result := inherited GetMemorySize;
+
+    if (not Assigned(m_pCache)) then
+        Exit;
+
+    Inc(Result, m_pCache.InstanceSize + m_pCache.m_pGraphics.InstanceSize);
+
+    // measure the cached brushes
+    for brushItem in m_pCache.m_pBrushes do
+        Inc(Result, brushItem.Key.InstanceSize + brushItem.Value.InstanceSize);
+
+    // measure the cached pens
+    for penItem in m_pCache.m_pPens do
+        Inc(Result, penItem.Key.InstanceSize + penItem.Value.InstanceSize);
+
+    // measure the cached fonts
+    for fontItem in m_pCache.m_pFonts do
+        Inc(Result, fontItem.Key.InstanceSize + TWMemoryHelper.GetStringSize(fontItem.Key.m_Name)
+                + fontItem.Value.InstanceSize);
+
+    // measure the "first in/first out" lists
+    Inc(Result, NativeUInt(m_pCache.m_pFIFOBrushList.Capacity + m_pCache.m_pFIFOPenList.Capacity
+            + m_pCache.m_pFIFOFontList.Capacity) * SizeOf(Pointer));
+
+    // measure the custom font names
+    for name in m_pCache.m_pCustomFontList do
+        Inc(Result, TWMemoryHelper.GetStringSize(name));
+end;
+//---------------------------------------------------------------------------
 function TWRenderer_GDIPlus.AddFontToSession(const name, fileName: UnicodeString): Boolean;
 var
     familyCount: Integer;
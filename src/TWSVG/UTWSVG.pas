@@ -10,6 +10,7 @@ interface
 uses System.Classes,
      System.SysUtils,
      System.Math,
+     System.Generics.Collections,
      Winapi.msxml,
      {$ifdef USE_VERYSIMPLEXML}
          Xml.VerySimple,
@@ -22,6 +23,7 @@ uses System.Classes,
      {$endif}
      UTWHelpers,
      UTWSVGItems,
+     UTWSVGElements,
      UTWSVGParser;
 
 type
@@ -40,12 +42,34 @@ type
      @br @bold(NOTE) See http://www.w3.org/TR/SVGCompositing/
     }
     TWSVG = class
+        public type
+            {**
+             Called when an unique identifier is released, i.e. when the SVG it identified is cleared,
+             reloaded, optimized or deleted
+             @param(uuid Released unique identifier)
+             @br @bold(NOTE) This event may be called from any thread, the listener should only
+                             remember the identifier, and release its linked content later
+            }
+            ITfReleaseUUIDEvent = procedure(const uuid: UnicodeString) of object;
+
+        private type
+            IReleaseListeners = TList<ITfReleaseUUIDEvent>;
+
+        private
+            class var m_pReleaseListeners: IReleaseListeners;
+
         private
             m_UUID:     UnicodeString;
             m_Encoding: string;
             m_pParser:  TWSVGParser;
             m_Options:  TWSVGOptions;
 
+            {**
+             Release the unique identifier, and notify the listeners that the content cached for it
+             is no longer used
+            }
+            procedure ReleaseUUID;
+
             {**
              Log all node content and hierarchy in the debugger output
              @param(pNode Node to log)
@@ -109,6 +133,32 @@ type
             }
             function LoadFromStr(const str: UnicodeString): Boolean; virtual;
 
+            {**
+             Save SVG to file, as UTF-8 encoded xml
+             @param(fileName File name)
+             @param(pretty If @true, the xml will be indented, otherwise it will be minified)
+             @br @bold(NOTE) The file is written from the parsed tree, not from the original data
+            }
+            procedure SaveToFile(const fileName: TFileName; pretty: Boolean = True); virtual;
+
+            {**
+             Save SVG to stream, as UTF-8 encoded xml
+             @param(pStream Stream to save to)
+             @param(pretty If @true, the xml will be indented, otherwise it will be minified)
+             @br @bold(NOTE) The stream is written from the parsed tree, not from the original data
+            }
+            procedure SaveToStream(const pStream: TStream; pretty: Boolean = True); virtual;
+
+            {**
+             Optimize the loaded SVG, i.e. simplify its tree to reduce the work done while it is drawn,
+             without changing the rendered result
+             @returns(Optimization report)
+             @br @bold(NOTE) A new unique identifier is generated if the tree changed, thus the content
+                             cached for the previous tree is no longer used
+             @br @bold(NOTE) See TWSVGOptimizer for the applied simplifications
+            }
+            function Optimize: TWSVGOptimizer.IReport; virtual;
+
             {**
              Log content
             }
@@ -127,6 +177,27 @@ type
             }
             function GetUUID: UnicodeString; virtual;
 
+            {**
+             Get the memory retained by the SVG, including its whole element tree
+             @returns(Retained memory size, in bytes)
+             @br @bold(NOTE) The returned size is an estimation, the memory manager overhead is ignored
+            }
+            function GetMemorySize: NativeUInt; virtual;
+
+            {**
+             Add a listener notified each time an unique identifier is released
+             @param(fListener Listener to add)
+             @br @bold(NOTE) This function is thread safe
+            }
+            class procedure AddReleaseListener(fListener: ITfReleaseUUIDEvent); static;
+
+            {**
+             Remove a listener notified each time an unique identifier is released
+             @param(fListener Listener to remove)
+             @br @bold(NOTE) This function is thread safe
+            }
+            class procedure RemoveReleaseListener(fListener: ITfReleaseUUIDEvent); static;
+
         public
             {**
              Get the SVG parser
@@ -180,6 +251,7 @@ end;
 //---------------------------------------------------------------------------
 destructor TWSVG.Destroy;
 begin
+    ReleaseUUID;
     m_pParser.Free;
 
     inherited Destroy;
@@ -260,9 +332,33 @@ end;
     end;
 {$endif}
 //---------------------------------------------------------------------------
+procedure TWSVG.ReleaseUUID;
+var
+    fListener: ITfReleaseUUIDEvent;
+begin
+    if (TWStringHelper.IsEmpty(m_UUID)) then
+        Exit;
+
+    // the listeners may still be notified while the application terminates
+    if (Assigned(m_pReleaseListeners)) then
+    begin
+        TMonitor.Enter(m_pReleaseListeners);
+
+        try
+            for fListener in m_pReleaseListeners do
+                fListener(m_UUID);
+        finally
+            TMonitor.Exit(m_pReleaseListeners);
+        end;
+    end;
+
+    m_UUID := '';
+end;
+//---------------------------------------------------------------------------
 procedure TWSVG.Clear;
 begin
-    m_UUID     := '';
+    ReleaseUUID;
+
     m_Encoding := '';
     m_pParser.Clear;
 end;
@@ -294,8 +390,10 @@ var
     {$else}
         pDocument: IXMLDocument;
     {$endif}
-    uid:       TGuid;
-    hRes:      HResult;
+    uid:        TGuid;
+    hRes:       HResult;
+    traceStart: Int64;
+    loaded:     Boolean;
 begin
     {$ifdef USE_VERYSIMPLEXML}
         pDocument := nil;
@@ -303,7 +401,7 @@ begin
         try
     {$endif}
             try
-                m_UUID := '';
+                ReleaseUUID;
 
                 if (not FileExists(fileName)) then
                 begin
@@ -312,6 +410,8 @@ begin
                     Exit(False);
                 end;
 
+                traceStart := TWTraceHelper.Start;
+
                 // load file
                 {$ifdef USE_VERYSIMPLEXML}
                     pDocument := TXmlVerySimple.Create;
@@ -320,6 +420,8 @@ begin
                     pDocument := LoadXMLDocument(fileName);
                 {$endif}
 
+                TWTraceHelper.Stop('Load', 'svg', traceStart);
+
                 // get the document encoding
                 m_Encoding := pDocument.Encoding;
 
@@ -327,7 +429,11 @@ begin
                     //LogNodeContent(pDocument.DocumentElement);
                 {$endif}
 
-                if (Assigned(pDocument) and m_pParser.Load(pDocument)) then
+                traceStart := TWTraceHelper.Start;
+                loaded     := Assigned(pDocument) and m_pParser.Load(pDocument);
+                TWTraceHelper.Stop('Parse', 'svg', traceStart);
+
+                if (loaded) then
                 begin
                     hRes := CreateGuid(uid);
 
@@ -364,6 +470,8 @@ var
     {$endif}
     uid:           TGuid;
     hRes:          HResult;
+    traceStart:    Int64;
+    loaded:        Boolean;
 begin
     {$ifdef USE_VERYSIMPLEXML}
         pDocument := nil;
@@ -371,7 +479,9 @@ begin
         try
     {$endif}
             try
-                m_UUID := '';
+                ReleaseUUID;
+
+                traceStart := TWTraceHelper.Start;
 
                 // load file
                 {$ifdef USE_VERYSIMPLEXML}
@@ -381,6 +491,8 @@ begin
                 {$endif}
                 pDocument.LoadFromStream(pStream);
 
+                TWTraceHelper.Stop('Load', 'svg', traceStart);
+
                 // get the document encoding
                 m_Encoding := pDocument.Encoding;
 
@@ -388,7 +500,11 @@ begin
                     //LogNodeContent(pDocument.DocumentElement);
                 {$endif}
 
-                if (Assigned(pDocument) and m_pParser.Load(pDocument)) then
+                traceStart := TWTraceHelper.Start;
+                loaded     := Assigned(pDocument) and m_pParser.Load(pDocument);
+                TWTraceHelper.Stop('Parse', 'svg', traceStart);
+
+                if (loaded) then
                 begin
                     hRes := CreateGuid(uid);
 
@@ -437,6 +553,58 @@ begin
     end;
 end;
 //---------------------------------------------------------------------------
+procedure TWSVG.SaveToFile(const fileName: TFileName; pretty: Boolean);
+var
+    pFileStream: TFileStream;
+begin
+    pFileStream := TFileStream.Create(fileName, fmCreate);
+
+    try
+        SaveToStream(pFileStream, pretty);
+    finally
+        pFileStream.Free;
+    end;
+end;
+//---------------------------------------------------------------------------
+procedure TWSVG.SaveToStream(const pStream: TStream; pretty: Boolean);
+begin
+    m_pParser.SaveToStream(pStream, pretty);
+end;
+//---------------------------------------------------------------------------
+function TWSVG.Optimize: TWSVGOptimizer.IReport;
+var
+    pOptimizer: TWSVGOptimizer;
+    uid:        TGuid;
+    traceStart: Int64;
+begin
+    pOptimizer := nil;
+
+    try
+        traceStart := TWTraceHelper.Start;
+        pOptimizer := TWSVGOptimizer.Create;
+        Result     := pOptimizer.Optimize(m_pParser);
+        TWTraceHelper.Stop('Optimize', 'svg', traceStart);
+    finally
+        pOptimizer.Free;
+    end;
+
+    // tree unchanged?
+    if (TWStringHelper.IsEmpty(m_UUID) or ((Result.m_ElementsBefore = Result.m_ElementsAfter)
+            and (Result.m_TransformsRemoved = 0) and (Result.m_PathsConverted = 0)))
+    then
+        Exit;
+
+    // the caches are linked to the unique identifier, generate a new one to not reuse them
+    if (CreateGuid(uid) <> S_OK) then
+    begin
+        TWLogHelper.LogToCompiler('Optimize - FAILED - could not create GUID');
+        Exit;
+    end;
+
+    ReleaseUUID;
+    m_UUID := GuidToString(uid);
+end;
+//---------------------------------------------------------------------------
 procedure TWSVG.Log;
 begin
     // log file content
@@ -453,6 +621,40 @@ begin
     Result := m_UUID;
 end;
 //---------------------------------------------------------------------------
+function TWSVG.GetMemorySize: NativeUInt;
+begin
+    Result := InstanceSize + TWMemoryHelper.GetStringSize(m_UUID) + TWMemoryHelper.GetStringSize(m_Encoding);
+
+    if (Assigned(m_pParser)) then
+        Inc(Result, m_pParser.GetMemorySize);
+end;
+//---------------------------------------------------------------------------
+class procedure TWSVG.AddReleaseListener(fListener: ITfReleaseUUIDEvent);
+begin
+    TMonitor.Enter(m_pReleaseListeners);
+
+    try
+        m_pReleaseListeners.Add(fListener);
+    finally
+        TMonitor.Exit(m_pReleaseListeners);
+    end;
+end;
+//---------------------------------------------------------------------------
+class procedure TWSVG.RemoveReleaseListener(fListener: ITfReleaseUUIDEvent);
+begin
+    // the listeners may still be removed while the application terminates
+    if (not Assigned(m_pReleaseListeners)) then
+        Exit;
+
+    TMonitor.Enter(m_pReleaseListeners);
+
+    try
+        m_pReleaseListeners.Remove(fListener);
+    finally
+        TMonitor.Exit(m_pReleaseListeners);
+    end;
+end;
+//---------------------------------------------------------------------------
 
 initialization
 //---------------------------------------------------------------------------
@@ -461,6 +663,15 @@ begin
     {$ifndef USE_VERYSIMPLEXML}
         MSXMLDOMDocumentFactory := TSVGDocumentFactory;
     {$endif}
+
+    TWSVG.m_pReleaseListeners := TWSVG.IReleaseListeners.Create;
+end;
+//---------------------------------------------------------------------------
+
+finalization
+//---------------------------------------------------------------------------
+begin
+    FreeAndNil(TWSVG.m_pReleaseListeners);
 end;
 //---------------------------------------------------------------------------
 
@@ -840,11 +840,23 @@ type
                     property AdditiveType: IEType read m_Type write m_Type;
             end;
 
+        private
+            class var m_LastKey: Integer;
+
         private
             m_Type:              IEAnimType;
             m_ValueType:         TWSVGCommon.IEValueType;
+            m_Links:             TWSVGArray<UnicodeString>;
+            m_Key:               Integer;
             m_ForcedToAnimColor: Boolean;
 
+            {**
+             Extract the local url links contained in a value, e.g. to="url(#gradient)"
+             @param(value Value to extract from)
+             @param(links @bold([in, out]) Link list to which the linked identifiers are added)
+            }
+            class procedure ExtractLinks(const value: UnicodeString; var links: TWSVGArray<UnicodeString>); static;
+
         public
             {**
              Constructor
@@ -931,9 +943,27 @@ type
              Get or set the value type
             }
             property ValueType: TWSVGCommon.IEValueType read m_ValueType write m_ValueType;
+
+            {**
+             Get the animation key
+             @br @bold(NOTE) The key identifies the animation and all the copies made from it, e.g.
+                             the clones drawn by a use element. Unlike the animation address, a key
+                             is never reused once the animation is deleted
+            }
+            property Key: Integer read m_Key;
+
+            {**
+             Get the identifiers of the elements linked by the animation values, e.g. the gradient
+             linked by to="url(#gradient)"
+             @br @bold(NOTE) The parsed values may not keep these links, e.g. the color values
+            }
+            property Links: TWSVGArray<UnicodeString> read m_Links;
     end;
 
 implementation
+
+uses Winapi.Windows;
+
 //---------------------------------------------------------------------------
 // TWSVGAnimation.IPropAttributeName
 //---------------------------------------------------------------------------
@@ -998,7 +1028,7 @@ end;
 //---------------------------------------------------------------------------
 function TWSVGAnimation.IPropAttributeName.ToXml: UnicodeString;
 begin
-    Result := ItemName + '=\"' + m_AttributeName + '\"';
+    Result := ItemName + '="' + m_AttributeName + '"';
 end;
 //---------------------------------------------------------------------------
 // TWSVGAnimation.IPropAttributeType
@@ -1066,7 +1096,7 @@ end;
 //---------------------------------------------------------------------------
 function TWSVGAnimation.IPropAttributeType.ToXml: UnicodeString;
 begin
-    Result := ItemName + '=\"' + TypeToStr(m_Type) + '\"';
+    Result := ItemName + '="' + TypeToStr(m_Type) + '"';
 end;
 //---------------------------------------------------------------------------
 class function TWSVGAnimation.IPropAttributeType.TypeToStr(attributeType: IEAttributeType): UnicodeString;
@@ -1155,7 +1185,7 @@ end;
 //---------------------------------------------------------------------------
 function TWSVGAnimation.IPropCalcMode.ToXml: UnicodeString;
 begin
-    Result := ItemName + '=\"' + TypeToStr(m_Type) + '\"';
+    Result := ItemName + '="' + TypeToStr(m_Type) + '"';
 end;
 //---------------------------------------------------------------------------
 class function TWSVGAnimation.IPropCalcMode.TypeToStr(calcModeType: IECalcModeType): UnicodeString;
@@ -1256,7 +1286,7 @@ end;
 //---------------------------------------------------------------------------
 function TWSVGAnimation.IPropFillMode.ToXml: UnicodeString;
 begin
-    Result := ItemName + '=\"' + ModeToStr(m_Mode) + '\"';
+    Result := ItemName + '="' + ModeToStr(m_Mode) + '"';
 end;
 //---------------------------------------------------------------------------
 class function TWSVGAnimation.IPropFillMode.ModeToStr(mode: IEMode): UnicodeString;
@@ -1402,17 +1432,17 @@ var
 begin
     // is repeat count indefinite?
     if (m_Indefinite) then
-        Result := ItemName + '=\"' + C_SVG_Animation_Indefinite + '\"'
+        Result := ItemName + '="' + C_SVG_Animation_Indefinite + '"'
     else
     // contains partial animation?
     if (m_PartialCount > 0) then
     begin
         // calculate complete and partial count fraction
         fraction := (m_Count + (m_PartialCount / 100.0));
-        Result   := ItemName + '=\"' + FloatToStr(fraction) + '\"';
+        Result   := ItemName + '="' + FloatToStr(fraction, g_InternationalFormatSettings) + '"';
     end
     else
-        Result := ItemName + '=\"' + IntToStr(m_Count) + '\"';
+        Result := ItemName + '="' + IntToStr(m_Count) + '"';
 end;
 //---------------------------------------------------------------------------
 // TWSVGAnimation.IPropRestart
@@ -1480,7 +1510,7 @@ end;
 //---------------------------------------------------------------------------
 function TWSVGAnimation.IPropRestart.ToXml: UnicodeString;
 begin
-    Result := ItemName + '=\"' + TypeToStr(m_Type) + '\"';
+    Result := ItemName + '="' + TypeToStr(m_Type) + '"';
 end;
 //---------------------------------------------------------------------------
 class function TWSVGAnimation.IPropRestart.TypeToStr(restartType: IERestartType): UnicodeString;
@@ -1573,7 +1603,7 @@ end;
 //---------------------------------------------------------------------------
 function TWSVGAnimation.IPropAnimTransformType.ToXml: UnicodeString;
 begin
-    Result := ItemName + '=\"' + TypeToStr(m_Type) + '\"';
+    Result := ItemName + '="' + TypeToStr(m_Type) + '"';
 end;
 //---------------------------------------------------------------------------
 class function TWSVGAnimation.IPropAnimTransformType.TypeToStr(transformType: IETransformType): UnicodeString;
@@ -1674,7 +1704,7 @@ end;
 //---------------------------------------------------------------------------
 function TWSVGAnimation.IPropAdditiveMode.ToXml: UnicodeString;
 begin
-    Result := ItemName + '=\"' + TypeToStr(m_Type) + '\"';
+    Result := ItemName + '="' + TypeToStr(m_Type) + '"';
 end;
 //---------------------------------------------------------------------------
 class function TWSVGAnimation.IPropAdditiveMode.TypeToStr(transformType: IEType): UnicodeString;
@@ -1703,6 +1733,7 @@ begin
 
     m_Type              := IE_AT_Unknown;
     m_ValueType         := TWSVGCommon.IEValueType.IE_VT_Unknown;
+    m_Key               := InterlockedIncrement(m_LastKey);
     m_ForcedToAnimColor := False;
 end;
 //---------------------------------------------------------------------------
@@ -1727,9 +1758,12 @@ begin
     // get source object
     pSource := pOther as TWSVGAnimation;
 
-    // copy data from source
+    // copy data from source. NOTE the copy shares the source key, so they share the same state
+    // in the rasterizer animation cache
     m_Type      := pSource.m_Type;
     m_ValueType := pSource.m_ValueType;
+    m_Links     := Copy(pSource.m_Links);
+    m_Key       := pSource.m_Key;
 end;
 //---------------------------------------------------------------------------
 procedure TWSVGAnimation.Clear;
@@ -1738,6 +1772,8 @@ begin
 
     m_Type      := IE_AT_Unknown;
     m_ValueType := TWSVGCommon.IEValueType.IE_VT_Unknown;
+
+    SetLength(m_Links, 0);
 end;
 //---------------------------------------------------------------------------
 function TWSVGAnimation.CreateInstance(pParent: TWSVGItem): TWSVGElement;
@@ -2232,9 +2268,51 @@ begin
         pAdditiveMode.Free;
     end;
 
+    // keep the elements linked by the values, because the parsed values may not keep them
+    ExtractLinks(TWSVGCommon.GetAttribute(pNode, C_SVG_Animation_Values, ''), m_Links);
+    ExtractLinks(TWSVGCommon.GetAttribute(pNode, C_SVG_Animation_From,   ''), m_Links);
+    ExtractLinks(TWSVGCommon.GetAttribute(pNode, C_SVG_Animation_To,     ''), m_Links);
+    ExtractLinks(TWSVGCommon.GetAttribute(pNode, C_SVG_Animation_By,     ''), m_Links);
+
     Result := True;
 end;
 //---------------------------------------------------------------------------
+class procedure TWSVGAnimation.ExtractLinks(const value: UnicodeString; var links: TWSVGArray<UnicodeString>);
+var
+    marker:               UnicodeString;
+    len, markerLen, i, j: Integer;
+begin
+    marker    := C_SVG_Link_URL + '(#';
+    len       := Length(value);
+    markerLen := Length(marker);
+    i         := 1;
+
+    while (i <= len - markerLen) do
+    begin
+        // not a local url link?
+        if (Copy(value, i, markerLen) <> marker) then
+        begin
+            Inc(i);
+            continue;
+        end;
+
+        // search for the link end
+        j := i + markerLen;
+
+        while ((j <= len) and (value[j] <> ')')) do
+            Inc(j);
+
+        // add the linked identifier, if any
+        if (j > i + markerLen) then
+        begin
+            SetLength(links, Length(links) + 1);
+            links[Length(links) - 1] := Trim(Copy(value, i + markerLen, j - i - markerLen));
+        end;
+
+        i := j + 1;
+    end;
+end;
+//---------------------------------------------------------------------------
 procedure TWSVGAnimation.Log(margin: Cardinal);
 begin
     TWLogHelper.LogBlockToCompiler(' Animation ');
@@ -17,6 +17,12 @@ uses System.SysUtils,
      UTWHelpers,
      UTWSVGAnimation;
 
+const
+    {**
+     Number of samples stored per key spline in the easing lookup table
+    }
+    C_SVG_Key_Spline_Samples = 64;
+
 type
     {**
      SVG animation descriptor, keeps the animation data and provides functions to process them
@@ -44,6 +50,8 @@ type
             m_AdditiveMode:     TWSVGAnimation.IPropAdditiveMode.IEType;
 
         protected
+            m_SplineLUT: IKeyList;
+
             {**
              Build Bezier control points from key splines
              @param(index Group index (a group is a set of 4 values, keySplines count is always a multiple of 4))
@@ -62,6 +70,23 @@ type
             }
             function GetBezierProgression(index: NativeUInt; position: Double): Double; virtual;
 
+            {**
+             Build the easing lookup table from the key splines
+             @br @bold(NOTE) The table contains C_SVG_Key_Spline_Samples + 1 progression values per
+                             key spline, sampled once, and shared between the copies of the
+                             descriptor. The progression is then read by interpolating the table
+                             instead of solving the Bezier curve again on each frame
+            }
+            procedure BuildSplineLUT; virtual;
+
+            {**
+             Find the key times segment containing a position
+             @param(position Position in percent (from 0.0 to 1.0))
+             @returns(Index of the key time starting the segment, -1 if not found)
+             @br @bold(NOTE) Key times are sorted, so the segment is found by a binary search
+            }
+            function FindKeyTime(position: Double): NativeInt; virtual;
+
         public
             {**
              Constructor
@@ -85,6 +110,20 @@ type
             }
             procedure AddKeyTime(key: Double); virtual;
 
+            {**
+             Assign (i.e. copy) the content from another descriptor
+             @param(pOther Other descriptor to copy from)
+             @br @bold(NOTE) The other descriptor should be of the same class to copy its values
+            }
+            procedure Assign(const pOther: TWSVGAnimationDescriptor); virtual;
+
+            {**
+             Build the lookup tables of the descriptor, if not already done
+             @br @bold(NOTE) This function should be called before the descriptor is cached, so the
+                             copies made from it share its tables instead of building their own
+            }
+            procedure Compile; virtual;
+
         public
             {**
              Get or set the SVG animation descriptor
@@ -167,6 +206,11 @@ type
             property AdditiveMode: TWSVGAnimation.IPropAdditiveMode.IEType read m_AdditiveMode write m_AdditiveMode;
     end;
 
+    {**
+     SVG animation descriptor class
+    }
+    TWSVGAnimationDescriptorClass = class of TWSVGAnimationDescriptor;
+
     {**
      SVG animation descriptor to use when the animation must be applied to values
     }
@@ -191,6 +235,12 @@ type
             }
             destructor Destroy; override;
 
+            {**
+             Assign (i.e. copy) the content from another descriptor
+             @param(pOther Other descriptor to copy from)
+            }
+            procedure Assign(const pOther: TWSVGAnimationDescriptor); override;
+
             {**
              Get animated value at position
              @param(position Animation position in percent (between 0.0 and 1.0))
@@ -281,6 +331,12 @@ type
             }
             destructor Destroy; override;
 
+            {**
+             Assign (i.e. copy) the content from another descriptor
+             @param(pOther Other descriptor to copy from)
+            }
+            procedure Assign(const pOther: TWSVGAnimationDescriptor); override;
+
             {**
              Get animated value at position
              @param(position Animation position in percent (between 0.0 and 1.0))
@@ -379,12 +435,18 @@ type
             }
             destructor Destroy; override;
 
+            {**
+             Assign (i.e. copy) the content from another descriptor
+             @param(pOther Other descriptor to copy from)
+            }
+            procedure Assign(const pOther: TWSVGAnimationDescriptor); override;
+
             {**
              Combine the animation values with a matrix
              @param(position Animation position in percent (between 0.0 and 1.0))
              @param(matrix @bold([in, out]) Matrix in which animation values will be combined)
             }
-            procedure Combine(position: Double; var matrix: TWMatrix3x3); virtual;
+            procedure Combine(position: Double; var matrix: TWMatrix2x3); virtual;
 
         public
             {**
@@ -417,6 +479,12 @@ type
             }
             destructor Destroy; override;
 
+            {**
+             Assign (i.e. copy) the content from another descriptor
+             @param(pOther Other descriptor to copy from)
+            }
+            procedure Assign(const pOther: TWSVGAnimationDescriptor); override;
+
             {**
              Get animated value at position
              @param(position Animation position in percent (between 0.0 and 1.0))
@@ -522,24 +590,93 @@ begin
 end;
 //---------------------------------------------------------------------------
 function TWSVGAnimationDescriptor.GetBezierProgression(index: NativeUInt; position: Double): Double;
+var
+    keyIndex, sampleIndex: NativeUInt;
+    samplePos:             Double;
+begin
+    // build the easing lookup table on the first use
+    if (Length(m_SplineLUT) = 0) then
+        BuildSplineLUT;
+
+    keyIndex := (index * (C_SVG_Key_Spline_Samples + 1));
+
+    if ((keyIndex + C_SVG_Key_Spline_Samples) >= NativeUInt(Length(m_SplineLUT))) then
+        raise Exception.Create('Index is out of bounds');
+
+    // find the samples surrounding the position
+    samplePos   := EnsureRange(position, 0.0, 1.0) * C_SVG_Key_Spline_Samples;
+    sampleIndex := Min(Trunc(samplePos), C_SVG_Key_Spline_Samples - 1);
+    samplePos   := samplePos - sampleIndex;
+    Inc(keyIndex, sampleIndex);
+
+    // interpolate the progression between the samples
+    Result := m_SplineLUT[keyIndex] + ((m_SplineLUT[keyIndex + 1] - m_SplineLUT[keyIndex]) * samplePos);
+end;
+//---------------------------------------------------------------------------
+procedure TWSVGAnimationDescriptor.BuildSplineLUT;
 var
     startPoint, endPoint, control1, control2: TWVector2;
+    splineCount, i, j:                        NativeUInt;
 begin
-    startPoint := Default(TWVector2);
-    endPoint   := TWVector2.Create(1.0, 1.0);
+    startPoint  := Default(TWVector2);
+    endPoint    := TWVector2.Create(1.0, 1.0);
+    splineCount := Length(m_KeySplines) div 4;
 
-    GetBezierControlPointsFromKeySplines(index, control1, control2);
+    SetLength(m_SplineLUT, splineCount * (C_SVG_Key_Spline_Samples + 1));
+
+    if (splineCount = 0) then
+        Exit;
 
-    // using a Bezier curve for a time value, the abscissa represents the elapsed time, and the
-    // ordinate represents the progression during this time. As the time may be considered as
-    // elapsing regularly, the resulting value can be found on the ordinate
-    Result := TWGeometryTools.GetCubicBezierPoint(startPoint, endPoint, control1, control2, position).Y;
+    for i := 0 to splineCount - 1 do
+    begin
+        GetBezierControlPointsFromKeySplines(i, control1, control2);
+
+        // using a Bezier curve for a time value, the abscissa represents the elapsed time, and the
+        // ordinate represents the progression during this time. As the time may be considered as
+        // elapsing regularly, the resulting value can be found on the ordinate
+        for j := 0 to C_SVG_Key_Spline_Samples do
+            m_SplineLUT[(i * (C_SVG_Key_Spline_Samples + 1)) + j] :=
+                    TWGeometryTools.GetCubicBezierPoint(startPoint, endPoint, control1, control2,
+                            j / C_SVG_Key_Spline_Samples).Y;
+    end;
+end;
+//---------------------------------------------------------------------------
+function TWSVGAnimationDescriptor.FindKeyTime(position: Double): NativeInt;
+var
+    first, last, middle: NativeInt;
+begin
+    // no segment?
+    if (Length(m_KeyTimes) < 2) then
+        Exit(-1);
+
+    first := 0;
+    last  := Length(m_KeyTimes) - 2;
+
+    // search for the first segment ending after the position
+    while (first < last) do
+    begin
+        middle := (first + last) div 2;
+
+        if (m_KeyTimes[middle + 1] >= position) then
+            last := middle
+        else
+            first := middle + 1;
+    end;
+
+    // found current key?
+    if ((position >= m_KeyTimes[first]) and (position <= m_KeyTimes[first + 1])) then
+        Exit(first);
+
+    Result := -1;
 end;
 //---------------------------------------------------------------------------
 procedure TWSVGAnimationDescriptor.AddKeySpline(key: Double);
 begin
     SetLength(m_KeySplines, Length(m_KeySplines) + 1);
     m_KeySplines[Length(m_KeySplines) - 1] := key;
+
+    // the easing lookup table should be rebuilt
+    SetLength(m_SplineLUT, 0);
 end;
 //---------------------------------------------------------------------------
 procedure TWSVGAnimationDescriptor.AddKeyTime(key: Double);
@@ -548,6 +685,39 @@ begin
     m_KeyTimes[Length(m_KeyTimes) - 1] := key;
 end;
 //---------------------------------------------------------------------------
+procedure TWSVGAnimationDescriptor.Compile;
+begin
+    if ((Length(m_KeySplines) > 0) and (Length(m_SplineLUT) = 0)) then
+        BuildSplineLUT;
+end;
+//---------------------------------------------------------------------------
+procedure TWSVGAnimationDescriptor.Assign(const pOther: TWSVGAnimationDescriptor);
+begin
+    if (not Assigned(pOther)) then
+        Exit;
+
+    m_pAnimation := pOther.m_pAnimation;
+    m_pBegin.Assign(pOther.m_pBegin);
+    m_pEnd.Assign(pOther.m_pEnd);
+    m_pDuration.Assign(pOther.m_pDuration);
+
+    // the key lists are copied because they may be modified by the caller, the lookup table is
+    // never modified once built, so it can be shared
+    m_KeySplines       := Copy(pOther.m_KeySplines);
+    m_KeyTimes         := Copy(pOther.m_KeyTimes);
+    m_SplineLUT        := pOther.m_SplineLUT;
+    m_GroupCount       := pOther.m_GroupCount;
+    m_ValPerGroupCount := pOther.m_ValPerGroupCount;
+    m_RepeatCount      := pOther.m_RepeatCount;
+    m_PartialCount     := pOther.m_PartialCount;
+    m_DoLoop           := pOther.m_DoLoop;
+    m_NegativeBegin    := pOther.m_NegativeBegin;
+    m_NegativeEnd      := pOther.m_NegativeEnd;
+    m_NegativeDuration := pOther.m_NegativeDuration;
+    m_CalcMode         := pOther.m_CalcMode;
+    m_AdditiveMode     := pOther.m_AdditiveMode;
+end;
+//---------------------------------------------------------------------------
 // TWSVGValueAnimDesc
 //---------------------------------------------------------------------------
 constructor TWSVGValueAnimDesc.Create;
@@ -560,6 +730,23 @@ begin
     inherited Destroy;
 end;
 //---------------------------------------------------------------------------
+procedure TWSVGValueAnimDesc.Assign(const pOther: TWSVGAnimationDescriptor);
+var
+    pSource: TWSVGValueAnimDesc;
+begin
+    inherited Assign(pOther);
+
+    if (not (pOther is TWSVGValueAnimDesc)) then
+        Exit;
+
+    pSource := pOther as TWSVGValueAnimDesc;
+
+    m_From   := Copy(pSource.m_From);
+    m_To     := Copy(pSource.m_To);
+    m_By     := Copy(pSource.m_By);
+    m_Values := Copy(pSource.m_Values);
+end;
+//---------------------------------------------------------------------------
 function TWSVGValueAnimDesc.GetValueAt(position: Double): Double;
 var
     valueCount:     NativeUInt;
@@ -618,6 +805,7 @@ var
     frameIndex,
     curStart,
     curEnd:       NativeUInt;
+    keyIndex:     NativeInt;
     curPos,
     indexCount,
     progression,
@@ -655,62 +843,63 @@ begin
 
         curPos := Min(position, 1.0);
 
-        // iterate through animation keys
-        for i := 0 to keyTimeCount - 2 do
-            // found current key?
-            if ((curPos >= m_KeyTimes[i]) and (curPos <= m_KeyTimes[i + 1])) then
-            begin
-                // calculate start and end indexes to interpolate
-                startIndex := i;
-                endIndex   := i + 1;
-
-                // animations governed by time keys are in fact divided into several segments.
-                // Each values in the key time list represent the time where the animation
-                // should start and end. These values are paired with the values list, that
-                // represent the start and end positions the animated segment should reach. As
-                // the received position is relative to the whole animation, it must be
-                // converted to indicate which percent of the segment is currently processed.
-                // For example, a segment beginning on 22% of the total time and ending on 44%
-                // is 50% processed if the received position is equal to 33%
-                //
-                // --------------------------------------------------------------------------------------------------------
-                // |                                         Total time = 100%                                            |
-                // |------------------------------------------------------------------------------------------------------|
-                // | Seg. 1 from 0% to 22% | Seg. 2 from 22% to 44% | Seg. 3 from 44% to 100%                              |
-                // |                       |                       |                                                      |
-                // |-----------------------|-----------------------|------------------------------------------------------|
-                //                                       
-                //                                        position = 33%, pos in segment2 = 50%
-                //
-                deltaTime  := (m_KeyTimes[endIndex] - m_KeyTimes[startIndex]);
-                posBetween := (curPos - m_KeyTimes[startIndex]) / deltaTime;
-
-                // search for calculation mode
-                case (m_CalcMode) of
-                    TWSVGAnimation.IPropCalcMode.IECalcModeType.IE_CT_Discrete: progression := 1.0;
-                    TWSVGAnimation.IPropCalcMode.IECalcModeType.IE_CT_Linear:   progression := posBetween;
-                    TWSVGAnimation.IPropCalcMode.IECalcModeType.IE_CT_Spline:   progression := GetBezierProgression(startIndex, posBetween);
-                else
-                    raise Exception.CreateFmt('Unknown calculation mode - %d', [Integer(m_CalcMode)]);
-                end;
+        // search for the key times segment containing the current position
+        keyIndex := FindKeyTime(curPos);
 
-                SetLength(Result, resultCount);
+        // found current key?
+        if (keyIndex >= 0) then
+        begin
+            // calculate start and end indexes to interpolate
+            startIndex := keyIndex;
+            endIndex   := keyIndex + 1;
+
+            // animations governed by time keys are in fact divided into several segments.
+            // Each values in the key time list represent the time where the animation
+            // should start and end. These values are paired with the values list, that
+            // represent the start and end positions the animated segment should reach. As
+            // the received position is relative to the whole animation, it must be
+            // converted to indicate which percent of the segment is currently processed.
+            // For example, a segment beginning on 22% of the total time and ending on 44%
+            // is 50% processed if the received position is equal to 33%
+            //
+            // --------------------------------------------------------------------------------------------------------
+            // |                                         Total time = 100%                                            |
+            // |------------------------------------------------------------------------------------------------------|
+            // | Seg. 1 from 0% to 22% | Seg. 2 from 22% to 44% | Seg. 3 from 44% to 100%                              |
+            // |                       |                       |                                                      |
+            // |-----------------------|-----------------------|------------------------------------------------------|
+            //                                       
+            //                                        position = 33%, pos in segment2 = 50%
+            //
+            deltaTime  := (m_KeyTimes[endIndex] - m_KeyTimes[startIndex]);
+            posBetween := (curPos - m_KeyTimes[startIndex]) / deltaTime;
+
+            // search for calculation mode
+            case (m_CalcMode) of
+                TWSVGAnimation.IPropCalcMode.IECalcModeType.IE_CT_Discrete: progression := 1.0;
+                TWSVGAnimation.IPropCalcMode.IECalcModeType.IE_CT_Linear:   progression := posBetween;
+                TWSVGAnimation.IPropCalcMode.IECalcModeType.IE_CT_Spline:   progression := GetBezierProgression(startIndex, posBetween);
+            else
+                raise Exception.CreateFmt('Unknown calculation mode - %d', [Integer(m_CalcMode)]);
+            end;
 
-                for j := 0 to resultCount - 1 do
-                begin
-                    curStart := (startIndex * resultCount) + j;
-                    curEnd   := (endIndex   * resultCount) + j;
+            SetLength(Result, resultCount);
 
-                    // calculate relative animation position (i.e. animation between key times)
-                    relativePos := (values[curEnd] - values[curStart]) * progression;
+            for j := 0 to resultCount - 1 do
+            begin
+                curStart := (startIndex * resultCount) + j;
+                curEnd   := (endIndex   * resultCount) + j;
 
-                    // calculate animation length between keys
-                    Result[j] := (values[curStart] + relativePos);
-                end;
+                // calculate relative animation position (i.e. animation between key times)
+                relativePos := (values[curEnd] - values[curStart]) * progression;
 
-                Exit;
+                // calculate animation length between keys
+                Result[j] := (values[curStart] + relativePos);
             end;
 
+            Exit;
+        end;
+
         // should never happen because current position should always be found between key times
         TWLogHelper.LogToCompiler('Malformed animation - the key time could not be found - position - '
                 + FloatToStr(position) + ' - key time count - ' + IntToStr(keyTimeCount));
@@ -796,6 +985,23 @@ begin
     inherited Destroy;
 end;
 //---------------------------------------------------------------------------
+procedure TWSVGColorAnimDesc.Assign(const pOther: TWSVGAnimationDescriptor);
+var
+    pSource: TWSVGColorAnimDesc;
+begin
+    inherited Assign(pOther);
+
+    if (not (pOther is TWSVGColorAnimDesc)) then
+        Exit;
+
+    pSource := pOther as TWSVGColorAnimDesc;
+
+    m_From   := Copy(pSource.m_From);
+    m_To     := Copy(pSource.m_To);
+    m_By     := Copy(pSource.m_By);
+    m_Values := Copy(pSource.m_Values);
+end;
+//---------------------------------------------------------------------------
 function TWSVGColorAnimDesc.GetValueAt(position: Double): TWColor;
 var
     valueCount:         NativeUInt;
@@ -854,6 +1060,7 @@ var
     frameIndex,
     curStart,
     curEnd:       NativeUInt;
+    keyIndex:     NativeInt;
     curPos,
     indexCount,
     progression,
@@ -890,59 +1097,60 @@ begin
 
         curPos := Min(position, 1.0);
 
-        // iterate through animation keys
-        for i := 0 to keyTimeCount - 2 do
-            // found current key?
-            if ((curPos >= m_KeyTimes[i]) and (curPos <= m_KeyTimes[i + 1])) then
-            begin
-                // calculate start and end indexes to interpolate
-                startIndex := i;
-                endIndex   := i + 1;
-
-                // animations governed by time keys are in fact divided into several segments.
-                // Each values in the key time list represent the time where the animation
-                // should start and end. These values are paired with the values list, that
-                // represent the start and end positions the animated segment should reach. As
-                // the received position is relative to the whole animation, it must be
-                // converted to indicate which percent of the segment is currently processed.
-                // For example, a segment beginning on 22% of the total time and ending on 44%
-                // is 50% processed if the received position is equal to 33%
-                //
-                // --------------------------------------------------------------------------------------------------------
-                // |                                         Total time = 100%                                            |
-                // |------------------------------------------------------------------------------------------------------|
-                // | Seg. 1 from 0% to 22% | Seg. 2 from 22% to 44% | Seg. 3 from 44% to 100%                              |
-                // |                       |                       |                                                      |
-                // |-----------------------|-----------------------|------------------------------------------------------|
-                //                                       
-                //                                        position = 33%, pos in segment2 = 50%
-                //
-                deltaTime  := (m_KeyTimes[endIndex] - m_KeyTimes[startIndex]);
-                posBetween := (curPos - m_KeyTimes[startIndex]) / deltaTime;
-
-                // search for calculation mode
-                case (m_CalcMode) of
-                    TWSVGAnimation.IPropCalcMode.IECalcModeType.IE_CT_Discrete: progression := 1.0;
-                    TWSVGAnimation.IPropCalcMode.IECalcModeType.IE_CT_Linear:   progression := posBetween;
-                    TWSVGAnimation.IPropCalcMode.IECalcModeType.IE_CT_Spline:   progression := GetBezierProgression(startIndex, posBetween);
-                else
-                    raise Exception.CreateFmt('Unknown calculation mode - %d', [Integer(m_CalcMode)]);
-                end;
+        // search for the key times segment containing the current position
+        keyIndex := FindKeyTime(curPos);
 
-                SetLength(Result, resultCount);
+        // found current key?
+        if (keyIndex >= 0) then
+        begin
+            // calculate start and end indexes to interpolate
+            startIndex := keyIndex;
+            endIndex   := keyIndex + 1;
+
+            // animations governed by time keys are in fact divided into several segments.
+            // Each values in the key time list represent the time where the animation
+            // should start and end. These values are paired with the values list, that
+            // represent the start and end positions the animated segment should reach. As
+            // the received position is relative to the whole animation, it must be
+            // converted to indicate which percent of the segment is currently processed.
+            // For example, a segment beginning on 22% of the total time and ending on 44%
+            // is 50% processed if the received position is equal to 33%
+            //
+            // --------------------------------------------------------------------------------------------------------
+            // |                                         Total time = 100%                                            |
+            // |------------------------------------------------------------------------------------------------------|
+            // | Seg. 1 from 0% to 22% | Seg. 2 from 22% to 44% | Seg. 3 from 44% to 100%                              |
+            // |                       |                       |                                                      |
+            // |-----------------------|-----------------------|------------------------------------------------------|
+            //                                       
+            //                                        position = 33%, pos in segment2 = 50%
+            //
+            deltaTime  := (m_KeyTimes[endIndex] - m_KeyTimes[startIndex]);
+            posBetween := (curPos - m_KeyTimes[startIndex]) / deltaTime;
+
+            // search for calculation mode
+            case (m_CalcMode) of
+                TWSVGAnimation.IPropCalcMode.IECalcModeType.IE_CT_Discrete: progression := 1.0;
+                TWSVGAnimation.IPropCalcMode.IECalcModeType.IE_CT_Linear:   progression := posBetween;
+                TWSVGAnimation.IPropCalcMode.IECalcModeType.IE_CT_Spline:   progression := GetBezierProgression(startIndex, posBetween);
+            else
+                raise Exception.CreateFmt('Unknown calculation mode - %d', [Integer(m_CalcMode)]);
+            end;
 
-                for j := 0 to resultCount - 1 do
-                begin
-                    curStart := (startIndex * resultCount) + j;
-                    curEnd   := (endIndex   * resultCount) + j;
+            SetLength(Result, resultCount);
 
-                    // calculate relative animation color (i.e. between key times)
-                    Result[j] := values[curStart].Blend(values[curEnd], progression);
-                end;
+            for j := 0 to resultCount - 1 do
+            begin
+                curStart := (startIndex * resultCount) + j;
+                curEnd   := (endIndex   * resultCount) + j;
 
-                Exit;
+                // calculate relative animation color (i.e. between key times)
+                Result[j] := values[curStart].Blend(values[curEnd], progression);
             end;
 
+            Exit;
+        end;
+
         // should never happen because current position should always be found between key times
         TWLogHelper.LogToCompiler('Malformed animation - the key time could not be found - position - '
                 + FloatToStr(position) + ' - key time count - ' + IntToStr(keyTimeCount));
@@ -1042,7 +1250,17 @@ begin
     inherited Destroy;
 end;
 //---------------------------------------------------------------------------
-procedure TWSVGMatrixAnimDesc.Combine(position: Double; var matrix: TWMatrix3x3);
+procedure TWSVGMatrixAnimDesc.Assign(const pOther: TWSVGAnimationDescriptor);
+begin
+    inherited Assign(pOther);
+
+    if (not (pOther is TWSVGMatrixAnimDesc)) then
+        Exit;
+
+    m_TransformType := (pOther as TWSVGMatrixAnimDesc).m_TransformType;
+end;
+//---------------------------------------------------------------------------
+procedure TWSVGMatrixAnimDesc.Combine(position: Double; var matrix: TWMatrix2x3);
 var
     xMat, yMat:            Double;
     i, fromCount, toCount: NativeUInt;
@@ -1167,10 +1385,28 @@ begin
     inherited Destroy;
 end;
 //---------------------------------------------------------------------------
+procedure TWSVGEnumAnimDesc.Assign(const pOther: TWSVGAnimationDescriptor);
+var
+    pSource: TWSVGEnumAnimDesc;
+begin
+    inherited Assign(pOther);
+
+    if (not (pOther is TWSVGEnumAnimDesc)) then
+        Exit;
+
+    pSource := pOther as TWSVGEnumAnimDesc;
+
+    m_From   := Copy(pSource.m_From);
+    m_To     := Copy(pSource.m_To);
+    m_By     := Copy(pSource.m_By);
+    m_Values := Copy(pSource.m_Values);
+end;
+//---------------------------------------------------------------------------
 function TWSVGEnumAnimDesc.GetValueAt(position: Double): Integer;
 var
-    keyTimeCount, i: NativeUInt;
-    curPos:          Double;
+    keyTimeCount: NativeUInt;
+    keyIndex:     NativeInt;
+    curPos:       Double;
 begin
     keyTimeCount := Length(m_KeyTimes);
 
@@ -1179,11 +1415,12 @@ begin
     begin
         curPos := Min(position, 1.0);
 
-        // iterate through animation keys
-        for i := 0 to keyTimeCount - 2 do
-            // found current key?
-            if ((curPos >= m_KeyTimes[i]) and (curPos <= m_KeyTimes[i + 1])) then
-                Exit(m_Values[i]);
+        // search for the key times segment containing the current position
+        keyIndex := FindKeyTime(curPos);
+
+        // found current key?
+        if (keyIndex >= 0) then
+            Exit(m_Values[keyIndex]);
 
         // should never happen because current position should always be found between key times
         TWLogHelper.LogToCompiler('Malformed animation - the key time could not be found - position - '
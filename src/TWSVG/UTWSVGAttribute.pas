@@ -121,6 +121,12 @@ type
             }
             function Print(margin: Cardinal): UnicodeString; override;
 
+            {**
+             Get the memory retained by the attribute, including its values
+             @returns(Retained memory size, in bytes)
+            }
+            function GetMemorySize: NativeUInt; override;
+
             {**
              Get xml formatted string
              @returns(String)
@@ -477,6 +483,11 @@ begin
     Result := Result + #13 + #10;
 end;
 //---------------------------------------------------------------------------
+function TWSVGAttribute<T>.GetMemorySize: NativeUInt;
+begin
+    Result := inherited GetMemorySize + (NativeUInt(Length(m_Values)) * SizeOf(T));
+end;
+//---------------------------------------------------------------------------
 function TWSVGAttribute<T>.ToXml: UnicodeString;
 var
     animMatrixMode: Boolean;
@@ -487,7 +498,7 @@ begin
     animMatrixMode := IsMatrixAnimMode;
 
     // add name to string and open value area
-    Result := ItemName + '=\"';
+    Result := ItemName + '="';
     count  := Length(m_Values);
 
     // iterate through value list and add each value to string
@@ -522,14 +533,14 @@ begin
                     Result := Result + IntToStr(value.AsInt64);
 
             tkFloat:
-                Result := Result + FloatToStr(value.AsExtended);
+                Result := Result + FloatToStr(value.AsExtended, g_InternationalFormatSettings);
         else
             raise Exception.CreateFmt('Unsupported type - %d', [Integer(value.Kind)]);
         end;
     end;
 
     // close value area
-    Result := Result + '\"';
+    Result := Result + '"';
 end;
 //---------------------------------------------------------------------------
 
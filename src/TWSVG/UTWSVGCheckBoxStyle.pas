@@ -712,7 +712,7 @@ begin
                     Exit;
 
                 FillBg(bgRect, pCheckBox, m_pCanvas);
-                m_pCanvas.StretchDraw(cbRect, m_pDisabledUncheckedGlyph.Picture.Graphic);
+                DrawGlyph(m_pDisabledUncheckedGlyph, cbRect, IEGlyphState.IE_GS_DisabledUnchecked);
             end;
 
             cbChecked:
@@ -722,7 +722,7 @@ begin
                     Exit;
 
                 FillBg(bgRect, pCheckBox, m_pCanvas);
-                m_pCanvas.StretchDraw(cbRect, m_pDisabledCheckedGlyph.Picture.Graphic);
+                DrawGlyph(m_pDisabledCheckedGlyph, cbRect, IEGlyphState.IE_GS_DisabledChecked);
             end;
 
             cbGrayed:
@@ -732,7 +732,7 @@ begin
                     Exit;
 
                 FillBg(bgRect, pCheckBox, m_pCanvas);
-                m_pCanvas.StretchDraw(cbRect, m_pDisabledGrayedGlyph.Picture.Graphic);
+                DrawGlyph(m_pDisabledGrayedGlyph, cbRect, IEGlyphState.IE_GS_DisabledGrayed);
             end;
         end;
 
@@ -748,7 +748,7 @@ begin
                 Exit;
 
             FillBg(bgRect, pCheckBox, m_pCanvas);
-            m_pCanvas.StretchDraw(cbRect, m_pUncheckedGlyph.Picture.Graphic);
+            DrawGlyph(m_pUncheckedGlyph, cbRect, IEGlyphState.IE_GS_Unchecked);
         end;
 
         cbChecked:
@@ -758,7 +758,7 @@ begin
                 Exit;
 
             FillBg(bgRect, pCheckBox, m_pCanvas);
-            m_pCanvas.StretchDraw(cbRect, m_pCheckedGlyph.Picture.Graphic);
+            DrawGlyph(m_pCheckedGlyph, cbRect, IEGlyphState.IE_GS_Checked);
         end;
 
         cbGrayed:
@@ -768,7 +768,7 @@ begin
                 Exit;
 
             FillBg(bgRect, pCheckBox, m_pCanvas);
-            m_pCanvas.StretchDraw(cbRect, m_pGrayedGlyph.Picture.Graphic);
+            DrawGlyph(m_pGrayedGlyph, cbRect, IEGlyphState.IE_GS_Grayed);
         end;
     end;
 end;
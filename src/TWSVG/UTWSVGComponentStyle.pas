@@ -157,6 +157,20 @@ type
             }
             IWTargets = TList<TWinControl>;
 
+        protected type
+            {**
+             Glyph states, used to identify the glyphs in the shared glyph cache
+            }
+            IEGlyphState =
+            (
+                IE_GS_Unchecked,
+                IE_GS_Checked,
+                IE_GS_Grayed,
+                IE_GS_DisabledUnchecked,
+                IE_GS_DisabledChecked,
+                IE_GS_DisabledGrayed
+            );
+
         public type
             {**
              Style hook list
@@ -311,6 +325,15 @@ type
             }
             procedure FillBg(const rect: TRect; pTarget: TWinControl; pCanvas: TCanvas); virtual;
 
+            {**
+             Draw a glyph on the style canvas. The glyph is rasterized once in the shared glyph cache,
+             then blitted on each target painting it
+             @param(pGlyph Glyph to draw)
+             @param(rect Rect in which the glyph should be drawn)
+             @param(state Glyph state)
+            }
+            procedure DrawGlyph(pGlyph: IWGlyph; const rect: TRect; state: IEGlyphState); virtual;
+
             {**
              Enable or disable if animations are running
              @param(value If @true, animations are running)
@@ -872,6 +895,9 @@ begin
     if (m_PixelsPerInch = value) then
         Exit;
 
+    // the glyphs rasterized for the previous DPI are no longer used
+    TWSVGGlyphCache.Invalidate(m_PixelsPerInch);
+
     m_PixelsPerInch := value;
 
     // request a change in the glyphs size
@@ -1020,6 +1046,14 @@ begin
     m_pCanvas.FillRect(rect);
 end;
 //---------------------------------------------------------------------------
+procedure TWSVGComponentStyle.DrawGlyph(pGlyph: IWGlyph; const rect: TRect; state: IEGlyphState);
+begin
+    if (not Assigned(pGlyph)) then
+        Exit;
+
+    TWSVGGlyphCache.Draw(m_pCanvas, rect, pGlyph.Picture.Graphic, Ord(state), m_PixelsPerInch);
+end;
+//---------------------------------------------------------------------------
 procedure TWSVGComponentStyle.SetAnimate(value: Boolean);
 begin
     // nothing to do?
@@ -1260,6 +1294,10 @@ begin
             if (Assigned(m_fOnSVGComponentStyleDPIChanged)) then
                 handled := m_fOnSVGComponentStyleDPIChanged(m_PixelsPerInch, message.WParamLo);
 
+            // the glyphs rasterized for the previous DPI are no longer used
+            if (m_PixelsPerInch <> message.WParamLo) then
+                TWSVGGlyphCache.Invalidate(m_PixelsPerInch);
+
             // update pixels per inch to match with the current context
             m_PixelsPerInch := message.WParamLo;
 
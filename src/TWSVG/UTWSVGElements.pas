@@ -18,6 +18,7 @@ uses System.SysUtils,
      UTWMajorSettings,
      UTWGenericNumber,
      UTWGeometryTools,
+     UTWMatrix,
      UTWHelpers,
      UTWGraphicPath,
      UTWSVGTags,
@@ -131,6 +132,12 @@ type
             }
             function RegisterLink(pElement: TWSVGElement): Boolean; virtual;
 
+            {**
+             Write the container content (i.e. defines, children and animations) as xml
+             @param(pWriter Xml writer to write to)
+            }
+            procedure WriteXmlContent(pWriter: TWSVGXmlWriter); override;
+
         public
             {**
              Constructor
@@ -179,6 +186,12 @@ type
             }
             function Print(margin: Cardinal): UnicodeString; override;
 
+            {**
+             Get the memory retained by the container, including its children, defines and animations
+             @returns(Retained memory size, in bytes)
+            }
+            function GetMemorySize: NativeUInt; override;
+
             {**
              Get xml formatted string
              @returns(String)
@@ -219,6 +232,16 @@ type
      e.g. rect, ellipse, path, ...
     }
     TWSVGShape = class(TWSVGContainer)
+        protected
+            {**
+             Write a point list as xml attribute, as x,y pairs separated by spaces
+             @param(pWriter Xml writer to write to)
+             @param(name Attribute name)
+             @param(points Point list to write, nothing is written if empty)
+            }
+            procedure WritePoints(pWriter: TWSVGXmlWriter; const name: UnicodeString;
+                    const points: TWSVGArray<Single>);
+
         public
             {**
              Constructor
@@ -679,6 +702,13 @@ type
         private
             m_Points: TWSVGArray<Single>;
 
+        protected
+            {**
+             Write the element attributes, including its points, as xml
+             @param(pWriter Xml writer to write to)
+            }
+            procedure WriteXmlAttributes(pWriter: TWSVGXmlWriter); override;
+
         public
             {**
              Constructor
@@ -734,6 +764,12 @@ type
             }
             function Print(margin: Cardinal): UnicodeString; override;
 
+            {**
+             Get the memory retained by the polygon, including its points
+             @returns(Retained memory size, in bytes)
+            }
+            function GetMemorySize: NativeUInt; override;
+
         public
             {**
              Get points
@@ -748,6 +784,13 @@ type
         private
             m_Points: TWSVGArray<Single>;
 
+        protected
+            {**
+             Write the element attributes, including its points, as xml
+             @param(pWriter Xml writer to write to)
+            }
+            procedure WriteXmlAttributes(pWriter: TWSVGXmlWriter); override;
+
         public
             {**
              Constructor
@@ -803,6 +846,12 @@ type
             }
             function Print(margin: Cardinal): UnicodeString; override;
 
+            {**
+             Get the memory retained by the polyline, including its points
+             @returns(Retained memory size, in bytes)
+            }
+            function GetMemorySize: NativeUInt; override;
+
         public
             {**
              Get points
@@ -1254,6 +1303,13 @@ type
         private
             m_Text: UnicodeString;
 
+        protected
+            {**
+             Write the text content and its children as xml
+             @param(pWriter Xml writer to write to)
+            }
+            procedure WriteXmlContent(pWriter: TWSVGXmlWriter); override;
+
         public
             {**
              Constructor
@@ -1309,6 +1365,12 @@ type
             }
             function Print(margin: Cardinal): UnicodeString; override;
 
+            {**
+             Get the memory retained by the text, including its content
+             @returns(Retained memory size, in bytes)
+            }
+            function GetMemorySize: NativeUInt; override;
+
         public
             {**
              Get text
@@ -1428,6 +1490,13 @@ type
             }
             procedure DelAndClear;
 
+        protected
+            {**
+             Write the element attributes, including its path data, as xml
+             @param(pWriter Xml writer to write to)
+            }
+            procedure WriteXmlAttributes(pWriter: TWSVGXmlWriter); override;
+
         public
             {**
              Constructor
@@ -1483,6 +1552,21 @@ type
             }
             function Print(margin: Cardinal): UnicodeString; override;
 
+            {**
+             Get the memory retained by the path, including its commands
+             @returns(Retained memory size, in bytes)
+            }
+            function GetMemorySize: NativeUInt; override;
+
+            {**
+             Convert the path to an equivalent line, if the path is a single straight segment
+             @returns(Line, @nil if the path cannot be converted)
+             @br @bold(NOTE) The returned line belongs to the caller, which is responsible to free it.
+                             The line is created with the same parent, identifier and properties as
+                             the path, but the path itself is left unchanged
+            }
+            function ToLine: TWSVGLine; virtual;
+
         public
             {**
              Get path commands
@@ -1544,6 +1628,173 @@ type
             function Print(margin: Cardinal): UnicodeString; override;
     end;
 
+    {**
+     Scalable Vector Graphics (SVG) tree optimizer, simplifies a parsed tree to reduce the work done
+     while it is drawn, without changing the rendered result. The optimizer removes the hidden and
+     empty elements, the identity transforms and the unused defines, merges the groups containing a
+     single child, collapsing their transform in the child, and converts the straight paths to lines
+     @br @bold(NOTE) Only the static content is simplified, i.e. the elements owning animations or
+                     referenced by a link (e.g. by an use, a fill, a filter or a clip path) are
+                     never removed nor merged, and the direct children of a switch are kept as is
+    }
+    TWSVGOptimizer = class
+        public type
+            {**
+             Optimization report
+            }
+            IReport = record
+                m_ElementsBefore:      NativeUInt;
+                m_ElementsAfter:       NativeUInt;
+                m_HiddenRemoved:       NativeUInt;
+                m_EmptyRemoved:        NativeUInt;
+                m_DefsRemoved:         NativeUInt;
+                m_GroupsMerged:        NativeUInt;
+                m_TransformsRemoved:   NativeUInt;
+                m_TransformsCollapsed: NativeUInt;
+                m_PathsConverted:      NativeUInt;
+            end;
+
+        private type
+            IReferences = TDictionary<UnicodeString, Boolean>;
+            IChildren   = TList<TWSVGElement>;
+
+        private
+            m_pReferences: IReferences;
+            m_pDefsTable:  TWSVGDefsTable;
+            m_Report:      IReport;
+
+            {**
+             Get the direct children of an element, including its defines, animations, gradient stops
+             or filter effects
+             @param(pElement Element for which the children should be get)
+             @param(pChildren List to populate with the children)
+            }
+            procedure GetChildren(pElement: TWSVGElement; pChildren: IChildren);
+
+            {**
+             Count an element and all its descendants
+             @param(pElement Element to count)
+             @returns(Element count)
+            }
+            function CountElements(pElement: TWSVGElement): NativeUInt;
+
+            {**
+             Collect the elements referenced by a property
+             @param(pProperty Property to collect from)
+            }
+            procedure CollectLinks(pProperty: TWSVGProperty);
+
+            {**
+             Collect the elements referenced by an element and all its descendants
+             @param(pElement Element to collect from)
+            }
+            procedure CollectReferences(pElement: TWSVGElement);
+
+            {**
+             Check if an element or one of its descendants is referenced by a link
+             @param(pElement Element to check)
+             @returns(@true if the element or one of its descendants is referenced, otherwise @false)
+            }
+            function IsReferenced(pElement: TWSVGElement): Boolean;
+
+            {**
+             Check if an element is static, i.e. if it owns no animation and isn't referenced itself
+             @param(pElement Element to check)
+             @returns(@true if the element is static, otherwise @false)
+            }
+            function IsStatic(pElement: TWSVGElement): Boolean;
+
+            {**
+             Check if an element is hidden, i.e. if its display mode is set to none
+             @param(pElement Element to check)
+             @returns(@true if the element is hidden, otherwise @false)
+            }
+            function IsHidden(pElement: TWSVGElement): Boolean;
+
+            {**
+             Check if an element is empty, i.e. if it's a group without children or a path without data
+             @param(pElement Element to check)
+             @returns(@true if the element is empty, otherwise @false)
+            }
+            function IsEmpty(pElement: TWSVGElement): Boolean;
+
+            {**
+             Get the transform matrix of an element
+             @param(pElement Element for which the transform should be get)
+             @param(index @bold([out]) Transform property index, -1 if not found)
+             @returns(Transform matrix, @nil if not found)
+            }
+            function GetTransform(pElement: TWSVGElement; out index: Integer): TWSVGPropMatrix;
+
+            {**
+             Remove an element and all its descendants from the defines table
+             @param(pElement Element to remove)
+            }
+            procedure Unregister(pElement: TWSVGElement);
+
+            {**
+             Delete an element from a list
+             @param(pElements List containing the element to delete)
+             @param(index Index of the element to delete)
+            }
+            procedure DeleteElement(pElements: TWSVGElement.IElements; index: Integer);
+
+            {**
+             Remove the identity transforms of an element
+             @param(pElement Element for which the identity transforms should be removed)
+            }
+            procedure RemoveIdentityTransforms(pElement: TWSVGElement);
+
+            {**
+             Merge a group containing a single child, collapsing its transform in the child
+             @param(pGroup Group to merge)
+             @returns(Child replacing the group, @nil if the group cannot be merged)
+             @br @bold(NOTE) On success, the child is detached from the group, which may be deleted
+            }
+            function MergeGroup(pGroup: TWSVGGroup): TWSVGElement;
+
+            {**
+             Convert a straight path to a line
+             @param(pPath Path to convert)
+             @returns(Line replacing the path, @nil if the path cannot be converted)
+            }
+            function ConvertPath(pPath: TWSVGPath): TWSVGElement;
+
+            {**
+             Optimize a container content
+             @param(pContainer Container to optimize)
+            }
+            procedure OptimizeContainer(pContainer: TWSVGContainer);
+
+            {**
+             Optimize an element list
+             @param(pElements Element list to optimize)
+             @param(conditional If @true, the elements are conditionally rendered (e.g. by a switch)
+                                and their order and count should be kept)
+            }
+            procedure OptimizeElements(pElements: TWSVGElement.IElements; conditional: Boolean);
+
+        public
+            {**
+             Constructor
+            }
+            constructor Create; virtual;
+
+            {**
+             Destructor
+            }
+            destructor Destroy; override;
+
+            {**
+             Optimize a SVG tree
+             @param(pRoot Tree root, in most cases the SVG parser)
+             @returns(Optimization report)
+             @br @bold(NOTE) The tree should be optimized before being drawn, because the rasterizer
+                             caches may keep references to the removed elements
+            }
+            function Optimize(pRoot: TWSVGContainer): IReport; virtual;
+    end;
+
 implementation
 //---------------------------------------------------------------------------
 // TWSVGContainer
@@ -2081,6 +2332,33 @@ begin
     Result := True;
 end;
 //---------------------------------------------------------------------------
+procedure TWSVGContainer.WriteXmlContent(pWriter: TWSVGXmlWriter);
+var
+    pElement: TWSVGElement;
+    pAnim:    TWSVGAnimation;
+begin
+    inherited WriteXmlContent(pWriter);
+
+    // write the defines elements, if any, in their own section
+    if (m_pDefsElements.Count > 0) then
+    begin
+        pWriter.BeginElement(C_SVG_Tag_Defs);
+
+        for pElement in m_pDefsElements do
+            pElement.WriteXml(pWriter);
+
+        pWriter.EndElement(C_SVG_Tag_Defs);
+    end;
+
+    // iterate through elements to write
+    for pElement in m_pElements do
+        pElement.WriteXml(pWriter);
+
+    // iterate through animations to write
+    for pAnim in m_pAnimations do
+        pAnim.WriteXml(pWriter);
+end;
+//---------------------------------------------------------------------------
 procedure TWSVGContainer.Assign(const pOther: TWSVGItem);
 var
     pSource:               TWSVGContainer;
@@ -2434,46 +2712,85 @@ end;
 //---------------------------------------------------------------------------
 function TWSVGContainer.Print(margin: Cardinal): UnicodeString;
 var
+    pBuilder: TStringBuilder;
     pElement: TWSVGElement;
     pAnim:    TWSVGAnimation;
 begin
-    Result := inherited Print(margin);
+    pBuilder := TStringBuilder.Create;
 
-    // iterate through defines elements to print
-    for pElement in m_pDefsElements do
-        // print child element
-        Result := Result + pElement.Print(margin);
+    try
+        pBuilder.Append(inherited Print(margin));
+
+        // iterate through defines elements to print
+        for pElement in m_pDefsElements do
+            // print child element
+            pBuilder.Append(pElement.Print(margin));
+
+        // iterate through elements to print
+        for pElement in m_pElements do
+            // print child element
+            pBuilder.Append(pElement.Print(margin));
+
+        // iterate through animations to print
+        for pAnim in m_pAnimations do
+            pBuilder.Append(pAnim.Print(margin));
+
+        Result := pBuilder.ToString;
+    finally
+        pBuilder.Free;
+    end;
+end;
+//---------------------------------------------------------------------------
+function TWSVGContainer.GetMemorySize: NativeUInt;
+var
+    pElement:   TWSVGElement;
+    pAnimation: TWSVGAnimation;
+begin
+    Result := inherited GetMemorySize;
+
+    Inc(Result, m_pElements.InstanceSize + m_pDefsElements.InstanceSize + m_pAnimations.InstanceSize);
+    Inc(Result, NativeUInt(m_pElements.Capacity + m_pDefsElements.Capacity + m_pAnimations.Capacity)
+            * SizeOf(Pointer));
 
-    // iterate through elements to print
     for pElement in m_pElements do
-        // print child element
-        Result := Result + pElement.Print(margin);
+        Inc(Result, pElement.GetMemorySize);
 
-    // iterate through animations to print
-    for pAnim in m_pAnimations do
-        Result := Result + pAnim.Print(margin);
+    for pElement in m_pDefsElements do
+        Inc(Result, pElement.GetMemorySize);
+
+    for pAnimation in m_pAnimations do
+        Inc(Result, pAnimation.GetMemorySize);
 end;
 //---------------------------------------------------------------------------
 function TWSVGContainer.ToXml: UnicodeString;
 var
+    pBuilder: TStringBuilder;
     pElement: TWSVGElement;
     pAnim:    TWSVGAnimation;
 begin
-    Result := inherited ToXml;
+    pBuilder := TStringBuilder.Create;
 
-    // iterate through defines elements to print
-    for pElement in m_pDefsElements do
-        // print child element
-        Result := Result + pElement.ToXml;
+    try
+        pBuilder.Append(inherited ToXml);
 
-    // iterate through elements to print
-    for pElement in m_pElements do
-        // print child element
-        Result := Result + pElement.ToXml;
+        // iterate through defines elements to print
+        for pElement in m_pDefsElements do
+            // print child element
+            pBuilder.Append(pElement.ToXml);
 
-    // iterate through animations to convert to xml
-    for pAnim in m_pAnimations do
-        Result := Result + pAnim.ToXml;
+        // iterate through elements to print
+        for pElement in m_pElements do
+            // print child element
+            pBuilder.Append(pElement.ToXml);
+
+        // iterate through animations to convert to xml
+        for pAnim in m_pAnimations do
+            pBuilder.Append(pAnim.ToXml);
+
+        Result := pBuilder.ToString;
+    finally
+        pBuilder.Free;
+    end;
 end;
 //---------------------------------------------------------------------------
 // TWSVGShape
@@ -2488,6 +2805,40 @@ begin
     inherited Destroy;
 end;
 //---------------------------------------------------------------------------
+procedure TWSVGShape.WritePoints(pWriter: TWSVGXmlWriter; const name: UnicodeString;
+        const points: TWSVGArray<Single>);
+var
+    pBuilder: TStringBuilder;
+    count, i: NativeInt;
+begin
+    count := Length(points);
+
+    // no points to write?
+    if (count = 0) then
+        Exit;
+
+    pBuilder := TStringBuilder.Create;
+
+    try
+        // iterate through points and write them as x,y pairs
+        for i := 0 to count - 1 do
+        begin
+            // not the first value?
+            if (i <> 0) then
+                if ((i mod 2) = 0) then
+                    pBuilder.Append(' ')
+                else
+                    pBuilder.Append(',');
+
+            pBuilder.Append(FloatToStr(points[i], g_InternationalFormatSettings));
+        end;
+
+        pWriter.WriteAttribute(name, pBuilder.ToString);
+    finally
+        pBuilder.Free;
+    end;
+end;
+//---------------------------------------------------------------------------
 // TWSVGGroup
 //---------------------------------------------------------------------------
 constructor TWSVGGroup.Create(pParent: TWSVGItem; pOptions: PWSVGOptions);
@@ -3220,6 +3571,18 @@ begin
                 + FloatToStr(point) + #13 + #10;
 end;
 //---------------------------------------------------------------------------
+function TWSVGPolygon.GetMemorySize: NativeUInt;
+begin
+    Result := inherited GetMemorySize + (NativeUInt(Length(m_Points)) * SizeOf(Single));
+end;
+//---------------------------------------------------------------------------
+procedure TWSVGPolygon.WriteXmlAttributes(pWriter: TWSVGXmlWriter);
+begin
+    inherited WriteXmlAttributes(pWriter);
+
+    WritePoints(pWriter, C_SVG_Prop_Points, m_Points);
+end;
+//---------------------------------------------------------------------------
 // TWSVGPolyline
 //---------------------------------------------------------------------------
 constructor TWSVGPolyline.Create(pParent: TWSVGItem; pOptions: PWSVGOptions);
@@ -3332,6 +3695,18 @@ begin
                 + FloatToStr(point) + #13 + #10;
 end;
 //---------------------------------------------------------------------------
+function TWSVGPolyline.GetMemorySize: NativeUInt;
+begin
+    Result := inherited GetMemorySize + (NativeUInt(Length(m_Points)) * SizeOf(Single));
+end;
+//---------------------------------------------------------------------------
+procedure TWSVGPolyline.WriteXmlAttributes(pWriter: TWSVGXmlWriter);
+begin
+    inherited WriteXmlAttributes(pWriter);
+
+    WritePoints(pWriter, C_SVG_Prop_Points, m_Points);
+end;
+//---------------------------------------------------------------------------
 // TWSVGImage
 //---------------------------------------------------------------------------
 constructor TWSVGImage.Create(pParent: TWSVGItem; pOptions: PWSVGOptions);
@@ -3505,7 +3880,7 @@ end;
 //---------------------------------------------------------------------------
 function TWSVGText.IAnchor.ToXml: UnicodeString;
 begin
-    Result := ItemName + '=\"' + ToStr(m_Anchor) + '\"';
+    Result := ItemName + '="' + ToStr(m_Anchor) + '"';
 end;
 //---------------------------------------------------------------------------
 class function TWSVGText.IAnchor.ToStr(anchor: IEAnchor): UnicodeString;
@@ -3597,7 +3972,7 @@ end;
 //---------------------------------------------------------------------------
 function TWSVGText.IDecoration.ToXml: UnicodeString;
 begin
-    Result := ItemName + '=\"' + ToStr(m_Value) + '\"';
+    Result := ItemName + '="' + ToStr(m_Value) + '"';
 end;
 //---------------------------------------------------------------------------
 class function TWSVGText.IDecoration.ToStr(value: IEDecoration): UnicodeString;
@@ -3735,12 +4110,12 @@ end;
 function TWSVGText.IFontWeight.ToXml: UnicodeString;
 begin
     if (m_Bolder) then
-        Result := ItemName + '=\"' + C_SVG_Value_Text_Weight_Bolder + '\"'
+        Result := ItemName + '="' + C_SVG_Value_Text_Weight_Bolder + '"'
     else
     if (m_Lighter) then
-        Result := ItemName + '=\"' + C_SVG_Value_Text_Weight_Lighter + '\"'
+        Result := ItemName + '="' + C_SVG_Value_Text_Weight_Lighter + '"'
     else
-        Result := ItemName + '=\"' + IntToStr(m_Value) + '\"';
+        Result := ItemName + '="' + IntToStr(m_Value) + '"';
 end;
 //---------------------------------------------------------------------------
 // TWSVGText.IFontStyle
@@ -3948,13 +4323,13 @@ begin
     if (m_Style = IE_FS_Oblique) then
     begin
         if (m_Angle = 0.244) then
-            Result := ItemName + '=\"' + ToStr(m_Style) + '\"'
+            Result := ItemName + '="' + ToStr(m_Style) + '"'
         else
-            Result := ItemName + '=\"' + ToStr(m_Style) + ' '
-                    + FloatToStr(m_Angle, g_InternationalFormatSettings) + C_SVG_Value_Rad + '\"'
+            Result := ItemName + '="' + ToStr(m_Style) + ' '
+                    + FloatToStr(m_Angle, g_InternationalFormatSettings) + C_SVG_Value_Rad + '"'
     end
     else
-        Result := ItemName + '=\"' + ToStr(m_Style) + '\"';
+        Result := ItemName + '="' + ToStr(m_Style) + '"';
 end;
 //---------------------------------------------------------------------------
 class function TWSVGText.IFontStyle.ToStr(style: IEFontStyle): UnicodeString;
@@ -4163,6 +4538,18 @@ begin
             + ' - ' + m_Text + #13 + #10;
 end;
 //---------------------------------------------------------------------------
+function TWSVGText.GetMemorySize: NativeUInt;
+begin
+    Result := inherited GetMemorySize + TWMemoryHelper.GetStringSize(m_Text);
+end;
+//---------------------------------------------------------------------------
+procedure TWSVGText.WriteXmlContent(pWriter: TWSVGXmlWriter);
+begin
+    pWriter.WriteText(m_Text);
+
+    inherited WriteXmlContent(pWriter);
+end;
+//---------------------------------------------------------------------------
 // TWSVGPathCmd
 //---------------------------------------------------------------------------
 constructor TWSVGPathCmd.Create(pParent: TWSVGItem; separator: WideChar);
@@ -4268,7 +4655,7 @@ begin
             Result := Result + m_Separator;
 
         // add value
-        Result := Result + FloatToStr(value);
+        Result := Result + FloatToStr(value, g_InternationalFormatSettings);
         First  := False;
     end;
 end;
@@ -4597,76 +4984,255 @@ begin
     end;
 end;
 //---------------------------------------------------------------------------
-// TWSVGUse
-//---------------------------------------------------------------------------
-constructor TWSVGUse.Create(pParent: TWSVGItem; pOptions: PWSVGOptions);
+function TWSVGPath.GetMemorySize: NativeUInt;
+var
+    pCommand: TWPathCmd;
 begin
-    inherited Create(pParent, pOptions);
+    Result := inherited GetMemorySize;
 
-    ItemName := C_SVG_Tag_Use;
-end;
-//---------------------------------------------------------------------------
-destructor TWSVGUse.Destroy;
-begin
-    inherited Destroy;
-end;
-//---------------------------------------------------------------------------
-function TWSVGUse.CreateInstance(pParent: TWSVGItem): TWSVGElement;
-begin
-    Result := TWSVGUse.Create(pParent, m_pOptions);
+    if (not Assigned(m_pCommands)) then
+        Exit;
+
+    Inc(Result, m_pCommands.InstanceSize + (NativeUInt(m_pCommands.Capacity) * SizeOf(Pointer)));
+
+    for pCommand in m_pCommands do
+        Inc(Result, pCommand.InstanceSize + (NativeUInt(pCommand.PointCount) * SizeOf(Single)));
 end;
 //---------------------------------------------------------------------------
-{$ifdef USE_VERYSIMPLEXML}
-    function TWSVGUse.Read(const pNode: TXMLNode): Boolean;
-{$else}
-    function TWSVGUse.Read(const pNode: IXMLNode): Boolean;
-{$endif}
+function TWSVGPath.ToLine: TWSVGLine;
 var
-    pHRef, pXLinkHRef: TWSVGPropLink;
+    pStart, pEnd: TWPathCmd;
+    pLine:        TWSVGLine;
+    pMeasure:     TWSVGMeasure<Single>;
+    names:        array [0..3] of UnicodeString;
+    values:       array [0..3] of Single;
+    i:            Integer;
 begin
-    // no element?
-    if (not Assigned(pNode)) then
-        Exit(False);
+    // paths owning children or animations may change at runtime, keep them as is
+    if ((m_pElements.Count > 0) or (m_pDefsElements.Count > 0) or (m_pAnimations.Count > 0)) then
+        Exit(nil);
 
-    // read shape common properties
-    Result := inherited Read(pNode);
+    // a straight segment contains either a move to with an implicit line to, or a move to followed
+    // by a line to
+    if ((m_pCommands.Count < 1) or (m_pCommands.Count > 2)) then
+        Exit(nil);
 
-    pHRef := nil;
+    pStart := m_pCommands[0];
 
-    try
-        pHRef := TWSVGPropLink.Create(Self, m_pOptions);
+    if (pStart.Command <> TWPathCmd.IEType.IE_IT_MoveTo) then
+        Exit(nil);
 
-        // read external reference to another object (optional)
-        if (pHRef.Read(C_SVG_Prop_HRef, pNode)) then
-        begin
-            m_pProperties.Add(pHRef);
-            pHRef := nil;
-        end;
-    finally
-        pHRef.Free;
-    end;
+    // the first point of a path is always absolute, even if the move to is relative
+    values[0] := pStart.Points[0];
+    values[1] := pStart.Points[1];
 
-    pXLinkHRef := nil;
+    if (m_pCommands.Count = 1) then
+    begin
+        // a move to followed by a second coordinate pair is an implicit line to
+        if (pStart.PointCount <> 4) then
+            Exit(nil);
 
-    try
-        pXLinkHRef := TWSVGPropLink.Create(Self, m_pOptions);
+        values[2] := pStart.Points[2];
+        values[3] := pStart.Points[3];
 
-        // read external link/reference to another object (optional). NOTE this kind of links are
-        // deprecated in the SVG2 standards, but may still appear in several SVG files
-        if (pXLinkHRef.Read(C_SVG_Prop_XLink_HRef, pNode)) then
+        if (pStart.Relative) then
         begin
-            m_pProperties.Add(pXLinkHRef);
-            pXLinkHRef := nil;
+            values[2] := values[0] + values[2];
+            values[3] := values[1] + values[3];
         end;
-    finally
-        pXLinkHRef.Free;
-    end;
-end;
-//---------------------------------------------------------------------------
-procedure TWSVGUse.Log(margin: Cardinal);
-begin
-    TWLogHelper.LogBlockToCompiler(' Use ');
-
+    end
+    else
+    begin
+        if (pStart.PointCount <> 2) then
+            Exit(nil);
+
+        pEnd := m_pCommands[1];
+
+        case (pEnd.Command) of
+            TWPathCmd.IEType.IE_IT_LineTo:
+            begin
+                if (pEnd.PointCount <> 2) then
+                    Exit(nil);
+
+                values[2] := pEnd.Points[0];
+                values[3] := pEnd.Points[1];
+
+                if (pEnd.Relative) then
+                begin
+                    values[2] := values[0] + values[2];
+                    values[3] := values[1] + values[3];
+                end;
+            end;
+
+            TWPathCmd.IEType.IE_IT_Horiz_LineTo:
+            begin
+                if (pEnd.PointCount <> 1) then
+                    Exit(nil);
+
+                values[2] := pEnd.Points[0];
+                values[3] := values[1];
+
+                if (pEnd.Relative) then
+                    values[2] := values[0] + values[2];
+            end;
+
+            TWPathCmd.IEType.IE_IT_Vert_LineTo:
+            begin
+                if (pEnd.PointCount <> 1) then
+                    Exit(nil);
+
+                values[2] := values[0];
+                values[3] := pEnd.Points[0];
+
+                if (pEnd.Relative) then
+                    values[3] := values[1] + values[3];
+            end;
+        else
+            Exit(nil);
+        end;
+    end;
+
+    names[0] := C_SVG_Prop_X1;
+    names[1] := C_SVG_Prop_Y1;
+    names[2] := C_SVG_Prop_X2;
+    names[3] := C_SVG_Prop_Y2;
+
+    pLine := nil;
+
+    try
+        pLine        := TWSVGLine.Create(Parent, m_pOptions);
+        pLine.ItemID := ItemID;
+
+        // copy the path properties (style, transform, ...)
+        for i := 0 to m_pProperties.Count - 1 do
+            pLine.AddProperty(m_pProperties[i]);
+
+        // add the line coordinates
+        for i := 0 to 3 do
+        begin
+            pMeasure := nil;
+
+            try
+                pMeasure             := TWSVGMeasure<Single>.Create(pLine, m_pOptions, False);
+                pMeasure.ItemName    := names[i];
+                pMeasure.MeasureUnit := IEUnit.IE_UN_None;
+                pMeasure.Value       := values[i];
+                pLine.AddProperty(pMeasure);
+            finally
+                pMeasure.Free;
+            end;
+        end;
+
+        Result := pLine;
+        pLine  := nil;
+    finally
+        pLine.Free;
+    end;
+end;
+//---------------------------------------------------------------------------
+procedure TWSVGPath.WriteXmlAttributes(pWriter: TWSVGXmlWriter);
+var
+    pBuilder: TStringBuilder;
+    pCommand: TWPathCmd;
+begin
+    inherited WriteXmlAttributes(pWriter);
+
+    // no path data to write?
+    if (m_pCommands.Count = 0) then
+        Exit;
+
+    pBuilder := TStringBuilder.Create;
+
+    try
+        // iterate through commands to write
+        for pCommand in m_pCommands do
+        begin
+            if (not(pCommand is TWSVGPathCmd)) then
+                continue;
+
+            // not the first command?
+            if (pBuilder.Length > 0) then
+                pBuilder.Append(' ');
+
+            pBuilder.Append((pCommand as TWSVGPathCmd).ToXml);
+        end;
+
+        pWriter.WriteAttribute(C_SVG_Prop_Path, pBuilder.ToString);
+    finally
+        pBuilder.Free;
+    end;
+end;
+//---------------------------------------------------------------------------
+// TWSVGUse
+//---------------------------------------------------------------------------
+constructor TWSVGUse.Create(pParent: TWSVGItem; pOptions: PWSVGOptions);
+begin
+    inherited Create(pParent, pOptions);
+
+    ItemName := C_SVG_Tag_Use;
+end;
+//---------------------------------------------------------------------------
+destructor TWSVGUse.Destroy;
+begin
+    inherited Destroy;
+end;
+//---------------------------------------------------------------------------
+function TWSVGUse.CreateInstance(pParent: TWSVGItem): TWSVGElement;
+begin
+    Result := TWSVGUse.Create(pParent, m_pOptions);
+end;
+//---------------------------------------------------------------------------
+{$ifdef USE_VERYSIMPLEXML}
+    function TWSVGUse.Read(const pNode: TXMLNode): Boolean;
+{$else}
+    function TWSVGUse.Read(const pNode: IXMLNode): Boolean;
+{$endif}
+var
+    pHRef, pXLinkHRef: TWSVGPropLink;
+begin
+    // no element?
+    if (not Assigned(pNode)) then
+        Exit(False);
+
+    // read shape common properties
+    Result := inherited Read(pNode);
+
+    pHRef := nil;
+
+    try
+        pHRef := TWSVGPropLink.Create(Self, m_pOptions);
+
+        // read external reference to another object (optional)
+        if (pHRef.Read(C_SVG_Prop_HRef, pNode)) then
+        begin
+            m_pProperties.Add(pHRef);
+            pHRef := nil;
+        end;
+    finally
+        pHRef.Free;
+    end;
+
+    pXLinkHRef := nil;
+
+    try
+        pXLinkHRef := TWSVGPropLink.Create(Self, m_pOptions);
+
+        // read external link/reference to another object (optional). NOTE this kind of links are
+        // deprecated in the SVG2 standards, but may still appear in several SVG files
+        if (pXLinkHRef.Read(C_SVG_Prop_XLink_HRef, pNode)) then
+        begin
+            m_pProperties.Add(pXLinkHRef);
+            pXLinkHRef := nil;
+        end;
+    finally
+        pXLinkHRef.Free;
+    end;
+end;
+//---------------------------------------------------------------------------
+procedure TWSVGUse.Log(margin: Cardinal);
+begin
+    TWLogHelper.LogBlockToCompiler(' Use ');
+
     inherited Log(margin);
 end;
 //---------------------------------------------------------------------------
@@ -4675,5 +5241,542 @@ begin
     Result := '<Use>' + #13 + #10 + inherited Print(margin);
 end;
 //---------------------------------------------------------------------------
+// TWSVGOptimizer
+//---------------------------------------------------------------------------
+constructor TWSVGOptimizer.Create;
+begin
+    inherited Create;
+
+    m_pReferences := IReferences.Create;
+    m_pDefsTable  := nil;
+    m_Report      := Default(IReport);
+end;
+//---------------------------------------------------------------------------
+destructor TWSVGOptimizer.Destroy;
+begin
+    m_pReferences.Free;
+
+    inherited Destroy;
+end;
+//---------------------------------------------------------------------------
+procedure TWSVGOptimizer.GetChildren(pElement: TWSVGElement; pChildren: IChildren);
+var
+    pContainer: TWSVGContainer;
+    pGradient:  TWSVGGradient;
+    pFilter:    TWSVGFilter;
+    pChild:     TWSVGElement;
+    pAnimation: TWSVGAnimation;
+    i:          Integer;
+begin
+    if (pElement is TWSVGContainer) then
+    begin
+        pContainer := pElement as TWSVGContainer;
+
+        for pChild in pContainer.m_pElements do
+            pChildren.Add(pChild);
+
+        for pChild in pContainer.m_pDefsElements do
+            pChildren.Add(pChild);
+
+        for pAnimation in pContainer.m_pAnimations do
+            pChildren.Add(pAnimation);
+    end
+    else
+    if (pElement is TWSVGGradient) then
+    begin
+        pGradient := pElement as TWSVGGradient;
+
+        for i := 0 to Integer(pGradient.GradientStopCount) - 1 do
+            pChildren.Add(pGradient.GradientStops[i]);
+    end
+    else
+    if (pElement is TWSVGFilter) then
+    begin
+        pFilter := pElement as TWSVGFilter;
+
+        for i := 0 to Integer(pFilter.EffectCount) - 1 do
+            pChildren.Add(pFilter.Effects[i]);
+    end;
+end;
+//---------------------------------------------------------------------------
+function TWSVGOptimizer.CountElements(pElement: TWSVGElement): NativeUInt;
+var
+    pChildren: IChildren;
+    pChild:    TWSVGElement;
+begin
+    if (not Assigned(pElement)) then
+        Exit(0);
+
+    Result    := 1;
+    pChildren := nil;
+
+    try
+        pChildren := IChildren.Create;
+        GetChildren(pElement, pChildren);
+
+        for pChild in pChildren do
+            Inc(Result, CountElements(pChild));
+    finally
+        pChildren.Free;
+    end;
+end;
+//---------------------------------------------------------------------------
+procedure TWSVGOptimizer.CollectLinks(pProperty: TWSVGProperty);
+var
+    pLink:  TWSVGPropLink;
+    pStyle: TWSVGStyle;
+    i:      Integer;
+begin
+    if (pProperty is TWSVGPropLink) then
+    begin
+        pLink := pProperty as TWSVGPropLink;
+
+        // embedded data cannot reference another element
+        if (pLink.DataType in [TWSVGPropLink.IEDataType.IE_DT_PNG, TWSVGPropLink.IEDataType.IE_DT_JPG,
+                TWSVGPropLink.IEDataType.IE_DT_SVG])
+        then
+            Exit;
+
+        if (not TWStringHelper.IsEmpty(pLink.Value)) then
+            m_pReferences.AddOrSetValue(pLink.Value, True);
+    end
+    else
+    if (pProperty is TWSVGStyle) then
+    begin
+        pStyle := pProperty as TWSVGStyle;
+
+        // the links (e.g. fill:url(#gradient) or filter:url(#blur)) are stored in the style lists
+        for i := 0 to pStyle.Count - 1 do
+            CollectLinks(pStyle.Properties[i]);
+
+        for i := 0 to pStyle.Fill.Count - 1 do
+            CollectLinks(pStyle.Fill.Properties[i]);
+
+        for i := 0 to pStyle.Stroke.Count - 1 do
+            CollectLinks(pStyle.Stroke.Properties[i]);
+    end;
+end;
+//---------------------------------------------------------------------------
+procedure TWSVGOptimizer.CollectReferences(pElement: TWSVGElement);
+var
+    pChildren: IChildren;
+    pChild:    TWSVGElement;
+    link:      UnicodeString;
+    i:         Integer;
+begin
+    if (not Assigned(pElement)) then
+        Exit;
+
+    for i := 0 to pElement.Count - 1 do
+        CollectLinks(pElement.Properties[i]);
+
+    // the animation values may also link to other elements, e.g. to="url(#gradient)"
+    if (pElement is TWSVGAnimation) then
+        for link in (pElement as TWSVGAnimation).Links do
+            if (not TWStringHelper.IsEmpty(link)) then
+                m_pReferences.AddOrSetValue(link, True);
+
+    pChildren := nil;
+
+    try
+        pChildren := IChildren.Create;
+        GetChildren(pElement, pChildren);
+
+        for pChild in pChildren do
+            CollectReferences(pChild);
+    finally
+        pChildren.Free;
+    end;
+end;
+//---------------------------------------------------------------------------
+function TWSVGOptimizer.IsReferenced(pElement: TWSVGElement): Boolean;
+var
+    pChildren: IChildren;
+    pChild:    TWSVGElement;
+begin
+    if (not Assigned(pElement)) then
+        Exit(False);
+
+    if ((not TWStringHelper.IsEmpty(pElement.ItemID)) and m_pReferences.ContainsKey(pElement.ItemID)) then
+        Exit(True);
+
+    pChildren := nil;
+
+    try
+        pChildren := IChildren.Create;
+        GetChildren(pElement, pChildren);
+
+        for pChild in pChildren do
+            if (IsReferenced(pChild)) then
+                Exit(True);
+    finally
+        pChildren.Free;
+    end;
+
+    Result := False;
+end;
+//---------------------------------------------------------------------------
+function TWSVGOptimizer.IsStatic(pElement: TWSVGElement): Boolean;
+begin
+    if ((not TWStringHelper.IsEmpty(pElement.ItemID)) and m_pReferences.ContainsKey(pElement.ItemID)) then
+        Exit(False);
+
+    if ((pElement is TWSVGContainer) and ((pElement as TWSVGContainer).m_pAnimations.Count > 0)) then
+        Exit(False);
+
+    Result := True;
+end;
+//---------------------------------------------------------------------------
+function TWSVGOptimizer.IsHidden(pElement: TWSVGElement): Boolean;
+var
+    pStyle:   TWSVGStyle;
+    pDisplay: TWSVGStyle.IPropDisplay;
+    i, j:     Integer;
+begin
+    for i := 0 to pElement.Count - 1 do
+    begin
+        if (not(pElement.Properties[i] is TWSVGStyle)) then
+            continue;
+
+        pStyle := pElement.Properties[i] as TWSVGStyle;
+
+        for j := 0 to pStyle.Count - 1 do
+        begin
+            if (not(pStyle.Properties[j] is TWSVGStyle.IPropDisplay)) then
+                continue;
+
+            pDisplay := pStyle.Properties[j] as TWSVGStyle.IPropDisplay;
+
+            if ((pDisplay.Count > 0)
+                    and (pDisplay.Values[0] = Integer(TWSVGStyle.IPropDisplay.IEValue.IE_V_None)))
+            then
+                Exit(True);
+        end;
+    end;
+
+    Result := False;
+end;
+//---------------------------------------------------------------------------
+function TWSVGOptimizer.IsEmpty(pElement: TWSVGElement): Boolean;
+var
+    pContainer: TWSVGContainer;
+begin
+    if (not(pElement is TWSVGContainer)) then
+        Exit(False);
+
+    pContainer := pElement as TWSVGContainer;
+
+    // a group or a path owning content cannot be empty
+    if ((pContainer.m_pElements.Count > 0) or (pContainer.m_pDefsElements.Count > 0)
+            or (pContainer.m_pAnimations.Count > 0))
+    then
+        Exit(False);
+
+    if (pContainer.ClassType = TWSVGGroup) then
+        Exit(True);
+
+    if (pContainer is TWSVGPath) then
+        Exit((pContainer as TWSVGPath).Commands.Count = 0);
+
+    Result := False;
+end;
+//---------------------------------------------------------------------------
+function TWSVGOptimizer.GetTransform(pElement: TWSVGElement; out index: Integer): TWSVGPropMatrix;
+var
+    pProperty: TWSVGProperty;
+    i:         Integer;
+begin
+    for i := 0 to pElement.Count - 1 do
+    begin
+        pProperty := pElement.Properties[i];
+
+        if ((pProperty.ItemName = C_SVG_Prop_Transform) and (pProperty is TWSVGPropMatrix)) then
+        begin
+            index := i;
+            Exit(pProperty as TWSVGPropMatrix);
+        end;
+    end;
+
+    index  := -1;
+    Result := nil;
+end;
+//---------------------------------------------------------------------------
+procedure TWSVGOptimizer.Unregister(pElement: TWSVGElement);
+var
+    pChildren: IChildren;
+    pChild:    TWSVGElement;
+    pItem:     TWSVGItem;
+begin
+    if (not Assigned(m_pDefsTable)) then
+        Exit;
+
+    // remove the element from the defines table, but only if the identifier is linked to it
+    if ((not TWStringHelper.IsEmpty(pElement.ItemID))
+            and m_pDefsTable.TryGetValue(pElement.ItemID, pItem) and (pItem = pElement))
+    then
+        m_pDefsTable.Remove(pElement.ItemID);
+
+    pChildren := nil;
+
+    try
+        pChildren := IChildren.Create;
+        GetChildren(pElement, pChildren);
+
+        for pChild in pChildren do
+            Unregister(pChild);
+    finally
+        pChildren.Free;
+    end;
+end;
+//---------------------------------------------------------------------------
+procedure TWSVGOptimizer.DeleteElement(pElements: TWSVGElement.IElements; index: Integer);
+begin
+    Unregister(pElements[index]);
+
+    // NOTE the list owns its elements, so the deleted element is also freed
+    pElements.Delete(index);
+end;
+//---------------------------------------------------------------------------
+procedure TWSVGOptimizer.RemoveIdentityTransforms(pElement: TWSVGElement);
+var
+    pProperty: TWSVGProperty;
+    i:         Integer;
+begin
+    // a transform animation is applied on the local matrix, keep it as is
+    if (not IsStatic(pElement)) then
+        Exit;
+
+    for i := pElement.Count - 1 downto 0 do
+    begin
+        pProperty := pElement.Properties[i];
+
+        if ((pProperty.ItemName = C_SVG_Prop_Transform) and (pProperty is TWSVGPropMatrix)
+                and (pProperty as TWSVGPropMatrix).Matrix^.IsIdentity)
+        then
+        begin
+            pElement.DeleteProperty(i);
+            Inc(m_Report.m_TransformsRemoved);
+        end;
+    end;
+end;
+//---------------------------------------------------------------------------
+function TWSVGOptimizer.MergeGroup(pGroup: TWSVGGroup): TWSVGElement;
+var
+    pProperty:                TWSVGProperty;
+    pStyle:                   TWSVGStyle;
+    pTransform, pChildMatrix: TWSVGPropMatrix;
+    pChild:                   TWSVGElement;
+    index, i:                 Integer;
+begin
+    // only the plain groups containing a single child may be merged
+    if ((pGroup.ClassType <> TWSVGGroup) or (pGroup.m_pElements.Count <> 1)
+            or (pGroup.m_pDefsElements.Count > 0) or (not IsStatic(pGroup)))
+    then
+        Exit(nil);
+
+    pTransform := nil;
+
+    // the group properties should not affect its child, except the transform, which may be collapsed
+    for i := 0 to pGroup.Count - 1 do
+    begin
+        pProperty := pGroup.Properties[i];
+
+        if (pProperty is TWSVGStyle) then
+        begin
+            pStyle := pProperty as TWSVGStyle;
+
+            if ((pStyle.Count > 0) or (pStyle.Fill.Count > 0) or (pStyle.Stroke.Count > 0)
+                    or pStyle.Fill.NoFill or pStyle.Stroke.NoStroke)
+            then
+                Exit(nil);
+        end
+        else
+        if ((pProperty.ItemName = C_SVG_Prop_Transform) and (pProperty is TWSVGPropMatrix)) then
+            pTransform := pProperty as TWSVGPropMatrix
+        else
+        if (pProperty.ItemName <> C_SVG_Prop_ID) then
+            Exit(nil);
+    end;
+
+    pChild := pGroup.m_pElements[0];
+
+    // the child will be drawn in place of the group, so it should support a transform
+    if (not((pChild is TWSVGShape) or (pChild is TWSVGGroup) or (pChild is TWSVGSwitch)
+            or (pChild is TWSVGAction)))
+    then
+        Exit(nil);
+
+    if (Assigned(pTransform)) then
+    begin
+        // the child transform cannot be changed if it's animated, or if the child is reused elsewhere
+        if (not IsStatic(pChild)) then
+            Exit(nil);
+
+        pChildMatrix := GetTransform(pChild, index);
+
+        // collapse the group transform in the child one. NOTE the child matrix is combined with its
+        // parent matrix in the same order by the rasterizer
+        if (Assigned(pChildMatrix)) then
+        begin
+            pChildMatrix.Matrix^    := pChildMatrix.Matrix^.Multiply(pTransform.Matrix^);
+            pChildMatrix.MatrixType := TWSVGPropMatrix.IEType.IE_Custom;
+        end
+        else
+            pChild.AddProperty(pTransform);
+
+        Inc(m_Report.m_TransformsCollapsed);
+    end;
+
+    // detach the child from the group, and attach it to the group parent
+    pGroup.m_pElements.Extract(pChild);
+    pChild.Parent := pGroup.Parent;
+
+    Unregister(pGroup);
+
+    Inc(m_Report.m_GroupsMerged);
+
+    Result := pChild;
+end;
+//---------------------------------------------------------------------------
+function TWSVGOptimizer.ConvertPath(pPath: TWSVGPath): TWSVGElement;
+var
+    pItem: TWSVGItem;
+begin
+    Result := pPath.ToLine;
+
+    if (not Assigned(Result)) then
+        Exit;
+
+    // link the path identifier with the line which replaces it
+    if (Assigned(m_pDefsTable) and (not TWStringHelper.IsEmpty(pPath.ItemID))
+            and m_pDefsTable.TryGetValue(pPath.ItemID, pItem) and (pItem = pPath))
+    then
+        m_pDefsTable.AddOrSetValue(pPath.ItemID, Result);
+
+    Inc(m_Report.m_PathsConverted);
+end;
+//---------------------------------------------------------------------------
+procedure TWSVGOptimizer.OptimizeContainer(pContainer: TWSVGContainer);
+var
+    pElement: TWSVGElement;
+    i:        Integer;
+begin
+    i := 0;
+
+    // remove the unused defines, and optimize the remaining ones
+    while (i < pContainer.m_pDefsElements.Count) do
+    begin
+        pElement := pContainer.m_pDefsElements[i];
+
+        if (not IsReferenced(pElement)) then
+        begin
+            DeleteElement(pContainer.m_pDefsElements, i);
+            Inc(m_Report.m_DefsRemoved);
+            continue;
+        end;
+
+        if (pElement is TWSVGContainer) then
+            OptimizeContainer(pElement as TWSVGContainer);
+
+        Inc(i);
+    end;
+
+    OptimizeElements(pContainer.m_pElements, pContainer is TWSVGSwitch);
+end;
+//---------------------------------------------------------------------------
+procedure TWSVGOptimizer.OptimizeElements(pElements: TWSVGElement.IElements; conditional: Boolean);
+var
+    pElement, pReplacement: TWSVGElement;
+    i:                      Integer;
+begin
+    i := 0;
+
+    while (i < pElements.Count) do
+    begin
+        pElement := pElements[i];
+
+        // only the containers (i.e. groups, shapes, ...) are simplified, the other elements (e.g. the
+        // gradients or the header) are kept as is
+        if (not(pElement is TWSVGContainer)) then
+        begin
+            Inc(i);
+            continue;
+        end;
+
+        // optimize the children first, thus the nested groups may be merged in chain
+        OptimizeContainer(pElement as TWSVGContainer);
+
+        RemoveIdentityTransforms(pElement);
+
+        // the children of a switch are selected by their position and conditions, keep them
+        if (conditional) then
+        begin
+            Inc(i);
+            continue;
+        end;
+
+        // unused symbol or clip path? (these elements are only drawn when referenced)
+        if (((pElement is TWSVGSymbol) or (pElement is TWSVGClipPath)) and (not IsReferenced(pElement))) then
+        begin
+            DeleteElement(pElements, i);
+            Inc(m_Report.m_DefsRemoved);
+            continue;
+        end;
+
+        // hidden element? (NOTE an animation may change the display mode)
+        if (IsHidden(pElement) and ((pElement as TWSVGContainer).m_pAnimations.Count = 0)
+                and (not IsReferenced(pElement)))
+        then
+        begin
+            DeleteElement(pElements, i);
+            Inc(m_Report.m_HiddenRemoved);
+            continue;
+        end;
+
+        // empty element?
+        if (IsEmpty(pElement) and IsStatic(pElement)) then
+        begin
+            DeleteElement(pElements, i);
+            Inc(m_Report.m_EmptyRemoved);
+            continue;
+        end;
+
+        pReplacement := nil;
+
+        if (pElement is TWSVGGroup) then
+            pReplacement := MergeGroup(pElement as TWSVGGroup)
+        else
+        if (pElement is TWSVGPath) then
+            pReplacement := ConvertPath(pElement as TWSVGPath);
+
+        // replace the element. NOTE the list owns its elements, so the replaced element is also freed
+        if (Assigned(pReplacement)) then
+            pElements[i] := pReplacement;
+
+        Inc(i);
+    end;
+end;
+//---------------------------------------------------------------------------
+function TWSVGOptimizer.Optimize(pRoot: TWSVGContainer): IReport;
+begin
+    m_Report := Default(IReport);
+
+    if (not Assigned(pRoot)) then
+        Exit(m_Report);
+
+    m_pReferences.Clear;
+    m_pDefsTable := pRoot.DefsTable;
+
+    // NOTE the root itself isn't counted
+    m_Report.m_ElementsBefore := CountElements(pRoot) - 1;
+
+    CollectReferences(pRoot);
+    OptimizeContainer(pRoot);
+
+    m_Report.m_ElementsAfter := CountElements(pRoot) - 1;
+
+    Result := m_Report;
+end;
+//---------------------------------------------------------------------------
 
 end.
@@ -206,6 +206,12 @@ type
             }
             function GetEffectCount: NativeUInt; virtual;
 
+            {**
+             Write the filter effects as xml
+             @param(pWriter Xml writer to write to)
+            }
+            procedure WriteXmlContent(pWriter: TWSVGXmlWriter); override;
+
         public
             {**
              Constructor
@@ -461,6 +467,17 @@ begin
     Result := m_pEffects.Count;
 end;
 //---------------------------------------------------------------------------
+procedure TWSVGFilter.WriteXmlContent(pWriter: TWSVGXmlWriter);
+var
+    pEffect: TWSVGElement;
+begin
+    inherited WriteXmlContent(pWriter);
+
+    // iterate through effects to write
+    for pEffect in m_pEffects do
+        pEffect.WriteXml(pWriter);
+end;
+//---------------------------------------------------------------------------
 procedure TWSVGFilter.Assign(const pOther: TWSVGItem);
 var
     pSource:             TWSVGFilter;
@@ -794,14 +811,23 @@ end;
 //---------------------------------------------------------------------------
 function TWSVGFilter.ToXml: UnicodeString;
 var
-    pEffect: TWSVGElement;
+    pBuilder: TStringBuilder;
+    pEffect:  TWSVGElement;
 begin
-    Result := inherited ToXml;
+    pBuilder := TStringBuilder.Create;
 
-    // iterate through effects to convert to xml
-    for pEffect in m_pEffects do
-        // write child effect to xml
-        Result := Result + pEffect.ToXml();
+    try
+        pBuilder.Append(inherited ToXml);
+
+        // iterate through effects to convert to xml
+        for pEffect in m_pEffects do
+            // write child effect to xml
+            pBuilder.Append(pEffect.ToXml());
+
+        Result := pBuilder.ToString;
+    finally
+        pBuilder.Free;
+    end;
 end;
 //---------------------------------------------------------------------------
 
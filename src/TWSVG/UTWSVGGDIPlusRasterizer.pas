@@ -10,10 +10,17 @@ interface
     // do not include some GDI+ headers in hpp, because they may generate conflicts in C++ code
     (*$NOINCLUDE Winapi.GdipObj *)
 
+    // uncomment line below to enable the render profiling (never in release)
+    {$ifdef WTCONTROLS_DEBUG}
+        {$define ENABLE_SVG_RENDER_PROFILING}
+    {$endif}
+
 uses System.SysUtils,
      System.Classes,
      System.Types,
      System.Math,
+     System.Generics.Collections,
+     System.Diagnostics,
      {$if CompilerVersion > 24}
         System.NetEncoding,
      {$ifend}
@@ -30,6 +37,8 @@ uses System.SysUtils,
      UTWVector,
      UTWMatrix,
      UTWHelpers,
+     UTWMajorSettings,
+     UTWCacheHit,
      UTWSmartPointer,
      UTWGraphicPath,
      UTWGDIPlusGradient,
@@ -50,6 +59,9 @@ uses System.SysUtils,
      UTWSVGAnimationDescriptor,
      UTWSVGRasterizer;
 
+const
+    C_SVG_Hit_Grid_Size: Integer = 32; // max hit index cells per side
+
 type
     {**
      Scalable Vector Graphics (SVG) rasterizer using GDI+
@@ -84,8 +96,161 @@ type
                     property BoundingBox: TWRectF read m_BoundingBox write m_BoundingBox;
             end;
 
+            {**
+             Text layout, contains the GDI+ font and the measures required to draw a text run
+            }
+            ITextLayout = class
+                private
+                    m_pFont:        TGpFont;
+                    m_pFontFamily:  TGpFontFamily;
+                    m_BoundingBox:  TGpRectF; // text bounds, as measured inside the view box
+                    m_CharRect:     TGpRectF; // first char bounds, only measured for start and end anchors
+                    m_Ascent:       Integer;
+
+                public
+                    {**
+                     Constructor
+                    }
+                    constructor Create; virtual;
+
+                    {**
+                     Destructor
+                    }
+                    destructor Destroy; override;
+
+                public
+                    property Font:        TGpFont       read m_pFont;
+                    property FontFamily:  TGpFontFamily read m_pFontFamily;
+                    property BoundingBox: TGpRectF      read m_BoundingBox;
+                    property CharRect:    TGpRectF      read m_CharRect;
+                    property Ascent:      Integer       read m_Ascent;
+            end;
+
+            {**
+             Text layout cache, the key is built from the text and all the values that may change its
+             measures (font, size, style, anchor, view box and scaling)
+            }
+            ITextLayoutCache = TObjectDictionary<UnicodeString, ITextLayout>;
+
+            {**
+             "first in/first out" text layout key list
+            }
+            IFIFOTextLayout = TList<UnicodeString>;
+
+            {**
+             Hit shape, contains the geometry of a drawn element, as recorded to be hit-tested
+            }
+            IHitShape = class
+                private
+                    m_pElement: TWSVGElement;
+                    m_pPath:    TGpGraphicsPath; // element geometry, in local coordinates
+                    m_pPen:     TGpPen;          // pen outlining the geometry, @nil if not stroked
+                    m_pClip:    TGpRegion;       // clip region in device coordinates, @nil if not clipped
+                    m_Inverse:  TWMatrix2x3;     // matrix transforming the device coordinates to local ones
+                    m_Bounds:   TRect;           // element bounds, including the stroke, in device coordinates
+                    m_Filled:   Boolean;
+
+                public
+                    {**
+                     Constructor
+                    }
+                    constructor Create; virtual;
+
+                    {**
+                     Destructor
+                    }
+                    destructor Destroy; override;
+
+                    {**
+                     Check if a point is inside the painted area of the shape
+                     @param(point Point to check, in device coordinates)
+                     @returns(@true if the point is on the fill or the stroke, and inside the clip
+                              region, otherwise @false)
+                    }
+                    function Contains(const point: TPoint): Boolean;
+            end;
+
+            {**
+             Hit shape list, ordered from the bottom to the top
+            }
+            IHitShapes = TObjectList<IHitShape>;
+
+            {**
+             Hit index, contains the shapes drawn for a document frame, and a grid of device cells,
+             each referencing the shapes overlapping it
+            }
+            IHitIndex = class
+                private
+                    m_Key:       UnicodeString;
+                    m_pShapes:   IHitShapes;
+                    m_Cells:     TArray<TList<Integer>>;
+                    m_Bounds:    TRect;
+                    m_CellSize:  Integer;
+                    m_Columns:   Integer;
+                    m_Recording: Boolean;
+
+                public
+                    {**
+                     Constructor
+                     @param(key Key identifying the document, rect and animation position to index)
+                    }
+                    constructor Create(const key: UnicodeString); virtual;
+
+                    {**
+                     Destructor
+                    }
+                    destructor Destroy; override;
+
+                    {**
+                     Build the cell grid from the recorded shapes, and stop the recording
+                    }
+                    procedure Build;
+
+                    {**
+                     Get the topmost shape painted at a point
+                     @param(point Point to test, in device coordinates)
+                     @returns(Topmost shape, @nil if no shape was hit)
+                    }
+                    function HitTest(const point: TPoint): IHitShape;
+            end;
+
+            {**
+             GDI+ render context, contains the text layouts and the renderer used by a draw
+             @br @bold(NOTE) The default context has no renderer of its own, it draws with the
+                             private renderer if any, otherwise with the global one
+            }
+            IGDIPlusRenderContext = class(TWSVGRasterizer.IRenderContext)
+                private
+                    m_pRenderer:           TWRenderer_GDIPlus;
+                    m_pTextLayouts:        ITextLayoutCache;
+                    m_pFIFOTextLayoutList: IFIFOTextLayout;
+                    m_pTextLayoutsCount:   TWCacheHit;
+                    m_pHitIndex:           IHitIndex;
+                    m_pHitUse:             TWSVGElement; // outermost use instruction drawn while hit-testing
+
+                public
+                    {**
+                     Constructor
+                     @param(pOwner Rasterizer owning the context)
+                    }
+                    constructor Create(pOwner: TWSVGRasterizer); override;
+
+                    {**
+                     Destructor
+                    }
+                    destructor Destroy; override;
+
+                    {**
+                     Clear the context, i.e. reset the animation states, the profiler, the text layouts
+                     and the hit index
+                    }
+                    procedure Clear; override;
+            end;
+
         private
-            m_GDIPlusToken: ULONG_PTR;
+            m_GDIPlusToken:          ULONG_PTR;
+            m_MaxCachedTextLayouts:  NativeUInt;
+            m_pPrivateRenderer:      TWRenderer_GDIPlus;
 
             {**
              Draw SVG elements
@@ -163,6 +328,28 @@ type
                     const animation: TWSVGRasterizer.IAnimation; pAspectRatio: IAspectRatio;
                     pCanvas: TCanvas; pGraphics: TGpGraphics; pElement: TWSVGElement; prevRegion: TGpRegion): Boolean;
 
+            {**
+             Get the text layout from cache, measure it and add it to cache if not found
+             @param(text Text to measure)
+             @param(fontFamily Font family name)
+             @param(fontSize Font size, matching with the GDI font height)
+             @param(fontStyle Font style, including the text decoration)
+             @param(anchor Text anchor)
+             @param(viewBox View box in which the text is measured)
+             @param(scaleW Scale factor to apply to width)
+             @param(scaleH Scale factor to apply to height)
+             @param(pTextFormat GDI+ text format to use to measure the text)
+             @param(pCanvas GDI canvas used to create the font and get its metrics)
+             @param(pGraphics GDI+ graphics used to measure the text)
+             @returns(Text layout, @nil if text could not be measured)
+             @br @bold(NOTE) The returned layout belongs to the cache and should not be deleted. It
+                             remains valid until the next layout is added to the cache
+            }
+            function GetTextLayout(const text, fontFamily: UnicodeString; fontSize: Single;
+                    fontStyle: TFontStyles; anchor: IETextAnchor; const viewBox: TGpRectF;
+                    scaleW, scaleH: Single; pTextFormat: TGpStringFormat; pCanvas: TCanvas;
+                    pGraphics: TGpGraphics): ITextLayout;
+
             {**
              Populate aspect ratio from element properties
              @param(pos Element position)
@@ -295,6 +482,96 @@ type
             procedure ApplyMatrix(const pMatrix: TGpMatrix; const pos: TPoint; scaleW, scaleH: Single;
                     pGraphics: TGpGraphics);
 
+            {**
+             Check if an element is too small to be visible once transformed to device coordinates
+             @param(bounds Element bounds, in local coordinates)
+             @param(strokeWidth Element stroke width, in local coordinates)
+             @param(matrix Matrix transforming the local coordinates to device coordinates)
+             @returns(@true if the element is smaller than the minimum element size on both axis,
+                      otherwise @false)
+             @br @bold(NOTE) The device bounds of the animated elements are also added to the dirty
+                             rect here. For the same reason, @true is also returned if the element
+                             is outside the clip rect, or in measure only mode
+            }
+            function IsTooSmall(const bounds: TGpRectF; strokeWidth: Single;
+                    const matrix: TWMatrix2x3): Boolean; overload;
+
+            {**
+             Check if an element is too small to be visible once transformed to device coordinates
+             @param(bounds Element bounds, in local coordinates)
+             @param(strokeWidth Element stroke width, in local coordinates)
+             @param(pGraphics GDI+ graphics containing the matrix to apply to the element)
+             @returns(@true if the element is smaller than the minimum element size on both axis,
+                      otherwise @false)
+            }
+            function IsTooSmall(const bounds: TGpRectF; strokeWidth: Single;
+                    pGraphics: TGpGraphics): Boolean; overload;
+
+            {**
+             Check if a path is too small to be visible once transformed to device coordinates
+             @param(pPath Path to check)
+             @param(pStroke Path stroke, in local coordinates)
+             @param(pGraphics GDI+ graphics containing the matrix to apply to the path)
+             @returns(@true if the path is smaller than the minimum element size on both axis,
+                      otherwise @false)
+             @br @bold(NOTE) The path is measured with a pen configured like the stroke, because the
+                             miter joins and the square caps may exceed the stroke half width
+            }
+            function IsTooSmall(const pPath: TGpGraphicsPath; const pStroke: TWSVGRasterizer.IStroke;
+                    pGraphics: TGpGraphics): Boolean; overload;
+
+            {**
+             Check if the device bounds of the elements should be calculated
+             @returns(@true if the device bounds are required, otherwise @false)
+            }
+            function NeedsDeviceBounds: Boolean; inline;
+
+            {**
+             Check if an element may be skipped, because only the animated elements are measured and
+             it is a shape without animation
+             @param(pElement Element to check)
+             @returns(@true if the element may be skipped, otherwise @false)
+             @br @bold(NOTE) The containers and the use elements are never skipped, because they may
+                             draw animated children
+            }
+            function IsMeasureSkipped(pElement: TWSVGElement): Boolean;
+
+            {**
+             Get the GDI+ renderer to draw with
+             @returns(The renderer of the current render context if it isn't the default one, otherwise
+                      the private renderer if any, otherwise the global GDI+ renderer)
+            }
+            function GetRenderer: TWRenderer_GDIPlus;
+
+            {**
+             Get if the rasterizer uses its own GDI+ renderer
+             @returns(@true if the rasterizer uses its own renderer, otherwise @false)
+            }
+            function GetPrivateRenderer: Boolean;
+
+            {**
+             Set if the rasterizer uses its own GDI+ renderer
+             @param(value If @true, the rasterizer will use its own renderer)
+            }
+            procedure SetPrivateRenderer(value: Boolean);
+
+            {**
+             Flatten the path curves in draft quality, using a tolerance matching with the device scale
+             @param(pPath Path to flatten)
+             @param(pGraphics GDI+ graphics containing the matrix to apply to the path)
+             @br @bold(NOTE) In full quality the path is kept unchanged, GDI+ flattens it on the
+                             device with its own tolerance
+            }
+            procedure FlattenPath(pPath: TGpGraphicsPath; pGraphics: TGpGraphics);
+
+            {**
+             Configure the GDI+ graphics to match with the render quality
+             @param(antialiasing If @true, antialiasing should be used (if possible))
+             @param(pGraphics GDI+ graphics to configure)
+             @returns(@true if antialiasing should be used while elements are drawn, otherwise @false)
+            }
+            function ConfigureQuality(antialiasing: Boolean; pGraphics: TGpGraphics): Boolean;
+
             {**
              Update a bounding box
              @param(point New point to add to bounding box)
@@ -302,6 +579,99 @@ type
             }
             procedure UpdateBoundingBox(const point: TGpPointF; var boundingBox: TGpRectF);
 
+            {**
+             Get the matrix currently applied to a GDI+ graphics
+             @param(pGraphics GDI+ graphics to get from)
+             @returns(Matrix transforming the local coordinates to device coordinates, identity on error)
+            }
+            function GetTransform(pGraphics: TGpGraphics): TWMatrix2x3;
+
+            {**
+             Check if the drawn elements are recorded in the hit index
+             @returns(@true if the hit index is built by the running draw, otherwise @false)
+            }
+            function IsHitRecording: Boolean; inline;
+
+            {**
+             Record a drawn element in the hit index
+             @param(pElement Drawn element)
+             @param(pPath Element geometry, in local coordinates)
+             @param(fillMode Fill mode to apply to the geometry)
+             @param(pStyle Element style, defining if the geometry is filled and stroked. If @nil
+                           the geometry is considered as filled, e.g. for an image or a text)
+             @param(matrix Matrix transforming the local coordinates to device coordinates)
+             @param(pGraphics GDI+ graphics containing the current clip region)
+             @br @bold(NOTE) The elements drawn from an use instruction are clones, thus the outermost
+                             use instruction is recorded instead
+            }
+            procedure AddHitShape(pElement: TWSVGElement; const pPath: TGpGraphicsPath;
+                    fillMode: TFillMode; const pStyle: TWSVGRasterizer.IStyle; const matrix: TWMatrix2x3;
+                    pGraphics: TGpGraphics);
+
+            {**
+             Record a drawn rectangle in the hit index
+             @param(pElement Drawn element)
+             @param(rect Rectangle, in local coordinates)
+             @param(rx Corner horizontal radius)
+             @param(ry Corner vertical radius)
+             @param(pStyle Element style, @nil if the rectangle is filled, see AddHitShape())
+             @param(matrix Matrix transforming the local coordinates to device coordinates)
+             @param(pGraphics GDI+ graphics containing the current clip region)
+            }
+            procedure AddHitRect(pElement: TWSVGElement; const rect: TGpRectF; rx, ry: Single;
+                    const pStyle: TWSVGRasterizer.IStyle; const matrix: TWMatrix2x3; pGraphics: TGpGraphics);
+
+            {**
+             Build the hit index of a document frame, by measuring it on a scratch graphics
+             @param(pSVG SVG to index)
+             @param(rect Rect in which svg is drawn)
+             @param(proportional If @true, svg proportions are conserved)
+             @param(animation Animation params, containing e.g. position in percent (between 0 and 100))
+             @param(key Key identifying the document, rect and animation position)
+             @returns(@true on success, otherwise @false)
+            }
+            function BuildHitIndex(const pSVG: TWSVG; const rect: TRect; proportional: Boolean;
+                    const animation: TWSVGRasterizer.IAnimation; const key: UnicodeString): Boolean;
+
+            {**
+             Draw SVG on a GDI+ graphics
+             @param(pSVG SVG to draw)
+             @param(pos Draw position in pixels)
+             @param(scale Scale factor)
+             @param(antialiasing If @true, antialiasing should be used (if possible))
+             @param(animation Animation params, containing e.g. position in percent (between 0 and 100))
+             @param(pCanvas GDI canvas on which the texts are measured)
+             @param(pGraphics GDI+ graphics to draw on)
+             @returns(@true on success, otherwise @false)
+            }
+            function DrawToGraphics(const pSVG: TWSVG; const pos: TPoint; scale: Single; antialiasing: Boolean;
+                    const animation: TWSVGRasterizer.IAnimation; pCanvas: TCanvas;
+                    pGraphics: TGpGraphics): Boolean; overload;
+
+            {**
+             Draw SVG on a GDI+ graphics
+             @param(pSVG SVG to draw)
+             @param(rect Rect in which svg will be drawn)
+             @param(proportional If @true, svg proportions will be conserved)
+             @param(antialiasing If @true, antialiasing should be used (if possible))
+             @param(animation Animation params, containing e.g. position in percent (between 0 and 100))
+             @param(pCanvas GDI canvas on which the texts are measured)
+             @param(pGraphics GDI+ graphics to draw on)
+             @returns(@true on success, otherwise @false)
+            }
+            function DrawToGraphics(const pSVG: TWSVG; const rect: TRect; proportional, antialiasing: Boolean;
+                    const animation: TWSVGRasterizer.IAnimation; pCanvas: TCanvas;
+                    pGraphics: TGpGraphics): Boolean; overload;
+
+            {**
+             Swap the red and blue channels of 32 bit pixels, in place
+             @param(pBits First pixel of the top row)
+             @param(width Width in pixels)
+             @param(height Height in pixels)
+             @param(stride Offset in bytes between two rows)
+            }
+            procedure SwapRedAndBlue(pBits: PByte; width, height, stride: Integer);
+
             {**
              Apply the watermark above the draw when the library is compiled as trial version
              @param(rect SVG rect)
@@ -355,6 +725,69 @@ type
             }
             function Draw(const pSVG: TWSVG; const rect: TRect; proportional, antialiasing: Boolean;
                     const animation: TWSVGRasterizer.IAnimation; pCanvas: TCustomCanvas): Boolean; overload; override;
+
+            {**
+             Draw a part of a SVG directly in a memory buffer provided by the caller, without
+             intermediate bitmap
+             @param(pSVG SVG to draw)
+             @param(rect Rect in which svg will be drawn, in buffer coordinates)
+             @param(proportional If @true, svg proportions will be conserved)
+             @param(antialiasing If @true, antialiasing should be used (if possible))
+             @param(animation Animation params, containing e.g. position in percent (between 0 and 100))
+             @param(buffer Buffer to draw on)
+             @param(subRect Buffer area to draw, in buffer coordinates, the pixels outside it remain
+                            unchanged. If empty the whole buffer is drawn)
+             @returns(@true on success, otherwise @false)
+             @br @bold(NOTE) The buffer memory is used as is by GDI+, so the premultiplied BGRA pixels
+                             are drawn without any copy. The straight RGBA pixels are drawn as BGRA,
+                             their red and blue channels being swapped in place before and after
+            }
+            function DrawToBuffer(const pSVG: TWSVG; const rect: TRect; proportional, antialiasing: Boolean;
+                    const animation: TWSVGRasterizer.IAnimation; const buffer: TWSVGRasterizer.IRenderBuffer;
+                    const subRect: TRect): Boolean; overload; override;
+
+            {**
+             Get the cache hit counters used by the rasterizer, including the ones of its renderer
+             @param(pCounters List to which the counters should be added)
+            }
+            procedure GetCacheCounters(pCounters: TList<TWCacheHit>); override;
+
+            {**
+             Create a new render context, to draw with this rasterizer
+             @returns(Render context, which belongs to the caller)
+             @br @bold(NOTE) Each context other than the default one draws with its own GDI+ renderer,
+                             thus the contexts may be used concurrently from several threads
+            }
+            function CreateContext: TWSVGRasterizer.IRenderContext; override;
+
+            {**
+             Get the topmost element drawn at a point
+             @param(pSVG SVG to hit-test)
+             @param(rect Rect in which svg is drawn)
+             @param(proportional If @true, svg proportions are conserved)
+             @param(animation Animation params, containing e.g. position in percent (between 0 and 100))
+             @param(point Point to test, in the same coordinates as the rect)
+             @param(pAncestors List to populate with the element ancestors, from its parent to the
+                               root, ignored if @nil)
+             @returns(Topmost element drawn at point, @nil if no element was hit)
+             @br @bold(NOTE) The first query measures the frame in measure only mode and records the
+                             geometry, the clip region and the device bounds of each drawn element in
+                             the render context. The next queries with the same document, rect and
+                             animation position only test the shapes of the grid cell containing
+                             the point, from the top to the bottom
+            }
+            function HitTest(const pSVG: TWSVG; const rect: TRect; proportional: Boolean;
+                    const animation: TWSVGRasterizer.IAnimation; const point: TPoint;
+                    pAncestors: TList<TWSVGElement>): TWSVGElement; overload; override;
+
+        public
+            {**
+             Get or set if the rasterizer uses its own GDI+ renderer, instead of the global one
+             shared by all the controls
+             @br @bold(NOTE) The global renderer caches aren't thread safe, so a rasterizer used
+                             outside the main thread should use its own renderer
+            }
+            property PrivateRenderer: Boolean read GetPrivateRenderer write SetPrivateRenderer;
     end;
 
 implementation
@@ -392,65 +825,282 @@ begin
     inherited Destroy;
 end;
 //---------------------------------------------------------------------------
-// TWSVGGDIPlusRasterizer
+// TWSVGGDIPlusRasterizer.ITextLayout
 //---------------------------------------------------------------------------
-constructor TWSVGGDIPlusRasterizer.Create(token: ULONG_PTR);
+constructor TWSVGGDIPlusRasterizer.ITextLayout.Create;
 begin
     inherited Create;
 
-    m_GDIPlusToken := token;
+    m_pFont       := nil;
+    m_pFontFamily := nil;
+    m_BoundingBox := Default(TGpRectF);
+    m_CharRect    := Default(TGpRectF);
+    m_Ascent      := 0;
 end;
 //---------------------------------------------------------------------------
-destructor TWSVGGDIPlusRasterizer.Destroy;
+destructor TWSVGGDIPlusRasterizer.ITextLayout.Destroy;
 begin
+    m_pFontFamily.Free;
+    m_pFont.Free;
+
     inherited Destroy;
 end;
 //---------------------------------------------------------------------------
-function TWSVGGDIPlusRasterizer.DrawElements(const pElements: TWSVGContainer.IElements; const pos: TPoint;
-        scaleW, scaleH: Single; antialiasing, switchMode: Boolean;
-        const animation: TWSVGRasterizer.IAnimation; pCanvas: TCanvas;
-        pGraphics: TGpGraphics): Boolean;
+// TWSVGGDIPlusRasterizer.IHitShape
+//---------------------------------------------------------------------------
+constructor TWSVGGDIPlusRasterizer.IHitShape.Create;
+begin
+    inherited Create;
+
+    m_pElement := nil;
+    m_pPath    := nil;
+    m_pPen     := nil;
+    m_pClip    := nil;
+    m_Inverse  := TWMatrix2x3.GetDefault;
+    m_Bounds   := Default(TRect);
+    m_Filled   := False;
+end;
+//---------------------------------------------------------------------------
+destructor TWSVGGDIPlusRasterizer.IHitShape.Destroy;
+begin
+    m_pPath.Free;
+    m_pPen.Free;
+    m_pClip.Free;
+
+    inherited Destroy;
+end;
+//---------------------------------------------------------------------------
+function TWSVGGDIPlusRasterizer.IHitShape.Contains(const point: TPoint): Boolean;
 var
-    pProperties, pHeaderProps: IWSmartPointer<IProperties>;
-    pElement:                  TWSVGElement;
-    pHeader:                   TWSVGParser.IHeader;
-    viewBox:                   TWRectF;
-    pAnimationData:            IWSmartPointer<IAnimationData>;
+    localPoint: TWVector2;
 begin
-    pProperties := TWSmartPointer<IProperties>.Create();
+    // point is clipped?
+    if (Assigned(m_pClip) and not m_pClip.IsVisible(point.X, point.Y)) then
+        Exit(False);
 
-    // load default properties
-    pProperties.Default;
+    // convert the point to the local coordinates, in which the geometry and the pen are expressed
+    localPoint := m_Inverse.Transform(TWVector2.Create(point.X, point.Y));
 
-    // iterate through SVG elements
-    for pElement in pElements do
-    begin
-        // get svg header (should always be the first element, because header is contained inside
-        // svg tag itself, that is the root tag)
-        if ((pElement.ItemName = C_SVG_Tag_Name) and (pElement is TWSVGParser.IHeader)) then
-        begin
-            pHeader := pElement as TWSVGParser.IHeader;
+    // point is on the fill?
+    if (m_Filled and m_pPath.IsVisible(localPoint.X, localPoint.Y)) then
+        Exit(True);
 
-            // found it?
-            if (not Assigned(pHeader)) then
-                continue;
+    // point is on the stroke?
+    Result := Assigned(m_pPen) and m_pPath.IsOutlineVisible(localPoint.X, localPoint.Y, m_pPen);
+end;
+//---------------------------------------------------------------------------
+// TWSVGGDIPlusRasterizer.IHitIndex
+//---------------------------------------------------------------------------
+constructor TWSVGGDIPlusRasterizer.IHitIndex.Create(const key: UnicodeString);
+begin
+    inherited Create;
 
-            // get view box
-            viewBox := GetViewBox(pHeader);
+    m_Key       := key;
+    m_pShapes   := IHitShapes.Create(True);
+    m_Bounds    := Default(TRect);
+    m_CellSize  := 1;
+    m_Columns   := 0;
+    m_Recording := True;
+end;
+//---------------------------------------------------------------------------
+destructor TWSVGGDIPlusRasterizer.IHitIndex.Destroy;
+var
+    pCell: TList<Integer>;
+begin
+    for pCell in m_Cells do
+        pCell.Free;
 
-            try
-                pHeaderProps   := TWSmartPointer<IProperties>.Create();
-                pAnimationData := TWSmartPointer<IAnimationData>.Create();
+    m_pShapes.Free;
 
-                // get header properties
-                if (not GetElementProps(pElement, pHeaderProps, pAnimationData, animation.m_pCustomData)) then
-                    Exit(False);
+    inherited Destroy;
+end;
+//---------------------------------------------------------------------------
+procedure TWSVGGDIPlusRasterizer.IHitIndex.Build;
+var
+    pShape:                                         IHitShape;
+    i, x, y, left, top, right, bottom, index, rows: Integer;
+begin
+    m_Recording := False;
 
-                pHeaderProps.Merge(pProperties);
+    // nothing was drawn?
+    if (m_pShapes.Count = 0) then
+        Exit;
 
-                Exit(DrawElements(pHeader, viewBox.ToGpRectF, pHeaderProps, pElements, pos, scaleW,
-                        scaleH, antialiasing, switchMode, False, False, False, animation, nil,
-                        pCanvas, pGraphics));
+    // get the area covered by all the shapes
+    m_Bounds := m_pShapes[0].m_Bounds;
+
+    for i := 1 to m_pShapes.Count - 1 do
+        UnionRect(m_Bounds, m_Bounds, m_pShapes[i].m_Bounds);
+
+    // split the area in square cells
+    m_CellSize := Max(Ceil(Max(m_Bounds.Width, m_Bounds.Height) / C_SVG_Hit_Grid_Size), 1);
+    m_Columns  := (m_Bounds.Width  div m_CellSize) + 1;
+    rows       := (m_Bounds.Height div m_CellSize) + 1;
+
+    SetLength(m_Cells, m_Columns * rows);
+
+    // reference each shape in the cells it overlaps. As the shapes are added from the bottom to the
+    // top, each cell lists them in the same order
+    for i := 0 to m_pShapes.Count - 1 do
+    begin
+        pShape := m_pShapes[i];
+
+        if (pShape.m_Bounds.IsEmpty) then
+            continue;
+
+        left   := (pShape.m_Bounds.Left       - m_Bounds.Left) div m_CellSize;
+        top    := (pShape.m_Bounds.Top        - m_Bounds.Top)  div m_CellSize;
+        right  := (pShape.m_Bounds.Right  - 1 - m_Bounds.Left) div m_CellSize;
+        bottom := (pShape.m_Bounds.Bottom - 1 - m_Bounds.Top)  div m_CellSize;
+
+        for y := top to bottom do
+            for x := left to right do
+            begin
+                index := (y * m_Columns) + x;
+
+                if (not Assigned(m_Cells[index])) then
+                    m_Cells[index] := TList<Integer>.Create;
+
+                m_Cells[index].Add(i);
+            end;
+    end;
+end;
+//---------------------------------------------------------------------------
+function TWSVGGDIPlusRasterizer.IHitIndex.HitTest(const point: TPoint): IHitShape;
+var
+    pCell:  TList<Integer>;
+    pShape: IHitShape;
+    i:      Integer;
+begin
+    // point is outside all the shapes?
+    if ((Length(m_Cells) = 0) or not m_Bounds.Contains(point)) then
+        Exit(nil);
+
+    // get the cell containing the point
+    pCell := m_Cells[(((point.Y - m_Bounds.Top) div m_CellSize) * m_Columns)
+            + ((point.X - m_Bounds.Left) div m_CellSize)];
+
+    if (not Assigned(pCell)) then
+        Exit(nil);
+
+    // the last drawn shapes are above the others, thus they are tested first
+    for i := pCell.Count - 1 downto 0 do
+    begin
+        pShape := m_pShapes[pCell[i]];
+
+        if (pShape.m_Bounds.Contains(point) and pShape.Contains(point)) then
+            Exit(pShape);
+    end;
+
+    Result := nil;
+end;
+//---------------------------------------------------------------------------
+// TWSVGGDIPlusRasterizer.IGDIPlusRenderContext
+//---------------------------------------------------------------------------
+constructor TWSVGGDIPlusRasterizer.IGDIPlusRenderContext.Create(pOwner: TWSVGRasterizer);
+begin
+    inherited Create(pOwner);
+
+    m_pRenderer           := nil;
+    m_pTextLayouts        := ITextLayoutCache.Create([doOwnsValues]);
+    m_pFIFOTextLayoutList := IFIFOTextLayout.Create;
+    m_pHitIndex           := nil;
+    m_pHitUse             := nil;
+
+    // the counters are always maintained, to be queried by GetCacheCounters(), but only logged on
+    // destruction if required
+    m_pTextLayoutsCount      := TWCacheHit.Create;
+    m_pTextLayoutsCount.Name := 'Text layouts';
+
+    {$if not defined(ENABLE_GDIPLUS_CACHE_LOGGING) and not defined(ENABLE_SVG_RENDER_PROFILING)}
+        m_pTextLayoutsCount.LogOnDestroy := False;
+    {$ifend}
+end;
+//---------------------------------------------------------------------------
+destructor TWSVGGDIPlusRasterizer.IGDIPlusRenderContext.Destroy;
+begin
+    m_pRenderer.Free;
+    m_pTextLayouts.Free;
+    m_pFIFOTextLayoutList.Free;
+    m_pHitIndex.Free;
+    m_pTextLayoutsCount.Free;
+
+    inherited Destroy;
+end;
+//---------------------------------------------------------------------------
+procedure TWSVGGDIPlusRasterizer.IGDIPlusRenderContext.Clear;
+begin
+    inherited Clear;
+
+    m_pTextLayouts.Clear;
+    m_pFIFOTextLayoutList.Clear;
+
+    FreeAndNil(m_pHitIndex);
+end;
+//---------------------------------------------------------------------------
+// TWSVGGDIPlusRasterizer
+//---------------------------------------------------------------------------
+constructor TWSVGGDIPlusRasterizer.Create(token: ULONG_PTR);
+begin
+    inherited Create;
+
+    m_GDIPlusToken         := token;
+    m_MaxCachedTextLayouts := 100;
+    m_pPrivateRenderer     := nil;
+end;
+//---------------------------------------------------------------------------
+destructor TWSVGGDIPlusRasterizer.Destroy;
+begin
+    m_pPrivateRenderer.Free;
+
+    inherited Destroy;
+end;
+//---------------------------------------------------------------------------
+function TWSVGGDIPlusRasterizer.DrawElements(const pElements: TWSVGContainer.IElements; const pos: TPoint;
+        scaleW, scaleH: Single; antialiasing, switchMode: Boolean;
+        const animation: TWSVGRasterizer.IAnimation; pCanvas: TCanvas;
+        pGraphics: TGpGraphics): Boolean;
+var
+    pProperties, pHeaderProps: IWSmartPointer<IProperties>;
+    pElement:                  TWSVGElement;
+    pHeader:                   TWSVGParser.IHeader;
+    viewBox:                   TWRectF;
+    pAnimationData:            IWSmartPointer<IAnimationData>;
+begin
+    pProperties := TWSmartPointer<IProperties>.Create();
+
+    // load default properties
+    pProperties.Default;
+
+    // iterate through SVG elements
+    for pElement in pElements do
+    begin
+        // get svg header (should always be the first element, because header is contained inside
+        // svg tag itself, that is the root tag)
+        if ((pElement.ItemName = C_SVG_Tag_Name) and (pElement is TWSVGParser.IHeader)) then
+        begin
+            pHeader := pElement as TWSVGParser.IHeader;
+
+            // found it?
+            if (not Assigned(pHeader)) then
+                continue;
+
+            // get view box
+            viewBox := GetViewBox(pHeader);
+
+            try
+                pHeaderProps   := TWSmartPointer<IProperties>.Create();
+                pAnimationData := TWSmartPointer<IAnimationData>.Create();
+
+                // get header properties
+                if (not GetElementProps(pElement, pHeaderProps, pAnimationData, animation.m_pCustomData)) then
+                    Exit(False);
+
+                pHeaderProps.Merge(pProperties);
+
+                Exit(DrawElements(pHeader, viewBox.ToGpRectF, pHeaderProps, pElements, pos, scaleW,
+                        scaleH, antialiasing, switchMode, False, False, False, animation, nil,
+                        pCanvas, pGraphics));
             finally
                 {$ifdef TRIAL_BUILD}
                     // apply trial timesamp
@@ -497,41 +1147,42 @@ var
     pFill:                                                                                            IWSmartPointer<TWFill>;
     pStroke:                                                                                          IWSmartPointer<TWStroke>;
     paPen:                                                                                            IWSmartPointer<TGpPen>;
-    pFont:                                                                                            IWSmartPointer<TGpFont>;
-    pFontFamily:                                                                                      IWSmartPointer<TGPFontFamily>;
-    pTextFont:                                                                                        IWSmartPointer<TFont>;
     pTextFormat:                                                                                      IWSmartPointer<TGpStringFormat>;
     pGradientFactory:                                                                                 IWSmartPointer<TWGDIPlusGradient>;
     pRegion, pPrevRegion, pCurRegion, pPrevAspectRatioRegion:                                         IWSmartPointer<TGpRegion>;
     pImageData:                                                                                       IWSmartPointer<TMemoryStream>;
     pAspectRatioOverride:                                                                             IWSmartPointer<IAspectRatio>;
     pAspectRatioToUse:                                                                                IAspectRatio;
+    pTextLayout:                                                                                      ITextLayout;
     pGraphic:                                                                                         TGraphic;
-    textMetrics:                                                                                      TEXTMETRIC;
     charRange:                                                                                        TCharacterRange;
-    charRegions:                                                                                      array of TGpRegion;
     points:                                                                                           TWRenderer_GDIPlus.IGDIPlusPointList;
     pGpPen, pFakePen:                                                                                 TGpPen;
     point, textPos:                                                                                   TGpPointF;
-    boundingBox, rectToDraw, charRect:                                                                TGpRectF;
+    boundingBox, rectToDraw:                                                                          TGpRectF;
     rect, imageRect, elementViewBox:                                                                  TWRectF;
     iRect:                                                                                            TRect;
     svgPos, posFromProps:                                                                             TPoint;
     color:                                                                                            TWColor;
     outputMatrix:                                                                                     TWMatrix3x3;
+    elementMatrix:                                                                                    TWMatrix2x3;
     dashPatternCount, i:                                                                              NativeInt;
     count:                                                                                            NativeUInt;
     x, y, initialX, initialY, x1, y1, x2, y2, r, rx, ry, d, dx, dy, width, height, dashFactor, coord: Single;
     fontSize, fontStyleAngle:                                                                         Single;
     fontWeight:                                                                                       Cardinal;
-    fontFamily, fontFamilyLowerCase:                                                                  UnicodeString;
+    fontFamily:                                                                                       UnicodeString;
     anchor:                                                                                           IETextAnchor;
     decoration:                                                                                       IETextDecoration;
     imageType:                                                                                        IEImageType;
     pImageOptions:                                                                                    TWRenderer.IImageOptions;
     fontStyle:                                                                                        TWSVGText.IEFontStyle;
     gdiFontStyle:                                                                                     TFontStyles;
-    isXCoord, isClipped, isAspectRatioClipped, bolder, lighter:                                       Boolean;
+    isXCoord, isClipped, isAspectRatioClipped, isHitUse, bolder, lighter:                             Boolean;
+    traceStart:                                                                                       Int64;
+    {$ifdef ENABLE_SVG_RENDER_PROFILING}
+        elementStart, stageStart:                                                                     Int64;
+    {$endif}
 begin
     // svg header should always be declared, otherwise svg data is malformed (NOTE svg header
     // element should exist even if the svg tag contains nothing else)
@@ -539,7 +1190,7 @@ begin
         raise Exception.Create('SVG is malformed');
 
     // get GDI+ renderer
-    pRenderer := TWControlRenderer.GetGDIPlusRenderer;
+    pRenderer := GetRenderer;
 
     // found it?
     if (not Assigned(pRenderer)) then
@@ -548,6 +1199,25 @@ begin
     // iterate through SVG elements
     for pElement in pElements do
     begin
+        {$ifdef ENABLE_SVG_RENDER_PROFILING}
+            elementStart := GetContext.Profiler.Start;
+        {$endif}
+
+        traceStart := TWTraceHelper.Start;
+
+        try
+
+        // measuring only the animated elements? A static shape changes nothing, so it is skipped
+        // before its clipping and properties are resolved
+        if (IsMeasureSkipped(pElement)) then
+        begin
+            // is switch mode enabled?
+            if (switchMode) then
+                Exit(True);
+
+            continue;
+        end;
+
         // is a group?
         if (pElement is TWSVGGroup) then
         begin
@@ -834,12 +1504,24 @@ begin
                 pClonedElements := TWSmartPointer<TWSVGContainer.IElements>.Create(TWSVGContainer.IElements.Create(False));
                 pClonedElements.Add(pClone);
 
-                // draw the cloned element
-                if (not DrawElements(pHeader, viewBox, pProps, pClonedElements, posFromProps, scaleW,
-                        scaleH, antialiasing, switchMode, clippingMode, True, intersection, animation,
-                        pAspectRatio, pCanvas, pGraphics))
-                then
-                    Exit(False);
+                // the cloned elements only live while drawing, thus the outermost use instruction is
+                // recorded instead of them while hit-testing
+                isHitUse := IsHitRecording and not Assigned(IGDIPlusRenderContext(GetContext).m_pHitUse);
+
+                if (isHitUse) then
+                    IGDIPlusRenderContext(GetContext).m_pHitUse := pUse;
+
+                try
+                    // draw the cloned element
+                    if (not DrawElements(pHeader, viewBox, pProps, pClonedElements, posFromProps, scaleW,
+                            scaleH, antialiasing, switchMode, clippingMode, True, intersection, animation,
+                            pAspectRatio, pCanvas, pGraphics))
+                    then
+                        Exit(False);
+                finally
+                    if (isHitUse) then
+                        IGDIPlusRenderContext(GetContext).m_pHitUse := nil;
+                end;
 
                 continue;
             end;
@@ -1102,12 +1784,19 @@ begin
                         TWSmartPointer<TWGraphicPathConverter_GDIPlus>.Create
                                 (TWGraphicPathConverter_GDIPlus.Create(pGraphicsPath));
 
+                {$ifdef ENABLE_SVG_RENDER_PROFILING}
+                    stageStart := GetContext.Profiler.Start;
+                {$endif}
+
                 // get path to draw
                 if (not pPathConverter.Process(rect, pPath.Commands)) then
                     Exit(False);
 
-                pMatrix := TWSmartPointer<TGpMatrix>.Create();
-                pProps.Matrix.Value.ToGpMatrix(pMatrix);
+                {$ifdef ENABLE_SVG_RENDER_PROFILING}
+                    GetContext.Profiler.Stop(pElement, IE_PS_Geometry, stageStart);
+                {$endif}
+
+                pMatrix := TWSmartPointer<TGpMatrix>.Create(pProps.Matrix.Value.ToGpMatrix);
 
                 isAspectRatioClipped := False;
 
@@ -1143,6 +1832,11 @@ begin
                     ApplyMatrix(pMatrix, svgPos, scaleW, scaleH, pGraphics);
                 end;
 
+                // record the path geometry, if hit-testing
+                if ((not clippingMode) and IsHitRecording) then
+                    AddHitShape(pElement, pGraphicsPath, GetFillMode(pParentProps, pProps), pProps.Style,
+                            GetTransform(pGraphics), pGraphics);
+
                 // do apply a clipping path?
                 if (clippingMode) then
                 begin
@@ -1167,7 +1861,11 @@ begin
                         pGraphics.SetClip(pRegion, CombineModeUnion);
                 end
                 else
+                // is path large enough to be visible?
+                if (not IsTooSmall(pGraphicsPath, pProps.Style.Stroke, pGraphics)) then
                 begin
+                    FlattenPath(pGraphicsPath, pGraphics);
+
                     pGraphicsPath.SetFillMode(GetFillMode(pParentProps, pProps));
 
                      // get the path bounding box
@@ -1193,15 +1891,31 @@ begin
 
                     pFill := TWSmartPointer<TWFill>.Create();
 
+                    {$ifdef ENABLE_SVG_RENDER_PROFILING}
+                        stageStart := GetContext.Profiler.Start;
+                    {$endif}
+
                     // draw the path
                     if (GetBrush(pProps.Style, viewBox, boundingBox, scaleW, scaleH, pRenderer, pFill)) then
                         pRenderer.FillPath(pGraphicsPath, pFill, pGraphics, TWRectF.Create(boundingBox, False));
 
+                    {$ifdef ENABLE_SVG_RENDER_PROFILING}
+                        GetContext.Profiler.Stop(pElement, IE_PS_Fill, stageStart);
+                    {$endif}
+
                     pStroke := TWSmartPointer<TWStroke>.Create();
 
+                    {$ifdef ENABLE_SVG_RENDER_PROFILING}
+                        stageStart := GetContext.Profiler.Start;
+                    {$endif}
+
                     // outline the path
                     if (GetPen(pProps.Style, viewBox, boundingBox, scaleW, scaleH, pRenderer, pStroke)) then
                         pRenderer.DrawPath(pGraphicsPath, pStroke, pGraphics, TWRectF.Create(boundingBox, False));
+
+                    {$ifdef ENABLE_SVG_RENDER_PROFILING}
+                        GetContext.Profiler.Stop(pElement, IE_PS_Stroke, stageStart);
+                    {$endif}
                 end;
 
                 // restore the previous cliping before aspect ratio, if any
@@ -1277,19 +1991,19 @@ begin
                 // do apply a clipping path?
                 if (clippingMode) then
                 begin
-                    pMatrix := TWSmartPointer<TGpMatrix>.Create();
-                    pProps.Matrix.Value.ToGpMatrix(pMatrix);
+                    elementMatrix := pProps.Matrix.Value^;
 
                     // set svg element to final size
-                    pMatrix.Scale(scaleW, scaleH, MatrixOrderAppend);
+                    elementMatrix.AppendScale(scaleW, scaleH);
 
                     // calculate position at which svg element should be drawn
                     svgPos := CalculateFinalPos(pos, viewBox, scaleW, scaleH);
 
                     // set svg element to final location (applying user position and viewbox correction)
-                    pMatrix.Translate(svgPos.X, svgPos.Y, MatrixOrderAppend);
+                    elementMatrix.AppendTranslate(svgPos.X, svgPos.Y);
 
                     // apply transformation matrix to rectangle
+                    pMatrix := TWSmartPointer<TGpMatrix>.Create(elementMatrix.ToGpMatrix);
                     pGraphics.SetTransform(pMatrix);
 
                     // get the current region
@@ -1335,17 +2049,17 @@ begin
                     pRectOptions.Radius.RightBottom.X := pRectOptions.Radius.LeftTop.X;
                     pRectOptions.Radius.RightBottom.Y := pRectOptions.Radius.LeftTop.Y;
 
-                    pMatrix := TWSmartPointer<TGpMatrix>.Create();
-                    pProps.Matrix.Value.ToGpMatrix(pMatrix);
+                    elementMatrix := pProps.Matrix.Value^;
 
                     // set svg element to final size
-                    pMatrix.Scale(scaleW, scaleH, MatrixOrderAppend);
+                    elementMatrix.AppendScale(scaleW, scaleH);
 
                     isAspectRatioClipped := False;
 
                     // should apply an aspect ratio onto the rectangle?
                     if (Assigned(pAspectRatio)) then
                     begin
+                        pMatrix                := TWSmartPointer<TGpMatrix>.Create(elementMatrix.ToGpMatrix);
                         pPrevAspectRatioRegion := TWSmartPointer<TGpRegion>.Create();
 
                         // apply aspect ratio and get the previous clipping region, if any
@@ -1358,18 +2072,31 @@ begin
                         svgPos := CalculateFinalPos(pos, viewBox, scaleW, scaleH);
 
                         // set svg element to final location (applying user position and viewbox correction)
-                        pMatrix.Translate(svgPos.X, svgPos.Y, MatrixOrderAppend);
+                        elementMatrix.AppendTranslate(svgPos.X, svgPos.Y);
                     end;
 
                     // apply transformation matrix to rectangle
-                    outputMatrix := TWMatrix3x3.Create(pMatrix);
+                    outputMatrix := elementMatrix.ToMatrix3x3;
                     pRectOptions.TransformMatrix.Assign(outputMatrix);
 
+                    // record the rectangle geometry, if hit-testing
+                    if (IsHitRecording) then
+                        AddHitRect(pElement, rectToDraw, rx, ry, pProps.Style, elementMatrix, pGraphics);
+
                     GetBrush(pProps.Style, viewBox, rectToDraw, scaleW, scaleH, pRenderer, pRectOptions.Fill);
                     GetPen  (pProps.Style, viewBox, rectToDraw, scaleW, scaleH, pRenderer, pRectOptions.Stroke);
 
-                    // draw rectangle
-                    pRenderer.DrawRect(TWRectF.Create(rectToDraw, False), pRectOptions, pGraphics, iRect);
+                    {$ifdef ENABLE_SVG_RENDER_PROFILING}
+                        stageStart := GetContext.Profiler.Start;
+                    {$endif}
+
+                    // draw rectangle, if large enough to be visible
+                    if (not IsTooSmall(rectToDraw, pProps.Style.Stroke.Width.Value, elementMatrix)) then
+                        pRenderer.DrawRect(TWRectF.Create(rectToDraw, False), pRectOptions, pGraphics, iRect);
+
+                    {$ifdef ENABLE_SVG_RENDER_PROFILING}
+                        GetContext.Profiler.Stop(pElement, IE_PS_Fill, stageStart);
+                    {$endif}
 
                     // restore the previous cliping before aspect ratio, if any
                     if (isAspectRatioClipped) then
@@ -1448,8 +2175,7 @@ begin
                 // calculate diameter
                 d := r * 2.0;
 
-                pMatrix := TWSmartPointer<TGpMatrix>.Create();
-                pProps.Matrix.Value.ToGpMatrix(pMatrix);
+                pMatrix := TWSmartPointer<TGpMatrix>.Create(pProps.Matrix.Value.ToGpMatrix);
 
                 isAspectRatioClipped := False;
 
@@ -1476,6 +2202,16 @@ begin
                     ApplyMatrix(pMatrix, svgPos, scaleW, scaleH, pGraphics);
                 end;
 
+                // record the circle geometry, if hit-testing
+                if ((not clippingMode) and IsHitRecording) then
+                begin
+                    pGraphicsPath := TWSmartPointer<TGpGraphicsPath>.Create(TGpGraphicsPath.Create);
+                    pGraphicsPath.AddEllipse(x - r, y - r, d, d);
+
+                    AddHitShape(pElement, pGraphicsPath, GetFillMode(pParentProps, pProps), pProps.Style,
+                            GetTransform(pGraphics), pGraphics);
+                end;
+
                 // do apply a clipping path?
                 if (clippingMode) then
                 begin
@@ -1503,6 +2239,8 @@ begin
                         pGraphics.SetClip(pRegion, CombineModeUnion);
                 end
                 else
+                // is circle large enough to be visible?
+                if (not IsTooSmall(MakeRect(x - r, y - r, d, d), pProps.Style.Stroke.Width.Value, pGraphics)) then
                 begin
                     // calculate the circle bounding box
                     if ((pProps.Style.Fill.Brush.BrushType <> E_BT_Solid)
@@ -1522,15 +2260,31 @@ begin
 
                     pFill := TWSmartPointer<TWFill>.Create();
 
+                    {$ifdef ENABLE_SVG_RENDER_PROFILING}
+                        stageStart := GetContext.Profiler.Start;
+                    {$endif}
+
                     // draw the circle
                     if (GetBrush(pProps.Style, viewBox, boundingBox, scaleW, scaleH, pRenderer, pFill)) then
                         pRenderer.FillEllipse(x - r, y - r, d, d, pFill, pGraphics, TWRectF.Create(boundingBox, False));
 
+                    {$ifdef ENABLE_SVG_RENDER_PROFILING}
+                        GetContext.Profiler.Stop(pElement, IE_PS_Fill, stageStart);
+                    {$endif}
+
                     pStroke := TWSmartPointer<TWStroke>.Create();
 
+                    {$ifdef ENABLE_SVG_RENDER_PROFILING}
+                        stageStart := GetContext.Profiler.Start;
+                    {$endif}
+
                     // outline the circle
                     if (GetPen(pProps.Style, viewBox, boundingBox, scaleW, scaleH, pRenderer, pStroke)) then
                         pRenderer.DrawEllipse(x - r, y - r, d, d, pStroke, pGraphics, TWRectF.Create(boundingBox, False));
+
+                    {$ifdef ENABLE_SVG_RENDER_PROFILING}
+                        GetContext.Profiler.Stop(pElement, IE_PS_Stroke, stageStart);
+                    {$endif}
                 end;
 
                 // restore the previous cliping before aspect ratio, if any
@@ -1610,8 +2364,7 @@ begin
                 dx := rx * 2.0;
                 dy := ry * 2.0;
 
-                pMatrix := TWSmartPointer<TGpMatrix>.Create();
-                pProps.Matrix.Value.ToGpMatrix(pMatrix);
+                pMatrix := TWSmartPointer<TGpMatrix>.Create(pProps.Matrix.Value.ToGpMatrix);
 
                 isAspectRatioClipped := False;
 
@@ -1638,6 +2391,16 @@ begin
                     ApplyMatrix(pMatrix, svgPos, scaleW, scaleH, pGraphics);
                 end;
 
+                // record the ellipse geometry, if hit-testing
+                if ((not clippingMode) and IsHitRecording) then
+                begin
+                    pGraphicsPath := TWSmartPointer<TGpGraphicsPath>.Create(TGpGraphicsPath.Create);
+                    pGraphicsPath.AddEllipse(x - rx, y - ry, dx, dy);
+
+                    AddHitShape(pElement, pGraphicsPath, GetFillMode(pParentProps, pProps), pProps.Style,
+                            GetTransform(pGraphics), pGraphics);
+                end;
+
                 // do apply a clipping path?
                 if (clippingMode) then
                 begin
@@ -1665,6 +2428,8 @@ begin
                         pGraphics.SetClip(pRegion, CombineModeUnion);
                 end
                 else
+                // is ellipse large enough to be visible?
+                if (not IsTooSmall(MakeRect(x - rx, y - ry, dx, dy), pProps.Style.Stroke.Width.Value, pGraphics)) then
                 begin
                     // calculate the circle bounding box
                     if ((pProps.Style.Fill.Brush.BrushType <> E_BT_Solid)
@@ -1684,15 +2449,31 @@ begin
 
                     pFill := TWSmartPointer<TWFill>.Create();
 
+                    {$ifdef ENABLE_SVG_RENDER_PROFILING}
+                        stageStart := GetContext.Profiler.Start;
+                    {$endif}
+
                     // draw the ellipse
                     if (GetBrush(pProps.Style, viewBox, boundingBox, scaleW, scaleH, pRenderer, pFill)) then
                         pRenderer.FillEllipse(x - rx, y - ry, dx, dy, pFill, pGraphics, TWRectF.Create(boundingBox, False));
 
+                    {$ifdef ENABLE_SVG_RENDER_PROFILING}
+                        GetContext.Profiler.Stop(pElement, IE_PS_Fill, stageStart);
+                    {$endif}
+
                     pStroke := TWSmartPointer<TWStroke>.Create();
 
+                    {$ifdef ENABLE_SVG_RENDER_PROFILING}
+                        stageStart := GetContext.Profiler.Start;
+                    {$endif}
+
                     // outline the ellipse
                     if (GetPen(pProps.Style, viewBox, boundingBox, scaleW, scaleH, pRenderer, pStroke)) then
                         pRenderer.DrawEllipse(x - rx, y - ry, dx, dy, pStroke, pGraphics, TWRectF.Create(boundingBox, False));
+
+                    {$ifdef ENABLE_SVG_RENDER_PROFILING}
+                        GetContext.Profiler.Stop(pElement, IE_PS_Stroke, stageStart);
+                    {$endif}
                 end;
 
                 // restore the previous cliping before aspect ratio, if any
@@ -1790,8 +2571,7 @@ begin
                     end;
                 end;
 
-                pMatrix := TWSmartPointer<TGpMatrix>.Create();
-                pProps.Matrix.Value.ToGpMatrix(pMatrix);
+                pMatrix := TWSmartPointer<TGpMatrix>.Create(pProps.Matrix.Value.ToGpMatrix);
 
                 isAspectRatioClipped := False;
 
@@ -1812,12 +2592,30 @@ begin
                     ApplyMatrix(pMatrix, svgPos, scaleW, scaleH, pGraphics);
                 end;
 
+                // record the line geometry, if hit-testing
+                if ((not clippingMode) and IsHitRecording) then
+                begin
+                    pGraphicsPath := TWSmartPointer<TGpGraphicsPath>.Create(TGpGraphicsPath.Create);
+                    pGraphicsPath.AddLine(x1, y1, x2, y2);
+
+                    AddHitShape(pElement, pGraphicsPath, FillModeAlternate, pProps.Style,
+                            GetTransform(pGraphics), pGraphics);
+                end;
+
                 pStroke := TWSmartPointer<TWStroke>.Create();
 
+                {$ifdef ENABLE_SVG_RENDER_PROFILING}
+                    stageStart := GetContext.Profiler.Start;
+                {$endif}
+
                 // draw the line
                 if (GetPen(pProps.Style, viewBox, boundingBox, scaleW, scaleH, pRenderer, pStroke)) then
                     pRenderer.DrawLine(x1, y1, x2, y2, pStroke, pGraphics, TWRectF.Create(boundingBox, False));
 
+                {$ifdef ENABLE_SVG_RENDER_PROFILING}
+                    GetContext.Profiler.Stop(pElement, IE_PS_Stroke, stageStart);
+                {$endif}
+
                 // restore the previous cliping before aspect ratio, if any
                 if (isAspectRatioClipped) then
                     pGraphics.SetClip(pPrevAspectRatioRegion, CombineModeReplace);
@@ -1914,8 +2712,7 @@ begin
                     Inc(count);
                 end;
 
-                pMatrix := TWSmartPointer<TGpMatrix>.Create();
-                pProps.Matrix.Value.ToGpMatrix(pMatrix);
+                pMatrix := TWSmartPointer<TGpMatrix>.Create(pProps.Matrix.Value.ToGpMatrix);
 
                 isAspectRatioClipped := False;
 
@@ -1936,6 +2733,16 @@ begin
                     ApplyMatrix(pMatrix, svgPos, scaleW, scaleH, pGraphics);
                 end;
 
+                // record the polygon geometry, if hit-testing
+                if ((not clippingMode) and IsHitRecording) then
+                begin
+                    pGraphicsPath := TWSmartPointer<TGpGraphicsPath>.Create(TGpGraphicsPath.Create);
+                    pGraphicsPath.AddPolygon(PGPPointF(points), Length(points));
+
+                    AddHitShape(pElement, pGraphicsPath, GetFillMode(pParentProps, pProps), pProps.Style,
+                            GetTransform(pGraphics), pGraphics);
+                end;
+
                 // do apply a clipping path?
                 if (clippingMode) then
                 begin
@@ -1966,15 +2773,31 @@ begin
                 begin
                     pFill := TWSmartPointer<TWFill>.Create();
 
+                    {$ifdef ENABLE_SVG_RENDER_PROFILING}
+                        stageStart := GetContext.Profiler.Start;
+                    {$endif}
+
                     // draw the polygon
                     if (GetBrush(pProps.Style, viewBox, boundingBox, scaleW, scaleH, pRenderer, pFill)) then
                         pRenderer.FillPolygon(points, pFill, pGraphics, TWRectF.Create(boundingBox, False));
 
+                    {$ifdef ENABLE_SVG_RENDER_PROFILING}
+                        GetContext.Profiler.Stop(pElement, IE_PS_Fill, stageStart);
+                    {$endif}
+
                     pStroke := TWSmartPointer<TWStroke>.Create();
 
+                    {$ifdef ENABLE_SVG_RENDER_PROFILING}
+                        stageStart := GetContext.Profiler.Start;
+                    {$endif}
+
                     // outline the polygon
                     if (GetPen(pProps.Style, viewBox, boundingBox, scaleW, scaleH, pRenderer, pStroke)) then
                         pRenderer.DrawPolygon(points, pStroke, pGraphics, TWRectF.Create(boundingBox, False));
+
+                    {$ifdef ENABLE_SVG_RENDER_PROFILING}
+                        GetContext.Profiler.Stop(pElement, IE_PS_Stroke, stageStart);
+                    {$endif}
                 end;
 
                 // restore the previous cliping before aspect ratio, if any
@@ -2072,8 +2895,7 @@ begin
                     Inc(count);
                 end;
 
-                pMatrix := TWSmartPointer<TGpMatrix>.Create();
-                pProps.Matrix.Value.ToGpMatrix(pMatrix);
+                pMatrix := TWSmartPointer<TGpMatrix>.Create(pProps.Matrix.Value.ToGpMatrix);
 
                 isAspectRatioClipped := False;
 
@@ -2094,8 +2916,23 @@ begin
                     ApplyMatrix(pMatrix, svgPos, scaleW, scaleH, pGraphics);
                 end;
 
+                // record the lines geometry, if hit-testing. NOTE the figure is kept open, thus its
+                // outline doesn't join the last point to the first one, whereas its fill is closed
+                if ((not clippingMode) and IsHitRecording) then
+                begin
+                    pGraphicsPath := TWSmartPointer<TGpGraphicsPath>.Create(TGpGraphicsPath.Create);
+                    pGraphicsPath.AddLines(PGPPointF(points), Length(points));
+
+                    AddHitShape(pElement, pGraphicsPath, GetFillMode(pParentProps, pProps), pProps.Style,
+                            GetTransform(pGraphics), pGraphics);
+                end;
+
                 pFill := TWSmartPointer<TWFill>.Create();
 
+                {$ifdef ENABLE_SVG_RENDER_PROFILING}
+                    stageStart := GetContext.Profiler.Start;
+                {$endif}
+
                 // draw the lines
                 if (GetBrush(pProps.Style, viewBox, boundingBox, scaleW, scaleH, pRenderer, pFill)) then
                 begin
@@ -2116,12 +2953,24 @@ begin
                     pRenderer.FillPath(pPolylinePath, pFill, pGraphics, TWRectF.Create(boundingBox, False));
                 end;
 
+                {$ifdef ENABLE_SVG_RENDER_PROFILING}
+                    GetContext.Profiler.Stop(pElement, IE_PS_Fill, stageStart);
+                {$endif}
+
                 pStroke := TWSmartPointer<TWStroke>.Create();
 
+                {$ifdef ENABLE_SVG_RENDER_PROFILING}
+                    stageStart := GetContext.Profiler.Start;
+                {$endif}
+
                 // draw the lines
                 if (GetPen(pProps.Style, viewBox, boundingBox, scaleW, scaleH, pRenderer, pStroke)) then
                     pRenderer.DrawLines(points, pStroke, pGraphics, TWRectF.Create(boundingBox, False));
 
+                {$ifdef ENABLE_SVG_RENDER_PROFILING}
+                    GetContext.Profiler.Stop(pElement, IE_PS_Stroke, stageStart);
+                {$endif}
+
                 // restore the previous cliping before aspect ratio, if any
                 if (isAspectRatioClipped) then
                     pGraphics.SetClip(pPrevAspectRatioRegion, CombineModeReplace);
@@ -2203,8 +3052,7 @@ begin
                         pAspectRatioToUse := nil;
                 end;
 
-                pMatrix := TWSmartPointer<TGpMatrix>.Create();
-                pProps.Matrix.Value.ToGpMatrix(pMatrix);
+                pMatrix := TWSmartPointer<TGpMatrix>.Create(pProps.Matrix.Value.ToGpMatrix);
 
                 pGraphic             := nil;
                 pImageOptions        := nil;
@@ -2281,6 +3129,10 @@ begin
                         rect.Bottom := height;
                     end;
 
+                    // record the image box, if hit-testing
+                    if ((not clippingMode) and IsHitRecording) then
+                        AddHitRect(pElement, rect.ToGpRectF, 0.0, 0.0, nil, GetTransform(pGraphics), pGraphics);
+
                     // set the image options
                     pImageOptions             := TWRenderer.IImageOptions.Create;
                     pImageOptions.ResizeMode  := E_RzMode_BicubicHQ;
@@ -2288,8 +3140,16 @@ begin
                     pImageOptions.Transparent := (imageType = IE_IT_PNG) or (imageType = IE_IT_SVG);
                     pImageOptions.Vectorial   := (imageType = IE_IT_SVG);
 
+                    {$ifdef ENABLE_SVG_RENDER_PROFILING}
+                        stageStart := GetContext.Profiler.Start;
+                    {$endif}
+
                     // draw the image
                     pRenderer.DrawImage(pGraphic, imageRect, pGraphics, rect, pImageOptions);
+
+                    {$ifdef ENABLE_SVG_RENDER_PROFILING}
+                        GetContext.Profiler.Stop(pElement, IE_PS_Effect, stageStart);
+                    {$endif}
                 finally
                     if (Assigned(pImageOptions)) then
                         pImageOptions.Free;
@@ -2386,15 +3246,6 @@ begin
                 if (fontWeight >= 600) then
                     gdiFontStyle := gdiFontStyle + [fsBold];
 
-                // configure the font to use. NOTE be careful, the SVG font size matches with the
-                // GDI font HEIGHT property, and not with the font SIZE
-                pTextFont        :=  TWSmartPointer<TFont>.Create();
-                pTextFont.Name   :=  fontFamily;
-                pTextFont.Height := -Round(fontSize);
-                pTextFont.Style  :=  gdiFontStyle;
-                pFont            :=  TWSmartPointer<TGpFont>.Create(TGpFont.Create(pCanvas.Handle,
-                        pTextFont.Handle));
-
                 // char range is required to extract the first char bounds
                 charRange.First  := 0;
                 charRange.Length := 1;
@@ -2415,22 +3266,26 @@ begin
                     raise Exception.CreateFmt('Unknown text anchor value - %d', [Integer(anchor)]);
                 end;
 
-                pMatrix := TWSmartPointer<TGpMatrix>.Create();
-                pProps.Matrix.Value.ToGpMatrix(pMatrix);
+                pMatrix := TWSmartPointer<TGpMatrix>.Create(pProps.Matrix.Value.ToGpMatrix);
 
                 isAspectRatioClipped := False;
+                pTextLayout          := nil;
 
                 // should apply an aspect ratio onto the lines?
                 if (Assigned(pAspectRatio)) then
                 begin
-                    // measure the rect surrounding the text (before transformation)
-                    pGraphics.MeasureString(pText.Text, Length(pText.Text), pFont, viewBox,
-                            pTextFormat, boundingBox);
+                    // get the layout surrounding the text (measured before transformation)
+                    pTextLayout := GetTextLayout(pText.Text, fontFamily, fontSize, gdiFontStyle, anchor,
+                            viewBox, scaleW, scaleH, pTextFormat, pCanvas, pGraphics);
+
+                    // text could not be measured?
+                    if (not Assigned(pTextLayout)) then
+                        continue;
 
                     pPrevAspectRatioRegion := TWSmartPointer<TGpRegion>.Create();
 
                     // apply aspect ratio and get the previous clipping region, if any
-                    isAspectRatioClipped := ApplyAspectRatio(pAspectRatio, pProps, boundingBox,
+                    isAspectRatioClipped := ApplyAspectRatio(pAspectRatio, pProps, pTextLayout.BoundingBox,
                             pMatrix, pGraphics, pPrevAspectRatioRegion);
                 end
                 else
@@ -2439,143 +3294,46 @@ begin
                     svgPos := CalculateFinalPos(pos, viewBox, scaleW, scaleH);
 
                     ApplyMatrix(pMatrix, svgPos, scaleW, scaleH, pGraphics);
-                end;
-
-                // measure the rect surrounding the text
-                if (pGraphics.MeasureString(pText.Text, Length(pText.Text), pFont, viewBox,
-                        pTextFormat, boundingBox) <> Ok)
-                then
-                begin
-                    // todo FIXME -cFeature -oJean: find a better way for the font fallback
-                    fontFamilyLowerCase := LowerCase(fontFamily);
 
-                    // if the font family is a known unsupported font, map it to a supported one
-                    if (fontFamilyLowerCase = 'courier') then
-                    begin
-                        pTextFont.Name := 'Courier New';
-                        pFont          :=  TWSmartPointer<TGpFont>.Create(TGpFont.Create(pCanvas.Handle,
-                        pTextFont.Handle));
-                    end
-                    else
-                    begin
-                        TWLogHelper.LogToCompiler('Draw text - FAILED - font unsupported by GDI+ - name - '
-                                + fontFamily);
-                        continue;
-                    end;
+                    // get the layout surrounding the text
+                    pTextLayout := GetTextLayout(pText.Text, fontFamily, fontSize, gdiFontStyle, anchor,
+                            viewBox, scaleW, scaleH, pTextFormat, pCanvas, pGraphics);
 
-                    // and try again
-                    if (pGraphics.MeasureString(pText.Text, Length(pText.Text), pFont, viewBox,
-                            pTextFormat, boundingBox) <> Ok)
-                    then
-                    begin
-                        TWLogHelper.LogToCompiler('Draw text - FAILED - font unsupported by GDI+ - name - '
-                                + fontFamily);
+                    // text could not be measured?
+                    if (not Assigned(pTextLayout)) then
                         continue;
-                    end;
                 end;
 
-                pCanvas.Font.Assign(pTextFont);
-
-                // get text metrics. They will contain the required info about text height
-                if (not GetTextMetrics(pCanvas.Handle, textMetrics)) then
-                    continue;
+                boundingBox := pTextLayout.BoundingBox;
 
-                // apply the text anchoring
+                // calculate the real text position. This is required, because the GDI+ will draw the
+                // text from the left top corner of the bounding box, and will add an extra pad space
+                // before the first letter, whereas the SVG coordinates represent the text from its
+                // baseline, and starting immediately on the first letter, without padding
                 case (anchor) of
-                    IE_TA_Start:
-                    begin
-                        try
-                            // create and populate a region list to get the first char region
-                            SetLength(charRegions, 1);
-                            charRegions[0] := TGpRegion.Create;
-
-                            // measure the char ranges. In this case only the first char will be measured
-                            if (pGraphics.MeasureCharacterRanges(pText.Text, 1, pFont, boundingBox,
-                                    pTextFormat, 1, charRegions) <> Ok)
-                            then
-                                continue;
-
-                            // get first char bounding box
-                            charRegions[0].GetBounds(charRect, pGraphics);
-                        finally
-                            for i := 0 to Length(charRegions) - 1 do
-                                charRegions[i].Free;
-
-                            SetLength(charRegions, 0);
-                        end;
-
-                        // calculate the real text position. This is required, because the GDI+ will
-                        // draw the text from the left top corner of the bounding box, and will add
-                        // an extra pad space before the first letter, whereas the SVG coordinates
-                        // represent the text from its baseline, and starting immediately on the
-                        // first letter, without padding
-                        textPos.X := x - charRect.X;
-                        textPos.Y := y - textMetrics.tmAscent;
-
-                        // move the bounding box to correct location
-                        boundingBox.X := textPos.X;
-                        boundingBox.Y := textPos.Y;
-                    end;
-
-                    IE_TA_Middle:
-                    begin
-                        textPos.X := x - (boundingBox.Width / 2.0);
-                        textPos.Y := y - textMetrics.tmAscent;
-
-                        // move the bounding box to correct location
-                        boundingBox.X := textPos.X;
-                        boundingBox.Y := textPos.Y;
-                    end;
-
-                    IE_TA_End:
-                    begin
-                        try
-                            // create and populate a region list to get the first char region
-                            SetLength(charRegions, 1);
-                            charRegions[0] := TGpRegion.Create;
-
-                            // measure the char ranges. In this case only the first char will be measured
-                            if (pGraphics.MeasureCharacterRanges(pText.Text, 1, pFont, boundingBox,
-                                    pTextFormat, 1, charRegions) <> Ok)
-                            then
-                                continue;
-
-                            // get first char bounding box
-                            charRegions[0].GetBounds(charRect, pGraphics);
-                        finally
-                            for i := 0 to Length(charRegions) - 1 do
-                                charRegions[i].Free;
-
-                            SetLength(charRegions, 0);
-                        end;
-
-                        // calculate the real text position. This is required, because the GDI+ will
-                        // draw the text from the left top corner of the bounding box, and will add
-                        // an extra pad space before the first letter, whereas the SVG coordinates
-                        // represent the text from its baseline, and starting immediately on the
-                        // first letter, without padding
-                        textPos.X := x - charRect.X;
-                        textPos.Y := y - textMetrics.tmAscent;
-
-                        // move the bounding box to correct location
-                        boundingBox.X := textPos.X;
-                        boundingBox.Y := textPos.Y;
-                    end;
+                    IE_TA_Start,
+                    IE_TA_End:    textPos.X := x - pTextLayout.CharRect.X;
+                    IE_TA_Middle: textPos.X := x - (boundingBox.Width / 2.0);
                 else
                     raise Exception.CreateFmt('Unknown text anchor value - %d', [Integer(anchor)]);
                 end;
 
+                textPos.Y := y - pTextLayout.Ascent;
+
+                // move the bounding box to correct location
+                boundingBox.X := textPos.X;
+                boundingBox.Y := textPos.Y;
+
+                // record the text box, if hit-testing
+                if ((not clippingMode) and IsHitRecording) then
+                    AddHitRect(pElement, boundingBox, 0.0, 0.0, nil, GetTransform(pGraphics), pGraphics);
+
                 if (antialiasing) then
                     pGraphics.SetTextRenderingHint(TextRenderingHintAntiAlias);
 
                 // do apply a clipping path?
                 if (clippingMode) then
                 begin
-                    pFontFamily := TWSmartPointer<TGPFontFamily>.Create();
-
-                    // get the font family
-                    pFont.GetFamily(pFontFamily);
-
                     // create a path containing the text to clip. NOTE the size must be converted from
                     // point size to "em" size
                     pGraphicsPath := TWSmartPointer<TGpGraphicsPath>.Create(TGpGraphicsPath.Create);
@@ -2583,8 +3341,8 @@ begin
                     if (intersection) then
                         pGraphicsPath.SetFillMode(FillModeWinding);
 
-                    pGraphicsPath.AddString(pText.Text, Length(pText.Text), pFontFamily, pFont.GetStyle,
-                            fontSize, textPos, pTextFormat);
+                    pGraphicsPath.AddString(pText.Text, Length(pText.Text), pTextLayout.FontFamily,
+                            pTextLayout.Font.GetStyle, fontSize, textPos, pTextFormat);
 
                     // get the current region
                     pCurRegion := TWSmartPointer<TGpRegion>.Create(TGpRegion.Create);
@@ -2620,11 +3378,6 @@ begin
                         if (not g_GDIPlusCacheController.m_Pens) then
                             paPen := TWSmartPointer<TGpPen>.Create(pGpPen);
 
-                        pFontFamily := TWSmartPointer<TGPFontFamily>.Create();
-
-                        // get the font family
-                        pFont.GetFamily(pFontFamily);
-
                         // create new GDI+ path. NOTE create explicitly the graphics path before keep it
                         // inside the smart pointer, because otherwise the incorrect constructor is
                         // called while the smart pointer tries to auto-create the object, causing thus
@@ -2633,8 +3386,8 @@ begin
 
                         // create a path containing the text to outline. NOTE the size must be converted
                         // from point size to "em" size
-                        pTextPath.AddString(pText.Text, Length(pText.Text), pFontFamily, pFont.GetStyle,
-                                fontSize, textPos, pTextFormat);
+                        pTextPath.AddString(pText.Text, Length(pText.Text), pTextLayout.FontFamily,
+                                pTextLayout.Font.GetStyle, fontSize, textPos, pTextFormat);
 
                         // outline the text
                         pGraphics.DrawPath(pGpPen, pTextPath);
@@ -2642,10 +3395,18 @@ begin
 
                     pFill := TWSmartPointer<TWFill>.Create();
 
+                    {$ifdef ENABLE_SVG_RENDER_PROFILING}
+                        stageStart := GetContext.Profiler.Start;
+                    {$endif}
+
                     // draw the text
                     if (GetBrush(pProps.Style, viewBox, boundingBox, scaleW, scaleH, pRenderer, pFill)) then
-                        pRenderer.DrawString(pText.Text, textPos, pFont, pFill, pGraphics,
+                        pRenderer.DrawString(pText.Text, textPos, pTextLayout.Font, pFill, pGraphics,
                                 TWRectF.Create(boundingBox, True));
+
+                    {$ifdef ENABLE_SVG_RENDER_PROFILING}
+                        GetContext.Profiler.Stop(pElement, IE_PS_Fill, stageStart);
+                    {$endif}
                 end;
 
                 // restore the previous cliping before aspect ratio, if any
@@ -2663,31 +3424,180 @@ begin
                 continue;
             end;
         end;
+
+        finally
+            // NOTE the measured time also contains the children time, if any
+            {$ifdef ENABLE_SVG_RENDER_PROFILING}
+                GetContext.Profiler.Stop(pElement, IE_PS_Element, elementStart);
+            {$endif}
+
+            TWTraceHelper.Stop(pElement.ClassType, 'element', traceStart);
+        end;
     end;
 
     Result := True;
 end;
 //---------------------------------------------------------------------------
-function TWSVGGDIPlusRasterizer.ApplyClipPath(const pHeader: TWSVGParser.IHeader; const viewBox: TGpRectF;
-        const pParentProps: TWSVGGDIPlusRasterizer.IProperties; const pElements: TWSVGContainer.IElements;
-        const pos: TPoint; scaleW, scaleH: Single; antialiasing, switchMode, clippingMode, useMode: Boolean;
-        const animation: TWSVGRasterizer.IAnimation; pAspectRatio: IAspectRatio; pCanvas: TCanvas;
-        pGraphics: TGpGraphics; pElement: TWSVGElement; prevRegion: TGpRegion): Boolean;
+function TWSVGGDIPlusRasterizer.GetTextLayout(const text, fontFamily: UnicodeString; fontSize: Single;
+        fontStyle: TFontStyles; anchor: IETextAnchor; const viewBox: TGpRectF; scaleW, scaleH: Single;
+        pTextFormat: TGpStringFormat; pCanvas: TCanvas; pGraphics: TGpGraphics): ITextLayout;
 var
-    pClipPath:             TWSVGClipPath;
-    pProps:                IWSmartPointer<IProperties>;
-    pAnimationData:        IWSmartPointer<IAnimationData>;
-    clipPathPos:           TPoint;
-    x, y, width, height:   Single;
-    elementViewBox:        TWRectF;
-    pIntersectionClipPath: TWSVGClipPath;
-    intersect, clipResult: Boolean;
+    pContext:    IGDIPlusRenderContext;
+    pTextFont:   IWSmartPointer<TFont>;
+    pLayout:     ITextLayout;
+    charRegions: array of TGpRegion;
+    textMetrics: TEXTMETRIC;
+    key:         UnicodeString;
+    i:           NativeInt;
 begin
-    pClipPath := nil;
+    // the contexts are always created by this rasterizer, thus they are always GDI+ contexts
+    pContext := IGDIPlusRenderContext(GetContext);
+
+    // build the layout key. The font is created from the canvas device context, whose resolution
+    // changes its measures, so the resolution is part of the key. NOTE the text is added at the end,
+    // because it may contain any char
+    key := Format('%d:%s|%d|%d|%d|%d|%g|%g|%g|%g|%g|%g|',
+            [Length(fontFamily), fontFamily, GetDeviceCaps(pCanvas.Handle, LOGPIXELSY), Round(fontSize),
+             Byte(fontStyle), Integer(anchor), viewBox.X, viewBox.Y, viewBox.Width, viewBox.Height, scaleW,
+             scaleH], g_InternationalFormatSettings) + text;
+
+    // search for an already measured layout
+    if (pContext.m_pTextLayouts.TryGetValue(key, Result)) then
+    begin
+        pContext.m_pTextLayoutsCount.Hit := pContext.m_pTextLayoutsCount.Hit + 1;
+        Exit;
+    end;
 
-    if (not GetClipPath(pElement, pClipPath)) then
+    pContext.m_pTextLayoutsCount.Miss := pContext.m_pTextLayoutsCount.Miss + 1;
+
+    TWTraceHelper.Instant('Text layout cache miss', 'cache');
+
+    pLayout := ITextLayout.Create;
+
+    try
+        // configure the font to use. NOTE be careful, the SVG font size matches with the GDI font
+        // HEIGHT property, and not with the font SIZE
+        pTextFont         :=  TWSmartPointer<TFont>.Create();
+        pTextFont.Name    :=  fontFamily;
+        pTextFont.Height  := -Round(fontSize);
+        pTextFont.Style   :=  fontStyle;
+        pLayout.m_pFont   :=  TGpFont.Create(pCanvas.Handle, pTextFont.Handle);
+
+        // measure the rect surrounding the text
+        if (pGraphics.MeasureString(text, Length(text), pLayout.m_pFont, viewBox, pTextFormat,
+                pLayout.m_BoundingBox) <> Ok)
+        then
+        begin
+            // todo FIXME -cFeature -oJean: find a better way for the font fallback
+            // if the font family is a known unsupported font, map it to a supported one
+            if (LowerCase(fontFamily) = 'courier') then
+            begin
+                pTextFont.Name := 'Courier New';
+
+                FreeAndNil(pLayout.m_pFont);
+                pLayout.m_pFont := TGpFont.Create(pCanvas.Handle, pTextFont.Handle);
+            end
+            else
+            begin
+                TWLogHelper.LogToCompiler('Draw text - FAILED - font unsupported by GDI+ - name - '
+                        + fontFamily);
+                Exit(nil);
+            end;
+
+            // and try again
+            if (pGraphics.MeasureString(text, Length(text), pLayout.m_pFont, viewBox, pTextFormat,
+                    pLayout.m_BoundingBox) <> Ok)
+            then
+            begin
+                TWLogHelper.LogToCompiler('Draw text - FAILED - font unsupported by GDI+ - name - '
+                        + fontFamily);
+                Exit(nil);
+            end;
+        end;
+
+        pCanvas.Font.Assign(pTextFont);
+
+        // get text metrics. They will contain the required info about text height
+        if (not GetTextMetrics(pCanvas.Handle, textMetrics)) then
+            Exit(nil);
+
+        pLayout.m_Ascent := textMetrics.tmAscent;
+
+        // the first char bounds are required to remove the pad GDI+ adds before the first letter
+        if ((anchor = IE_TA_Start) or (anchor = IE_TA_End)) then
+            try
+                // create and populate a region list to get the first char region
+                SetLength(charRegions, 1);
+                charRegions[0] := TGpRegion.Create;
+
+                // measure the char ranges. In this case only the first char will be measured
+                if (pGraphics.MeasureCharacterRanges(text, 1, pLayout.m_pFont, pLayout.m_BoundingBox,
+                        pTextFormat, 1, charRegions) <> Ok)
+                then
+                    Exit(nil);
+
+                // get first char bounding box
+                charRegions[0].GetBounds(pLayout.m_CharRect, pGraphics);
+            finally
+                for i := 0 to Length(charRegions) - 1 do
+                    charRegions[i].Free;
+
+                SetLength(charRegions, 0);
+            end;
+
+        // get the font family, required to convert the text to path
+        pLayout.m_pFontFamily := TGpFontFamily.Create;
+        pLayout.m_pFont.GetFamily(pLayout.m_pFontFamily);
+
+        // cache is full? Delete the oldest layouts
+        while ((pContext.m_pFIFOTextLayoutList.Count > 0)
+                and (NativeUInt(pContext.m_pFIFOTextLayoutList.Count) >= m_MaxCachedTextLayouts))
+        do
+        begin
+            pContext.m_pTextLayouts.Remove(pContext.m_pFIFOTextLayoutList[0]);
+            pContext.m_pFIFOTextLayoutList.Delete(0);
+        end;
+
+        // add the new layout to cache
+        pContext.m_pTextLayouts.Add(key, pLayout);
+        pContext.m_pFIFOTextLayoutList.Add(key);
+
+        Result  := pLayout;
+        pLayout := nil;
+    finally
+        pLayout.Free;
+    end;
+end;
+//---------------------------------------------------------------------------
+function TWSVGGDIPlusRasterizer.ApplyClipPath(const pHeader: TWSVGParser.IHeader; const viewBox: TGpRectF;
+        const pParentProps: TWSVGGDIPlusRasterizer.IProperties; const pElements: TWSVGContainer.IElements;
+        const pos: TPoint; scaleW, scaleH: Single; antialiasing, switchMode, clippingMode, useMode: Boolean;
+        const animation: TWSVGRasterizer.IAnimation; pAspectRatio: IAspectRatio; pCanvas: TCanvas;
+        pGraphics: TGpGraphics; pElement: TWSVGElement; prevRegion: TGpRegion): Boolean;
+var
+    pClipPath:             TWSVGClipPath;
+    pProps:                IWSmartPointer<IProperties>;
+    pAnimationData:        IWSmartPointer<IAnimationData>;
+    clipPathPos:           TPoint;
+    x, y, width, height:   Single;
+    elementViewBox:        TWRectF;
+    pIntersectionClipPath: TWSVGClipPath;
+    intersect, clipResult: Boolean;
+    {$ifdef ENABLE_SVG_RENDER_PROFILING}
+        startTime:         Int64;
+    {$endif}
+begin
+    pClipPath := nil;
+
+    if (not GetClipPath(pElement, pClipPath)) then
         Exit(False);
 
+    {$ifdef ENABLE_SVG_RENDER_PROFILING}
+        startTime := GetContext.Profiler.Start;
+
+        try
+    {$endif}
+
     pIntersectionClipPath := nil;
     intersect             := False;
     clipResult            := True;
@@ -2788,6 +3698,12 @@ begin
     Result := DrawElements(pHeader, viewBox, pProps, pClipPath.ElementList, clipPathPos, scaleW,
             scaleH, antialiasing, False, True, useMode, intersect, animation, pAspectRatio, pCanvas,
             pGraphics) and clipResult;
+
+    {$ifdef ENABLE_SVG_RENDER_PROFILING}
+        finally
+            GetContext.Profiler.Stop(pElement, IE_PS_Clipping, startTime);
+        end;
+    {$endif}
 end;
 //---------------------------------------------------------------------------
 function TWSVGGDIPlusRasterizer.PopulateAspectRatio(pos: TPoint; width, height, scaleW, scaleH: Single;
@@ -3527,6 +4443,224 @@ begin
     pGraphics.SetTransform(pTransformMatrix);
 end;
 //---------------------------------------------------------------------------
+function TWSVGGDIPlusRasterizer.IsTooSmall(const bounds: TGpRectF; strokeWidth: Single;
+        const matrix: TWMatrix2x3): Boolean;
+var
+    pContext:                 TWSVGRasterizer.IRenderContext;
+    localBounds, transformed: TWRectF;
+    deviceBounds:             TRect;
+begin
+    // are all elements drawn, whatever their size, and is there nothing to measure?
+    if (not NeedsDeviceBounds) then
+        Exit(False);
+
+    // get the element bounds, including the stroke
+    localBounds := TWRectF.Create(bounds.X - (strokeWidth * 0.5), bounds.Y - (strokeWidth * 0.5),
+            bounds.X + bounds.Width + (strokeWidth * 0.5), bounds.Y + bounds.Height + (strokeWidth * 0.5));
+
+    // transform the bounds to device coordinates
+    transformed := matrix.TransformRect(localBounds);
+
+    // get the bounds of the touched pixels, with a margin for the antialiasing
+    deviceBounds := TRect.Create(Floor(transformed.Left) - 1, Floor(transformed.Top) - 1,
+            Ceil(transformed.Right) + 1, Ceil(transformed.Bottom) + 1);
+
+    AddDirtyBounds(deviceBounds);
+
+    pContext := GetContext;
+
+    // measuring only?
+    if (pContext.MeasureOnly) then
+        Exit(True);
+
+    // element is outside the clip rect?
+    if (not pContext.ClipRect.IsEmpty and not pContext.ClipRect.IntersectsWith(deviceBounds)) then
+        Exit(True);
+
+    // are all elements drawn, whatever their size?
+    if (m_MinElementSize <= 0.0) then
+        Exit(False);
+
+    Result := ((transformed.Width < m_MinElementSize) and (transformed.Height < m_MinElementSize));
+end;
+//---------------------------------------------------------------------------
+function TWSVGGDIPlusRasterizer.IsTooSmall(const bounds: TGpRectF; strokeWidth: Single;
+        pGraphics: TGpGraphics): Boolean;
+var
+    pMatrix: IWSmartPointer<TGpMatrix>;
+begin
+    // are all elements drawn, whatever their size, and is there nothing to measure?
+    if (not NeedsDeviceBounds) then
+        Exit(False);
+
+    pMatrix := TWSmartPointer<TGpMatrix>.Create();
+
+    // get the matrix currently applied to the graphics
+    if (pGraphics.GetTransform(pMatrix) <> Ok) then
+        Exit(False);
+
+    Result := IsTooSmall(bounds, strokeWidth, TWMatrix2x3.Create(pMatrix));
+end;
+//---------------------------------------------------------------------------
+function TWSVGGDIPlusRasterizer.IsTooSmall(const pPath: TGpGraphicsPath; const pStroke: TWSVGRasterizer.IStroke;
+        pGraphics: TGpGraphics): Boolean;
+var
+    pPen:   IWSmartPointer<TGpPen>;
+    bounds: TGpRectF;
+begin
+    // are all elements drawn, whatever their size, and is there nothing to measure?
+    if (not NeedsDeviceBounds) then
+        Exit(False);
+
+    // no stroke?
+    if (pStroke.Width.Value <= 0.0) then
+    begin
+        // measure the path in local coordinates
+        if (pPath.GetBounds(bounds) <> Ok) then
+            Exit(False);
+
+        Exit(IsTooSmall(bounds, 0.0, pGraphics));
+    end;
+
+    // create a pen to measure the stroke with. The color is not important, but the width, the caps
+    // and the joins are. NOTE create explicitly the pen before keep it inside the smart pointer,
+    // otherwise the incorrect constructor is called
+    pPen := TWSmartPointer<TGpPen>.Create(TGpPen.Create(MakeColor(255, 0, 0, 0), pStroke.Width.Value));
+
+    case (pStroke.LineCap.Value) of
+        TWSVGStroke.IELineCap.IE_LC_Round:  pPen.SetLineCap(LineCapRound,  LineCapRound,  DashCapRound);
+        TWSVGStroke.IELineCap.IE_LC_Square: pPen.SetLineCap(LineCapSquare, LineCapSquare, DashCapFlat);
+    end;
+
+    case (pStroke.LineJoin.Value) of
+        TWSVGStroke.IELineJoin.IE_LJ_Round: pPen.SetLineJoin(LineJoinRound);
+        TWSVGStroke.IELineJoin.IE_LJ_Bevel: pPen.SetLineJoin(LineJoinBevel);
+    else
+        pPen.SetLineJoin(LineJoinMiter);
+    end;
+
+    // measure the path in local coordinates, including the whole stroke
+    if (pPath.GetBounds(bounds, nil, pPen) <> Ok) then
+        Exit(False);
+
+    Result := IsTooSmall(bounds, 0.0, pGraphics);
+end;
+//---------------------------------------------------------------------------
+function TWSVGGDIPlusRasterizer.NeedsDeviceBounds: Boolean;
+var
+    pContext: TWSVGRasterizer.IRenderContext;
+begin
+    pContext := GetContext;
+    Result   := ((m_MinElementSize > 0.0) or pContext.ElemAnimated or pContext.MeasureOnly
+            or not pContext.ClipRect.IsEmpty);
+end;
+//---------------------------------------------------------------------------
+function TWSVGGDIPlusRasterizer.IsMeasureSkipped(pElement: TWSVGElement): Boolean;
+var
+    pContext: TWSVGRasterizer.IRenderContext;
+begin
+    pContext := GetContext;
+
+    // NOTE the hit index is also built in measure only mode, but it requires all the elements
+    if (not pContext.MeasureOnly or IsHitRecording) then
+        Exit(False);
+
+    // only the shapes may be skipped
+    if (not (pElement is TWSVGShape) or (pElement is TWSVGUse)) then
+        Exit(False);
+
+    // the shape is animated if it owns animations, and if the animations are enabled, as when its
+    // animations are read
+    Result := (not IsAnimationEnabled or (TWSVGShape(pElement).AnimationCount = 0));
+end;
+//---------------------------------------------------------------------------
+function TWSVGGDIPlusRasterizer.GetRenderer: TWRenderer_GDIPlus;
+var
+    pContext: IGDIPlusRenderContext;
+begin
+    pContext := IGDIPlusRenderContext(GetContext);
+
+    // drawing with an explicit context? Use its own renderer, because the renderer caches aren't
+    // thread safe and the explicit contexts may be used concurrently
+    if (pContext <> DefaultContext) then
+    begin
+        if (not Assigned(pContext.m_pRenderer)) then
+            pContext.m_pRenderer := TWRenderer_GDIPlus.Create;
+
+        Exit(pContext.m_pRenderer);
+    end;
+
+    if (Assigned(m_pPrivateRenderer)) then
+        Exit(m_pPrivateRenderer);
+
+    Result := TWControlRenderer.GetGDIPlusRenderer;
+end;
+//---------------------------------------------------------------------------
+function TWSVGGDIPlusRasterizer.GetPrivateRenderer: Boolean;
+begin
+    Result := Assigned(m_pPrivateRenderer);
+end;
+//---------------------------------------------------------------------------
+procedure TWSVGGDIPlusRasterizer.SetPrivateRenderer(value: Boolean);
+begin
+    // nothing to change?
+    if (value = Assigned(m_pPrivateRenderer)) then
+        Exit;
+
+    if (value) then
+        m_pPrivateRenderer := TWRenderer_GDIPlus.Create
+    else
+        FreeAndNil(m_pPrivateRenderer);
+end;
+//---------------------------------------------------------------------------
+procedure TWSVGGDIPlusRasterizer.FlattenPath(pPath: TGpGraphicsPath; pGraphics: TGpGraphics);
+var
+    pMatrix:     IWSmartPointer<TGpMatrix>;
+    elements:    TMatrixArray;
+    deviceScale: Single;
+begin
+    // in full quality GDI+ already flattens the curves on the device
+    if (m_Quality <> IE_RQ_Draft) then
+        Exit;
+
+    pMatrix := TWSmartPointer<TGpMatrix>.Create();
+
+    // get the matrix currently applied to the graphics
+    if (pGraphics.GetTransform(pMatrix) <> Ok) then
+        Exit;
+
+    if (pMatrix.GetElements(elements) <> Ok) then
+        Exit;
+
+    // the device scale is the square root of the matrix determinant
+    deviceScale := Sqrt(Abs((elements[0] * elements[3]) - (elements[1] * elements[2])));
+
+    if (deviceScale = 0.0) then
+        Exit;
+
+    // flatten the curves, converting the draft tolerance from device pixels to local units
+    pPath.Flatten(nil, C_SVG_Draft_Flatness / deviceScale);
+end;
+//---------------------------------------------------------------------------
+function TWSVGGDIPlusRasterizer.ConfigureQuality(antialiasing: Boolean; pGraphics: TGpGraphics): Boolean;
+begin
+    // draft quality, favor the speed over the quality
+    if (m_Quality = IE_RQ_Draft) then
+    begin
+        pGraphics.SetSmoothingMode(SmoothingModeHighSpeed);
+        pGraphics.SetPixelOffsetMode(PixelOffsetModeHighSpeed);
+        pGraphics.SetCompositingQuality(CompositingQualityHighSpeed);
+        pGraphics.SetTextRenderingHint(TextRenderingHintSingleBitPerPixelGridFit);
+        Exit(False);
+    end;
+
+    // enable antialiasing, if needed
+    if (antialiasing) then
+        pGraphics.SetSmoothingMode(SmoothingModeAntiAlias);
+
+    Result := antialiasing;
+end;
+//---------------------------------------------------------------------------
 procedure TWSVGGDIPlusRasterizer.UpdateBoundingBox(const point: TGpPointF; var boundingBox: TGpRectF);
 begin
     // update bounding box
@@ -3551,6 +4685,206 @@ begin
         boundingBox.Height := point.Y;
 end;
 //---------------------------------------------------------------------------
+function TWSVGGDIPlusRasterizer.GetTransform(pGraphics: TGpGraphics): TWMatrix2x3;
+var
+    pMatrix: IWSmartPointer<TGpMatrix>;
+begin
+    pMatrix := TWSmartPointer<TGpMatrix>.Create();
+
+    if (pGraphics.GetTransform(pMatrix) <> Ok) then
+        Exit(TWMatrix2x3.GetDefault);
+
+    Result := TWMatrix2x3.Create(pMatrix);
+end;
+//---------------------------------------------------------------------------
+function TWSVGGDIPlusRasterizer.IsHitRecording: Boolean;
+var
+    pContext: IGDIPlusRenderContext;
+begin
+    pContext := IGDIPlusRenderContext(GetContext);
+    Result   := Assigned(pContext.m_pHitIndex) and pContext.m_pHitIndex.m_Recording;
+end;
+//---------------------------------------------------------------------------
+procedure TWSVGGDIPlusRasterizer.AddHitShape(pElement: TWSVGElement; const pPath: TGpGraphicsPath;
+        fillMode: TFillMode; const pStyle: TWSVGRasterizer.IStyle; const matrix: TWMatrix2x3;
+        pGraphics: TGpGraphics);
+var
+    pContext:    IGDIPlusRenderContext;
+    pShape:      IHitShape;
+    pMatrix:     IWSmartPointer<TGpMatrix>;
+    localBounds: TGpRectF;
+    transformed: TWRectF;
+begin
+    pContext := IGDIPlusRenderContext(GetContext);
+
+    // the clones drawn from an use instruction are deleted after the draw, record the use instead
+    if (Assigned(pContext.m_pHitUse)) then
+        pElement := pContext.m_pHitUse;
+
+    pShape := IHitShape.Create;
+
+    try
+        pShape.m_pElement := pElement;
+        pShape.m_pPath    := pPath.Clone;
+        pShape.m_pPath.SetFillMode(fillMode);
+
+        // no style? (e.g. image or text) In this case the shape is hit everywhere in its box
+        if (Assigned(pStyle)) then
+        begin
+            pShape.m_Filled := not pStyle.Fill.NoFill.Value;
+
+            // is stroked? Create a pen matching with the drawn one
+            if ((not pStyle.Stroke.NoStroke.Value) and (pStyle.Stroke.Width.Value > 0.0)) then
+            begin
+                pShape.m_pPen := TGpPen.Create(aclBlack, pStyle.Stroke.Width.Value);
+
+                case (pStyle.Stroke.LineCap.Value) of
+                    TWSVGStroke.IELineCap.IE_LC_Round:  pShape.m_pPen.SetLineCap(LineCapRound,  LineCapRound,  DashCapRound);
+                    TWSVGStroke.IELineCap.IE_LC_Square: pShape.m_pPen.SetLineCap(LineCapSquare, LineCapSquare, DashCapFlat);
+                end;
+
+                case (pStyle.Stroke.LineJoin.Value) of
+                    TWSVGStroke.IELineJoin.IE_LJ_Round: pShape.m_pPen.SetLineJoin(LineJoinRound);
+                    TWSVGStroke.IELineJoin.IE_LJ_Bevel: pShape.m_pPen.SetLineJoin(LineJoinBevel);
+                end;
+            end;
+        end
+        else
+            pShape.m_Filled := True;
+
+        // nothing is painted?
+        if ((not pShape.m_Filled) and (not Assigned(pShape.m_pPen))) then
+            Exit;
+
+        // the tested points will be converted to local coordinates. If the matrix cannot be
+        // inverted, the shape is flat and cannot be hit
+        if (not matrix.Invert(pShape.m_Inverse)) then
+            Exit;
+
+        // measure the shape bounds, including the stroke, and transform them to device coordinates
+        pShape.m_pPath.GetBounds(localBounds, nil, pShape.m_pPen);
+
+        transformed := matrix.TransformRect(TWRectF.Create(localBounds.X, localBounds.Y,
+                localBounds.X + localBounds.Width, localBounds.Y + localBounds.Height));
+
+        pShape.m_Bounds := TRect.Create(Floor(transformed.Left) - 1, Floor(transformed.Top) - 1,
+                Ceil(transformed.Right) + 1, Ceil(transformed.Bottom) + 1);
+
+        pMatrix := TWSmartPointer<TGpMatrix>.Create();
+
+        // get the current clip region in device coordinates, i.e. without the graphics matrix
+        pGraphics.GetTransform(pMatrix);
+        pGraphics.ResetTransform;
+
+        pShape.m_pClip := TGpRegion.Create;
+        pGraphics.GetClip(pShape.m_pClip);
+
+        pGraphics.SetTransform(pMatrix);
+
+        // not clipped?
+        if (pShape.m_pClip.IsInfinite(pGraphics)) then
+            FreeAndNil(pShape.m_pClip);
+
+        pContext.m_pHitIndex.m_pShapes.Add(pShape);
+        pShape := nil;
+    finally
+        pShape.Free;
+    end;
+end;
+//---------------------------------------------------------------------------
+procedure TWSVGGDIPlusRasterizer.AddHitRect(pElement: TWSVGElement; const rect: TGpRectF; rx, ry: Single;
+        const pStyle: TWSVGRasterizer.IStyle; const matrix: TWMatrix2x3; pGraphics: TGpGraphics);
+var
+    pPath:  IWSmartPointer<TGpGraphicsPath>;
+    dx, dy: Single;
+begin
+    pPath := TWSmartPointer<TGpGraphicsPath>.Create(TGpGraphicsPath.Create);
+
+    // is a rounded rectangle?
+    if ((rx > 0.0) and (ry > 0.0)) then
+    begin
+        dx := Min(rx, rect.Width  * 0.5) * 2.0;
+        dy := Min(ry, rect.Height * 0.5) * 2.0;
+
+        pPath.AddArc(rect.X,                     rect.Y,                      dx, dy, 180.0, 90.0);
+        pPath.AddArc(rect.X + rect.Width - dx,   rect.Y,                      dx, dy, 270.0, 90.0);
+        pPath.AddArc(rect.X + rect.Width - dx,   rect.Y + rect.Height - dy,   dx, dy,   0.0, 90.0);
+        pPath.AddArc(rect.X,                     rect.Y + rect.Height - dy,   dx, dy,  90.0, 90.0);
+        pPath.CloseFigure;
+    end
+    else
+        pPath.AddRectangle(rect);
+
+    AddHitShape(pElement, pPath, FillModeAlternate, pStyle, matrix, pGraphics);
+end;
+//---------------------------------------------------------------------------
+function TWSVGGDIPlusRasterizer.BuildHitIndex(const pSVG: TWSVG; const rect: TRect; proportional: Boolean;
+        const animation: TWSVGRasterizer.IAnimation; const key: UnicodeString): Boolean;
+var
+    pContext:     IGDIPlusRenderContext;
+    pBitmap:      TGpBitmap;
+    pGraphics:    TGpGraphics;
+    pCanvas:      TCanvas;
+    hMemDC:       HDC;
+    lastDrawTime: Double;
+    measureOnly:  Boolean;
+    traceStart:   Int64;
+begin
+    pContext := IGDIPlusRenderContext(GetContext);
+
+    FreeAndNil(pContext.m_pHitIndex);
+
+    pBitmap      := nil;
+    pGraphics    := nil;
+    pCanvas      := nil;
+    hMemDC       := 0;
+    lastDrawTime := pContext.LastDrawTime;
+    measureOnly  := pContext.MeasureOnly;
+    traceStart   := TWTraceHelper.Start;
+    Result       := False;
+
+    pContext.m_pHitIndex := IHitIndex.Create(key);
+
+    try
+        // the measured elements are recorded instead of drawn, thus a single pixel is enough to
+        // draw the few ones which cannot be measured
+        pBitmap   := TGpBitmap.Create(1, 1, PixelFormat32bppPARGB);
+        pGraphics := TGpGraphics.Create(pBitmap);
+
+        // the texts are measured on a memory device context, on which nothing is drawn
+        hMemDC := CreateCompatibleDC(0);
+
+        if (hMemDC = 0) then
+            Exit(False);
+
+        pCanvas        := TCanvas.Create;
+        pCanvas.Handle := hMemDC;
+
+        pContext.MeasureOnly := True;
+
+        Result := DrawToGraphics(pSVG, rect, proportional, False, animation, pCanvas, pGraphics);
+    finally
+        // the hit index build is not a draw, restore the draw state
+        pContext.MeasureOnly  := measureOnly;
+        pContext.LastDrawTime := lastDrawTime;
+
+        if (Result) then
+            pContext.m_pHitIndex.Build
+        else
+            FreeAndNil(pContext.m_pHitIndex);
+
+        pCanvas.Free;
+
+        if (hMemDC <> 0) then
+            DeleteDC(hMemDC);
+
+        pGraphics.Free;
+        pBitmap.Free;
+
+        TWTraceHelper.Stop('Hit index build', 'svg', traceStart);
+    end;
+end;
+//---------------------------------------------------------------------------
 {$ifdef TRIAL_BUILD}
     // apply trial time watermark function
     procedure TWSVGGDIPlusRasterizer.PrepareRenderer(const rect: TWRectF; const pos: TPoint;
@@ -3610,7 +4944,7 @@ end;
             Exit;
 
         // get GDI+ renderer
-        pRenderer := TWControlRenderer.GetGDIPlusRenderer;
+        pRenderer := GetRenderer;
 
         // found it?
         if (not Assigned(pRenderer)) then
@@ -3705,6 +5039,116 @@ end;
     end;
 {$endif}
 //---------------------------------------------------------------------------
+function TWSVGGDIPlusRasterizer.DrawToGraphics(const pSVG: TWSVG; const pos: TPoint; scale: Single;
+        antialiasing: Boolean; const animation: TWSVGRasterizer.IAnimation; pCanvas: TCanvas;
+        pGraphics: TGpGraphics): Boolean;
+var
+    stopwatch:  TStopwatch;
+    useAA:      Boolean;
+    traceStart: Int64;
+begin
+    stopwatch  := TStopwatch.StartNew;
+    traceStart := TWTraceHelper.Start;
+
+    try
+        Initialize(pSVG);
+        BeginDirtyRect;
+
+        // configure the render quality
+        useAA := ConfigureQuality(antialiasing, pGraphics);
+
+        // draw all elements contained in SVG
+        Result := DrawElements(pSVG.Parser.ElementList, pos, scale, scale, useAA, False, animation,
+                pCanvas, pGraphics);
+    finally
+        EndDirtyRect;
+        GetContext.LastDrawTime := stopwatch.Elapsed.TotalMilliseconds;
+        TWTraceHelper.Stop('Draw', 'svg', traceStart);
+    end;
+end;
+//---------------------------------------------------------------------------
+function TWSVGGDIPlusRasterizer.DrawToGraphics(const pSVG: TWSVG; const rect: TRect; proportional,
+        antialiasing: Boolean; const animation: TWSVGRasterizer.IAnimation; pCanvas: TCanvas;
+        pGraphics: TGpGraphics): Boolean;
+var
+    pos:                                       TPoint;
+    sourceSize:                                TSize;
+    square, drawRect:                          TRect;
+    scale, width, srcWidth, height, srcHeight: Single;
+    stopwatch:                                 TStopwatch;
+    useAA:                                     Boolean;
+    traceStart:                                Int64;
+begin
+    stopwatch  := TStopwatch.StartNew;
+    traceStart := TWTraceHelper.Start;
+
+    try
+        Initialize(pSVG);
+        BeginDirtyRect;
+
+        // configure the render quality
+        useAA := ConfigureQuality(antialiasing, pGraphics);
+
+        // get source size
+        sourceSize := GetSize(pSVG);
+
+        // is size valid?
+        if ((sourceSize.Width = 0) or (sourceSize.Height = 0)) then
+        begin
+            // calculate svg position
+            pos := TPoint.Create(rect.Left, rect.Top);
+
+            // cannot determine the size, so draw the svg without size calculation
+            Exit(DrawToGraphics(pSVG, pos, 1.0, antialiasing, animation, pCanvas, pGraphics));
+        end;
+
+        // do keep image proportional?
+        if (proportional) then
+        begin
+            // get closest square contained inside rect
+            square := GetClosestSquare(rect);
+
+            drawRect.Left   := 0;
+            drawRect.Top    := 0;
+            drawRect.Right  := square.Width;
+            drawRect.Bottom := square.Height;
+
+            // calculate the proportional size to draw the complete svg inside the draw rect
+            TWImageHelper.GetProportionalSize(sourceSize.Width, sourceSize.Height, drawRect.Right,
+                    drawRect.Bottom, True);
+
+            // calculate svg position
+            pos.Create(rect.Left + ((rect.Width - drawRect.Width) div 2), rect.Top
+                    + ((rect.Height - drawRect.Height) div 2));
+
+            // calculate scale factor
+            width    := drawRect.Width;
+            srcWidth := sourceSize.Width;
+            scale    := (width / srcWidth);
+
+            // draw svg inside draw rectangle
+            Exit(DrawElements(pSVG.Parser.ElementList, pos, scale, scale, useAA, False, animation,
+                    pCanvas, pGraphics));
+        end;
+
+        // calculate svg position
+        pos := TPoint.Create(rect.Left, rect.Top);
+
+        width     := rect.Width;
+        srcWidth  := sourceSize.Width;
+        height    := rect.Height;
+        srcHeight := sourceSize.Height;
+
+        // draw svg inside draw rectangle
+        Result := DrawElements(pSVG.Parser.ElementList, pos, (width / srcWidth), (height / srcHeight),
+                useAA, False, animation, pCanvas, pGraphics);
+    finally
+        EndDirtyRect;
+        GetContext.LastDrawTime := stopwatch.Elapsed.TotalMilliseconds;
+        TWTraceHelper.Stop('Draw', 'svg', traceStart);
+    end;
+end;
+//---------------------------------------------------------------------------
 function TWSVGGDIPlusRasterizer.Draw(const pSVG: TWSVG; const pos: TPoint; scale: Single; antialiasing: Boolean;
         const animation: TWSVGRasterizer.IAnimation; pCanvas: TCustomCanvas): Boolean;
 var
@@ -3732,26 +5176,14 @@ begin
     if (not Assigned(pGraphics)) then
         Exit(False);
 
-    Initialize(pSVG);
-
-    // enable antialiasing, if needed
-    if (antialiasing) then
-        pGraphics.SetSmoothingMode(SmoothingModeAntiAlias);
-
-    // draw all elements contained in SVG
-    Result := DrawElements(pSVG.Parser.ElementList, pos, scale, scale, antialiasing, False,
-            animation, pGDICanvas, pGraphics);
+    Result := DrawToGraphics(pSVG, pos, scale, antialiasing, animation, pGDICanvas, pGraphics);
 end;
 //---------------------------------------------------------------------------
 function TWSVGGDIPlusRasterizer.Draw(const pSVG: TWSVG; const rect: TRect; proportional, antialiasing: Boolean;
         const animation: TWSVGRasterizer.IAnimation; pCanvas: TCustomCanvas): Boolean;
 var
-    pGDICanvas:                                TCanvas;
-    pGraphics:                                 IWSmartPointer<TGpGraphics>;
-    pos:                                       TPoint;
-    sourceSize:                                TSize;
-    square, drawRect:                          TRect;
-    scale, width, srcWidth, height, srcHeight: Single;
+    pGDICanvas: TCanvas;
+    pGraphics:  IWSmartPointer<TGpGraphics>;
 begin
     // is GDI+ initialized?
     if (m_GDIPlusToken = 0) then
@@ -3774,65 +5206,196 @@ begin
     if (not Assigned(pGraphics)) then
         Exit(False);
 
-    Initialize(pSVG);
+    Result := DrawToGraphics(pSVG, rect, proportional, antialiasing, animation, pGDICanvas, pGraphics);
+end;
+//---------------------------------------------------------------------------
+function TWSVGGDIPlusRasterizer.DrawToBuffer(const pSVG: TWSVG; const rect: TRect; proportional,
+        antialiasing: Boolean; const animation: TWSVGRasterizer.IAnimation;
+        const buffer: TWSVGRasterizer.IRenderBuffer; const subRect: TRect): Boolean;
+var
+    pBitmap:     TGpBitmap;
+    pGraphics:   TGpGraphics;
+    pCanvas:     TCanvas;
+    hMemDC:      HDC;
+    area:        TRect;
+    drawRect:    TRect;
+    pBits:       PByte;
+    pixelFormat: Integer;
+    swapped:     Boolean;
+begin
+    // is GDI+ initialized?
+    if (m_GDIPlusToken = 0) then
+        Exit(False);
+
+    // is buffer valid?
+    if (not Assigned(buffer.m_pBits) or (buffer.m_Width <= 0) or (buffer.m_Height <= 0)
+            or (Abs(buffer.m_Stride) < (buffer.m_Width * 4)))
+    then
+    begin
+        TWLogHelper.LogToCompiler('Draw to buffer - FAILED - invalid buffer');
+        Exit(False);
+    end;
 
-    // enable antialiasing, if needed
-    if (antialiasing) then
-        pGraphics.SetSmoothingMode(SmoothingModeAntiAlias);
+    // get the buffer area to draw
+    area := TRect.Create(0, 0, buffer.m_Width, buffer.m_Height);
+
+    if (not subRect.IsEmpty and not IntersectRect(area, area, subRect)) then
+        Exit(True);
+
+    // point to the first pixel of the area. As the GDI+ bitmap is built above the area, the pixels
+    // outside it are never touched
+    pBits := PByte(buffer.m_pBits) + (NativeInt(area.Top) * buffer.m_Stride) + (area.Left * 4);
+
+    // GDI+ has no RGBA format, the straight pixels are drawn as BGRA and swapped in place
+    if (buffer.m_PixelFormat = IE_PF_PremultipliedBGRA) then
+        pixelFormat := PixelFormat32bppPARGB
+    else
+        pixelFormat := PixelFormat32bppARGB;
+
+    // the draw rect is expressed in buffer coordinates, move it in the area coordinates
+    drawRect := rect;
+    OffsetRect(drawRect, -area.Left, -area.Top);
+
+    pBitmap   := nil;
+    pGraphics := nil;
+    pCanvas   := nil;
+    hMemDC    := 0;
+    swapped   := False;
+
+    try
+        // build a GDI+ bitmap using the buffer memory as pixels, thus nothing is copied
+        pBitmap := TGpBitmap.Create(area.Width, area.Height, buffer.m_Stride, pixelFormat, pBits);
+
+        if (pBitmap.GetLastStatus <> Ok) then
+        begin
+            TWLogHelper.LogToCompiler('Draw to buffer - FAILED - could not create the GDI+ bitmap');
+            Exit(False);
+        end;
+
+        if (buffer.m_PixelFormat = IE_PF_StraightRGBA) then
+        begin
+            SwapRedAndBlue(pBits, area.Width, area.Height, buffer.m_Stride);
+            swapped := True;
+        end;
 
-    // get source size
-    sourceSize := GetSize(pSVG);
+        pGraphics := TGpGraphics.Create(pBitmap);
 
-    // is size valid?
-    if ((sourceSize.Width = 0) or (sourceSize.Height = 0)) then
+        // the texts are measured on a memory device context, on which nothing is drawn
+        hMemDC := CreateCompatibleDC(0);
+
+        if (hMemDC = 0) then
+            Exit(False);
+
+        pCanvas        := TCanvas.Create;
+        pCanvas.Handle := hMemDC;
+
+        Result := DrawToGraphics(pSVG, drawRect, proportional, antialiasing, animation, pCanvas, pGraphics);
+    finally
+        pCanvas.Free;
+
+        if (hMemDC <> 0) then
+            DeleteDC(hMemDC);
+
+        // deleting the graphics flushes the pending operations in the buffer
+        pGraphics.Free;
+        pBitmap.Free;
+
+        if (swapped) then
+            SwapRedAndBlue(pBits, area.Width, area.Height, buffer.m_Stride);
+    end;
+end;
+//---------------------------------------------------------------------------
+procedure TWSVGGDIPlusRasterizer.SwapRedAndBlue(pBits: PByte; width, height, stride: Integer);
+var
+    pPixel: PByte;
+    x, y:   Integer;
+    value:  Byte;
+begin
+    for y := 0 to height - 1 do
     begin
-        // calculate svg position
-        pos := TPoint.Create(rect.Left, rect.Top);
+        pPixel := pBits + (NativeInt(y) * stride);
 
-        // cannot determine the size, so draw the svg without size calculation
-        Exit(Draw(pSVG, pos, 1.0, antialiasing, animation, pCanvas));
+        for x := 0 to width - 1 do
+        begin
+            value     := pPixel[0];
+            pPixel[0] := pPixel[2];
+            pPixel[2] := value;
+            Inc(pPixel, 4);
+        end;
     end;
+end;
+//---------------------------------------------------------------------------
+procedure TWSVGGDIPlusRasterizer.GetCacheCounters(pCounters: TList<TWCacheHit>);
+var
+    pRenderer: TWRenderer_GDIPlus;
+begin
+    inherited GetCacheCounters(pCounters);
 
-    // do keep image proportional?
-    if (proportional) then
-    begin
-        // get closest square contained inside rect
-        square := GetClosestSquare(rect);
+    if (not Assigned(pCounters)) then
+        Exit;
 
-        drawRect.Left   := 0;
-        drawRect.Top    := 0;
-        drawRect.Right  := square.Width;
-        drawRect.Bottom := square.Height;
+    if (Assigned(IGDIPlusRenderContext(DefaultContext).m_pTextLayoutsCount)) then
+        pCounters.Add(IGDIPlusRenderContext(DefaultContext).m_pTextLayoutsCount);
 
-        // calculate the proportional size to draw the complete svg inside the draw rect
-        TWImageHelper.GetProportionalSize(sourceSize.Width, sourceSize.Height, drawRect.Right,
-                drawRect.Bottom, True);
+    // get GDI+ renderer
+    pRenderer := GetRenderer;
 
-        // calculate svg position
-        pos.Create(rect.Left + ((rect.Width - drawRect.Width) div 2), rect.Top
-                + ((rect.Height - drawRect.Height) div 2));
+    if (Assigned(pRenderer)) then
+        pRenderer.GetCacheCounters(pCounters);
+end;
+//---------------------------------------------------------------------------
+function TWSVGGDIPlusRasterizer.CreateContext: TWSVGRasterizer.IRenderContext;
+begin
+    Result := IGDIPlusRenderContext.Create(Self);
+end;
+//---------------------------------------------------------------------------
+function TWSVGGDIPlusRasterizer.HitTest(const pSVG: TWSVG; const rect: TRect; proportional: Boolean;
+        const animation: TWSVGRasterizer.IAnimation; const point: TPoint;
+        pAncestors: TList<TWSVGElement>): TWSVGElement;
+var
+    pContext: IGDIPlusRenderContext;
+    pShape:   IHitShape;
+    pItem:    TWSVGItem;
+    key:      UnicodeString;
+begin
+    if (Assigned(pAncestors)) then
+        pAncestors.Clear;
 
-        // calculate scale factor
-        width    := drawRect.Width;
-        srcWidth := sourceSize.Width;
-        scale    := (width / srcWidth);
+    // is GDI+ initialized?
+    if ((m_GDIPlusToken = 0) or (not Assigned(pSVG))) then
+        Exit(nil);
 
-        // draw svg inside draw rectangle
-        Exit(DrawElements(pSVG.Parser.ElementList, pos, scale, scale, antialiasing, False, animation,
-                pGDICanvas, pGraphics));
-    end;
+    pContext := IGDIPlusRenderContext(GetContext);
+
+    // the hit index remains valid while the same document frame is drawn at the same location
+    key := Format('%p|%s|%d|%d|%d|%d|%d|%g', [Pointer(pSVG), pSVG.UUID, rect.Left, rect.Top,
+            rect.Right, rect.Bottom, Ord(proportional), animation.m_Position]);
+
+    if ((not Assigned(pContext.m_pHitIndex)) or (pContext.m_pHitIndex.m_Key <> key)) then
+        if (not BuildHitIndex(pSVG, rect, proportional, animation, key)) then
+            Exit(nil);
+
+    pShape := pContext.m_pHitIndex.HitTest(point);
+
+    // nothing was hit?
+    if (not Assigned(pShape)) then
+        Exit(nil);
 
-    // calculate svg position
-    pos := TPoint.Create(rect.Left, rect.Top);
+    Result := pShape.m_pElement;
 
-    width     := rect.Width;
-    srcWidth  := sourceSize.Width;
-    height    := rect.Height;
-    srcHeight := sourceSize.Height;
+    if (not Assigned(pAncestors)) then
+        Exit;
+
+    pItem := Result.Parent;
 
-    // draw svg inside draw rectangle
-    Result := DrawElements(pSVG.Parser.ElementList, pos, (width / srcWidth), (height / srcHeight),
-            antialiasing, False, animation, pGDICanvas, pGraphics);
+    // populate the ancestors, from the parent to the root
+    while (Assigned(pItem)) do
+    begin
+        if (pItem is TWSVGElement) then
+            pAncestors.Add(pItem as TWSVGElement);
+
+        pItem := pItem.Parent;
+    end;
 end;
 //---------------------------------------------------------------------------
 
@@ -191,6 +191,12 @@ type
             }
             function GetGradientStopCount: NativeUInt; virtual;
 
+            {**
+             Write the gradient stops as xml
+             @param(pWriter Xml writer to write to)
+            }
+            procedure WriteXmlContent(pWriter: TWSVGXmlWriter); override;
+
         public
             {**
              Constructor
@@ -357,6 +363,8 @@ implementation
 constructor TWSVGGradientStop.Create(pParent: TWSVGItem; pOptions: PWSVGOptions);
 begin
     inherited Create(pParent, pOptions);
+
+    ItemName := C_SVG_Tag_Gradient_Stop;
 end;
 //---------------------------------------------------------------------------
 destructor TWSVGGradientStop.Destroy;
@@ -510,7 +518,7 @@ end;
 //---------------------------------------------------------------------------
 function TWSVGGradient.IGradientSpreadMethod.ToXml: UnicodeString;
 begin
-    Result := ItemName + '=\"' + ToStr(m_Method) + '\"';
+    Result := ItemName + '="' + ToStr(m_Method) + '"';
 end;
 //---------------------------------------------------------------------------
 class function TWSVGGradient.IGradientSpreadMethod.ToStr(method: IEGradientSpreadMethod): UnicodeString;
@@ -555,6 +563,17 @@ begin
     Result := m_pGradientStops.Count;
 end;
 //---------------------------------------------------------------------------
+procedure TWSVGGradient.WriteXmlContent(pWriter: TWSVGXmlWriter);
+var
+    pGradientStop: TWSVGGradientStop;
+begin
+    inherited WriteXmlContent(pWriter);
+
+    // iterate through gradient stops to write
+    for pGradientStop in m_pGradientStops do
+        pGradientStop.WriteXml(pWriter);
+end;
+//---------------------------------------------------------------------------
 procedure TWSVGGradient.DelAndClear;
 begin
     // clear all gradient stops. NOTE as a TObjectList is used, the list will take care of freeing
@@ -13,10 +13,13 @@ uses System.Classes,
      System.SysUtils,
      System.StrUtils,
      System.Math,
+     System.SyncObjs,
+     System.Generics.Collections,
      Vcl.Graphics,
      Vcl.Imaging.jpeg,
      Vcl.Imaging.PngImage,
      Vcl.Clipbrd,
+     Vcl.ExtCtrls,
      Winapi.Windows,
      UTWMajorSettings,
      UTWColor,
@@ -39,6 +42,12 @@ const
     C_TWSVGGraphic_Default_Antialiasing  = True;
     C_TWSVGGraphic_Default_Animate       = False;
     C_TWSVGGraphic_Default_FramePosition = 0.0;
+    C_TWSVGGraphic_Interaction_Delay     = 250; // in milliseconds
+    C_TWSVGGraphic_Frame_Cache_Frames    = 100; // frames per animation cycle, see RunAnimation()
+    C_TWSVGGraphic_Frame_Cache_Budget    = 8;   // in milliseconds, spent per draw to fill the frame cache
+    C_TWSVGGraphic_Default_FrameCache    = False;
+    C_TWSVGGraphic_Default_Frame_Limit   = 32 * 1024 * 1024; // in bytes
+    C_TWSVGGlyphCache_Max_Glyphs         = 256;
     //---------------------------------------------------------------------------
 
 type
@@ -89,16 +98,501 @@ type
             ITfSVGAnimateEvent = function (pSender: TObject; pAnimDesc: TWSVGAnimationDescriptor;
                     pCustomData: Pointer): Boolean of object;
 
+            {**
+             Called when a SVG loaded asynchronously is ready, or could not be loaded
+             @param(pSender Event sender)
+             @param(success If @true, the SVG was loaded and is now shown, otherwise the previous
+                            SVG is kept)
+            }
+            ITfLoadedEvent = procedure (pSender: TObject; success: Boolean) of object;
+
+        private type
+            {**
+             Cache containing the pre-rendered frames of a looping animation, for a given size and
+             drawing options. Frames are kept as raw premultiplied pixels, or optionally as deltas
+             against the previous frame, so a looping animation may be played back by blitting
+             @br @bold(NOTE) The frames are kept in memory instead of bitmaps to avoid to consume
+                             one GDI handle per frame. They are added in order, a few on each draw,
+                             and the cache may only be played back once complete
+            }
+            IFrameCache = class
+                private type
+                    IPixels = array of Cardinal;
+                    IFrames = array of IPixels;
+
+                private
+                    m_Frames:       IFrames;
+                    m_Pixels:       IPixels;
+                    m_pBitmap:      Vcl.Graphics.TBitmap;
+                    m_Width:        Integer;
+                    m_Height:       Integer;
+                    m_Count:        Integer;
+                    m_Added:        Integer;
+                    m_DecodedIndex: Integer;
+                    m_BitmapIndex:  Integer;
+                    m_Size:         NativeUInt;
+                    m_Limit:        NativeUInt;
+                    m_Proportional: Boolean;
+                    m_Antialiasing: Boolean;
+                    m_Compressed:   Boolean;
+                    m_Rejected:     Boolean;
+
+                    {**
+                     Read the pixels of a bitmap
+                     @param(pBitmap Bitmap to read from)
+                     @param(pixels @bold([out]) Pixels read from bitmap)
+                    }
+                    procedure ReadPixels(pBitmap: Vcl.Graphics.TBitmap; out pixels: IPixels);
+
+                    {**
+                     Write pixels to the display bitmap
+                     @param(pixels Pixels to write)
+                    }
+                    procedure WritePixels(const pixels: IPixels);
+
+                    {**
+                     Encode a frame as a list of changed runs against the previous frame
+                     @param(previous Previous frame pixels)
+                     @param(current Current frame pixels)
+                     @returns(Encoded delta, as a [offset, count, pixels...] run list)
+                    }
+                    function Encode(const previous, current: IPixels): IPixels;
+
+                    {**
+                     Apply an encoded delta to pixels
+                     @param(delta Encoded delta to apply)
+                     @param(pixels @bold([in, out]) Pixels to update)
+                    }
+                    procedure Decode(const delta: IPixels; var pixels: IPixels);
+
+                    {**
+                     Reject the cache and release the frames
+                    }
+                    procedure Reject;
+
+                public
+                    {**
+                     Constructor
+                     @param(width Frame width)
+                     @param(height Frame height)
+                     @param(proportional Whether the frames are drawn proportionally)
+                     @param(antialiasing Whether the frames are drawn with antialiasing)
+                     @param(compressed If @true, the frames are stored as deltas against the previous frame)
+                     @param(limit Memory limit, in bytes)
+                    }
+                    constructor Create(width, height: Integer; proportional, antialiasing, compressed: Boolean;
+                            limit: NativeUInt); virtual;
+
+                    {**
+                     Destructor
+                    }
+                    destructor Destroy; override;
+
+                    {**
+                     Add the next frame
+                     @param(pBitmap Bitmap containing the frame, should match with the cache size)
+                     @returns(@true on success, otherwise @false)
+                     @br @bold(NOTE) The cache is rejected if the memory limit is exceeded
+                    }
+                    function Add(pBitmap: Vcl.Graphics.TBitmap): Boolean; virtual;
+
+                    {**
+                     Draw a frame
+                     @param(index Frame index)
+                     @param(pCanvas Canvas to draw on)
+                     @param(x Draw x position)
+                     @param(y Draw y position)
+                     @returns(@true on success, otherwise @false)
+                    }
+                    function Draw(index: Integer; pCanvas: TCanvas; x, y: Integer): Boolean; virtual;
+
+                    {**
+                     Check if the cache matches with a size and drawing options
+                     @param(width Frame width)
+                     @param(height Frame height)
+                     @param(proportional Whether the frames are drawn proportionally)
+                     @param(antialiasing Whether the frames are drawn with antialiasing)
+                     @returns(@true if the cache matches, otherwise @false)
+                    }
+                    function Matches(width, height: Integer; proportional, antialiasing: Boolean): Boolean; virtual;
+
+                public
+                    {**
+                     Get the frame count
+                    }
+                    property Count: Integer read m_Count;
+
+                    {**
+                     Get the memory used by the frames, in bytes
+                    }
+                    property Size: NativeUInt read m_Size;
+
+                    {**
+                     Get if the cache was rejected
+                    }
+                    property Rejected: Boolean read m_Rejected;
+
+                    {**
+                     Get the count of frames already added
+                    }
+                    property Added: Integer read m_Added;
+
+                    {**
+                     Get the bitmap on which the frames are played back. While the cache is
+                     incomplete, the next frame to add may be rendered on it
+                    }
+                    property Bitmap: Vcl.Graphics.TBitmap read m_pBitmap;
+            end;
+
+            {**
+             Buffer containing the last drawn animation frame, which is partially redrawn with the
+             regions changed since then
+            }
+            IBackBuffer = class
+                public
+                    m_pBitmap:       Vcl.Graphics.TBitmap;
+                    m_pScratch:      Vcl.Graphics.TBitmap;
+                    m_AnimatedRect:  TRect;
+                    m_PendingRect:   TRect;
+                    m_Width:         Integer;
+                    m_Height:        Integer;
+                    m_Position:      Double;
+                    m_PendingPos:    Double;
+                    m_NextChange:    Double;
+                    m_Proportional:  Boolean;
+                    m_Antialiasing:  Boolean;
+                    m_AnimatedAll:   Boolean;
+                    m_PendingValid:  Boolean;
+                    m_Valid:         Boolean;
+
+                    {**
+                     Constructor
+                     @param(width Buffer width)
+                     @param(height Buffer height)
+                     @param(proportional Whether the frame is drawn proportionally)
+                     @param(antialiasing Whether the frame is drawn with antialiasing)
+                    }
+                    constructor Create(width, height: Integer; proportional, antialiasing: Boolean); virtual;
+
+                    {**
+                     Destructor
+                    }
+                    destructor Destroy; override;
+
+                    {**
+                     Keep the state of the frame just drawn in the buffer
+                     @param(position Frame position)
+                     @param(pRasterizer Rasterizer used to draw the frame)
+                    }
+                    procedure Update(position: Double; pRasterizer: TWSVGRasterizer); virtual;
+
+                    {**
+                     Draw the buffer content
+                     @param(pCanvas Canvas to draw on)
+                     @param(x Draw x position)
+                     @param(y Draw y position)
+                     @returns(@true on success, otherwise @false)
+                    }
+                    function Draw(pCanvas: TCanvas; x, y: Integer): Boolean; virtual;
+
+                    {**
+                     Check if the buffer matches with a size and drawing options
+                     @param(width Buffer width)
+                     @param(height Buffer height)
+                     @param(proportional Whether the frame is drawn proportionally)
+                     @param(antialiasing Whether the frame is drawn with antialiasing)
+                     @returns(@true if the buffer matches, otherwise @false)
+                    }
+                    function Matches(width, height: Integer; proportional, antialiasing: Boolean): Boolean; virtual;
+            end;
+
+            {**
+             Graphic drawing a svg embedded as image in another svg rasterized by a worker thread.
+             Unlike TWSVGGraphic, it is never attached to the animation timer, and it uses its own
+             rasterizer and GDI+ renderer, thus it may be created and drawn outside the main thread
+             @br @bold(NOTE) The embedded svg is drawn at its first frame, as a nested TWSVGGraphic
+            }
+            IEmbeddedGraphic = class(TGraphic)
+                private
+                    m_pSVG:        TWSVG;
+                    m_pRasterizer: TWSVGGDIPlusRasterizer;
+                    m_Width:       Integer;
+                    m_Height:      Integer;
+
+                protected
+                    {**
+                     Draw the embedded svg
+                     @param(pCanvas Canvas to draw on)
+                     @param(rect Rect in which the svg should be drawn)
+                    }
+                    procedure Draw(pCanvas: TCanvas; const rect: TRect); override;
+
+                    {**
+                     Get if the graphic is empty
+                     @returns(@true if the graphic is empty, otherwise @false)
+                    }
+                    function GetEmpty: Boolean; override;
+
+                    {**
+                     Get the graphic width
+                     @returns(Width in pixels)
+                    }
+                    function GetWidth: Integer; override;
+
+                    {**
+                     Get the graphic height
+                     @returns(Height in pixels)
+                    }
+                    function GetHeight: Integer; override;
+
+                    {**
+                     Set the graphic width
+                     @param(value Width in pixels)
+                    }
+                    procedure SetWidth(value: Integer); override;
+
+                    {**
+                     Set the graphic height
+                     @param(value Height in pixels)
+                    }
+                    procedure SetHeight(value: Integer); override;
+
+                public
+                    {**
+                     Constructor
+                    }
+                    constructor Create; override;
+
+                    {**
+                     Destructor
+                    }
+                    destructor Destroy; override;
+
+                    {**
+                     Load the embedded svg from stream
+                     @param(pStream Stream to load from)
+                    }
+                    procedure LoadFromStream(pStream: TStream); override;
+
+                    {**
+                     Save the graphic to stream, not supported
+                     @param(pStream Stream to save to)
+                    }
+                    procedure SaveToStream(pStream: TStream); override;
+
+                    {**
+                     Load the graphic from clipboard, not supported
+                     @param(format Clipboard format)
+                     @param(data Clipboard data)
+                     @param(hPalette Palette)
+                    }
+                    procedure LoadFromClipboardFormat(format: Word; data: THandle; hPalette: HPALETTE); override;
+
+                    {**
+                     Save the graphic to clipboard, not supported
+                     @param(format @bold([out]) Clipboard format)
+                     @param(data @bold([out]) Clipboard data)
+                     @param(hPalette @bold([out]) Palette)
+                    }
+                    procedure SaveToClipboardFormat(var format: Word; var data: THandle; var hPalette: HPALETTE); override;
+
+                    {**
+                     Load an image embedded in a svg rasterized by a worker thread. Unlike
+                     TWSVGGraphic.DoGetImage(), the embedded svg images are loaded as IEmbeddedGraphic,
+                     thus this function is thread safe
+                     @param(pSender Event sender)
+                     @param(pStream Stream containing the image to read)
+                     @param(imageType The image type)
+                     @param(pGraphic The read image graphic)
+                     @returns(@true on success, otherwise @false)
+                    }
+                    class function GetImage(pSender: TObject; pStream: TMemoryStream;
+                            imageType: TWSVGRasterizer.IEImageType; var pGraphic: TGraphic): Boolean;
+            end;
+
+            {**
+             Worker thread rasterizing the next animation frame in a back buffer, while the main
+             thread presents the latest completed frame. Only the latest requested frame is kept,
+             the frames requested while the worker is busy are dropped
+             @br @bold(NOTE) The worker uses its own rasterizer and GDI+ renderer, and rasterizes its
+                             own copy of the SVG document, thus the main thread may draw or modify
+                             the graphic document meanwhile
+            }
+            IRenderThread = class(TThread)
+                private
+                    m_pSVG:              TWSVG;
+                    m_pRasterizer:       TWSVGGDIPlusRasterizer;
+                    m_pLock:             TCriticalSection;
+                    m_pSignal:           TEvent;
+                    m_pFrontBuffer:      Vcl.Graphics.TBitmap;
+                    m_pBackBuffer:       Vcl.Graphics.TBitmap;
+                    m_pCustomData:       Pointer;
+                    m_RequestPos:        Double;
+                    m_RequestTime:       Double;
+                    m_FramePos:          Double;
+                    m_FrameTime:         Double;
+                    m_NextChange:        Double;
+                    m_Width:             Integer;
+                    m_Height:            Integer;
+                    m_FrameWidth:        Integer;
+                    m_FrameHeight:       Integer;
+                    m_DroppedFrames:     Cardinal;
+                    m_Proportional:      Boolean;
+                    m_Antialiasing:      Boolean;
+                    m_FrameProportional: Boolean;
+                    m_FrameAntialiasing: Boolean;
+                    m_Requested:         Boolean;
+                    m_Rendered:          Boolean;
+                    m_fOnFrameReady:     TNotifyEvent;
+
+                    {**
+                     Get the dropped frame count
+                     @returns(Dropped frame count)
+                    }
+                    function GetDroppedFrames: Cardinal;
+
+                protected
+                    {**
+                     Thread main loop
+                    }
+                    procedure Execute; override;
+
+                public
+                    {**
+                     Constructor
+                     @param(pSVG SVG document to rasterize, copied before the worker starts)
+                     @param(fOnFrameReady Callback to call in the main thread when a frame is completed)
+                     @br @bold(NOTE) The worker never calls the graphic callbacks, the embedded images
+                                     are loaded by IEmbeddedGraphic.GetImage()
+                    }
+                    constructor Create(pSVG: TWSVG; fOnFrameReady: TNotifyEvent); reintroduce;
+
+                    {**
+                     Destructor
+                    }
+                    destructor Destroy; override;
+
+                    {**
+                     Request a frame to be rendered, for the size and options of the last presentation
+                     @param(position Frame position)
+                     @param(time Request time in milliseconds, as measured by the animation clock)
+                     @param(pCustomData Custom data to pass to the animation)
+                     @br @bold(NOTE) A previous request which was still not started is dropped
+                    }
+                    procedure Request(position, time: Double; pCustomData: Pointer);
+
+                    {**
+                     Draw the latest completed frame
+                     @param(pCanvas Canvas to draw on)
+                     @param(rect Draw rect)
+                     @param(proportional Whether the frame should be drawn proportionally)
+                     @param(antialiasing Whether the frame should be drawn with antialiasing)
+                     @param(position @bold([out]) Position of the drawn frame)
+                     @param(time @bold([out]) Request time of the drawn frame)
+                     @param(nextChange @bold([out]) Position from which the drawn frame changes)
+                     @returns(@true on success, @false if no completed frame matches with the rect
+                              and options)
+                     @br @bold(NOTE) The rect size and the options are kept for the next requests
+                    }
+                    function Present(pCanvas: TCanvas; const rect: TRect; proportional, antialiasing: Boolean;
+                            out position, time, nextChange: Double): Boolean;
+
+                public
+                    {**
+                     Get the number of frames dropped because the rendering fell behind
+                    }
+                    property DroppedFrames: Cardinal read GetDroppedFrames;
+            end;
+
+            {**
+             Worker thread reading and parsing a SVG document, then rasterizing its first frame, while
+             the main thread keeps showing the previous document. The result is only taken by the
+             main thread once the worker completed
+             @br @bold(NOTE) The worker uses its own document and rasterizer. The cancellation is
+                             cooperative, it is checked between the read, parse and rasterize steps,
+                             as the parser itself cannot be interrupted
+            }
+            ILoadThread = class(TThread)
+                private
+                    m_pSource:      TMemoryStream;
+                    m_pSVG:         TWSVG;
+                    m_pRasterizer:  TWSVGGDIPlusRasterizer;
+                    m_pFrame:       IBackBuffer;
+                    m_FileName:     TFileName;
+                    m_Data:         UnicodeString;
+                    m_DataHash:     Integer;
+                    m_Size:         TSize;
+                    m_Width:        Integer;
+                    m_Height:       Integer;
+                    m_Proportional: Boolean;
+                    m_Success:      Boolean;
+                    m_fOnLoaded:    TNotifyEvent;
+                    m_fOnEnded:     TNotifyEvent;
+
+                    {**
+                     Read and parse the document, then rasterize its first frame
+                     @returns(@true on success, otherwise @false)
+                    }
+                    function Load: Boolean;
+
+                protected
+                    {**
+                     Thread main function
+                    }
+                    procedure Execute; override;
+
+                public
+                    {**
+                     Constructor
+                     @param(pSource Stream to load from, ignored if a file name is defined)
+                     @param(fileName File to load from, if empty the document is loaded from the stream)
+                     @param(width Width of the first frame, if 0 the document width is used)
+                     @param(height Height of the first frame, if 0 the document height is used)
+                     @param(proportional If @true, the first frame keeps the document proportions)
+                     @param(fOnLoaded Callback to call in the main thread when the load is completed)
+                     @param(fOnEnded Callback to call in the main thread when the worker ended, even if
+                                     the load was cancelled, the worker may be released from it)
+                     @br @bold(NOTE) The stream content is copied, so the caller may release it. The
+                                     embedded images are loaded by IEmbeddedGraphic.GetImage()
+                    }
+                    constructor Create(pSource: TStream; const fileName: TFileName; width, height: Integer;
+                            proportional: Boolean; fOnLoaded, fOnEnded: TNotifyEvent); reintroduce;
+
+                    {**
+                     Destructor
+                     @br @bold(NOTE) The destructor waits until the worker ends, which may take some
+                                     time if a document is being parsed. The callbacks are no longer
+                                     called once the destructor is reached
+                    }
+                    destructor Destroy; override;
+            end;
+
+            ILoadThreads = TObjectList<ILoadThread>;
+
         private
             m_pSVG:                     TWSVG;
             m_pSVGRasterizer:           TWSVGGDIPlusRasterizer;
             m_pFrameCalculator:         TWSVGFrameCalculator;
+            m_pFrameCache:              IFrameCache;
+            m_pBackBuffer:              IBackBuffer;
+            m_pRenderThread:            IRenderThread;
+            m_pLoadThread:              ILoadThread;
+            m_pRetiredLoads:            ILoadThreads;
+            m_pLoadedFrame:             IBackBuffer;
+            m_pInteractionTimer:        TTimer;
+            m_FrameCacheLimit:          NativeUInt;
+            m_FrameRate:                Cardinal;
             m_hClipboardFormat:         THandle;
             m_hInkscapeClipboardFormat: THandle;
             m_Data:                     UnicodeString;
+            m_DataHash:                 Integer;
             m_Width:                    Integer;
             m_Height:                   Integer;
             m_FramePos:                 Double;
+            m_DrawnPos:                 Double;
+            m_NextChange:               Double;
+            m_PresentedTime:            Double;
+            m_FrameLatency:             Double;
             m_AnimSpeed:                Double;
             m_PerformedAnimLoops:       Cardinal;
             m_AnimLoopCount:            Cardinal;
@@ -110,11 +604,20 @@ type
             m_ForceOriginalSave:        Boolean;
             m_Opened:                   Boolean;
             m_OnError:                  Boolean;
+            m_Interacting:              Boolean;
+            m_Visible:                  Boolean;
+            m_SkipStaticFrames:         Boolean;
+            m_FrameCache:               Boolean;
+            m_FrameCacheCompressed:     Boolean;
+            m_PartialRedraw:            Boolean;
+            m_AsyncRendering:           Boolean;
+            m_FrameChanging:            Boolean;
             m_pCustomData:              Pointer;
             m_fOnAnimate:               ITfSVGAnimateEvent;
             m_fOnAnimationBegin:        TNotifyEvent;
             m_fOnAnimationEnd:          TNotifyEvent;
             m_fOnAnimationLoop:         TNotifyEvent;
+            m_fOnLoaded:                ITfLoadedEvent;
 
             {**
              Get the library version
@@ -129,6 +632,108 @@ type
             }
             procedure WriteRawDataToStream(data: UnicodeString; pStream: TStream);
 
+            {**
+             Render the next frames of the animation cycle in the frame cache, until the time budget
+             of the draw is exhausted
+             @param(frameWidth Frame width)
+             @param(frameHeight Frame height)
+             @returns(@true if the cache is complete and may be played back, otherwise @false)
+             @br @bold(NOTE) The cache is created again if the size or the drawing options changed.
+                             The animation should be drawn as usual until the cache is complete
+            }
+            function FillFrameCache(frameWidth, frameHeight: Integer): Boolean;
+
+            {**
+             Get the memory used by the frame cache
+             @returns(Memory used by the frame cache, in bytes)
+            }
+            function GetFrameCacheSize: NativeUInt;
+
+            {**
+             Draw the current animation frame in the back buffer, by redrawing only the regions
+             changed since the last frame, then draw the back buffer on the canvas
+             @param(pCanvas Canvas to draw on)
+             @param(rect Draw rect)
+            }
+            procedure DrawPartial(pCanvas: TCanvas; const rect: TRect);
+
+            {**
+             Set if the animation frames are partially redrawn
+             @param(value If @true, the frames are partially redrawn)
+            }
+            procedure SetPartialRedraw(value: Boolean);
+
+            {**
+             Draw the latest animation frame completed by the render thread, and request the next one
+             @param(pCanvas Canvas to draw on)
+             @param(rect Draw rect)
+             @returns(@true on success, @false if no completed frame matches with the draw rect)
+            }
+            function DrawAsync(pCanvas: TCanvas; const rect: TRect): Boolean;
+
+            {**
+             Set if the animation frames are rendered in a worker thread
+             @param(value If @true, the frames are rendered in a worker thread)
+            }
+            procedure SetAsyncRendering(value: Boolean);
+
+            {**
+             Get the number of animation frames dropped by the render thread
+             @returns(Dropped frame count)
+            }
+            function GetDroppedFrames: Cardinal;
+
+            {**
+             Called in the main thread when the render thread completed a frame
+             @param(pSender Event sender)
+            }
+            procedure OnFrameReady(pSender: TObject);
+
+            {**
+             Suspend the graphic in the animation timer if it has nothing to animate or isn't
+             visible, resume it otherwise
+            }
+            procedure UpdateScheduling;
+
+            {**
+             Get the hash identifying a SVG data content
+             @param(data SVG data)
+             @returns(Data hash)
+            }
+            class function GetDataHash(const data: UnicodeString): Integer; static;
+
+            {**
+             Get if a SVG is being loaded asynchronously
+             @returns(@true if a SVG is being loaded, otherwise @false)
+            }
+            function GetLoading: Boolean;
+
+            {**
+             Called in the main thread when a load worker ended, to release it
+             @param(pSender Event sender)
+            }
+            procedure OnLoadEnded(pSender: TObject);
+
+            {**
+             Called in the main thread when the load worker completed
+             @param(pSender Event sender)
+            }
+            procedure OnLoadCompleted(pSender: TObject);
+
+            {**
+             Copy the content from another graphic
+             @param(pSource Graphic to copy from)
+             @param(move If @true, the document and the frame rasterized while loading are taken from
+                         the source instead of being copied, the source should be cleared afterwards)
+            }
+            procedure AssignFrom(pSource: TWSVGGraphic; move: Boolean);
+
+            {**
+             Called when no interaction was notified for the interaction delay
+             @param(pSender Event sender)
+            }
+            procedure OnInteractionTimer(pSender: TObject);
+
         protected
             {**
              Draw svg
@@ -231,6 +836,36 @@ type
             }
             procedure SetAnimate(value: Boolean); virtual;
 
+            {**
+             Set if the graphic is visible
+             @param(value If @true, the graphic is visible, hidden otherwise)
+            }
+            procedure SetVisible(value: Boolean); virtual;
+
+            {**
+             Set the maximum number of times per second the graphic is animated
+             @param(value Frame rate, 0 means the animation timer default)
+            }
+            procedure SetFrameRate(value: Cardinal); virtual;
+
+            {**
+             Set if the looping animations are played back from pre-rendered frames
+             @param(value If @true, the frame cache is enabled, disabled otherwise)
+            }
+            procedure SetFrameCache(value: Boolean); virtual;
+
+            {**
+             Set the frame cache memory limit
+             @param(value Memory limit, in bytes)
+            }
+            procedure SetFrameCacheLimit(value: NativeUInt); virtual;
+
+            {**
+             Set if the cached frames are stored as deltas against the previous frame
+             @param(value If @true, the cached frames are compressed, otherwise they are stored as is)
+            }
+            procedure SetFrameCacheCompressed(value: Boolean); virtual;
+
             {**
              Called while animation is running
              @param(pAnimDesc Animation description)
@@ -299,6 +934,14 @@ type
             }
             procedure Assign(pOther: TPersistent); override;
 
+            {**
+             Move the content from another graphic. Unlike Assign(), the document isn't copied, thus
+             this is immediate even for a large svg, e.g. to take a svg loaded asynchronously in a
+             separate graphic, whose first rasterized frame is also kept
+             @param(pSource Graphic to move from, cleared once done)
+            }
+            procedure MoveFrom(pSource: TWSVGGraphic); virtual;
+
             {**
              Load svg from string
              @param(str String to load from)
@@ -311,6 +954,45 @@ type
             }
             procedure LoadFromStream(pStream: TStream); override;
 
+            {**
+             Load svg from file asynchronously. The file is read and parsed, and its first frame is
+             rasterized, in a worker thread, while the previous svg is still shown. The svg is replaced
+             once loaded, then the OnLoaded event is called
+             @param(fileName File to load from)
+             @param(width Width the svg will be drawn at, if 0 the svg width is used)
+             @param(height Height the svg will be drawn at, if 0 the svg height is used)
+             @param(proportional Proportional option the svg will be drawn with, set once loaded)
+             @br @bold(NOTE) A load still running is cancelled. The first frame is rasterized in the
+                             worker, and only presented if the svg is drawn at the same size and with
+                             the same options, so they should be known before the load. The worker
+                             never calls the graphic callbacks, the OnAnimate callback isn't called
+                             for this frame, and the embedded images are loaded by the worker with
+                             its own thread safe handler
+            }
+            procedure LoadFromFileAsync(const fileName: TFileName; width: Integer = 0; height: Integer = 0;
+                    proportional: Boolean = C_TWSVGGraphic_Default_Proportional); virtual;
+
+            {**
+             Load svg from stream asynchronously, see LoadFromFileAsync()
+             @param(pStream Stream to load from)
+             @param(width Width the svg will be drawn at, if 0 the svg width is used)
+             @param(height Height the svg will be drawn at, if 0 the svg height is used)
+             @param(proportional Proportional option the svg will be drawn with, set once loaded)
+             @br @bold(NOTE) The stream content is copied before the function returns, so the caller
+                             may release it
+            }
+            procedure LoadFromStreamAsync(pStream: TStream; width: Integer = 0; height: Integer = 0;
+                    proportional: Boolean = C_TWSVGGraphic_Default_Proportional); virtual;
+
+            {**
+             Cancel the asynchronous load still running, if any. The current svg is kept, and the
+             OnLoaded event isn't called for the cancelled load
+             @br @bold(NOTE) The function doesn't wait until the worker ends, it is released later.
+                             However the graphic destructor waits until its cancelled workers end,
+                             which may take some time if a large document is being parsed
+            }
+            procedure CancelLoad; virtual;
+
             {**
              Save svg to stream
              @param(pStream Stream to save to)
@@ -362,6 +1044,42 @@ type
             }
             procedure SetCustomData(pCustomData: Pointer); virtual;
 
+            {**
+             Notify that the user is interacting with the graphic, e.g. while zooming or resizing it.
+             The graphic is drawn in draft quality until the interaction ends
+             @br @bold(NOTE) This function may be called on each interaction event. The interaction
+                             ends automatically when no event was notified for a short delay, and
+                             the graphic is then redrawn in full quality
+            }
+            procedure BeginInteraction; virtual;
+
+            {**
+             End the interaction and redraw the graphic in full quality
+            }
+            procedure EndInteraction; virtual;
+
+            {**
+             Get the region changed between the last drawn animation frame and the current one
+             @param(width Draw rect width)
+             @param(height Draw rect height)
+             @param(rect @bold([out]) Changed region, relative to the draw rect top and left, may be
+                                      empty if nothing changed)
+             @returns(@true if the changed region is known, @false if the whole graphic should be
+                      redrawn)
+             @br @bold(NOTE) The region is only known if the partial redraw is enabled and the last
+                             frame was drawn with the same size. The OnAnimate callback is called
+                             while the region is measured
+            }
+            function GetDirtyRect(width, height: Integer; out rect: TRect): Boolean; virtual;
+
+            {**
+             Get the memory retained by the graphic, including the SVG tree, its source data, the
+             frame cache and the back buffers
+             @returns(Retained memory size, in bytes)
+             @br @bold(NOTE) The returned size is an estimation, the memory manager overhead is ignored
+            }
+            function GetMemorySize: NativeUInt; virtual;
+
         public
             {**
              Get the library version number
@@ -370,6 +1088,9 @@ type
 
             {**
              Get the native SVG object
+             @br @bold(NOTE) If the frames are rendered asynchronously, the worker rasterizes a copy
+                             of the document, taken when it was created. The changes made here are
+                             only rendered by a new worker, e.g. once AsyncRendering is toggled
             }
             property Native: TWSVG read m_pSVG;
 
@@ -383,6 +1104,11 @@ type
             }
             property Data: UnicodeString read m_Data;
 
+            {**
+             Get the SVG data hash, which identifies the document content
+            }
+            property DataHash: Integer read m_DataHash;
+
             {**
              Get or set if the SVG is animated
             }
@@ -423,6 +1149,103 @@ type
             }
             property Position: Double read m_FramePos write SetFramePos;
 
+            {**
+             Get or set if the graphic is visible. A hidden graphic isn't animated, thus the owner
+             should update this value e.g. when hidden or shown, to avoid to waste CPU
+            }
+            property Visible: Boolean read m_Visible write SetVisible default True;
+
+            {**
+             Get or set the maximum number of times per second the graphic is animated, 0 means the
+             animation timer default
+            }
+            property FrameRate: Cardinal read m_FrameRate write SetFrameRate default 0;
+
+            {**
+             Get or set if the animation frames identical to the last drawn one are skipped. In this
+             case the graphic isn't repainted while no animation is running, e.g. before an
+             animation begins or after it ended
+             @br @bold(NOTE) The OnAnimate callback isn't called for the skipped frames, so this
+                             option should be disabled if the callback alters the animations
+            }
+            property SkipStaticFrames: Boolean read m_SkipStaticFrames write m_SkipStaticFrames default True;
+
+            {**
+             Get or set if the looping animations are played back from pre-rendered frames. When
+             enabled, a full animation cycle is rendered once at the current draw size, then each
+             next frame is simply blitted
+             @br @bold(NOTE) The OnAnimate callback is only called while the frames are rendered,
+                             and thus cannot be used to alter a cached animation on the fly. The
+                             frame cache is ignored while the user interacts with the graphic
+            }
+            property FrameCache: Boolean read m_FrameCache write SetFrameCache default C_TWSVGGraphic_Default_FrameCache;
+
+            {**
+             Get or set the maximum memory the frame cache may use, in bytes. If a full cycle cannot
+             fit in this limit, the frame count is reduced, or if compressed, the cache is abandoned
+             and the animation is rasterized as usual
+            }
+            property FrameCacheLimit: NativeUInt read m_FrameCacheLimit write SetFrameCacheLimit;
+
+            {**
+             Get or set if the cached frames are stored as deltas against the previous frame. This
+             reduces the memory used by animations changing a small area, to the cost of a decoding
+             on each frame
+            }
+            property FrameCacheCompressed: Boolean read m_FrameCacheCompressed write SetFrameCacheCompressed;
+
+            {**
+             Get the memory currently used by the frame cache, in bytes
+            }
+            property FrameCacheSize: NativeUInt read GetFrameCacheSize;
+
+            {**
+             Get or set if the animation frames are partially redrawn. When enabled, the last frame
+             is kept in a buffer, and only the regions covered by the animated elements, before and
+             after they changed, are rasterized again. The owner may also invalidate these regions
+             only, see GetDirtyRect()
+             @br @bold(NOTE) The frame is fully redrawn if an animated element cannot be measured,
+                             e.g. an animated group or text. The frame cache, if enabled, has the
+                             priority on the partial redraw
+            }
+            property PartialRedraw: Boolean read m_PartialRedraw write SetPartialRedraw default False;
+
+            {**
+             Get if the graphic is changing because a new animation frame should be drawn
+            }
+            property FrameChanging: Boolean read m_FrameChanging;
+
+            {**
+             Get if a svg is being loaded asynchronously
+            }
+            property Loading: Boolean read GetLoading;
+
+            {**
+             Get or set if the animation frames are rasterized in a worker thread. The paint handler
+             then only presents the latest completed frame, and the owner is invalidated each time
+             a new frame is completed. If the rendering falls behind, the intermediate frames are
+             dropped instead of being queued
+             @br @bold(NOTE) The worker never calls the graphic callbacks. The frames are drawn
+                             synchronously while an OnAnimate handler is assigned, and the embedded
+                             images are loaded by the worker with its own thread safe handler. A frame
+                             is also drawn synchronously when the draw size changes, or while the user
+                             interacts with the graphic. The frame cache, if enabled, has the priority on the
+                             worker thread, which has itself the priority on the partial redraw
+            }
+            property AsyncRendering: Boolean read m_AsyncRendering write SetAsyncRendering default False;
+
+            {**
+             Get the time elapsed between the animation timer tick which requested the last
+             presented frame and its presentation, in milliseconds. Only measured while the frames
+             are rendered in a worker thread
+            }
+            property FrameLatency: Double read m_FrameLatency;
+
+            {**
+             Get the number of animation frames dropped because the worker thread fell behind
+            }
+            property DroppedFrames: Cardinal read GetDroppedFrames;
+
             {**
              Get or set if image is proportional
             }
@@ -467,6 +1290,109 @@ type
              Get or set the OnAnimationLoop callback
             }
             property OnAnimationLoop: TNotifyEvent read m_fOnAnimationLoop write m_fOnAnimationLoop;
+
+            {**
+             Get or set the OnLoaded callback, called in the main thread when a svg loaded
+             asynchronously is ready, or could not be loaded
+            }
+            property OnLoaded: ITfLoadedEvent read m_fOnLoaded write m_fOnLoaded;
+    end;
+
+    {**
+     Process-wide cache of the rasterized SVG glyphs, shared between all the controls painting the
+     same glyphs, e.g. the styled checkboxes and radio buttons, or the image buttons. Each glyph is
+     rasterized once per document, state, size and DPI, then blitted, so switching between the
+     glyph states is immediate once each state was painted. Once full, the least recently drawn glyph
+     is evicted to receive the new one
+     @br @bold(NOTE) The animated documents are never cached, they are always drawn from their SVG.
+                     The cache should only be used from the main thread
+    }
+    TWSVGGlyphCache = class
+        private type
+            {**
+             Cached glyph
+            }
+            IGlyph = class
+                private
+                    m_pBitmap: Vcl.Graphics.TBitmap;
+                    m_Data:    UnicodeString;
+                    m_DPI:     Integer;
+                    m_LastUse: UInt64;
+
+                public
+                    {**
+                     Constructor
+                     @param(data SVG source the glyph was rasterized from)
+                     @param(dpi Pixels per inch value the glyph was rasterized for)
+                    }
+                    constructor Create(const data: UnicodeString; dpi: Integer); virtual;
+
+                    {**
+                     Destructor
+                    }
+                    destructor Destroy; override;
+            end;
+
+            IGlyphs = TObjectDictionary<UnicodeString, IGlyph>;
+
+        private
+            class var m_pGlyphs:  IGlyphs;
+            class var m_UseCount: UInt64;
+
+            {**
+             Get the key identifying a glyph in the cache
+             @param(pSVG SVG graphic to draw)
+             @param(state Glyph state, defined by the caller)
+             @param(width Glyph width in pixels)
+             @param(height Glyph height in pixels)
+             @param(dpi Pixels per inch value)
+             @returns(Glyph key)
+            }
+            class function GetKey(pSVG: TWSVGGraphic; state, width, height, dpi: Integer): UnicodeString; static;
+
+            {**
+             Rasterize a glyph
+             @param(pSVG SVG graphic to rasterize)
+             @param(width Glyph width in pixels)
+             @param(height Glyph height in pixels)
+             @param(dpi Pixels per inch value)
+             @returns(Rasterized glyph, without bitmap if the SVG is animated)
+            }
+            class function Rasterize(pSVG: TWSVGGraphic; width, height, dpi: Integer): IGlyph; static;
+
+            {**
+             Remove the least recently drawn glyph from the cache
+            }
+            class procedure EvictOldest; static;
+
+        public
+            {**
+             Draw a glyph, from the cache if possible
+             @param(pCanvas Canvas to draw on)
+             @param(rect Rect in which the glyph should be drawn)
+             @param(pGraphic Glyph graphic, only the SVG graphics are cached, the others are drawn as usual)
+             @param(state Glyph state, e.g. checked or hovered, to keep each state of a control cached)
+             @param(dpi Pixels per inch value the glyph is drawn for)
+            }
+            class procedure Draw(pCanvas: TCanvas; const rect: TRect; pGraphic: TGraphic;
+                    state, dpi: Integer); static;
+
+            {**
+             Invalidate the glyphs rasterized for a pixels per inch value, e.g. after a DPI change
+             @param(dpi Pixels per inch value to invalidate)
+            }
+            class procedure Invalidate(dpi: Integer); static;
+
+            {**
+             Clear the cache
+            }
+            class procedure Clear; static;
+
+            {**
+             Get the memory retained by the cached glyphs
+             @returns(Retained memory size, in bytes)
+            }
+            class function GetMemorySize: NativeUInt; static;
     end;
 
     {**
@@ -485,7 +1411,15 @@ var
 implementation
 
 uses
-  System.UITypes;
+  System.UITypes,
+  System.Generics.Defaults,
+  System.Diagnostics,
+  Winapi.ActiveX
+  {$if CompilerVersion >= 29}
+      ,
+      System.Hash
+  {$ifend}
+  ;
 
 //---------------------------------------------------------------------------
 // TWSVGGraphicFilter
@@ -535,149 +1469,1322 @@ begin
     Result := ((Length(fileMask) > 0) and ContainsText(fileMask, 'svg'));
 end;
 //---------------------------------------------------------------------------
-// TWSVGGraphic
+// TWSVGGraphic.IFrameCache
 //---------------------------------------------------------------------------
-constructor TWSVGGraphic.Create;
+constructor TWSVGGraphic.IFrameCache.Create(width, height: Integer; proportional, antialiasing,
+        compressed: Boolean; limit: NativeUInt);
+var
+    frameSize: NativeUInt;
 begin
     inherited Create;
 
-    m_hClipboardFormat         := 0;
-    m_hInkscapeClipboardFormat := 0;
-    m_Width                    := 0;
-    m_Height                   := 0;
-    m_FramePos                 := C_TWSVGGraphic_Default_FramePosition;
-    m_AnimSpeed                := 1.0;
-    m_PerformedAnimLoops       := 0;
-    m_AnimLoopCount            := 0;
-    m_AnimLoop                 := True;
-    m_Animate                  := C_TWSVGGraphic_Default_Animate;
-    m_Proportional             := C_TWSVGGraphic_Default_Proportional;
-    m_Antialiasing             := C_TWSVGGraphic_Default_Antialiasing;
-    m_FramePosChanging         := False;
-    m_ForceOriginalSave        := False;
-    m_Opened                   := False;
-    m_OnError                  := False;
-    m_pSVG                     := nil;
-    m_pCustomData              := nil;
-    m_fOnAnimate               := nil;
-    m_fOnAnimationBegin        := nil;
-    m_fOnAnimationEnd          := nil;
-    m_fOnAnimationLoop         := nil;
-
-    // create internal SVG object
-    m_pSVG             := TWSVG.Create;
-    m_pSVGRasterizer   := TWSVGGDIPlusRasterizer.Create(TWControlRenderer.GetGDIPlusToken);
-    m_pFrameCalculator := TWSVGFrameCalculator.Create;
-
-    // link internal callbacks
-    m_pSVGRasterizer.OnAnimate  := DoAnimate;
-    m_pSVGRasterizer.OnGetImage := DoGetImage;
-
-    // set background transparent by default
-    Transparent := True;
+    m_Width        := width;
+    m_Height       := height;
+    m_Count        := C_TWSVGGraphic_Frame_Cache_Frames;
+    m_Added        := 0;
+    m_DecodedIndex := -1;
+    m_BitmapIndex  := -1;
+    m_Size         := 0;
+    m_Limit        := limit;
+    m_Proportional := proportional;
+    m_Antialiasing := antialiasing;
+    m_Compressed   := compressed;
+    m_Rejected     := False;
+    m_pBitmap      := nil;
+
+    frameSize := NativeUInt(Max(m_Width, 0)) * NativeUInt(Max(m_Height, 0)) * SizeOf(Cardinal);
+
+    // raw frames have a known size, so reduce the frame count to fit in the memory limit
+    if ((frameSize > 0) and not m_Compressed and ((m_Limit div frameSize) < NativeUInt(m_Count))) then
+        m_Count := m_Limit div frameSize;
+
+    // nothing worth to cache?
+    if ((frameSize = 0) or (m_Count < 2)) then
+    begin
+        m_Count    := 0;
+        m_Rejected := True;
+        Exit;
+    end;
 
-    // enable the animation support in the rasterizer for the entire graphic lifecycle. This is
-    // required to allow the graphic to work in a "marquee mode", where a frame position may be
-    // selected manually
-    m_pSVGRasterizer.EnableAnimation(True);
+    SetLength(m_Frames, m_Count);
 
-    // attach to animation timer to receive time notifications
-    TWAnimationTimer.GetInstance.Attach(Self);
+    // create the bitmap used to display the frames
+    m_pBitmap             := Vcl.Graphics.TBitmap.Create;
+    m_pBitmap.PixelFormat := pf32bit;
+    m_pBitmap.AlphaFormat := afPremultiplied;
+    m_pBitmap.SetSize(m_Width, m_Height);
 end;
 //---------------------------------------------------------------------------
-destructor TWSVGGraphic.Destroy;
+destructor TWSVGGraphic.IFrameCache.Destroy;
 begin
-    // unlink internal callbacks
-    m_pSVGRasterizer.OnAnimate := nil;
-
-    // detach from animation timer and stop to receive time notifications
-    TWAnimationTimer.GetInstance.Detach(Self);
-
-    FreeAndNil(m_pFrameCalculator);
-    FreeAndNil(m_pSVGRasterizer);
-    FreeAndNil(m_pSVG);
+    m_pBitmap.Free;
 
     inherited Destroy;
 end;
 //---------------------------------------------------------------------------
-function TWSVGGraphic.GetVersion: UnicodeString;
+procedure TWSVGGraphic.IFrameCache.ReadPixels(pBitmap: Vcl.Graphics.TBitmap; out pixels: IPixels);
+var
+    y: Integer;
 begin
-    if (not Assigned(TWLibraryVersion)) then
-        Exit('#ERROR');
+    SetLength(pixels, m_Width * m_Height);
 
-    Result := TWLibraryVersion.ToStr;
+    // copy the bitmap lines
+    for y := 0 to m_Height - 1 do
+        Move(pBitmap.ScanLine[y]^, pixels[y * m_Width], m_Width * SizeOf(Cardinal));
 end;
 //---------------------------------------------------------------------------
-procedure TWSVGGraphic.WriteRawDataToStream(data: UnicodeString; pStream: TStream);
+procedure TWSVGGraphic.IFrameCache.WritePixels(const pixels: IPixels);
 var
-    pStrWriter: TStreamWriter;
+    y: Integer;
 begin
-    pStrWriter := nil;
+    // copy the bitmap lines
+    for y := 0 to m_Height - 1 do
+        Move(pixels[y * m_Width], m_pBitmap.ScanLine[y]^, m_Width * SizeOf(Cardinal));
+end;
+//---------------------------------------------------------------------------
+function TWSVGGraphic.IFrameCache.Encode(const previous, current: IPixels): IPixels;
+var
+    pixelCount, i, start, count, len: NativeInt;
+begin
+    pixelCount := Length(current);
 
-    try
-        // write data to stream
-        pStrWriter := TStreamWriter.Create(pStream);
+    // reserve the worst case, i.e. every second pixel changed
+    SetLength(Result, ((pixelCount div 2) + 1) * 3);
+
+    len := 0;
+    i   := 0;
+
+    while (i < pixelCount) do
+    begin
+        // skip the unchanged pixels
+        if (current[i] = previous[i]) then
+        begin
+            Inc(i);
+            continue;
+        end;
+
+        start := i;
+
+        // search for the run end
+        while ((i < pixelCount) and (current[i] <> previous[i])) do
+            Inc(i);
+
+        count := i - start;
+
+        // write the run
+        Result[len]     := start;
+        Result[len + 1] := count;
+        Move(current[start], Result[len + 2], count * SizeOf(Cardinal));
+        Inc(len, count + 2);
+    end;
+
+    SetLength(Result, len);
+end;
+//---------------------------------------------------------------------------
+procedure TWSVGGraphic.IFrameCache.Decode(const delta: IPixels; var pixels: IPixels);
+var
+    len, count: NativeInt;
+begin
+    len := 0;
+
+    // apply the runs
+    while (len < Length(delta)) do
+    begin
+        count := delta[len + 1];
+        Move(delta[len + 2], pixels[delta[len]], count * SizeOf(Cardinal));
+        Inc(len, count + 2);
+    end;
+end;
+//---------------------------------------------------------------------------
+procedure TWSVGGraphic.IFrameCache.Reject;
+begin
+    m_Rejected := True;
+    m_Size     := 0;
+
+    SetLength(m_Frames, 0);
+    SetLength(m_Pixels, 0);
+end;
+//---------------------------------------------------------------------------
+function TWSVGGraphic.IFrameCache.Add(pBitmap: Vcl.Graphics.TBitmap): Boolean;
+var
+    pixels: IPixels;
+begin
+    if (m_Rejected or (m_Added >= m_Count)) then
+        Exit(False);
+
+    // bitmap doesn't match with the cache?
+    if (not Assigned(pBitmap) or (pBitmap.Width <> m_Width) or (pBitmap.Height <> m_Height)
+            or (pBitmap.PixelFormat <> pf32bit))
+    then
+    begin
+        Reject;
+        Exit(False);
+    end;
+
+    ReadPixels(pBitmap, pixels);
+
+    // the first frame is always a key frame
+    if (not m_Compressed) then
+        m_Frames[m_Added] := pixels
+    else
+    if (m_Added = 0) then
+        m_Frames[m_Added] := Copy(pixels)
+    else
+        m_Frames[m_Added] := Encode(m_Pixels, pixels);
+
+    Inc(m_Size, NativeUInt(Length(m_Frames[m_Added])) * SizeOf(Cardinal));
+
+    // memory limit exceeded?
+    if (m_Size > m_Limit) then
+    begin
+        Reject;
+        Exit(False);
+    end;
+
+    // keep the last frame, the next one will be encoded against it
+    if (m_Compressed) then
+    begin
+        m_Pixels       := pixels;
+        m_DecodedIndex := m_Added;
+    end;
+
+    Inc(m_Added);
+    Result := True;
+end;
+//---------------------------------------------------------------------------
+function TWSVGGraphic.IFrameCache.Draw(index: Integer; pCanvas: TCanvas; x, y: Integer): Boolean;
+begin
+    // cache is incomplete or unusable?
+    if (m_Rejected or (m_Added < m_Count)) then
+        Exit(False);
+
+    index := TWMathHelper.Clamp(index, 0, m_Count - 1);
+
+    // do update the display bitmap?
+    if (index <> m_BitmapIndex) then
+    begin
+        if (m_Compressed) then
+        begin
+            // the deltas may only be applied forward, so restart from the key frame when going back
+            if (index < m_DecodedIndex) then
+            begin
+                m_Pixels       := Copy(m_Frames[0]);
+                m_DecodedIndex := 0;
+            end;
+
+            // apply the deltas until the requested frame is reached
+            while (m_DecodedIndex < index) do
+            begin
+                Inc(m_DecodedIndex);
+                Decode(m_Frames[m_DecodedIndex], m_Pixels);
+            end;
+
+            WritePixels(m_Pixels);
+        end
+        else
+            WritePixels(m_Frames[index]);
+
+        m_BitmapIndex := index;
+    end;
+
+    // draw the frame on the final canvas
+    Result := TWGDIHelper.AlphaBlendImage(m_pBitmap, m_Width, m_Height, pCanvas, x, y, m_Width, m_Height);
+end;
+//---------------------------------------------------------------------------
+function TWSVGGraphic.IFrameCache.Matches(width, height: Integer; proportional, antialiasing: Boolean): Boolean;
+begin
+    Result := ((m_Width = width) and (m_Height = height) and (m_Proportional = proportional)
+            and (m_Antialiasing = antialiasing));
+end;
+//---------------------------------------------------------------------------
+// TWSVGGraphic.IBackBuffer
+//---------------------------------------------------------------------------
+constructor TWSVGGraphic.IBackBuffer.Create(width, height: Integer; proportional, antialiasing: Boolean);
+begin
+    inherited Create;
+
+    m_AnimatedRect := Default(TRect);
+    m_PendingRect  := Default(TRect);
+    m_Width        := width;
+    m_Height       := height;
+    m_Position     := 0.0;
+    m_PendingPos   := 0.0;
+    m_NextChange   := 0.0;
+    m_Proportional := proportional;
+    m_Antialiasing := antialiasing;
+    m_AnimatedAll  := True;
+    m_PendingValid := False;
+    m_Valid        := False;
+
+    // create the bitmap containing the last drawn frame
+    m_pBitmap             := Vcl.Graphics.TBitmap.Create;
+    m_pBitmap.PixelFormat := pf32bit;
+    m_pBitmap.AlphaFormat := afPremultiplied;
+    m_pBitmap.SetSize(width, height);
+
+    // create the bitmap on which the animated elements are measured. Nothing is really drawn on it
+    // for the measured elements, so a single pixel is enough
+    m_pScratch             := Vcl.Graphics.TBitmap.Create;
+    m_pScratch.PixelFormat := pf32bit;
+    m_pScratch.AlphaFormat := afPremultiplied;
+    m_pScratch.SetSize(1, 1);
+end;
+//---------------------------------------------------------------------------
+destructor TWSVGGraphic.IBackBuffer.Destroy;
+begin
+    m_pScratch.Free;
+    m_pBitmap.Free;
+
+    inherited Destroy;
+end;
+//---------------------------------------------------------------------------
+procedure TWSVGGraphic.IBackBuffer.Update(position: Double; pRasterizer: TWSVGRasterizer);
+begin
+    m_Position     := position;
+    m_AnimatedRect := pRasterizer.DirtyRect;
+    m_AnimatedAll  := pRasterizer.DirtyAll;
+    m_NextChange   := pRasterizer.NextChange;
+    m_PendingValid := False;
+    m_Valid        := True;
+end;
+//---------------------------------------------------------------------------
+function TWSVGGraphic.IBackBuffer.Draw(pCanvas: TCanvas; x, y: Integer): Boolean;
+begin
+    if (not m_Valid) then
+        Exit(False);
+
+    // draw the frame on the final canvas
+    Result := TWGDIHelper.AlphaBlendImage(m_pBitmap, m_Width, m_Height, pCanvas, x, y, m_Width, m_Height);
+end;
+//---------------------------------------------------------------------------
+function TWSVGGraphic.IBackBuffer.Matches(width, height: Integer; proportional, antialiasing: Boolean): Boolean;
+begin
+    Result := ((m_Width = width) and (m_Height = height) and (m_Proportional = proportional)
+            and (m_Antialiasing = antialiasing));
+end;
+//---------------------------------------------------------------------------
+// TWSVGGraphic.IEmbeddedGraphic
+//---------------------------------------------------------------------------
+constructor TWSVGGraphic.IEmbeddedGraphic.Create;
+begin
+    inherited Create;
+
+    m_Width  := 0;
+    m_Height := 0;
+    m_pSVG   := TWSVG.Create;
+
+    // the graphic may be drawn from a worker thread, so it uses its own GDI+ renderer, whose caches
+    // aren't shared with the main thread
+    m_pRasterizer                 := TWSVGGDIPlusRasterizer.Create(TWControlRenderer.GetGDIPlusToken);
+    m_pRasterizer.PrivateRenderer := True;
+    m_pRasterizer.OnGetImage      := GetImage;
+    m_pRasterizer.EnableAnimation(True);
+
+    Transparent := True;
+end;
+//---------------------------------------------------------------------------
+destructor TWSVGGraphic.IEmbeddedGraphic.Destroy;
+begin
+    m_pRasterizer.Free;
+    m_pSVG.Free;
+
+    inherited Destroy;
+end;
+//---------------------------------------------------------------------------
+procedure TWSVGGraphic.IEmbeddedGraphic.Draw(pCanvas: TCanvas; const rect: TRect);
+var
+    animation: TWSVGRasterizer.IAnimation;
+begin
+    if (not Assigned(pCanvas) or GetEmpty) then
+        Exit;
+
+    animation.m_Position    := C_TWSVGGraphic_Default_FramePosition;
+    animation.m_pCustomData := nil;
+
+    m_pRasterizer.Draw(m_pSVG, rect, C_TWSVGGraphic_Default_Proportional, C_TWSVGGraphic_Default_Antialiasing,
+            animation, pCanvas);
+end;
+//---------------------------------------------------------------------------
+function TWSVGGraphic.IEmbeddedGraphic.GetEmpty: Boolean;
+begin
+    Result := ((m_Width <= 0) or (m_Height <= 0));
+end;
+//---------------------------------------------------------------------------
+function TWSVGGraphic.IEmbeddedGraphic.GetWidth: Integer;
+begin
+    Result := m_Width;
+end;
+//---------------------------------------------------------------------------
+function TWSVGGraphic.IEmbeddedGraphic.GetHeight: Integer;
+begin
+    Result := m_Height;
+end;
+//---------------------------------------------------------------------------
+procedure TWSVGGraphic.IEmbeddedGraphic.SetWidth(value: Integer);
+begin
+    m_Width := value;
+end;
+//---------------------------------------------------------------------------
+procedure TWSVGGraphic.IEmbeddedGraphic.SetHeight(value: Integer);
+begin
+    m_Height := value;
+end;
+//---------------------------------------------------------------------------
+procedure TWSVGGraphic.IEmbeddedGraphic.LoadFromStream(pStream: TStream);
+var
+    size: TSize;
+begin
+    m_Width  := 0;
+    m_Height := 0;
+
+    if (not m_pSVG.LoadFromStream(pStream)) then
+    begin
+        TWLogHelper.LogToCompiler('Load embedded SVG - FAILED');
+        Exit;
+    end;
+
+    size     := m_pRasterizer.GetSize(m_pSVG);
+    m_Width  := size.Width;
+    m_Height := size.Height;
+end;
+//---------------------------------------------------------------------------
+procedure TWSVGGraphic.IEmbeddedGraphic.SaveToStream(pStream: TStream);
+begin
+    // the embedded svg is only drawn, its source isn't kept
+end;
+//---------------------------------------------------------------------------
+procedure TWSVGGraphic.IEmbeddedGraphic.LoadFromClipboardFormat(format: Word; data: THandle; hPalette: HPALETTE);
+begin
+    // not supported
+end;
+//---------------------------------------------------------------------------
+procedure TWSVGGraphic.IEmbeddedGraphic.SaveToClipboardFormat(var format: Word; var data: THandle;
+        var hPalette: HPALETTE);
+begin
+    format   := 0;
+    data     := 0;
+    hPalette := 0;
+end;
+//---------------------------------------------------------------------------
+class function TWSVGGraphic.IEmbeddedGraphic.GetImage(pSender: TObject; pStream: TMemoryStream;
+        imageType: TWSVGRasterizer.IEImageType; var pGraphic: TGraphic): Boolean;
+begin
+    if ((not Assigned(pStream)) or (pStream.Size = 0)) then
+        Exit(False);
+
+    pStream.Position := 0;
+
+    case (imageType) of
+        TWSVGRasterizer.IEImageType.IE_IT_JPG:
+        begin
+            pGraphic := TJpegImage.Create;
+            pGraphic.LoadFromStream(pStream);
+            Exit(True);
+        end;
+
+        TWSVGRasterizer.IEImageType.IE_IT_PNG:
+        begin
+            pGraphic := TPngImage.Create;
+            pGraphic.LoadFromStream(pStream);
+            Exit(True);
+        end;
+
+        TWSVGRasterizer.IEImageType.IE_IT_SVG:
+        begin
+            // a TWSVGGraphic would attach itself to the animation timer and share the main thread
+            // renderer, so the embedded svg is loaded in a graphic safe to use from a worker
+            pGraphic := IEmbeddedGraphic.Create;
+            pGraphic.LoadFromStream(pStream);
+            Exit(True);
+        end;
+    else
+        Exit(False);
+    end;
+end;
+//---------------------------------------------------------------------------
+// TWSVGGraphic.IRenderThread
+//---------------------------------------------------------------------------
+constructor TWSVGGraphic.IRenderThread.Create(pSVG: TWSVG; fOnFrameReady: TNotifyEvent);
+begin
+    // the worker rasterizes its own copy of the document, which cannot be modified meanwhile
+    m_pSVG := TWSVG.Create;
+    m_pSVG.Assign(pSVG);
+
+    m_pCustomData       := nil;
+    m_RequestPos        := 0.0;
+    m_RequestTime       := 0.0;
+    m_FramePos          := 0.0;
+    m_FrameTime         := 0.0;
+    m_NextChange        := 0.0;
+    m_Width             := 0;
+    m_Height            := 0;
+    m_FrameWidth        := 0;
+    m_FrameHeight       := 0;
+    m_DroppedFrames     := 0;
+    m_Proportional      := False;
+    m_Antialiasing      := False;
+    m_FrameProportional := False;
+    m_FrameAntialiasing := False;
+    m_Requested         := False;
+    m_Rendered          := False;
+    m_fOnFrameReady     := fOnFrameReady;
+    m_pLock             := TCriticalSection.Create;
+    m_pSignal           := TEvent.Create(nil, False, False, '');
+
+    // the worker uses its own rasterizer, and its own GDI+ renderer, whose caches aren't shared
+    // with the main thread
+    m_pRasterizer                 := TWSVGGDIPlusRasterizer.Create(TWControlRenderer.GetGDIPlusToken);
+    m_pRasterizer.PrivateRenderer := True;
+    m_pRasterizer.OnGetImage      := IEmbeddedGraphic.GetImage;
+    m_pRasterizer.EnableAnimation(True);
+
+    m_pFrontBuffer             := Vcl.Graphics.TBitmap.Create;
+    m_pFrontBuffer.PixelFormat := pf32bit;
+    m_pFrontBuffer.AlphaFormat := afPremultiplied;
+
+    m_pBackBuffer             := Vcl.Graphics.TBitmap.Create;
+    m_pBackBuffer.PixelFormat := pf32bit;
+    m_pBackBuffer.AlphaFormat := afPremultiplied;
+
+    inherited Create(False);
+end;
+//---------------------------------------------------------------------------
+destructor TWSVGGraphic.IRenderThread.Destroy;
+begin
+    // wake up the worker and wait until it ends
+    Terminate;
+    m_pSignal.SetEvent;
+    WaitFor;
+
+    // the frame ready notifications still not processed by the main thread should be dropped
+    TThread.RemoveQueuedEvents(Self);
+
+    m_pBackBuffer.Free;
+    m_pFrontBuffer.Free;
+    m_pRasterizer.Free;
+    m_pSVG.Free;
+    m_pSignal.Free;
+    m_pLock.Free;
+
+    inherited Destroy;
+end;
+//---------------------------------------------------------------------------
+function TWSVGGraphic.IRenderThread.GetDroppedFrames: Cardinal;
+begin
+    m_pLock.Enter;
+
+    try
+        Result := m_DroppedFrames;
+    finally
+        m_pLock.Leave;
+    end;
+end;
+//---------------------------------------------------------------------------
+procedure TWSVGGraphic.IRenderThread.Execute;
+var
+    animation:                              TWSVGRasterizer.IAnimation;
+    pBitmap:                                Vcl.Graphics.TBitmap;
+    time:                                   Double;
+    width, height:                          Integer;
+    proportional, antialiasing, hasRequest: Boolean;
+begin
+    while (not Terminated) do
+    begin
+        // wait until a frame is requested
+        m_pSignal.WaitFor(INFINITE);
+
+        if (Terminated) then
+            Break;
+
+        // get the latest request
+        m_pLock.Enter;
+
+        try
+            hasRequest              := m_Requested and (m_Width > 0) and (m_Height > 0);
+            m_Requested             := False;
+            animation.m_Position    := m_RequestPos;
+            animation.m_pCustomData := m_pCustomData;
+            time                    := m_RequestTime;
+            width                   := m_Width;
+            height                  := m_Height;
+            proportional            := m_Proportional;
+            antialiasing            := m_Antialiasing;
+        finally
+            m_pLock.Leave;
+        end;
+
+        if (not hasRequest) then
+            Continue;
+
+        // the back buffer is only used by the worker, however its canvas should be locked, otherwise
+        // the VCL may release its device context from the main thread
+        m_pBackBuffer.Canvas.Lock;
+
+        try
+            try
+                if ((m_pBackBuffer.Width <> width) or (m_pBackBuffer.Height <> height)) then
+                    m_pBackBuffer.SetSize(width, height);
+
+                TWGDIHelper.Clear(m_pBackBuffer);
+
+                if (not m_pRasterizer.Draw(m_pSVG, TRect.Create(0, 0, width, height), proportional, antialiasing,
+                        animation, m_pBackBuffer.Canvas))
+                then
+                    Continue;
+            except
+                on e: Exception do
+                begin
+                    TWLogHelper.LogToCompiler('Render SVG frame - FAILED - ' + e.Message);
+                    Continue;
+                end;
+            end;
+        finally
+            m_pBackBuffer.Canvas.Unlock;
+        end;
+
+        // publish the frame by swapping the buffers
+        m_pLock.Enter;
+
+        try
+            pBitmap             := m_pFrontBuffer;
+            m_pFrontBuffer      := m_pBackBuffer;
+            m_pBackBuffer       := pBitmap;
+            m_FramePos          := animation.m_Position;
+            m_FrameTime         := time;
+            m_NextChange        := m_pRasterizer.NextChange;
+            m_FrameWidth        := width;
+            m_FrameHeight       := height;
+            m_FrameProportional := proportional;
+            m_FrameAntialiasing := antialiasing;
+            m_Rendered          := True;
+        finally
+            m_pLock.Leave;
+        end;
+
+        // notify the main thread
+        Queue(procedure
+              begin
+                  if (Assigned(m_fOnFrameReady)) then
+                      m_fOnFrameReady(Self);
+              end);
+    end;
+end;
+//---------------------------------------------------------------------------
+procedure TWSVGGraphic.IRenderThread.Request(position, time: Double; pCustomData: Pointer);
+begin
+    m_pLock.Enter;
+
+    try
+        // same frame already requested or completed?
+        if ((m_Requested and (m_RequestPos = position))
+                or (m_Rendered and (m_FramePos = position) and (m_FrameWidth = m_Width)
+                        and (m_FrameHeight = m_Height) and (m_FrameProportional = m_Proportional)
+                        and (m_FrameAntialiasing = m_Antialiasing)))
+        then
+            Exit;
+
+        // the previous request was still not started, so drop it
+        if (m_Requested) then
+            Inc(m_DroppedFrames);
+
+        m_RequestPos  := position;
+        m_RequestTime := time;
+        m_pCustomData := pCustomData;
+        m_Requested   := True;
+    finally
+        m_pLock.Leave;
+    end;
+
+    m_pSignal.SetEvent;
+end;
+//---------------------------------------------------------------------------
+function TWSVGGraphic.IRenderThread.Present(pCanvas: TCanvas; const rect: TRect; proportional, antialiasing: Boolean;
+        out position, time, nextChange: Double): Boolean;
+var
+    width, height: Integer;
+begin
+    width  := rect.Right  - rect.Left;
+    height := rect.Bottom - rect.Top;
+
+    m_pLock.Enter;
+
+    try
+        // keep the size and options for the next requests
+        m_Width        := width;
+        m_Height       := height;
+        m_Proportional := proportional;
+        m_Antialiasing := antialiasing;
+
+        position   := m_FramePos;
+        time       := m_FrameTime;
+        nextChange := m_NextChange;
+
+        // no completed frame matches with the draw rect and options?
+        if (not m_Rendered or (m_FrameWidth <> width) or (m_FrameHeight <> height)
+                or (m_FrameProportional <> proportional) or (m_FrameAntialiasing <> antialiasing))
+        then
+            Exit(False);
+
+        // draw the frame on the final canvas. The worker cannot swap the buffers meanwhile
+        m_pFrontBuffer.Canvas.Lock;
+
+        try
+            Result := TWGDIHelper.AlphaBlendImage(m_pFrontBuffer, width, height, pCanvas, rect.Left,
+                    rect.Top, width, height);
+        finally
+            m_pFrontBuffer.Canvas.Unlock;
+        end;
+    finally
+        m_pLock.Leave;
+    end;
+end;
+//---------------------------------------------------------------------------
+// TWSVGGraphic.ILoadThread
+//---------------------------------------------------------------------------
+constructor TWSVGGraphic.ILoadThread.Create(pSource: TStream; const fileName: TFileName; width, height: Integer;
+        proportional: Boolean; fOnLoaded, fOnEnded: TNotifyEvent);
+begin
+    m_pFrame       := nil;
+    m_FileName     := fileName;
+    m_Data         := '';
+    m_DataHash     := 0;
+    m_Size         := Default(TSize);
+    m_Width        := width;
+    m_Height       := height;
+    m_Proportional := proportional;
+    m_Success      := False;
+    m_fOnLoaded    := fOnLoaded;
+    m_fOnEnded     := fOnEnded;
+    m_pSVG         := TWSVG.Create;
+
+    // copy the stream content, the caller may release it as soon as the load is started
+    m_pSource := TMemoryStream.Create;
+
+    if ((Length(m_FileName) = 0) and Assigned(pSource)) then
+        m_pSource.CopyFrom(pSource, 0);
+
+    // the worker uses its own rasterizer, and its own GDI+ renderer, whose caches aren't shared
+    // with the main thread
+    m_pRasterizer                 := TWSVGGDIPlusRasterizer.Create(TWControlRenderer.GetGDIPlusToken);
+    m_pRasterizer.PrivateRenderer := True;
+    m_pRasterizer.OnGetImage      := IEmbeddedGraphic.GetImage;
+    m_pRasterizer.EnableAnimation(True);
+
+    inherited Create(False);
+end;
+//---------------------------------------------------------------------------
+destructor TWSVGGraphic.ILoadThread.Destroy;
+begin
+    // the notifications processed while waiting should no longer reach the owner. NOTE they are
+    // only read from the main thread, as the destructor
+    m_fOnLoaded := nil;
+    m_fOnEnded  := nil;
+
+    // ask the worker to stop and wait until it ends
+    Terminate;
+    WaitFor;
+
+    // the completion notification still not processed by the main thread should be dropped
+    TThread.RemoveQueuedEvents(Self);
+
+    m_pFrame.Free;
+    m_pRasterizer.Free;
+    m_pSVG.Free;
+    m_pSource.Free;
+
+    inherited Destroy;
+end;
+//---------------------------------------------------------------------------
+function TWSVGGraphic.ILoadThread.Load: Boolean;
+var
+    pStrStream:    IWSmartPointer<TStringStream>;
+    pFrame:        IBackBuffer;
+    animation:     TWSVGRasterizer.IAnimation;
+    width, height: Integer;
+begin
+    // read the file, if any
+    if (Length(m_FileName) > 0) then
+        m_pSource.LoadFromFile(m_FileName);
+
+    // nothing to load?
+    if (m_pSource.Size = 0) then
+        Exit(False);
+
+    if (Terminated) then
+        Exit(False);
+
+    // keep the XML data, this is required to save back the SVG content, or to copy to clipboard
+    pStrStream := TWSmartPointer<TStringStream>.Create();
+    pStrStream.CopyFrom(m_pSource, 0);
+    m_Data     := pStrStream.DataString;
+    m_DataHash := TWSVGGraphic.GetDataHash(m_Data);
+
+    if (Terminated) then
+        Exit(False);
+
+    m_pSource.Position := 0;
+
+    // load svg from data buffer
+    if (not m_pSVG.LoadFromStream(m_pSource)) then
+    begin
+        TWLogHelper.LogToCompiler('Load SVG asynchronously - FAILED');
+        Exit(False);
+    end;
+
+    // get SVG size
+    m_Size := m_pRasterizer.GetSize(m_pSVG);
+
+    if (Terminated) then
+        Exit(False);
+
+    width  := m_Width;
+    height := m_Height;
+
+    // rasterize the first frame at the svg size if no size was requested
+    if ((width <= 0) or (height <= 0)) then
+    begin
+        width  := m_Size.Width;
+        height := m_Size.Height;
+    end;
+
+    // nothing to rasterize? The document is loaded anyway
+    if ((width <= 0) or (height <= 0)) then
+        Exit(True);
+
+    // rasterize the first frame with the drawing options the graphic will use once loaded
+    pFrame := IBackBuffer.Create(width, height, m_Proportional, C_TWSVGGraphic_Default_Antialiasing);
+
+    try
+        // the frame bitmap is only used by the worker for now, however its canvas should be locked,
+        // otherwise the VCL may release its device context from the main thread
+        pFrame.m_pBitmap.Canvas.Lock;
+
+        try
+            animation.m_Position    := C_TWSVGGraphic_Default_FramePosition;
+            animation.m_pCustomData := nil;
+
+            TWGDIHelper.Clear(pFrame.m_pBitmap);
+
+            // the frame is only an optimization, the document is drawn as usual if it failed
+            if (not m_pRasterizer.Draw(m_pSVG, TRect.Create(0, 0, width, height), pFrame.m_Proportional,
+                    pFrame.m_Antialiasing, animation, pFrame.m_pBitmap.Canvas))
+            then
+                Exit(True);
+
+            pFrame.Update(animation.m_Position, m_pRasterizer);
+        finally
+            pFrame.m_pBitmap.Canvas.Unlock;
+        end;
+
+        m_pFrame := pFrame;
+        pFrame   := nil;
+    finally
+        pFrame.Free;
+    end;
+
+    Result := True;
+end;
+//---------------------------------------------------------------------------
+procedure TWSVGGraphic.ILoadThread.Execute;
+begin
+    // the XML parser may rely on COM, which should be initialized in each thread
+    CoInitialize(nil);
+
+    try
+        try
+            m_Success := Load;
+        except
+            on e: Exception do
+            begin
+                TWLogHelper.LogToCompiler('Load SVG asynchronously - FAILED - ' + e.Message);
+                m_Success := False;
+            end;
+        end;
+    finally
+        CoUninitialize;
+    end;
+
+    // notify the main thread. NOTE a cancelled load is never notified as completed, however its end
+    // is, so the worker may be released without waiting for the owner to be destroyed
+    Queue(procedure
+          begin
+              try
+                  if (not Terminated and Assigned(m_fOnLoaded)) then
+                      m_fOnLoaded(Self);
+              finally
+                  // the worker is no longer used, and may be released from this callback, which
+                  // should thus be the last one to be called
+                  if (Assigned(m_fOnEnded)) then
+                      m_fOnEnded(Self);
+              end;
+          end);
+end;
+//---------------------------------------------------------------------------
+// TWSVGGraphic
+//---------------------------------------------------------------------------
+constructor TWSVGGraphic.Create;
+begin
+    inherited Create;
+
+    m_hClipboardFormat         := 0;
+    m_hInkscapeClipboardFormat := 0;
+    m_Width                    := 0;
+    m_Height                   := 0;
+    m_FramePos                 := C_TWSVGGraphic_Default_FramePosition;
+    m_DrawnPos                 := 0.0;
+    m_NextChange               := 0.0;
+    m_AnimSpeed                := 1.0;
+    m_PerformedAnimLoops       := 0;
+    m_AnimLoopCount            := 0;
+    m_AnimLoop                 := True;
+    m_Animate                  := C_TWSVGGraphic_Default_Animate;
+    m_Proportional             := C_TWSVGGraphic_Default_Proportional;
+    m_Antialiasing             := C_TWSVGGraphic_Default_Antialiasing;
+    m_FramePosChanging         := False;
+    m_ForceOriginalSave        := False;
+    m_Opened                   := False;
+    m_OnError                  := False;
+    m_Interacting              := False;
+    m_Visible                  := True;
+    m_SkipStaticFrames         := True;
+    m_FrameRate                := 0;
+    m_FrameCache               := C_TWSVGGraphic_Default_FrameCache;
+    m_FrameCacheCompressed     := False;
+    m_FrameCacheLimit          := C_TWSVGGraphic_Default_Frame_Limit;
+    m_PartialRedraw            := False;
+    m_AsyncRendering           := False;
+    m_PresentedTime            := 0.0;
+    m_FrameLatency             := 0.0;
+    m_FrameChanging            := False;
+    m_pSVG                     := nil;
+    m_pCustomData              := nil;
+    m_fOnAnimate               := nil;
+    m_fOnAnimationBegin        := nil;
+    m_fOnAnimationEnd          := nil;
+    m_fOnAnimationLoop         := nil;
+    m_fOnLoaded                := nil;
+
+    // create internal SVG object
+    m_pSVG              := TWSVG.Create;
+    m_pSVGRasterizer    := TWSVGGDIPlusRasterizer.Create(TWControlRenderer.GetGDIPlusToken);
+    m_pFrameCalculator  := TWSVGFrameCalculator.Create;
+    m_pFrameCache       := nil;
+    m_pBackBuffer       := nil;
+    m_pRenderThread     := nil;
+    m_pLoadThread       := nil;
+    m_pRetiredLoads     := ILoadThreads.Create;
+    m_pLoadedFrame      := nil;
+    m_pInteractionTimer := nil;
+
+    // link internal callbacks
+    m_pSVGRasterizer.OnAnimate  := DoAnimate;
+    m_pSVGRasterizer.OnGetImage := DoGetImage;
+
+    // set background transparent by default
+    Transparent := True;
+
+    // enable the animation support in the rasterizer for the entire graphic lifecycle. This is
+    // required to allow the graphic to work in a "marquee mode", where a frame position may be
+    // selected manually
+    m_pSVGRasterizer.EnableAnimation(True);
+
+    // attach to animation timer to receive time notifications
+    TWAnimationTimer.GetInstance.Attach(Self);
+
+    // nothing to animate yet, so don't receive time notifications for now
+    UpdateScheduling;
+end;
+//---------------------------------------------------------------------------
+destructor TWSVGGraphic.Destroy;
+begin
+    // unlink internal callbacks
+    m_pSVGRasterizer.OnAnimate := nil;
+
+    FreeAndNil(m_pInteractionTimer);
+
+    // detach from animation timer and stop to receive time notifications
+    TWAnimationTimer.GetInstance.Detach(Self);
+
+    // stop the render thread before the document it reads is released
+    FreeAndNil(m_pRenderThread);
+
+    // stop the load workers, their completion should no longer be notified. NOTE the ended workers
+    // are already released, so this only waits until the ones still running end, i.e. at worst
+    // until the document being parsed is loaded
+    CancelLoad;
+    FreeAndNil(m_pRetiredLoads);
+
+    FreeAndNil(m_pLoadedFrame);
+    FreeAndNil(m_pBackBuffer);
+    FreeAndNil(m_pFrameCache);
+    FreeAndNil(m_pFrameCalculator);
+    FreeAndNil(m_pSVGRasterizer);
+    FreeAndNil(m_pSVG);
+
+    inherited Destroy;
+end;
+//---------------------------------------------------------------------------
+function TWSVGGraphic.GetVersion: UnicodeString;
+begin
+    if (not Assigned(TWLibraryVersion)) then
+        Exit('#ERROR');
+
+    Result := TWLibraryVersion.ToStr;
+end;
+//---------------------------------------------------------------------------
+procedure TWSVGGraphic.WriteRawDataToStream(data: UnicodeString; pStream: TStream);
+var
+    pStrWriter: TStreamWriter;
+begin
+    pStrWriter := nil;
+
+    try
+        // write data to stream
+        pStrWriter := TStreamWriter.Create(pStream);
         pStrWriter.Write(data);
     finally
         pStrWriter.Free;
     end;
 end;
 //---------------------------------------------------------------------------
+function TWSVGGraphic.FillFrameCache(frameWidth, frameHeight: Integer): Boolean;
+var
+    animation: TWSVGRasterizer.IAnimation;
+    stopwatch: TStopwatch;
+    pOverlay:  Vcl.Graphics.TBitmap;
+begin
+    // render the frames again if the size or the drawing options changed
+    if (not Assigned(m_pFrameCache)
+            or not m_pFrameCache.Matches(frameWidth, frameHeight, m_Proportional, m_Antialiasing))
+    then
+    begin
+        TWTraceHelper.Instant('Frame cache miss', 'cache');
+
+        FreeAndNil(m_pFrameCache);
+
+        m_pFrameCache := IFrameCache.Create(frameWidth, frameHeight, m_Proportional, m_Antialiasing,
+                m_FrameCacheCompressed, m_FrameCacheLimit);
+    end;
+
+    // nothing to render?
+    if (m_pFrameCache.Rejected) then
+        Exit(False);
+
+    // already complete?
+    if (m_pFrameCache.Added >= m_pFrameCache.Count) then
+        Exit(True);
+
+    // the next frames are rendered on the playback bitmap, which is unused until the cache is complete
+    pOverlay                := m_pFrameCache.Bitmap;
+    animation.m_pCustomData := m_pCustomData;
+    stopwatch               := TStopwatch.StartNew;
+
+    // render the next frames until the budget is exhausted, at least one per draw, so the cache is
+    // filled over several draws instead of blocking the first one. NOTE the frames are added in order,
+    // because a compressed frame is encoded against the previous one
+    repeat
+        TWGDIHelper.Clear(pOverlay);
+
+        animation.m_Position := m_pFrameCache.Added / m_pFrameCache.Count;
+
+        m_pSVGRasterizer.Draw(m_pSVG, TRect.Create(0, 0, frameWidth, frameHeight), m_Proportional, m_Antialiasing,
+                animation, pOverlay.Canvas);
+
+        // memory limit exceeded? (the cache is rejected and the animation will be rasterized as usual)
+        if (not m_pFrameCache.Add(pOverlay)) then
+            Exit(False);
+    until ((m_pFrameCache.Added >= m_pFrameCache.Count)
+            or (stopwatch.ElapsedMilliseconds >= C_TWSVGGraphic_Frame_Cache_Budget));
+
+    Result := (m_pFrameCache.Added >= m_pFrameCache.Count);
+end;
+//---------------------------------------------------------------------------
+function TWSVGGraphic.GetFrameCacheSize: NativeUInt;
+begin
+    if (not Assigned(m_pFrameCache)) then
+        Exit(0);
+
+    Result := m_pFrameCache.Size;
+end;
+//---------------------------------------------------------------------------
+procedure TWSVGGraphic.DrawPartial(pCanvas: TCanvas; const rect: TRect);
+var
+    animation:               TWSVGRasterizer.IAnimation;
+    dirtyRect:               TRect;
+    frameWidth, frameHeight: Integer;
+    hBufferDC:               HDC;
+    savedDC:                 Integer;
+begin
+    frameWidth  := rect.Right  - rect.Left;
+    frameHeight := rect.Bottom - rect.Top;
+
+    // nothing to draw?
+    if ((frameWidth <= 0) or (frameHeight <= 0)) then
+        Exit;
+
+    // create the buffer again if the size or the drawing options changed
+    if (not Assigned(m_pBackBuffer)
+            or not m_pBackBuffer.Matches(frameWidth, frameHeight, m_Proportional, m_Antialiasing))
+    then
+    begin
+        FreeAndNil(m_pBackBuffer);
+        m_pBackBuffer := IBackBuffer.Create(frameWidth, frameHeight, m_Proportional, m_Antialiasing);
+    end;
+
+    // is the buffered frame outdated?
+    if (not m_pBackBuffer.m_Valid or (m_pBackBuffer.m_Position <> m_FramePos)) then
+    begin
+        // populate animation structure
+        animation.m_Position    := m_FramePos;
+        animation.m_pCustomData := m_pCustomData;
+
+        // can only the changed region be redrawn?
+        if (GetDirtyRect(frameWidth, frameHeight, dirtyRect)) then
+        begin
+            // nothing to redraw if no visible element changed, in this case the rasterizer state is
+            // already up to date from the measure
+            if (not dirtyRect.IsEmpty) then
+            begin
+                TWGDIHelper.Clear(m_pBackBuffer.m_pBitmap, dirtyRect);
+
+                hBufferDC := m_pBackBuffer.m_pBitmap.Canvas.Handle;
+                savedDC   := SaveDC(hBufferDC);
+
+                try
+                    // clip the drawing to the changed region, the rasterizer will also skip the
+                    // elements outside it
+                    IntersectClipRect(hBufferDC, dirtyRect.Left, dirtyRect.Top, dirtyRect.Right,
+                            dirtyRect.Bottom);
+                    m_pSVGRasterizer.ClipRect := dirtyRect;
+
+                    m_pSVGRasterizer.Draw(m_pSVG, TRect.Create(0, 0, frameWidth, frameHeight), m_Proportional,
+                            m_Antialiasing, animation, m_pBackBuffer.m_pBitmap.Canvas);
+                finally
+                    m_pSVGRasterizer.ClipRect := Default(TRect);
+                    RestoreDC(hBufferDC, savedDC);
+                end;
+            end;
+        end
+        else
+        begin
+            // redraw the whole frame
+            TWGDIHelper.Clear(m_pBackBuffer.m_pBitmap);
+
+            m_pSVGRasterizer.Draw(m_pSVG, TRect.Create(0, 0, frameWidth, frameHeight), m_Proportional,
+                    m_Antialiasing, animation, m_pBackBuffer.m_pBitmap.Canvas);
+        end;
+
+        m_pBackBuffer.Update(m_FramePos, m_pSVGRasterizer);
+    end;
+
+    m_pBackBuffer.Draw(pCanvas, rect.Left, rect.Top);
+
+    m_NextChange := m_pBackBuffer.m_NextChange;
+end;
+//---------------------------------------------------------------------------
+procedure TWSVGGraphic.UpdateScheduling;
+begin
+    if (m_Visible and m_Animate) then
+        TWAnimationTimer.GetTimer.Resume(Self)
+    else
+        TWAnimationTimer.GetTimer.Suspend(Self);
+end;
+//---------------------------------------------------------------------------
+class function TWSVGGraphic.GetDataHash(const data: UnicodeString): Integer;
+begin
+    {$if CompilerVersion >= 29}
+        Result := THashBobJenkins.GetHashValue(PChar(data)^, Length(data) * SizeOf(Char), 0);
+    {$else}
+        Result := BobJenkinsHash(PChar(data)^, Length(data) * SizeOf(Char), 0);
+    {$ifend}
+end;
+//---------------------------------------------------------------------------
+function TWSVGGraphic.GetLoading: Boolean;
+begin
+    Result := Assigned(m_pLoadThread);
+end;
+//---------------------------------------------------------------------------
+procedure TWSVGGraphic.OnLoadEnded(pSender: TObject);
+begin
+    if (not(pSender is ILoadThread)) then
+        Exit;
+
+    // release the cancelled or completed worker. NOTE its destructor waits until it ends, but it is
+    // already about to end here
+    m_pRetiredLoads.Remove(pSender as ILoadThread);
+end;
+//---------------------------------------------------------------------------
+procedure TWSVGGraphic.OnLoadCompleted(pSender: TObject);
+var
+    pThread: ILoadThread;
+    success: Boolean;
+begin
+    // the load may be completed after it was cancelled
+    if (not Assigned(m_pLoadThread) or (pSender <> m_pLoadThread)) then
+        Exit;
+
+    pThread       := m_pLoadThread;
+    m_pLoadThread := nil;
+    success       := pThread.m_Success;
+
+    // the worker is ending, it will be released once this function returns, as it is called from
+    // its notification
+    m_pRetiredLoads.Add(pThread);
+
+    // keep the previous svg if the new one could not be loaded
+    if (success) then
+    begin
+        // clear previous svg data
+        Clear;
+
+        // take the loaded svg and its first frame from the worker
+        m_pSVG.Free;
+        m_pSVG           := pThread.m_pSVG;
+        pThread.m_pSVG   := nil;
+        m_pLoadedFrame   := pThread.m_pFrame;
+        pThread.m_pFrame := nil;
+        m_Data           := pThread.m_Data;
+        m_DataHash       := pThread.m_DataHash;
+
+        // update image width, if needed
+        if (m_Width = 0) then
+            m_Width := pThread.m_Size.Width;
+
+        // update image height, if needed
+        if (m_Height = 0) then
+            m_Height := pThread.m_Size.Height;
+
+        m_Proportional := pThread.m_Proportional;
+        m_Opened       := True;
+        m_OnError      := False;
+
+        // notify that content has changed
+        Changed(Self);
+    end;
+
+    if (Assigned(m_fOnLoaded)) then
+        m_fOnLoaded(Self, success);
+end;
+//---------------------------------------------------------------------------
 procedure TWSVGGraphic.Draw(pCanvas: TCanvas; const rect: TRect);
 var
-    pageColor, borderColor: TWColor;
-    borderOpacity:          Single;
-    animation:              TWSVGRasterizer.IAnimation;
+    pageColor, borderColor:  TWColor;
+    borderOpacity:           Single;
+    animation:               TWSVGRasterizer.IAnimation;
+    frameWidth, frameHeight: Integer;
+    traceStart:              Int64;
 begin
+    traceStart := TWTraceHelper.Start;
+
     try
-        // no canvas?
-        if (not Assigned(pCanvas)) then
-            Exit;
+        try
+            // no canvas?
+            if (not Assigned(pCanvas)) then
+                Exit;
 
-        // is svg file or stream opened?
-        if (not m_Opened) then
-            Exit;
+            // is svg file or stream opened?
+            if (not m_Opened) then
+                Exit;
 
-        // is svg on error?
-        if (m_OnError) then
-            Exit;
+            // is svg on error?
+            if (m_OnError) then
+                Exit;
 
-        // is background transparent?
-        if (not Transparent) then
-        begin
-            // get page style
-            if (m_pSVGRasterizer.GetPageStyle(m_pSVG, pageColor, borderColor, borderOpacity)) then
+            // is background transparent?
+            if (not Transparent) then
             begin
-                // is page color empty?
-                if (pageColor.IsEmpty) then
+                // get page style
+                if (m_pSVGRasterizer.GetPageStyle(m_pSVG, pageColor, borderColor, borderOpacity)) then
+                begin
+                    // is page color empty?
+                    if (pageColor.IsEmpty) then
+                        // by default, set page color to white
+                        pageColor := TWColor.Create(clWhite);
+                end
+                else
                     // by default, set page color to white
                     pageColor := TWColor.Create(clWhite);
-            end
-            else
-                // by default, set page color to white
-                pageColor := TWColor.Create(clWhite);
-
-            // fill background
-            pCanvas.Brush.Color := pageColor.GetColor;
-            pCanvas.FillRect(rect);
-        end;
 
-        // populate animation structure
-        animation.m_Position    := m_FramePos;
-        animation.m_pCustomData := m_pCustomData;
+                // fill background
+                pCanvas.Brush.Color := pageColor.GetColor;
+                pCanvas.FillRect(rect);
+            end;
 
-        // draw svg to canvas
-        m_pSVGRasterizer.Draw(m_pSVG, rect, m_Proportional, m_Antialiasing, animation, pCanvas);
-    except
-        // catch exception
-        on e: Exception do
-        begin
-            // as the draw function may be called inside a message loop, don't try to draw again if
-            // an error occurred. Instead put the svg in panic mode
-            m_OnError := True;
+            // the next change is only known if the frame is fully rasterized
+            m_DrawnPos   := m_FramePos;
+            m_NextChange := m_FramePos;
 
-            TWLogHelper.LogToCompiler(e.Message);
+            // can the first frame rasterized while the svg was loaded be presented?
+            if (Assigned(m_pLoadedFrame)) then
+            begin
+                if (not m_Interacting and (m_pLoadedFrame.m_Position = m_FramePos)
+                        and m_pLoadedFrame.Matches(rect.Right - rect.Left, rect.Bottom - rect.Top,
+                                m_Proportional, m_Antialiasing)
+                        and m_pLoadedFrame.Draw(pCanvas, rect.Left, rect.Top))
+                then
+                begin
+                    m_NextChange := m_pLoadedFrame.m_NextChange;
+                    Exit;
+                end;
+
+                // the frame is useless once the svg is drawn differently
+                FreeAndNil(m_pLoadedFrame);
+            end;
+
+            // can the looping animation be played back from the pre-rendered frames?
+            if (m_FrameCache and m_Animate and m_AnimLoop and not m_Interacting) then
+            begin
+                frameWidth  := rect.Right  - rect.Left;
+                frameHeight := rect.Bottom - rect.Top;
+
+                // draw the frame matching with the current position, once all the frames were
+                // rendered. Until then the animation is drawn live below
+                if (FillFrameCache(frameWidth, frameHeight)
+                        and m_pFrameCache.Draw(Floor(m_FramePos * m_pFrameCache.Count), pCanvas, rect.Left,
+                                rect.Top))
+                then
+                    Exit;
+            end;
+
+            // can the animation frame be presented from the render thread? NOTE the OnAnimate handler
+            // may access the VCL or modify the animations, so it can only be called from the main
+            // thread, thus the frame is drawn synchronously if a handler is assigned
+            if (m_AsyncRendering and m_Animate and not m_Interacting and not Assigned(m_fOnAnimate)
+                    and DrawAsync(pCanvas, rect))
+            then
+                Exit;
+
+            // can the animation frame be redrawn partially over the previous one?
+            if (m_PartialRedraw and m_Animate and not m_Interacting) then
+            begin
+                DrawPartial(pCanvas, rect);
+                Exit;
+            end;
+
+            // populate animation structure
+            animation.m_Position    := m_FramePos;
+            animation.m_pCustomData := m_pCustomData;
+
+            // draw svg to canvas
+            m_pSVGRasterizer.Draw(m_pSVG, rect, m_Proportional, m_Antialiasing, animation, pCanvas);
+
+            // keep the position at which the drawn frame will change, the elements skipped in draft
+            // quality may hide a change
+            if (not m_Interacting) then
+                m_NextChange := m_pSVGRasterizer.NextChange;
+        except
+            // catch exception
+            on e: Exception do
+            begin
+                // as the draw function may be called inside a message loop, don't try to draw again if
+                // an error occurred. Instead put the svg in panic mode
+                m_OnError := True;
+
+                TWLogHelper.LogToCompiler(e.Message);
+            end;
         end;
+    finally
+        TWTraceHelper.Stop('Graphic draw', 'graphic', traceStart);
     end;
 end;
 //---------------------------------------------------------------------------
@@ -748,43 +2855,177 @@ begin
     Result := m_pSVGRasterizer.GetAnimationDuration(m_pSVG);
 end;
 //---------------------------------------------------------------------------
-procedure TWSVGGraphic.SetAnimLoop(value: Boolean);
+procedure TWSVGGraphic.SetAnimLoop(value: Boolean);
+begin
+    m_AnimLoop := value;
+end;
+//---------------------------------------------------------------------------
+procedure TWSVGGraphic.SetAnimLoopCount(value: Cardinal);
+begin
+    m_AnimLoopCount := value;
+end;
+//---------------------------------------------------------------------------
+function TWSVGGraphic.GetFrameCount: Cardinal;
+begin
+    Result := Round(m_pFrameCalculator.FrameCount);
+end;
+//---------------------------------------------------------------------------
+procedure TWSVGGraphic.SetFrameCount(count: Cardinal);
+begin
+    m_pFrameCalculator.FrameCount := count;
+end;
+//---------------------------------------------------------------------------
+procedure TWSVGGraphic.SetAnimate(value: Boolean);
+begin
+    // nothing to change?
+    if (m_Animate = value) then
+        Exit;
+
+    m_Animate := value;
+
+    UpdateScheduling;
+
+    // run the animation, if needed
+    if (m_Animate) then
+    begin
+        RunAnimation;
+        Exit;
+    end;
+
+    // invalidate the owning control (if any)
+    Changed(Self);
+end;
+//---------------------------------------------------------------------------
+procedure TWSVGGraphic.SetVisible(value: Boolean);
+begin
+    // nothing to change?
+    if (m_Visible = value) then
+        Exit;
+
+    m_Visible := value;
+
+    UpdateScheduling;
+end;
+//---------------------------------------------------------------------------
+procedure TWSVGGraphic.SetFrameRate(value: Cardinal);
+begin
+    m_FrameRate := value;
+
+    TWAnimationTimer.GetTimer.SetFrameRate(Self, m_FrameRate);
+end;
+//---------------------------------------------------------------------------
+procedure TWSVGGraphic.SetFrameCache(value: Boolean);
+begin
+    // nothing to change?
+    if (m_FrameCache = value) then
+        Exit;
+
+    m_FrameCache := value;
+
+    // release the frames, they will be rendered again on the next draw if required
+    FreeAndNil(m_pFrameCache);
+end;
+//---------------------------------------------------------------------------
+procedure TWSVGGraphic.SetFrameCacheLimit(value: NativeUInt);
+begin
+    // nothing to change?
+    if (m_FrameCacheLimit = value) then
+        Exit;
+
+    m_FrameCacheLimit := value;
+
+    FreeAndNil(m_pFrameCache);
+end;
+//---------------------------------------------------------------------------
+procedure TWSVGGraphic.SetFrameCacheCompressed(value: Boolean);
+begin
+    // nothing to change?
+    if (m_FrameCacheCompressed = value) then
+        Exit;
+
+    m_FrameCacheCompressed := value;
+
+    FreeAndNil(m_pFrameCache);
+end;
+//---------------------------------------------------------------------------
+function TWSVGGraphic.DrawAsync(pCanvas: TCanvas; const rect: TRect): Boolean;
+var
+    framePos, frameTime, nextChange: Double;
 begin
-    m_AnimLoop := value;
+    if (not Assigned(m_pRenderThread)) then
+        m_pRenderThread := IRenderThread.Create(m_pSVG, OnFrameReady);
+
+    // draw the latest completed frame, if it matches with the draw rect
+    if (m_pRenderThread.Present(pCanvas, rect, m_Proportional, m_Antialiasing, framePos, frameTime, nextChange))
+    then
+    begin
+        // measure the latency once per presented frame
+        if (frameTime <> m_PresentedTime) then
+        begin
+            m_PresentedTime := frameTime;
+            m_FrameLatency  := TWAnimationTimer.GetTimer.Clock.GetTime - frameTime;
+        end;
+
+        m_DrawnPos   := framePos;
+        m_NextChange := nextChange;
+
+        // is the presented frame late? (e.g. the graphic was invalidated for another reason)
+        if (framePos <> m_FramePos) then
+            m_pRenderThread.Request(m_FramePos, TWAnimationTimer.GetTimer.Clock.GetTime, m_pCustomData);
+
+        Exit(True);
+    end;
+
+    // no frame was rendered for this size yet. Request one, the current frame will be drawn synchronously
+    m_pRenderThread.Request(m_FramePos, TWAnimationTimer.GetTimer.Clock.GetTime, m_pCustomData);
+    Result := False;
 end;
 //---------------------------------------------------------------------------
-procedure TWSVGGraphic.SetAnimLoopCount(value: Cardinal);
+procedure TWSVGGraphic.SetAsyncRendering(value: Boolean);
 begin
-    m_AnimLoopCount := value;
+    // nothing to change?
+    if (m_AsyncRendering = value) then
+        Exit;
+
+    m_AsyncRendering := value;
+
+    // the worker is created again on the next draw if required
+    FreeAndNil(m_pRenderThread);
 end;
 //---------------------------------------------------------------------------
-function TWSVGGraphic.GetFrameCount: Cardinal;
+function TWSVGGraphic.GetDroppedFrames: Cardinal;
 begin
-    Result := Round(m_pFrameCalculator.FrameCount);
+    if (not Assigned(m_pRenderThread)) then
+        Exit(0);
+
+    Result := m_pRenderThread.DroppedFrames;
 end;
 //---------------------------------------------------------------------------
-procedure TWSVGGraphic.SetFrameCount(count: Cardinal);
+procedure TWSVGGraphic.OnFrameReady(pSender: TObject);
 begin
-    m_pFrameCalculator.FrameCount := count;
+    // the frame may be completed after the async rendering was stopped
+    if (not m_AsyncRendering) then
+        Exit;
+
+    // invalidate the owner, in the same way as when the animation timer requests it
+    m_FrameChanging := True;
+
+    try
+        Changed(Self);
+    finally
+        m_FrameChanging := False;
+    end;
 end;
 //---------------------------------------------------------------------------
-procedure TWSVGGraphic.SetAnimate(value: Boolean);
+procedure TWSVGGraphic.SetPartialRedraw(value: Boolean);
 begin
     // nothing to change?
-    if (m_Animate = value) then
+    if (m_PartialRedraw = value) then
         Exit;
 
-    m_Animate := value;
-
-    // run the animation, if needed
-    if (m_Animate) then
-    begin
-        RunAnimation;
-        Exit;
-    end;
+    m_PartialRedraw := value;
 
-    // invalidate the owning control (if any)
-    Changed(Self);
+    FreeAndNil(m_pBackBuffer);
 end;
 //---------------------------------------------------------------------------
 function TWSVGGraphic.DoAnimate(pAnimDesc: TWSVGAnimationDescriptor; pCustomData: Pointer): Boolean;
@@ -870,6 +3111,8 @@ begin
     begin
         m_Animate := False;
 
+        UpdateScheduling;
+
         // animation aborted, notify that animation ends
         if (Assigned(m_fOnAnimationEnd)) then
             m_fOnAnimationEnd(Self);
@@ -945,13 +3188,27 @@ procedure TWSVGGraphic.OnProcessAnimation;
 begin
     CalculateNextFrame;
 
-    // calling the Changed() function force any component owning this graphic, like e.g. a TImage,
-    // to invaliate itself. So the animation may be processed in this case without having to keep
-    // a pointer on a such component
-    Changed(Self);
+    // is the drawn frame still identical to the new one? In this case there is nothing to repaint
+    if (m_SkipStaticFrames and m_Animate and (m_FramePos >= m_DrawnPos) and (m_FramePos < m_NextChange)) then
+        Exit;
+
+    // is the frame rendered in the background? In this case the owner is invalidated once the
+    // frame is completed
+    if (m_AsyncRendering and Assigned(m_pRenderThread) and not m_Interacting) then
+        m_pRenderThread.Request(m_FramePos, TWAnimationTimer.GetTimer.Clock.GetTime, m_pCustomData)
+    else
+        // the owner should be invalidated, however the request is sent to the animation timer,
+        // which will coalesce it with the other requests and notify the graphic once the tick is
+        // completed
+        TWAnimationTimer.GetTimer.Invalidate(Self);
+
+    // stop to receive time notifications if the animation ended
+    UpdateScheduling;
 end;
 //---------------------------------------------------------------------------
 procedure TWSVGGraphic.OnNotified(message: TWMessage);
+var
+    traceStart: Int64;
 begin
     case (TWAnimationTimer.EWAnimationTimerMessages(message.m_Type)) of
         TWAnimationTimer.EWAnimationTimerMessages.IE_AM_Animate:
@@ -961,6 +3218,23 @@ begin
 
             OnProcessAnimation;
         end;
+
+        TWAnimationTimer.EWAnimationTimerMessages.IE_AM_Invalidate:
+        begin
+            // calling the Changed() function force any component owning this graphic, like e.g. a
+            // TImage, to invaliate itself. So the animation may be processed in this case without
+            // having to keep a pointer on a such component. The owner may also check FrameChanging
+            // to invalidate the changed region only
+            m_FrameChanging := True;
+            traceStart      := TWTraceHelper.Start;
+
+            try
+                Changed(Self);
+            finally
+                m_FrameChanging := False;
+                TWTraceHelper.Stop('Invalidate', 'graphic', traceStart);
+            end;
+        end;
     end;
 end;
 //---------------------------------------------------------------------------
@@ -969,6 +3243,7 @@ begin
     m_Width              := 0;
     m_Height             := 0;
     m_FramePos           := C_TWSVGGraphic_Default_FramePosition;
+    m_NextChange         := 0.0;
     m_AnimSpeed          := 1.0;
     m_PerformedAnimLoops := 0;
     m_AnimLoopCount      := 0;
@@ -981,33 +3256,39 @@ begin
     m_OnError            := False;
     m_pCustomData        := nil;
     m_Data               := '';
+    m_DataHash           := 0;
+
+    CancelLoad;
+
+    FreeAndNil(m_pRenderThread);
+    FreeAndNil(m_pLoadedFrame);
+    FreeAndNil(m_pFrameCache);
+    FreeAndNil(m_pBackBuffer);
 
     m_pSVG.Parser.Clear;
 
+    UpdateScheduling;
+
     // notify that content has changed
     Changed(Self);
 end;
 //---------------------------------------------------------------------------
-procedure TWSVGGraphic.Assign(pOther: TPersistent);
+procedure TWSVGGraphic.AssignFrom(pSource: TWSVGGraphic; move: Boolean);
 var
-    pSource: TWSVGGraphic;
+    pSVG: TWSVG;
 begin
-    // found it?
-    if (not Assigned(pOther) or not(pOther is TWSVGGraphic)) then
-    begin
-        // clear previous svg data
-        Clear;
-        Exit;
-    end;
-
-    // get source object to copy from
-    pSource := pOther as TWSVGGraphic;
+    // the copied svg supersedes the one being loaded, if any
+    CancelLoad;
+    FreeAndNil(m_pLoadedFrame);
 
     // copy data from source
     m_Data              := pSource.m_Data;
+    m_DataHash          := pSource.m_DataHash;
     m_Width             := pSource.m_Width;
     m_Height            := pSource.m_Height;
     m_FramePos          := pSource.m_FramePos;
+    m_NextChange        := 0.0;
+    m_SkipStaticFrames  := pSource.m_SkipStaticFrames;
     m_AnimSpeed         := pSource.m_AnimSpeed;
     m_AnimLoopCount     := pSource.m_AnimLoopCount;
     m_AnimLoop          := pSource.m_AnimLoop;
@@ -1017,7 +3298,40 @@ begin
     m_ForceOriginalSave := pSource.m_ForceOriginalSave;
     m_Opened            := pSource.m_Opened;
     m_OnError           := pSource.m_OnError;
-    m_pSVG.Assign(pSource.m_pSVG);
+
+    // the render thread should be stopped before the document it reads changes
+    FreeAndNil(m_pRenderThread);
+    m_AsyncRendering := pSource.m_AsyncRendering;
+
+    if (move) then
+    begin
+        // same for the source render thread, as its document is taken
+        FreeAndNil(pSource.m_pRenderThread);
+
+        // swap the documents, the previous one will be released while the source is cleared
+        pSVG           := m_pSVG;
+        m_pSVG         := pSource.m_pSVG;
+        pSource.m_pSVG := pSVG;
+
+        // the frame rasterized while the source was loaded remains valid
+        m_pLoadedFrame         := pSource.m_pLoadedFrame;
+        pSource.m_pLoadedFrame := nil;
+    end
+    else
+        m_pSVG.Assign(pSource.m_pSVG);
+
+    // the cached frames aren't shared, they will be rendered again on the next draw if required
+    FreeAndNil(m_pFrameCache);
+    m_FrameCache           := pSource.m_FrameCache;
+    m_FrameCacheCompressed := pSource.m_FrameCacheCompressed;
+    m_FrameCacheLimit      := pSource.m_FrameCacheLimit;
+
+    // same for the partially redrawn frame
+    FreeAndNil(m_pBackBuffer);
+    m_PartialRedraw := pSource.m_PartialRedraw;
+
+    SetFrameRate(pSource.m_FrameRate);
+    UpdateScheduling;
 
     m_pSVGRasterizer.EnableAnimation(pSource.m_pSVGRasterizer.IsAnimationEnabled);
 
@@ -1025,6 +3339,33 @@ begin
     Changed(Self);
 end;
 //---------------------------------------------------------------------------
+procedure TWSVGGraphic.Assign(pOther: TPersistent);
+begin
+    // found it?
+    if (not Assigned(pOther) or not(pOther is TWSVGGraphic)) then
+    begin
+        // clear previous svg data
+        Clear;
+        Exit;
+    end;
+
+    AssignFrom(pOther as TWSVGGraphic, False);
+end;
+//---------------------------------------------------------------------------
+procedure TWSVGGraphic.MoveFrom(pSource: TWSVGGraphic);
+begin
+    if (not Assigned(pSource) or (pSource = Self)) then
+        Exit;
+
+    // the source load, if any, cannot complete once its content is taken
+    pSource.CancelLoad;
+
+    AssignFrom(pSource, True);
+
+    // release the previous document, now owned by the source
+    pSource.Clear;
+end;
+//---------------------------------------------------------------------------
 procedure TWSVGGraphic.LoadFromStr(str: UnicodeString);
 var
     pStrStream: TStringStream;
@@ -1067,6 +3408,9 @@ begin
 
         // keep the XML data, this is required to save back the SVG content, or to copy to clipboard
         m_Data := pStrStream.DataString;
+
+        // identify the document content, e.g. to share its rasterized glyphs
+        m_DataHash := GetDataHash(m_Data);
     finally
         pStrStream.Free;
     end;
@@ -1098,6 +3442,37 @@ begin
     Changed(Self);
 end;
 //---------------------------------------------------------------------------
+procedure TWSVGGraphic.LoadFromFileAsync(const fileName: TFileName; width: Integer; height: Integer;
+        proportional: Boolean);
+begin
+    // the previous load, if any, is superseded
+    CancelLoad;
+
+    m_pLoadThread := ILoadThread.Create(nil, fileName, width, height, proportional, OnLoadCompleted,
+            OnLoadEnded);
+end;
+//---------------------------------------------------------------------------
+procedure TWSVGGraphic.LoadFromStreamAsync(pStream: TStream; width: Integer; height: Integer;
+        proportional: Boolean);
+begin
+    // the previous load, if any, is superseded
+    CancelLoad;
+
+    m_pLoadThread := ILoadThread.Create(pStream, '', width, height, proportional, OnLoadCompleted,
+            OnLoadEnded);
+end;
+//---------------------------------------------------------------------------
+procedure TWSVGGraphic.CancelLoad;
+begin
+    if (not Assigned(m_pLoadThread)) then
+        Exit;
+
+    // ask the worker to stop without waiting for it, it will be released as soon as it ends
+    m_pLoadThread.Terminate;
+    m_pRetiredLoads.Add(m_pLoadThread);
+    m_pLoadThread := nil;
+end;
+//---------------------------------------------------------------------------
 procedure TWSVGGraphic.SaveToStream(pStream: TStream);
 var
     {$if defined (WTCONTROLS_LOG) and defined (ENABLE_SVG_GRAPHIC_LOGGING)}
@@ -1403,6 +3778,7 @@ begin
     m_PerformedAnimLoops := 0;
     m_Animate            := True;
 
+    UpdateScheduling;
     RunAnimation;
 end;
 //---------------------------------------------------------------------------
@@ -1411,6 +3787,338 @@ begin
     m_pCustomData := pCustomData;
 end;
 //---------------------------------------------------------------------------
+procedure TWSVGGraphic.BeginInteraction;
+begin
+    // the interaction ends once no event was notified for the interaction delay. A dedicated timer
+    // is used, because the animation timer doesn't notify a static graphic
+    if (not Assigned(m_pInteractionTimer)) then
+    begin
+        m_pInteractionTimer          := TTimer.Create(nil);
+        m_pInteractionTimer.Enabled  := False;
+        m_pInteractionTimer.Interval := C_TWSVGGraphic_Interaction_Delay;
+        m_pInteractionTimer.OnTimer  := OnInteractionTimer;
+    end;
+
+    // restart the delay
+    m_pInteractionTimer.Enabled := False;
+    m_pInteractionTimer.Enabled := True;
+
+    // already interacting?
+    if (m_Interacting) then
+        Exit;
+
+    m_Interacting            := True;
+    m_pSVGRasterizer.Quality := TWSVGRasterizer.IERenderQuality.IE_RQ_Draft;
+end;
+//---------------------------------------------------------------------------
+procedure TWSVGGraphic.EndInteraction;
+begin
+    // not interacting?
+    if (not m_Interacting) then
+        Exit;
+
+    if (Assigned(m_pInteractionTimer)) then
+        m_pInteractionTimer.Enabled := False;
+
+    m_Interacting            := False;
+    m_pSVGRasterizer.Quality := TWSVGRasterizer.IERenderQuality.IE_RQ_Full;
+
+    // redraw the graphic in full quality
+    Changed(Self);
+end;
+//---------------------------------------------------------------------------
+procedure TWSVGGraphic.OnInteractionTimer(pSender: TObject);
+begin
+    EndInteraction;
+end;
+//---------------------------------------------------------------------------
+function TWSVGGraphic.GetDirtyRect(width, height: Integer; out rect: TRect): Boolean;
+var
+    animation: TWSVGRasterizer.IAnimation;
+    newRect:   TRect;
+begin
+    rect := Default(TRect);
+
+    // no frame was drawn in the buffer, or it was drawn with another size?
+    if (not m_PartialRedraw or not Assigned(m_pBackBuffer) or not m_pBackBuffer.m_Valid
+            or (m_pBackBuffer.m_Width <> width) or (m_pBackBuffer.m_Height <> height))
+    then
+        Exit(False);
+
+    // the regions changed by the last drawn frame are unknown?
+    if (m_pBackBuffer.m_AnimatedAll) then
+        Exit(False);
+
+    // buffered frame is already the current one?
+    if (m_pBackBuffer.m_Position = m_FramePos) then
+        Exit(True);
+
+    // region was already measured for the current position?
+    if (m_pBackBuffer.m_PendingValid and (m_pBackBuffer.m_PendingPos = m_FramePos)) then
+    begin
+        rect := m_pBackBuffer.m_PendingRect;
+        Exit(True);
+    end;
+
+    // populate animation structure
+    animation.m_Position    := m_FramePos;
+    animation.m_pCustomData := m_pCustomData;
+
+    // measure the animated elements at the current position, without drawing them
+    m_pSVGRasterizer.MeasureOnly := True;
+
+    try
+        m_pSVGRasterizer.Draw(m_pSVG, TRect.Create(0, 0, width, height), m_Proportional, m_Antialiasing,
+                animation, m_pBackBuffer.m_pScratch.Canvas);
+    finally
+        m_pSVGRasterizer.MeasureOnly := False;
+    end;
+
+    // an animated element cannot be measured?
+    if (m_pSVGRasterizer.DirtyAll) then
+        Exit(False);
+
+    // both the old and the new location of the animated elements should be redrawn
+    rect    := m_pBackBuffer.m_AnimatedRect;
+    newRect := m_pSVGRasterizer.DirtyRect;
+
+    if (rect.IsEmpty) then
+        rect := newRect
+    else
+    if (not newRect.IsEmpty) then
+        rect.Union(newRect);
+
+    // limit the region to the buffer surface
+    if (not rect.IsEmpty) then
+        rect := TRect.Intersect(rect, TRect.Create(0, 0, width, height));
+
+    m_pBackBuffer.m_PendingRect  := rect;
+    m_pBackBuffer.m_PendingPos   := m_FramePos;
+    m_pBackBuffer.m_PendingValid := True;
+
+    Result := True;
+end;
+//---------------------------------------------------------------------------
+function TWSVGGraphic.GetMemorySize: NativeUInt;
+begin
+    Result := InstanceSize + TWMemoryHelper.GetStringSize(m_Data);
+
+    if (Assigned(m_pSVG)) then
+        Inc(Result, m_pSVG.GetMemorySize);
+
+    if (Assigned(m_pSVGRasterizer)) then
+        Inc(Result, m_pSVGRasterizer.InstanceSize);
+
+    // measure the frame cache, the compressed or raw frames are already counted in its size
+    if (Assigned(m_pFrameCache)) then
+        Inc(Result, m_pFrameCache.InstanceSize + m_pFrameCache.m_Size
+                + (NativeUInt(Length(m_pFrameCache.m_Pixels)) * SizeOf(Cardinal))
+                + TWMemoryHelper.GetBitmapSize(m_pFrameCache.m_pBitmap));
+
+    // measure the first frame rasterized while the svg was loaded
+    if (Assigned(m_pLoadedFrame)) then
+        Inc(Result, m_pLoadedFrame.InstanceSize + TWMemoryHelper.GetBitmapSize(m_pLoadedFrame.m_pBitmap)
+                + TWMemoryHelper.GetBitmapSize(m_pLoadedFrame.m_pScratch));
+
+    // measure the partial redraw back buffer
+    if (Assigned(m_pBackBuffer)) then
+        Inc(Result, m_pBackBuffer.InstanceSize + TWMemoryHelper.GetBitmapSize(m_pBackBuffer.m_pBitmap)
+                + TWMemoryHelper.GetBitmapSize(m_pBackBuffer.m_pScratch));
+
+    // measure the background renderer, which owns its own SVG copy and buffers
+    if (Assigned(m_pRenderThread)) then
+    begin
+        m_pRenderThread.m_pLock.Enter;
+
+        try
+            Inc(Result, m_pRenderThread.InstanceSize + m_pRenderThread.m_pSVG.GetMemorySize
+                    + TWMemoryHelper.GetBitmapSize(m_pRenderThread.m_pFrontBuffer)
+                    + TWMemoryHelper.GetBitmapSize(m_pRenderThread.m_pBackBuffer));
+        finally
+            m_pRenderThread.m_pLock.Leave;
+        end;
+    end;
+end;
+//---------------------------------------------------------------------------
+// TWSVGGlyphCache.IGlyph
+//---------------------------------------------------------------------------
+constructor TWSVGGlyphCache.IGlyph.Create(const data: UnicodeString; dpi: Integer);
+begin
+    inherited Create;
+
+    m_pBitmap := nil;
+    m_Data    := data;
+    m_DPI     := dpi;
+    m_LastUse := 0;
+end;
+//---------------------------------------------------------------------------
+destructor TWSVGGlyphCache.IGlyph.Destroy;
+begin
+    FreeAndNil(m_pBitmap);
+
+    inherited Destroy;
+end;
+//---------------------------------------------------------------------------
+// TWSVGGlyphCache
+//---------------------------------------------------------------------------
+class function TWSVGGlyphCache.GetKey(pSVG: TWSVGGraphic; state, width, height, dpi: Integer): UnicodeString;
+var
+    options: Integer;
+begin
+    // the drawing options also change the rasterized glyph
+    options := Ord(pSVG.Proportional) or (Ord(pSVG.Antialiasing) shl 1) or (Ord(pSVG.Transparent) shl 2);
+
+    Result := Format('%d:%d:%d:%d:%dx%d:%d', [pSVG.DataHash, Length(pSVG.Data), options, state, width,
+            height, dpi]);
+end;
+//---------------------------------------------------------------------------
+class function TWSVGGlyphCache.Rasterize(pSVG: TWSVGGraphic; width, height, dpi: Integer): IGlyph;
+begin
+    Result := IGlyph.Create(pSVG.Data, dpi);
+
+    try
+        // animated glyphs change over time, so they cannot be cached
+        if (pSVG.AnimationDuration > 0) then
+            Exit;
+
+        Result.m_pBitmap             := Vcl.Graphics.TBitmap.Create;
+        Result.m_pBitmap.PixelFormat := pf32bit;
+        Result.m_pBitmap.AlphaFormat := afPremultiplied;
+        Result.m_pBitmap.SetSize(width, height);
+        TWGDIHelper.Clear(Result.m_pBitmap);
+
+        Result.m_pBitmap.Canvas.StretchDraw(TRect.Create(0, 0, width, height), pSVG);
+    except
+        Result.Free;
+        raise;
+    end;
+end;
+//---------------------------------------------------------------------------
+class procedure TWSVGGlyphCache.EvictOldest;
+var
+    pair:      TPair<UnicodeString, IGlyph>;
+    oldestKey: UnicodeString;
+    oldestUse: UInt64;
+begin
+    if (m_pGlyphs.Count = 0) then
+        Exit;
+
+    oldestUse := High(UInt64);
+
+    // search for the least recently drawn glyph. NOTE the cache is small, and this only happens on a
+    // cache miss, which rasterizes a SVG anyway
+    for pair in m_pGlyphs do
+        if (pair.Value.m_LastUse < oldestUse) then
+        begin
+            oldestKey := pair.Key;
+            oldestUse := pair.Value.m_LastUse;
+        end;
+
+    // NOTE the dictionary will take care to free the glyph
+    m_pGlyphs.Remove(oldestKey);
+end;
+//---------------------------------------------------------------------------
+class procedure TWSVGGlyphCache.Draw(pCanvas: TCanvas; const rect: TRect; pGraphic: TGraphic;
+        state, dpi: Integer);
+var
+    pSVG:          TWSVGGraphic;
+    pGlyph:        IGlyph;
+    key:           UnicodeString;
+    width, height: Integer;
+begin
+    if (not Assigned(pCanvas) or not Assigned(pGraphic)) then
+        Exit;
+
+    width  := rect.Right  - rect.Left;
+    height := rect.Bottom - rect.Top;
+
+    // only the SVG graphics are cached
+    if (not Assigned(m_pGlyphs) or not (pGraphic is TWSVGGraphic) or (width <= 0) or (height <= 0)) then
+    begin
+        pCanvas.StretchDraw(rect, pGraphic);
+        Exit;
+    end;
+
+    pSVG := TWSVGGraphic(pGraphic);
+    key  := GetKey(pSVG, state, width, height, dpi);
+
+    // the key only contains the source hash, so a cached glyph is reused only if its source matches.
+    // NOTE the strings share the same buffer in most cases, so the comparison is usually immediate
+    if (m_pGlyphs.TryGetValue(key, pGlyph) and (pGlyph.m_Data <> pSVG.Data)) then
+    begin
+        m_pGlyphs.Remove(key);
+        pGlyph := nil;
+    end;
+
+    // glyph not cached yet?
+    if (not Assigned(pGlyph)) then
+    begin
+        TWTraceHelper.Instant('Glyph cache miss', 'cache');
+
+        // a full cache releases its least recently drawn glyph
+        if (m_pGlyphs.Count >= C_TWSVGGlyphCache_Max_Glyphs) then
+            EvictOldest;
+
+        pGlyph := Rasterize(pSVG, width, height, dpi);
+        m_pGlyphs.Add(key, pGlyph);
+    end;
+
+    Inc(m_UseCount);
+    pGlyph.m_LastUse := m_UseCount;
+
+    // animated glyph? Draw it as usual
+    if (not Assigned(pGlyph.m_pBitmap)) then
+    begin
+        pCanvas.StretchDraw(rect, pGraphic);
+        Exit;
+    end;
+
+    // draw the cached glyph on the final canvas
+    TWGDIHelper.AlphaBlendImage(pGlyph.m_pBitmap, width, height, pCanvas, rect.Left, rect.Top, width, height);
+end;
+//---------------------------------------------------------------------------
+class procedure TWSVGGlyphCache.Invalidate(dpi: Integer);
+var
+    pKeys: IWSmartPointer<TList<UnicodeString>>;
+    pair:  TPair<UnicodeString, IGlyph>;
+    key:   UnicodeString;
+begin
+    if (not Assigned(m_pGlyphs)) then
+        Exit;
+
+    pKeys := TWSmartPointer<TList<UnicodeString>>.Create();
+
+    // get the glyphs rasterized for this DPI
+    for pair in m_pGlyphs do
+        if (pair.Value.m_DPI = dpi) then
+            pKeys.Add(pair.Key);
+
+    // remove them. NOTE the dictionary will take care to free the glyphs
+    for key in pKeys do
+        m_pGlyphs.Remove(key);
+end;
+//---------------------------------------------------------------------------
+class procedure TWSVGGlyphCache.Clear;
+begin
+    if (not Assigned(m_pGlyphs)) then
+        Exit;
+
+    m_pGlyphs.Clear;
+end;
+//---------------------------------------------------------------------------
+class function TWSVGGlyphCache.GetMemorySize: NativeUInt;
+var
+    pGlyph: IGlyph;
+begin
+    if (not Assigned(m_pGlyphs)) then
+        Exit(0);
+
+    Result := m_pGlyphs.InstanceSize;
+
+    for pGlyph in m_pGlyphs.Values do
+        Inc(Result, pGlyph.InstanceSize + TWMemoryHelper.GetBitmapSize(pGlyph.m_pBitmap));
+end;
+//---------------------------------------------------------------------------
 
 initialization
 //---------------------------------------------------------------------------
@@ -1419,6 +4127,10 @@ initialization
 begin
     // register the SVG filter
     g_pSVGGraphicFilter := TWSVGGraphicFilter.Create;
+
+    // create the shared glyph cache, and report its memory in the process memory summary
+    TWSVGGlyphCache.m_pGlyphs := TObjectDictionary<UnicodeString, TWSVGGlyphCache.IGlyph>.Create([doOwnsValues]);
+    TWMemoryHelper.RegisterReporter('SVG glyph cache', TWSVGGlyphCache.GetMemorySize);
 end;
 //---------------------------------------------------------------------------
 
@@ -1429,6 +4141,10 @@ finalization
 begin
     // release the SVG filter
     g_pSVGGraphicFilter.Free;
+
+    // release the shared glyph cache
+    TWMemoryHelper.UnregisterReporter('SVG glyph cache');
+    FreeAndNil(TWSVGGlyphCache.m_pGlyphs);
 end;
 //---------------------------------------------------------------------------
 
@@ -12,7 +12,10 @@ uses System.Classes,
      System.SysUtils,
      System.Math,
      Vcl.Graphics,
+     Vcl.Controls,
      Vcl.ExtCtrls,
+     Winapi.Windows,
+     Winapi.Messages,
      UTWMajorSettings,
      UTWAnimationTimer,
      UTWSVGAnimationDescriptor,
@@ -107,8 +110,11 @@ type
         private
             m_ImgGUID:              UnicodeString;
             m_pAnimationProps:      IAnimationProps;
+            m_pLoadingSVG:          TWSVGGraphic;
             m_fOnAnimate:           ITfSVGAnimateEvent;
+            m_fOnLoaded:            TWSVGGraphic.ITfLoadedEvent;
             m_fPrevOnPictureChange: TNotifyEvent;
+            m_DirtyInvalidated:     Boolean;
 
             {**
              Get the library version
@@ -116,6 +122,31 @@ type
             }
             function GetVersion: UnicodeString;
 
+            {**
+             Windows visibility changed message override
+             @param(message @bold([in, out]) Windows message, may contains result on function ends)
+            }
+            procedure CMVisibleChanged(var message: TMessage); message CM_VISIBLECHANGED;
+
+            {**
+             Get if a SVG is being loaded asynchronously
+             @returns(@true if a SVG is being loaded, otherwise @false)
+            }
+            function GetLoading: Boolean;
+
+            {**
+             Set the OnAnimate event
+             @param(fValue Event to set)
+            }
+            procedure SetOnAnimate(fValue: ITfSVGAnimateEvent);
+
+            {**
+             Get the size the first frame of a SVG loaded asynchronously should be rasterized for
+             @param(width @bold([out]) Frame width, 0 if the SVG width should be used)
+             @param(height @bold([out]) Frame height, 0 if the SVG height should be used)
+            }
+            procedure GetLoadFrameSize(out width, height: Integer);
+
         protected
             {**
              Called when the frame count should be set to properties
@@ -170,6 +201,20 @@ type
             }
             procedure OnPictureChange(pSender: TObject); virtual;
 
+            {**
+             Get the SVG graphic in which a SVG should be loaded asynchronously
+             @returns(The picture graphic if it's a SVG, otherwise a separate SVG graphic, moved to
+                      the picture once loaded)
+            }
+            function GetLoadTarget: TWSVGGraphic; virtual;
+
+            {**
+             Called when a SVG loaded asynchronously is ready, or could not be loaded
+             @param(pSender Event sender)
+             @param(success If @true, the SVG was loaded, otherwise the previous picture is kept)
+            }
+            procedure OnSVGLoaded(pSender: TObject; success: Boolean); virtual;
+
         public
             {**
              Constructor
@@ -182,6 +227,54 @@ type
             }
             destructor Destroy; override;
 
+            {**
+             Invalidate the control
+             @br @bold(NOTE) While a new animation frame is about to be drawn, the invalidation is
+                             batched by the animation timer, so all the images of the same parent
+                             are invalidated at once. Nothing is invalidated if only the region
+                             changed by the frame was already invalidated
+            }
+            procedure Invalidate; override;
+
+            {**
+             Load a SVG file asynchronously. The file is read, parsed and rasterized in a worker
+             thread, while the previous picture is still shown, then the picture is replaced and the
+             OnLoaded event is called
+             @param(fileName SVG file to load)
+             @param(width Width the SVG will be drawn at, if 0 it's deduced from the image options)
+             @param(height Height the SVG will be drawn at, if 0 it's deduced from the image options)
+             @param(proportional Proportional option the SVG will be drawn with)
+             @br @bold(NOTE) A load still running is cancelled, thus the last requested file is shown
+                             while browsing quickly between several files. The first frame rendered
+                             while loading is only shown if the SVG size and options aren't changed
+                             once loaded, see TWSVGGraphic.LoadFromFileAsync()
+            }
+            procedure LoadFromFileAsync(const fileName: TFileName; width: Integer = 0; height: Integer = 0;
+                    proportional: Boolean = C_TWSVGGraphic_Default_Proportional); virtual;
+
+            {**
+             Load a SVG stream asynchronously, see LoadFromFileAsync()
+             @param(pStream Stream to load from)
+             @param(width Width the SVG will be drawn at, if 0 it's deduced from the image options)
+             @param(height Height the SVG will be drawn at, if 0 it's deduced from the image options)
+             @param(proportional Proportional option the SVG will be drawn with)
+             @br @bold(NOTE) The stream content is copied before the function returns, so the caller
+                             may release it
+            }
+            procedure LoadFromStreamAsync(pStream: TStream; width: Integer = 0; height: Integer = 0;
+                    proportional: Boolean = C_TWSVGGraphic_Default_Proportional); virtual;
+
+            {**
+             Cancel the asynchronous load still running, if any. The current picture is kept
+            }
+            procedure CancelLoad; virtual;
+
+        public
+            {**
+             Get if a SVG is being loaded asynchronously
+            }
+            property Loading: Boolean read GetLoading;
+
         published
             {**
              Get the library version number
@@ -196,7 +289,13 @@ type
             {**
              Get or set the OnAnimate event
             }
-            property OnAnimate: ITfSVGAnimateEvent read m_fOnAnimate write m_fOnAnimate;
+            property OnAnimate: ITfSVGAnimateEvent read m_fOnAnimate write SetOnAnimate;
+
+            {**
+             Get or set the OnLoaded event, called when a SVG loaded asynchronously is ready, or
+             could not be loaded
+            }
+            property OnLoaded: TWSVGGraphic.ITfLoadedEvent read m_fOnLoaded write m_fOnLoaded;
     end;
 
 implementation
@@ -258,8 +357,11 @@ constructor TWSVGImage.Create(pOwner: TComponent);
 begin
     inherited Create(pOwner);
 
-    m_pAnimationProps := IAnimationProps.Create(Self);
-    m_fOnAnimate      := nil;
+    m_pAnimationProps  := IAnimationProps.Create(Self);
+    m_pLoadingSVG      := nil;
+    m_fOnAnimate       := nil;
+    m_fOnLoaded        := nil;
+    m_DirtyInvalidated := False;
 
     // override the picture OnChange event
     m_fPrevOnPictureChange := Picture.OnChange;
@@ -268,6 +370,7 @@ end;
 //---------------------------------------------------------------------------
 destructor TWSVGImage.Destroy;
 begin
+    FreeAndNil(m_pLoadingSVG);
     FreeAndNil(m_pAnimationProps);
 
     inherited Destroy;
@@ -281,6 +384,52 @@ begin
     Result := TWLibraryVersion.ToStr;
 end;
 //---------------------------------------------------------------------------
+procedure TWSVGImage.CMVisibleChanged(var message: TMessage);
+begin
+    inherited;
+
+    // is a SVG? If yes, don't animate it while hidden
+    if (Assigned(Picture.Graphic) and (Picture.Graphic is TWSVGGraphic)) then
+        (Picture.Graphic as TWSVGGraphic).Visible := Visible;
+end;
+//---------------------------------------------------------------------------
+function TWSVGImage.GetLoading: Boolean;
+begin
+    if (Assigned(m_pLoadingSVG) and m_pLoadingSVG.Loading) then
+        Exit(True);
+
+    Result := (Assigned(Picture.Graphic) and (Picture.Graphic is TWSVGGraphic)
+            and (Picture.Graphic as TWSVGGraphic).Loading);
+end;
+//---------------------------------------------------------------------------
+procedure TWSVGImage.SetOnAnimate(fValue: ITfSVGAnimateEvent);
+begin
+    m_fOnAnimate := fValue;
+
+    // the svg calls the handler only if the user assigned one, otherwise its frames may be rendered
+    // asynchronously
+    if (Assigned(Picture.Graphic) and (Picture.Graphic is TWSVGGraphic)) then
+        if (Assigned(m_fOnAnimate)) then
+            (Picture.Graphic as TWSVGGraphic).OnAnimate := DoAnimate
+        else
+            (Picture.Graphic as TWSVGGraphic).OnAnimate := nil;
+end;
+//---------------------------------------------------------------------------
+procedure TWSVGImage.GetLoadFrameSize(out width, height: Integer);
+begin
+    // the draw size is only known in advance if the picture fills the whole image, otherwise it
+    // depends on the SVG size
+    if (Stretch and not Proportional) then
+    begin
+        width  := ClientWidth;
+        height := ClientHeight;
+        Exit;
+    end;
+
+    width  := 0;
+    height := 0;
+end;
+//---------------------------------------------------------------------------
 procedure TWSVGImage.DoSetFrameCount(pSender: IAnimationProps; value: Cardinal);
 var
     pSVG:     TWSVGGraphic;
@@ -349,19 +498,7 @@ end;
 //---------------------------------------------------------------------------
 function TWSVGImage.DoAnimate(pSender: TObject; pAnimDesc: TWSVGAnimationDescriptor;
         pCustomData: Pointer): Boolean;
-var
-    pSVG: TWSVGGraphic;
 begin
-    if (pSender is TWSVGGraphic) then
-    begin
-        // get the SVG
-        pSVG := pSender as TWSVGGraphic;
-
-        // update the published values
-        m_pAnimationProps.FrameCount := pSVG.FrameCount;
-        m_pAnimationProps.Position   := Round(pSVG.Position * 100.0);
-    end;
-
     // ask user about continuing animation
     if (Assigned(m_fOnAnimate)) then
         Exit(m_fOnAnimate(pSender, pAnimDesc, pCustomData));
@@ -432,8 +569,15 @@ begin
                 pSVG.Position   := pAnimProps.Position;
             end;
 
-            pSVG.OnAnimate := DoAnimate;
-            guid           := pSVG.Native.GetUUID;
+            // the handler is only set if the user assigned one, because the svg frames are drawn
+            // synchronously while it's set
+            if (Assigned(m_fOnAnimate)) then
+                pSVG.OnAnimate := DoAnimate
+            else
+                pSVG.OnAnimate := nil;
+
+            pSVG.Visible := Visible;
+            guid         := pSVG.Native.GetUUID;
         end;
     end;
 
@@ -450,11 +594,156 @@ begin
 end;
 //---------------------------------------------------------------------------
 procedure TWSVGImage.OnPictureChange(pSender: TObject);
+var
+    pSVG:              TWSVGGraphic;
+    destRc, dirtyRect: TRect;
 begin
     RunAnimation(m_ImgGUID, Picture.Graphic, m_pAnimationProps);
 
-    if (Assigned(m_fPrevOnPictureChange)) then
-        m_fPrevOnPictureChange(pSender);
+    // is a new animation frame about to be drawn? Update the published values. NOTE the values are
+    // written directly, otherwise they would be applied back to the svg while it notifies its change
+    if (not(csDesigning in ComponentState) and (Picture.Graphic is TWSVGGraphic)
+            and (Picture.Graphic as TWSVGGraphic).FrameChanging)
+    then
+    begin
+        pSVG                           := Picture.Graphic as TWSVGGraphic;
+        m_pAnimationProps.m_FrameCount := pSVG.FrameCount;
+        m_pAnimationProps.m_Position   := Min(Round(pSVG.Position * 100.0), 100);
+    end;
+
+    // is a new animation frame about to be drawn on a partially redrawn graphic?
+    if (Assigned(Parent) and Parent.HandleAllocated and (Picture.Graphic is TWSVGGraphic)) then
+    begin
+        pSVG := Picture.Graphic as TWSVGGraphic;
+
+        if (pSVG.PartialRedraw and pSVG.FrameChanging) then
+        begin
+            destRc := DestRect;
+
+            // invalidate only the region which changed since the last frame, if known
+            if (pSVG.GetDirtyRect(destRc.Width, destRc.Height, dirtyRect)) then
+            begin
+                if (not dirtyRect.IsEmpty) then
+                begin
+                    dirtyRect.Offset(Left + destRc.Left, Top + destRc.Top);
+                    TWAnimationTimer.GetTimer.InvalidateWindow(Parent.Handle, dirtyRect,
+                            not (csOpaque in ControlStyle));
+                end;
+
+                // the previous handler should still be called, but without invalidating the whole
+                // control again
+                m_DirtyInvalidated := True;
+            end;
+        end;
+    end;
+
+    try
+        if (Assigned(m_fPrevOnPictureChange)) then
+            m_fPrevOnPictureChange(pSender);
+    finally
+        m_DirtyInvalidated := False;
+    end;
+end;
+//---------------------------------------------------------------------------
+procedure TWSVGImage.Invalidate;
+var
+    pSVG: TWSVGGraphic;
+begin
+    // the region changed by the new frame was already invalidated?
+    if (m_DirtyInvalidated) then
+        Exit;
+
+    // is a new animation frame about to be drawn? If yes, let the timer merge this invalidation with
+    // the other ones of the same parent
+    if (Visible and Assigned(Parent) and Parent.HandleAllocated and (Picture.Graphic is TWSVGGraphic)) then
+    begin
+        pSVG := Picture.Graphic as TWSVGGraphic;
+
+        if (pSVG.FrameChanging) then
+        begin
+            TWAnimationTimer.GetTimer.InvalidateWindow(Parent.Handle, BoundsRect,
+                    not (csOpaque in ControlStyle));
+            Exit;
+        end;
+    end;
+
+    inherited Invalidate;
+end;
+//---------------------------------------------------------------------------
+function TWSVGImage.GetLoadTarget: TWSVGGraphic;
+begin
+    // is a SVG? If yes, load in it, it keeps showing the previous SVG until the new one is ready
+    if (Assigned(Picture.Graphic) and (Picture.Graphic is TWSVGGraphic)) then
+    begin
+        // a load started while the picture wasn't a SVG is superseded
+        if (Assigned(m_pLoadingSVG)) then
+            m_pLoadingSVG.CancelLoad;
+
+        Result := Picture.Graphic as TWSVGGraphic;
+    end
+    else
+    begin
+        // otherwise load in a separate SVG, the picture is kept until the SVG is ready
+        if (not Assigned(m_pLoadingSVG)) then
+            m_pLoadingSVG := TWSVGGraphic.Create;
+
+        Result := m_pLoadingSVG;
+    end;
+
+    Result.OnLoaded := OnSVGLoaded;
+end;
+//---------------------------------------------------------------------------
+procedure TWSVGImage.OnSVGLoaded(pSender: TObject; success: Boolean);
+var
+    pSVG: TWSVGGraphic;
+begin
+    // was the SVG loaded separately because the picture wasn't a SVG? Move it to the picture
+    if (success and (pSender = m_pLoadingSVG)) then
+    begin
+        // the picture always copies the graphic it receives, so give it an empty SVG, and move the
+        // loaded content to its copy. This way the document isn't copied, and the frame rendered
+        // while loading is kept
+        pSVG := TWSVGGraphic.Create;
+
+        try
+            Picture.Graphic := pSVG;
+        finally
+            pSVG.Free;
+        end;
+
+        (Picture.Graphic as TWSVGGraphic).MoveFrom(m_pLoadingSVG);
+    end;
+
+    if (Assigned(m_fOnLoaded)) then
+        m_fOnLoaded(Self, success);
+end;
+//---------------------------------------------------------------------------
+procedure TWSVGImage.LoadFromFileAsync(const fileName: TFileName; width: Integer; height: Integer;
+        proportional: Boolean);
+begin
+    if ((width <= 0) or (height <= 0)) then
+        GetLoadFrameSize(width, height);
+
+    GetLoadTarget.LoadFromFileAsync(fileName, width, height, proportional);
+end;
+//---------------------------------------------------------------------------
+procedure TWSVGImage.LoadFromStreamAsync(pStream: TStream; width: Integer; height: Integer;
+        proportional: Boolean);
+begin
+    if ((width <= 0) or (height <= 0)) then
+        GetLoadFrameSize(width, height);
+
+    GetLoadTarget.LoadFromStreamAsync(pStream, width, height, proportional);
+end;
+//---------------------------------------------------------------------------
+procedure TWSVGImage.CancelLoad;
+begin
+    if (Assigned(m_pLoadingSVG)) then
+        m_pLoadingSVG.CancelLoad;
+
+    // is a SVG?
+    if (Assigned(Picture.Graphic) and (Picture.Graphic is TWSVGGraphic)) then
+        (Picture.Graphic as TWSVGGraphic).CancelLoad;
 end;
 //---------------------------------------------------------------------------
 
@@ -14,6 +14,7 @@ uses System.Classes,
      Winapi.Messages,
      Winapi.Windows,
      Winapi.UxTheme,
+     UTWHelpers,
      UTWSVGGraphic,
      UTWSVGAnimationDescriptor,
      UTWSVGImage,
@@ -24,6 +25,18 @@ type
      Image that acts as a button and supports animated SVG graphics
     }
     TWSVGImageButton = class(TWSVGImage)
+        private type
+            {**
+             Button states, used to identify the pictures in the shared glyph cache
+            }
+            IEState =
+            (
+                IE_S_Normal,
+                IE_S_Hovered,
+                IE_S_Clicked,
+                IE_S_Disabled
+            );
+
         private
             m_pCanvas:                      TCanvas;
             m_HoveredImgGUID:               UnicodeString;
@@ -57,6 +70,13 @@ type
             }
             function GetSVG(pAnimProps: TWSVGImage.IAnimationProps): TWSVGGraphic;
 
+            {**
+             Get the button state matching with a picture
+             @param(pPicture Picture to check)
+             @returns(The button state the picture is painted for)
+            }
+            function GetState(pPicture: TPicture): IEState;
+
             {**
              Get the animation properties set matching with an SVG
              @param(pSVG The SVG graphic)
@@ -340,6 +360,20 @@ begin
     Result := nil;
 end;
 //---------------------------------------------------------------------------
+function TWSVGImageButton.GetState(pPicture: TPicture): IEState;
+begin
+    if (pPicture = m_pHoveredPicture) then
+        Exit(IEState.IE_S_Hovered);
+
+    if (pPicture = m_pClickedPicture) then
+        Exit(IEState.IE_S_Clicked);
+
+    if (pPicture = m_pDisabledPicture) then
+        Exit(IEState.IE_S_Disabled);
+
+    Result := IEState.IE_S_Normal;
+end;
+//---------------------------------------------------------------------------
 function TWSVGImageButton.GetAnimationProps(pSVG: TWSVGGraphic): TWSVGImage.IAnimationProps;
 var
     pSrcSVG: TWSVGGraphic;
@@ -527,7 +561,9 @@ begin
         end;
     end
     else
-        pCanvas.StretchDraw(CalculateDestRect(pPicture), pPicture.Graphic);
+        // draw the picture from the shared glyph cache, so the state changes are immediate
+        TWSVGGlyphCache.Draw(pCanvas, CalculateDestRect(pPicture), pPicture.Graphic, Ord(GetState(pPicture)),
+                TWVCLHelper.GetPixelsPerInchRef(Self));
 end;
 //---------------------------------------------------------------------------
 procedure TWSVGImageButton.DoSetFrameCount(pSender: TWSVGImage.IAnimationProps; value: Cardinal);
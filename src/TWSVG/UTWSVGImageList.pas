@@ -24,8 +24,32 @@ uses System.SysUtils,
      UTWColor,
      UTWHelpers,
      UTWSmartPointer,
+     UTWDesignPatterns,
+     UTWAnimationTimer,
      UTWSVGGraphic;
 
+const
+    {**
+     Interval in milliseconds between two deferred rasterization passes
+    }
+    C_TWSVGImageList_Rasterize_Interval = 10;
+
+    {**
+     Maximum time in milliseconds a deferred rasterization pass may spend on the pending images. The
+     budget is shared by all the image lists notified on the same animation timer tick
+    }
+    C_TWSVGImageList_Rasterize_Budget = 8;
+
+    {**
+     Default value for the lazy loading of the pictures read from DFM
+    }
+    C_TWSVGImageList_Default_LazyLoad = False;
+
+    {**
+     Default value for the background warm-up of the lazily loaded pictures
+    }
+    C_TWSVGImageList_Default_LazyWarmup = True;
+
 type
     {**
      Called when image list detects a DPI change and should update its content
@@ -38,15 +62,28 @@ type
     {**
      Image list override that supports SVG graphics
     }
-    TWSVGImageList = class(TCustomImageList)
+    TWSVGImageList = class(TCustomImageList, IWObserver)
         private type
             {**
              Picture item
             }
             IWPictureItem = class
                 private
-                    m_pPicture: TPicture;
-                    m_ColorKey: TWColor;
+                    m_pPicture:    TPicture;
+                    m_pImage:      Vcl.Graphics.TBitmap;
+                    m_Data:        TBytes;
+                    m_ColorKey:    TWColor;
+                    m_Index:       Integer;
+                    m_Dirty:       Boolean;
+                    m_Promoted:    Boolean;
+                    m_Outdated:    Boolean;
+                    m_Rasterizing: Boolean;
+
+                    {**
+                     Called when the picture changed
+                     @param(pSender Event sender)
+                    }
+                    procedure OnPictureChange(pSender: TObject);
 
                 public
                     {**
@@ -71,16 +108,29 @@ type
             }
             IWPictureList = TObjectList<IWPictureItem>;
 
+            {**
+             Queue of picture items waiting to be rasterized at the current size
+            }
+            IWRasterizeQueue = TList<IWPictureItem>;
+
+        private class var
+            m_RasterizeTickStart: Int64;
+
         private
             m_pPictures:                       IWPictureList;
-            m_Graphics:                        array of TWSVGGraphic;
+            m_pRasterizeQueue:                 IWRasterizeQueue;
+            m_pPromotedQueue:                  IWRasterizeQueue;
+            m_QueueHead:                       Integer;
             m_RefWidth:                        Integer;
             m_RefHeight:                       Integer;
             m_ParentPixelsPerInch:             Integer;
             m_RefPixelsPerInch:                Integer;
             m_PixelsPerInch:                   Integer;
             m_DPIScale:                        Boolean;
+            m_LazyLoad:                        Boolean;
+            m_LazyWarmup:                      Boolean;
             m_fOnSVGImageListDPIChanged:       TWfOnSVGImageListDPIChanged;
+            m_MemoryReporterName:              UnicodeString;
 
             {$if CompilerVersion < 33}
                 m_hParent:                     HWND;
@@ -101,14 +151,91 @@ type
             function GetVersion: UnicodeString;
 
             {**
-             Backup the SVG list content in a temporary array
+             Initialize the deferred rasterization members
             }
-            procedure Backup;
+            procedure InitRasterizeQueue;
 
             {**
-             Restore the SVG list content from a temporary array
+             Add a picture item on the end of the rasterization queue
+             @param(pPictureItem Picture item to add)
             }
-            procedure Restore;
+            procedure EnqueuePending(pPictureItem: IWPictureItem);
+
+            {**
+             Get the next picture item to rasterize, the promoted items first
+             @returns(Next picture item to rasterize, @nil if the queues are empty)
+             @br @bold(NOTE) The returned item may no longer be dirty, e.g. if it was already
+                             rasterized while promoted, in this case it should just be skipped
+            }
+            function DequeuePending: IWPictureItem;
+
+            {**
+             Remove a picture item from the rasterization queues, e.g. before it is deleted
+             @param(pPictureItem Picture item to remove)
+            }
+            procedure RemovePending(pPictureItem: IWPictureItem);
+
+            {**
+             Clear the rasterization queues
+            }
+            procedure ClearPending;
+
+            {**
+             Resume the image list in the animation timer while images are pending, suspend it
+             otherwise
+            }
+            procedure UpdateScheduling;
+
+            {**
+             Get the position of a picture item in the picture list
+             @param(pPictureItem Picture item for which the position should be get)
+             @returns(Picture item position, -1 if not found)
+             @br @bold(NOTE) The position is cached in the item, and all the positions are updated
+                             at once when the list changed, so the search is usually immediate
+            }
+            function GetItemIndex(pPictureItem: IWPictureItem): Integer;
+
+            {**
+             Resize the base image list and replace its images by scaled copies of the previous ones,
+             then schedule the SVG pictures to be rasterized again at the new size
+             @param(newWidth New image width, in pixels)
+             @param(newHeight New image height, in pixels)
+             @br @bold(NOTE) The scaled copies are only placeholders, they will be replaced one by
+                             one by the final images while the deferred rasterization progresses.
+                             The lazily loaded pictures not parsed yet are only scheduled if the
+                             warm-up is enabled, otherwise they remain parsed on their first use
+            }
+            procedure ResizeImages(newWidth, newHeight: Integer);
+
+            {**
+             Move a pending picture item on the front of the rasterization queue
+             @param(pPictureItem Picture item to promote)
+            }
+            procedure PromotePending(pPictureItem: IWPictureItem);
+
+            {**
+             Parse the raw SVG data of a lazily loaded picture item, if not already done
+             @param(pPictureItem Picture item to parse)
+            }
+            procedure Materialize(pPictureItem: IWPictureItem);
+
+            {**
+             Check if a picture item contains a SVG, parsed or still waiting to be parsed
+             @param(pPictureItem Picture item to check)
+             @returns(@true if the picture item contains a SVG, otherwise @false)
+            }
+            function IsSVGItem(pPictureItem: IWPictureItem): Boolean; inline;
+
+            {**
+             Rasterize the next pending picture item and swap it in the base image list
+             @returns(@true if an item was rasterized, @false if the queue is empty)
+            }
+            function RasterizeNextPending: Boolean;
+
+            {**
+             Rasterize the pending images until the time budget of the current tick is exhausted
+            }
+            procedure OnRasterizeTick;
 
         protected
             {**
@@ -146,17 +273,39 @@ type
             }
             function IsPixelsPerInchStored: Boolean; virtual;
 
+            {**
+             Rasterize a picture item onto a bitmap image, at the current image list size
+             @param(pPictureItem Picture item to rasterize)
+             @param(pBitmap Bitmap to draw on, will be resized to the image list size)
+             @br @bold(NOTE) The bitmap is converted to a premultiplied 32 bit image, and is kept
+                             transparent unless the item color key is opaque
+            }
+            procedure RasterizeItem(pPictureItem: IWPictureItem; pBitmap: Vcl.Graphics.TBitmap); virtual;
+
+            {**
+             Check if the premultiplied image of a picture item is up to date at the current size
+             @param(pPictureItem Picture item to check)
+             @returns(@true if the image can be blit as is, otherwise @false)
+            }
+            function IsImageReady(pPictureItem: IWPictureItem): Boolean; inline;
+
             {**
              Rasterize the SVG onto a bitmap image and add or insert it inside the base image list
              @param(index Index at which the SVG will be inserted, if -1 will be added on the end)
              @param(pSVG SVG image to add or insert)
-             @param(colorKey Color key to use as transparent background for the SVG)
+             @param(colorKey Opaque background to fill behind the SVG, transparent if clNone)
              @param(doReplace If true, the image will replace another image at index instead of insert it)
              @returns(The newly added or inserted position in the list)
             }
             function RasterizeAndAssign(index: Integer; pSVG: TWSVGGraphic; colorKey: TColor;
                     doReplace: Boolean): Integer; virtual;
 
+            {**
+             Called when subject send a notification to the observer
+             @param(message Notification message)
+            }
+            procedure OnNotified(message: TWMessage); virtual;
+
             {**
              Declares properties that will deal with DFM files
              @param(pFiler DFM file manager)
@@ -272,7 +421,8 @@ type
             {**
              Add a new SVG image inside the list
              @param(pSVG SVG image to add)
-             @param(colorKey Color key to use with the image, if clNone the color will be those defined in BkColor)
+             @param(colorKey Opaque background color to use with the image, if clNone the color will be
+                             those defined in BkColor, and the image will remain transparent if both are clNone)
              @returns(Index of the newly added image, -1 on error)
             }
             function AddSVG(pSVG: TWSVGGraphic; colorKey: TColor = clNone): Integer; virtual;
@@ -281,7 +431,8 @@ type
              Insert a new SVG image inside the list
              @param(index Index where the SVG will be inserted)
              @param(pSVG SVG image to add)
-             @param(colorKey Color key to use with the image, if clNone the color will be those defined in BkColor)
+             @param(colorKey Opaque background color to use with the image, if clNone the color will be
+                             those defined in BkColor, and the image will remain transparent if both are clNone)
             }
             procedure InsertSVG(index: Integer; pSVG: TWSVGGraphic; colorKey: TColor = clNone); virtual;
 
@@ -289,7 +440,8 @@ type
              Replace a SVG image by another
              @param(index Index of the SVG to replace)
              @param(pSVG SVG image to replace by)
-             @param(colorKey Color key to use with the image, if clNone the color will be those defined in BkColor)
+             @param(colorKey Opaque background color to use with the image, if clNone the color will be
+                             those defined in BkColor, and the image will remain transparent if both are clNone)
             }
             procedure ReplaceSVG(index: Integer; pSVG: TWSVGGraphic; colorKey: TColor = clNone); virtual;
 
@@ -303,9 +455,34 @@ type
              Get the SVG image at index
              @param(index Index of the SVG to get)
              @returns(The SVG image, @nil on error or if not found)
+             @br @bold(NOTE) The cached image is kept, unless the caller modifies the returned
+                             graphic. In this case it will be rasterized again on the next draw
             }
             function GetSVG(index: Integer): TWSVGGraphic; virtual;
 
+            {**
+             Rasterize immediately all the images still waiting to be updated after a size or DPI change
+             @br @bold(NOTE) After a size or DPI change, the images are rasterized in the background
+                             on the main thread, the visible or requested ones first. Call this
+                             function when all the final images are required at once, e.g. before
+                             extracting them from the base image list
+            }
+            procedure RasterizePending; virtual;
+
+            {**
+             Get if images are still waiting to be updated after a size or DPI change
+             @returns(@true if images are pending, otherwise @false)
+            }
+            function HasPending: Boolean; virtual;
+
+            {**
+             Get the estimated memory size used by the image list
+             @returns(The estimated memory size, in bytes)
+             @br @bold(NOTE) The size contains the SVG documents, their rasterized frames and the
+                             native image list bitmap, which is estimated from the image count and size
+            }
+            function GetMemorySize: NativeUInt; virtual;
+
             {**
              Get the SVG image color key at index
              @param(index Index of the color key to get)
@@ -361,6 +538,21 @@ type
             }
             property PixelsPerInch: Integer read m_PixelsPerInch write SetPixelsPerInch stored IsPixelsPerInchStored nodefault;
 
+            {**
+             Get or set if the pictures read from DFM are kept as raw SVG data, and only parsed when
+             first drawn or requested. This reduces the form creation time if the list contains
+             many pictures, e.g. for menus that may never open
+             @br @bold(NOTE) Until a picture is parsed, the image stored with the base image list
+                             is used as its thumbnail
+            }
+            property LazyLoad: Boolean read m_LazyLoad write m_LazyLoad default C_TWSVGImageList_Default_LazyLoad;
+
+            {**
+             Get or set if the lazily loaded pictures are parsed in the background once the form is
+             loaded, while the application is idle. If disabled, each picture is parsed when first used
+            }
+            property LazyWarmup: Boolean read m_LazyWarmup write m_LazyWarmup default C_TWSVGImageList_Default_LazyWarmup;
+
             {**
              Get or set the OnChange event
             }
@@ -373,6 +565,11 @@ type
     end;
 
 implementation
+
+uses
+  System.Diagnostics,
+  Winapi.CommCtrl;
+
 //---------------------------------------------------------------------------
 // TWSVGImageList.IWPictureItem
 //---------------------------------------------------------------------------
@@ -380,14 +577,23 @@ constructor TWSVGImageList.IWPictureItem.Create;
 begin
     inherited Create;
 
-    m_pPicture := TPicture.Create;
+    m_pPicture    := TPicture.Create;
+    m_pImage      := nil;
+    m_Index       := -1;
+    m_Dirty       := False;
+    m_Promoted    := False;
+    m_Outdated    := False;
+    m_Rasterizing := False;
 
     m_ColorKey.Clear;
+
+    m_pPicture.OnChange := OnPictureChange;
 end;
 //---------------------------------------------------------------------------
 destructor TWSVGImageList.IWPictureItem.Destroy;
 begin
     FreeAndNil(m_pPicture);
+    FreeAndNil(m_pImage);
 
     inherited Destroy;
 end;
@@ -398,7 +604,33 @@ begin
         Exit;
 
     m_pPicture.Assign(pSource.m_pPicture);
+    m_Data := Copy(pSource.m_Data);
     m_ColorKey.Assign(pSource.m_ColorKey);
+    m_Dirty    := pSource.m_Dirty;
+    m_Outdated := pSource.m_Outdated;
+
+    // copy the premultiplied image, if any
+    if (Assigned(pSource.m_pImage)) then
+    begin
+        if (not Assigned(m_pImage)) then
+            m_pImage := Vcl.Graphics.TBitmap.Create;
+
+        m_pImage.Assign(pSource.m_pImage);
+    end
+    else
+        FreeAndNil(m_pImage);
+end;
+//---------------------------------------------------------------------------
+procedure TWSVGImageList.IWPictureItem.OnPictureChange(pSender: TObject);
+begin
+    // the picture is resized while rasterized, this doesn't change the image
+    if (m_Rasterizing) then
+        Exit;
+
+    // the graphic changed, e.g. modified by the caller of GetSVG(), so the premultiplied image
+    // should be rasterized again on the next draw. NOTE it isn't released here, because it may be
+    // used by the base image list meanwhile
+    m_Outdated := True;
 end;
 //---------------------------------------------------------------------------
 // TWSVGImageList
@@ -425,8 +657,16 @@ begin
     m_ParentPixelsPerInch       := m_RefPixelsPerInch;
     m_PixelsPerInch             := m_RefPixelsPerInch;
     m_DPIScale                  := False;
+    m_LazyLoad                  := C_TWSVGImageList_Default_LazyLoad;
+    m_LazyWarmup                := C_TWSVGImageList_Default_LazyWarmup;
     m_fOnSVGImageListDPIChanged := nil;
 
+    InitRasterizeQueue;
+
+    // report the image list memory in the process memory summary
+    m_MemoryReporterName := Format('%s (%p)', [ClassName, Pointer(Self)]);
+    TWMemoryHelper.RegisterReporter(m_MemoryReporterName, GetMemorySize);
+
     {$if CompilerVersion < 33}
         {$if CompilerVersion < 30}
             hSHCore := GetModuleHandleA('shcore.dll');
@@ -490,8 +730,16 @@ begin
     m_ParentPixelsPerInch       := m_RefPixelsPerInch;
     m_PixelsPerInch             := m_RefPixelsPerInch;
     m_DPIScale                  := False;
+    m_LazyLoad                  := C_TWSVGImageList_Default_LazyLoad;
+    m_LazyWarmup                := C_TWSVGImageList_Default_LazyWarmup;
     m_fOnSVGImageListDPIChanged := nil;
 
+    InitRasterizeQueue;
+
+    // report the image list memory in the process memory summary
+    m_MemoryReporterName := Format('%s (%p)', [ClassName, Pointer(Self)]);
+    TWMemoryHelper.RegisterReporter(m_MemoryReporterName, GetMemorySize);
+
     {$if CompilerVersion < 33}
         {$if CompilerVersion < 30}
             hSHCore := GetModuleHandleA('shcore.dll');
@@ -520,14 +768,11 @@ begin
 end;
 //---------------------------------------------------------------------------
 destructor TWSVGImageList.Destroy;
-var
-    localCount, i: Integer;
 begin
-    localCount := Length(m_Graphics);
+    TWMemoryHelper.UnregisterReporter(m_MemoryReporterName);
 
-    // free the local array items
-    for i := 0 to localCount - 1 do
-        m_Graphics[i].Free;
+    // detach from animation timer and stop to receive the deferred rasterization ticks
+    TWAnimationTimer.GetInstance.Detach(Self);
 
     {$if CompilerVersion < 33}
         // release parent control Windows procedure, if needed
@@ -538,6 +783,8 @@ begin
         TMessageManager.DefaultManager.Unsubscribe(TChangeScaleMessage, m_DPIChangedMessageID);
     {$ifend}
 
+    FreeAndNil(m_pPromotedQueue);
+    FreeAndNil(m_pRasterizeQueue);
     FreeAndNil(m_pPictures);
 
     inherited Destroy;
@@ -551,39 +798,351 @@ begin
     Result := TWLibraryVersion.ToStr;
 end;
 //---------------------------------------------------------------------------
-procedure TWSVGImageList.Backup;
+procedure TWSVGImageList.InitRasterizeQueue;
+begin
+    m_pRasterizeQueue := IWRasterizeQueue.Create;
+    m_pPromotedQueue  := IWRasterizeQueue.Create;
+    m_QueueHead       := 0;
+
+    // the deferred rasterization is scheduled by the global animation timer, which is shared with
+    // the animated graphics and the other image lists, instead of a timer per list. The list is
+    // only resumed while images are pending
+    TWAnimationTimer.GetInstance.Attach(Self);
+    TWAnimationTimer.GetTimer.SetFrameRate(Self, 1000 div C_TWSVGImageList_Rasterize_Interval);
+    TWAnimationTimer.GetTimer.Suspend(Self);
+end;
+//---------------------------------------------------------------------------
+procedure TWSVGImageList.EnqueuePending(pPictureItem: IWPictureItem);
+begin
+    m_pRasterizeQueue.Add(pPictureItem);
+end;
+//---------------------------------------------------------------------------
+function TWSVGImageList.DequeuePending: IWPictureItem;
+begin
+    // the promoted items are rasterized first, the last promoted one before the others
+    if (m_pPromotedQueue.Count > 0) then
+    begin
+        Result            := m_pPromotedQueue[m_pPromotedQueue.Count - 1];
+        Result.m_Promoted := False;
+        m_pPromotedQueue.Delete(m_pPromotedQueue.Count - 1);
+        Exit;
+    end;
+
+    Result := nil;
+
+    // get the next item from the queue head. NOTE the items are not deleted one by one, which
+    // would move the whole queue each time, the consumed part is released once large enough
+    while ((not Assigned(Result)) and (m_QueueHead < m_pRasterizeQueue.Count)) do
+    begin
+        Result                         := m_pRasterizeQueue[m_QueueHead];
+        m_pRasterizeQueue[m_QueueHead] := nil;
+        Inc(m_QueueHead);
+    end;
+
+    if (m_QueueHead >= m_pRasterizeQueue.Count) then
+    begin
+        m_pRasterizeQueue.Clear;
+        m_QueueHead := 0;
+    end
+    else
+    if (m_QueueHead > (m_pRasterizeQueue.Count div 2)) then
+    begin
+        m_pRasterizeQueue.DeleteRange(0, m_QueueHead);
+        m_QueueHead := 0;
+    end;
+end;
+//---------------------------------------------------------------------------
+procedure TWSVGImageList.RemovePending(pPictureItem: IWPictureItem);
+var
+    i: Integer;
+begin
+    // the removed item slot is emptied rather than deleted, to keep the queue head valid
+    for i := m_QueueHead to m_pRasterizeQueue.Count - 1 do
+        if (m_pRasterizeQueue[i] = pPictureItem) then
+            m_pRasterizeQueue[i] := nil;
+
+    if (pPictureItem.m_Promoted) then
+    begin
+        m_pPromotedQueue.Remove(pPictureItem);
+        pPictureItem.m_Promoted := False;
+    end;
+end;
+//---------------------------------------------------------------------------
+procedure TWSVGImageList.ClearPending;
+var
+    pPictureItem: IWPictureItem;
+begin
+    for pPictureItem in m_pPromotedQueue do
+        pPictureItem.m_Promoted := False;
+
+    m_pPromotedQueue.Clear;
+    m_pRasterizeQueue.Clear;
+    m_QueueHead := 0;
+end;
+//---------------------------------------------------------------------------
+procedure TWSVGImageList.UpdateScheduling;
+begin
+    if (HasPending) then
+        TWAnimationTimer.GetTimer.Resume(Self)
+    else
+        TWAnimationTimer.GetTimer.Suspend(Self);
+end;
+//---------------------------------------------------------------------------
+function TWSVGImageList.GetItemIndex(pPictureItem: IWPictureItem): Integer;
 var
     i: Integer;
 begin
-    // initialize the local array in which the list content will be saved
-    SetLength(m_Graphics, Count);
+    // cached position still valid?
+    if ((pPictureItem.m_Index >= 0) and (pPictureItem.m_Index < m_pPictures.Count)
+            and (m_pPictures[pPictureItem.m_Index] = pPictureItem))
+    then
+        Exit(pPictureItem.m_Index);
+
+    // the list changed since the positions were cached, update them all
+    for i := 0 to m_pPictures.Count - 1 do
+        m_pPictures[i].m_Index := i;
+
+    // the item still doesn't match? (i.e. it is no longer in the list)
+    if ((pPictureItem.m_Index < 0) or (pPictureItem.m_Index >= m_pPictures.Count)
+            or (m_pPictures[pPictureItem.m_Index] <> pPictureItem))
+    then
+        Exit(-1);
+
+    Result := pPictureItem.m_Index;
+end;
+//---------------------------------------------------------------------------
+procedure TWSVGImageList.ResizeImages(newWidth, newHeight: Integer);
+var
+    pPlaceholders: IWSmartPointer<TObjectList<Vcl.Graphics.TBitmap>>;
+    pSnapshot:     IWSmartPointer<Vcl.Graphics.TBitmap>;
+    pPlaceholder:  Vcl.Graphics.TBitmap;
+    pPictureItem:  IWPictureItem;
+    color:         TWColor;
+    i:             Integer;
+begin
+    pPlaceholders := TWSmartPointer<TObjectList<Vcl.Graphics.TBitmap>>.Create
+            (TObjectList<Vcl.Graphics.TBitmap>.Create(True));
+
+    // create a bitmap able to receive the images at their current size
+    pSnapshot        := TWSmartPointer<Vcl.Graphics.TBitmap>.Create();
+    pSnapshot.Width  := Width;
+    pSnapshot.Height := Height;
 
-    // save the list content
+    // build the placeholders by scaling the current images. NOTE the images are read directly from
+    // the image list handle, to not trigger a SVG rendering through DoDraw()
     for i := 0 to Count - 1 do
     begin
-        m_Graphics[i] := TWSVGGraphic.Create;
-        m_Graphics[i].Assign(GetSVG(i));
+        // the picture already owns a premultiplied image? Scale it with its alpha channel on the
+        // placeholder, which is fully transparent once created
+        if ((i < m_pPictures.Count) and IsImageReady(m_pPictures[i])) then
+        begin
+            pPlaceholder := Vcl.Graphics.TBitmap.Create;
+            pPlaceholders.Add(pPlaceholder);
+
+            pPlaceholder.PixelFormat := pf32bit;
+            pPlaceholder.AlphaFormat := afPremultiplied;
+            pPlaceholder.SetSize(newWidth, newHeight);
+
+            TWGDIHelper.AlphaBlendImage(m_pPictures[i].m_pImage, Width, Height, pPlaceholder.Canvas, 0, 0,
+                    newWidth, newHeight);
+
+            continue;
+        end;
+
+        // select the color key to use as background
+        if (i < m_pPictures.Count) then
+            color.Assign(m_pPictures[i].m_ColorKey)
+        else
+        if (BkColor <> clNone) then
+            color.SetColor(BkColor)
+        else
+            color.Clear;
+
+        // get the image at its current size
+        pSnapshot.Canvas.Brush.Color := color.GetColor;
+        pSnapshot.Canvas.Brush.Style := bsSolid;
+        pSnapshot.Canvas.FillRect(TRect.Create(0, 0, pSnapshot.Width, pSnapshot.Height));
+        ImageList_Draw(Handle, i, pSnapshot.Canvas.Handle, 0, 0, ILD_NORMAL);
+
+        pPlaceholder := Vcl.Graphics.TBitmap.Create;
+        pPlaceholders.Add(pPlaceholder);
+
+        // scale it to the new size
+        pPlaceholder.Width  := newWidth;
+        pPlaceholder.Height := newHeight;
+        SetStretchBltMode(pPlaceholder.Canvas.Handle, HALFTONE);
+        SetBrushOrgEx(pPlaceholder.Canvas.Handle, 0, 0, nil);
+        StretchBlt(pPlaceholder.Canvas.Handle, 0, 0, newWidth, newHeight, pSnapshot.Canvas.Handle,
+                0, 0, pSnapshot.Width, pSnapshot.Height, SRCCOPY);
+    end;
+
+    // the previously pending images will be rescheduled below
+    ClearPending;
+
+    // resize the base image list and fill it with the placeholders. NOTE only the base images are
+    // cleared, the SVG pictures are kept as is and don't need to be copied
+    inherited Clear;
+    inherited SetSize(newWidth, newHeight);
+
+    for pPlaceholder in pPlaceholders do
+        Add(pPlaceholder, nil);
+
+    // schedule the SVG pictures to be rasterized at the new size. NOTE the lazily loaded pictures not
+    // parsed yet are skipped without warm-up, otherwise resizing the list, e.g. while scaling it to
+    // the monitor DPI once loaded, would parse them all
+    for pPictureItem in m_pPictures do
+    begin
+        pPictureItem.m_Dirty := (IsSVGItem(pPictureItem) and ((Length(pPictureItem.m_Data) = 0)
+                or m_LazyWarmup or (csDesigning in ComponentState)));
+
+        if (pPictureItem.m_Dirty) then
+            EnqueuePending(pPictureItem);
+    end;
+
+    // nothing to rasterize?
+    if (not HasPending) then
+    begin
+        UpdateScheduling;
+        Exit;
     end;
+
+    // the designer streams the base images, so they should be final before it reads them
+    if (csDesigning in ComponentState) then
+    begin
+        RasterizePending;
+        Exit;
+    end;
+
+    UpdateScheduling;
 end;
 //---------------------------------------------------------------------------
-procedure TWSVGImageList.Restore;
+procedure TWSVGImageList.PromotePending(pPictureItem: IWPictureItem);
+begin
+    // nothing to promote, or already promoted?
+    if (not Assigned(pPictureItem) or not pPictureItem.m_Dirty or pPictureItem.m_Promoted) then
+        Exit;
+
+    // the item is pushed on the promoted queue without searching it in the rasterization queue,
+    // where it will just be skipped once reached, because it will no longer be dirty
+    pPictureItem.m_Promoted := True;
+    m_pPromotedQueue.Add(pPictureItem);
+end;
+//---------------------------------------------------------------------------
+procedure TWSVGImageList.Materialize(pPictureItem: IWPictureItem);
 var
-    localCount, i: Integer;
+    pSVG:       IWSmartPointer<TWSVGGraphic>;
+    pStream:    IWSmartPointer<TBytesStream>;
+    traceStart: Int64;
 begin
-    localCount := Length(m_Graphics);
+    // already parsed?
+    if (Length(pPictureItem.m_Data) = 0) then
+        Exit;
+
+    traceStart := TWTraceHelper.Start;
+
+    try
+        pSVG    := TWSmartPointer<TWSVGGraphic>.Create();
+        pStream := TWSmartPointer<TBytesStream>.Create(TBytesStream.Create(pPictureItem.m_Data));
 
-    // restore the list content from the local array and free the local array items
-    for i := 0 to localCount - 1 do
+        pSVG.LoadFromStream(pStream);
+        pPictureItem.m_pPicture.Assign(pSVG);
+    finally
+        // the raw data is no longer required, even if it could not be parsed
+        pPictureItem.m_Data := nil;
+
+        TWTraceHelper.Stop('Image list picture parse', 'imagelist', traceStart);
+    end;
+end;
+//---------------------------------------------------------------------------
+function TWSVGImageList.IsSVGItem(pPictureItem: IWPictureItem): Boolean;
+begin
+    Result := ((Length(pPictureItem.m_Data) > 0) or (pPictureItem.m_pPicture.Graphic is TWSVGGraphic));
+end;
+//---------------------------------------------------------------------------
+function TWSVGImageList.RasterizeNextPending: Boolean;
+var
+    pPictureItem: IWPictureItem;
+    index:        Integer;
+begin
+    // nothing to rasterize?
+    if (not HasPending) then
+        Exit(False);
+
+    // get the next pending item
+    pPictureItem := DequeuePending;
+
+    // already rasterized or removed meanwhile?
+    if (not Assigned(pPictureItem) or not pPictureItem.m_Dirty) then
+        Exit(True);
+
+    pPictureItem.m_Dirty := False;
+
+    // get the item position in the base image list
+    index := GetItemIndex(pPictureItem);
+
+    // found it?
+    if ((index < 0) or (index >= Count)) then
+        Exit(True);
+
+    // rasterize the final image, unless already done by a draw, then swap it with its placeholder in
+    // one step
+    if (not IsImageReady(pPictureItem)) then
     begin
-        AddSVG(m_Graphics[i]);
-        m_Graphics[i].Free;
+        if (not Assigned(pPictureItem.m_pImage)) then
+            pPictureItem.m_pImage := Vcl.Graphics.TBitmap.Create;
+
+        RasterizeItem(pPictureItem, pPictureItem.m_pImage);
     end;
 
-    // clear the local list
-    SetLength(m_Graphics, 0);
+    Replace(index, pPictureItem.m_pImage, nil);
+
+    Result := True;
+end;
+//---------------------------------------------------------------------------
+procedure TWSVGImageList.OnRasterizeTick;
+var
+    now:     Int64;
+    elapsed: Int64;
+begin
+    now     := TStopwatch.GetTimeStamp;
+    elapsed := ((now - m_RasterizeTickStart) * 1000) div TStopwatch.Frequency;
+
+    // the image lists are notified one after the other on the same tick, and share its time
+    // budget. The tick is considered as new once the rasterization interval is elapsed since the
+    // first list was notified
+    if (elapsed >= C_TWSVGImageList_Rasterize_Interval) then
+    begin
+        m_RasterizeTickStart := now;
+        elapsed              := 0;
+    end;
+
+    // rasterize the pending images until the time budget is exhausted, to keep the UI responsive.
+    // NOTE the images are rasterized on the main thread, because the pictures and the base image
+    // list are VCL objects. Rasterizing them in workers would require each worker to own a copy of
+    // the documents and a private renderer, as the graphic render thread does
+    while (elapsed < C_TWSVGImageList_Rasterize_Budget) do
+    begin
+        if (not RasterizeNextPending) then
+            break;
+
+        elapsed := ((TStopwatch.GetTimeStamp - m_RasterizeTickStart) * 1000) div TStopwatch.Frequency;
+    end;
+
+    // stop to receive the ticks once all images are up to date
+    UpdateScheduling;
+end;
+//---------------------------------------------------------------------------
+procedure TWSVGImageList.OnNotified(message: TWMessage);
+begin
+    case (TWAnimationTimer.EWAnimationTimerMessages(message.m_Type)) of
+        TWAnimationTimer.EWAnimationTimerMessages.IE_AM_Animate:
+            OnRasterizeTick;
+    end;
 end;
 //---------------------------------------------------------------------------
 procedure TWSVGImageList.Loaded;
+var
+    pPictureItem: IWPictureItem;
 begin
     // update reference with the one defined by user
     m_RefPixelsPerInch := m_PixelsPerInch;
@@ -600,6 +1159,19 @@ begin
     // will also scale these values in relation to current DPI
     SetSize(Width, Height);
 
+    // parse the lazily loaded pictures in the background. NOTE their base image is kept meanwhile
+    if (m_LazyLoad and m_LazyWarmup and not (csDesigning in ComponentState)) then
+    begin
+        for pPictureItem in m_pPictures do
+            if ((Length(pPictureItem.m_Data) > 0) and not pPictureItem.m_Dirty) then
+            begin
+                pPictureItem.m_Dirty := True;
+                EnqueuePending(pPictureItem);
+            end;
+
+        UpdateScheduling;
+    end;
+
     inherited Loaded;
 end;
 //---------------------------------------------------------------------------
@@ -617,14 +1189,8 @@ begin
     if ((m_RefWidth = value) and (Width = w)) then
         Exit;
 
-    try
-        Backup;
-        Clear;
-        m_RefWidth      := value;
-        inherited Width := w;
-    finally
-        Restore;
-    end;
+    m_RefWidth := value;
+    ResizeImages(w, Height);
 end;
 //---------------------------------------------------------------------------
 procedure TWSVGImageList.SetHeight(value: Integer);
@@ -641,14 +1207,8 @@ begin
     if ((m_RefHeight = value) and (Height = h)) then
         Exit;
 
-    try
-        Backup;
-        Clear;
-        m_RefHeight      := value;
-        inherited Height := h;
-    finally
-        Restore;
-    end;
+    m_RefHeight := value;
+    ResizeImages(Width, h);
 end;
 //---------------------------------------------------------------------------
 procedure TWSVGImageList.SetDPIScale(value: Boolean);
@@ -679,10 +1239,73 @@ begin
     Result := (m_PixelsPerInch <> m_ParentPixelsPerInch);
 end;
 //---------------------------------------------------------------------------
+procedure TWSVGImageList.RasterizeItem(pPictureItem: IWPictureItem; pBitmap: Vcl.Graphics.TBitmap);
+var
+    pLine:      PWRGBQuadArray;
+    background: TRGBQuad;
+    x, y:       Integer;
+begin
+    // the picture is parsed and resized while rasterized, which should not mark the image as outdated
+    pPictureItem.m_Rasterizing := True;
+
+    try
+        // parse the picture first if it was lazily loaded
+        Materialize(pPictureItem);
+
+        pPictureItem.m_Outdated := False;
+
+        pBitmap.PixelFormat := pf32bit;
+        pBitmap.AlphaFormat := afPremultiplied;
+        pBitmap.SetSize(Width, Height);
+
+        // only an opaque color key is painted as background, otherwise the image remains
+        // transparent. NOTE the pixels are written directly, because the GDI resets the alpha
+        // channel on fill
+        if (pPictureItem.m_ColorKey.GetAlpha <> 0) then
+        begin
+            background.rgbBlue     := pPictureItem.m_ColorKey.GetBlue;
+            background.rgbGreen    := pPictureItem.m_ColorKey.GetGreen;
+            background.rgbRed      := pPictureItem.m_ColorKey.GetRed;
+            background.rgbReserved := 255;
+        end
+        else
+            FillChar(background, SizeOf(background), 0);
+
+        for y := 0 to pBitmap.Height - 1 do
+        begin
+            pLine := PWRGBQuadArray(pBitmap.ScanLine[y]);
+
+            for x := 0 to pBitmap.Width - 1 do
+                pLine[x] := background;
+        end;
+
+        // no picture to rasterize?
+        if (not Assigned(pPictureItem.m_pPicture.Graphic)) then
+            Exit;
+
+        // update the picture size to match with the rendering size
+        pPictureItem.m_pPicture.Graphic.Width  := Width  - 1;
+        pPictureItem.m_pPicture.Graphic.Height := Height - 1;
+
+        // rasterize the picture onto the bitmap
+        pBitmap.Canvas.Draw(0, 0, pPictureItem.m_pPicture.Graphic);
+    finally
+        pPictureItem.m_Rasterizing := False;
+    end;
+end;
+//---------------------------------------------------------------------------
+function TWSVGImageList.IsImageReady(pPictureItem: IWPictureItem): Boolean;
+begin
+    Result := (Assigned(pPictureItem.m_pImage)        and
+              (not pPictureItem.m_Outdated)           and
+              (pPictureItem.m_pImage.Width  = Width)  and
+              (pPictureItem.m_pImage.Height = Height) and
+              (Width > 0) and (Height > 0));
+end;
+//---------------------------------------------------------------------------
 function TWSVGImageList.RasterizeAndAssign(index: Integer; pSVG: TWSVGGraphic; colorKey: TColor;
         doReplace: Boolean): Integer;
 var
-    pBitmap:      IWSmartPointer<Vcl.Graphics.TBitmap>;
     pPictureItem: IWPictureItem;
     color:        TWColor;
 begin
@@ -691,11 +1314,6 @@ begin
     if (not Assigned(pSVG)) then
         Exit;
 
-    // create a bitmap image in which the SVG will be rasterized for the base image list
-    pBitmap        := TWSmartPointer<Vcl.Graphics.TBitmap>.Create();
-    pBitmap.Width  := Width;
-    pBitmap.Height := Height;
-
     // select a color key. By default, use the user defined background color
     if (colorKey <> clNone) then
         color.SetColor(colorKey)
@@ -705,11 +1323,6 @@ begin
     else
         color.Clear;
 
-    // fill bitmap with color key
-    pBitmap.Canvas.Brush.Color := color.GetColor;
-    pBitmap.Canvas.Brush.Style := bsSolid;
-    pBitmap.Canvas.FillRect(TRect.Create(0, 0, pBitmap.Width, pBitmap.Height));
-
     pPictureItem := nil;
 
     try
@@ -717,27 +1330,28 @@ begin
         pPictureItem := IWPictureItem.Create;
         pPictureItem.m_ColorKey.Assign(color);
 
-        // copy the SVG in the picture item, and update its size to match with the rendering size
+        // copy the SVG in the picture item, and rasterize it onto its premultiplied image, which is
+        // also added to the base image list
         pPictureItem.m_pPicture.Assign(pSVG);
-        pPictureItem.m_pPicture.Graphic.Width  := Width  - 1;
-        pPictureItem.m_pPicture.Graphic.Height := Height - 1;
-
-        // rasterize the SVG onto the bitmap
-        pBitmap.Canvas.Draw(0, 0, pPictureItem.m_pPicture.Graphic);
+        pPictureItem.m_pImage := Vcl.Graphics.TBitmap.Create;
+        RasterizeItem(pPictureItem, pPictureItem.m_pImage);
 
         // add, insert or replace the rasterized SVG in the base image list
         if (doReplace) then
         begin
-            Replace(index, pBitmap, nil);
+            Replace(index, pPictureItem.m_pImage, nil);
 
-            // replace the SVG in the picture list
+            // replace the SVG in the picture list, the replaced item is no longer pending
             if (index < m_pPictures.Count) then
+            begin
+                RemovePending(m_pPictures[index]);
                 m_pPictures[index].Assign(pPictureItem);
+            end;
         end
         else
         if (index < 0) then
         begin
-            index  := Add(pBitmap, nil);
+            index  := Add(pPictureItem.m_pImage, nil);
             Result := index;
 
             // add the SVG in the picture list
@@ -746,7 +1360,7 @@ begin
         end
         else
         begin
-            Insert(index, pBitmap, nil);
+            Insert(index, pPictureItem.m_pImage, nil);
 
             // insert the SVG in the picture list
             m_pPictures.Insert(index, pPictureItem);
@@ -804,6 +1418,19 @@ begin
     try
         for i := 0 to count - 1 do
         begin
+            // picture still not parsed? Save its raw data as is
+            if (Length(pList[i].m_Data) > 0) then
+            begin
+                imgNameBytes := TEncoding.UTF8.GetBytes(TWSVGGraphic.ClassName);
+                size         := Length(imgNameBytes);
+                pStream.WriteBuffer(size, SizeOf(size));
+                pStream.WriteBuffer(PByte(imgNameBytes)^, size);
+
+                size := Length(pList[i].m_Data);
+                pStream.WriteBuffer(size, SizeOf(size));
+                pStream.WriteBuffer(PByte(pList[i].m_Data)^, size);
+            end
+            else
             // a picture should always be assigned in the list so this should never happen
             if (not Assigned(pList[i].m_pPicture.Graphic)) then
             begin
@@ -917,6 +1544,13 @@ begin
                 // read the next size
                 pStream.ReadBuffer(size, SizeOf(size));
 
+                // keep the SVG data as is, it will be parsed when first used
+                if ((size > 0) and m_LazyLoad and (imgClassName = 'TWSVGGraphic')) then
+                begin
+                    SetLength(pItem.m_Data, size);
+                    pStream.ReadBuffer(PByte(pItem.m_Data)^, size);
+                end
+                else
                 // read the image from stream
                 if (size > 0) then
                 begin
@@ -1015,29 +1649,32 @@ begin
         // found it?
         if (Assigned(pPictureItem)) then
             // do draw a SVG graphic?
-            if (pPictureItem.m_pPicture.Graphic is TWSVGGraphic) then
+            if (IsSVGItem(pPictureItem)) then
             begin
-                // fill the background with the color key
-                if (pPictureItem.m_ColorKey.GetAlpha <> 0) then
-                begin
-                    pCanvas.Brush.Color := pPictureItem.m_ColorKey.GetColor;
-                    pCanvas.Brush.Style := bsSolid;
-                    pCanvas.FillRect(TRect.Create(x, y, x + Width, y + Height));
-                end
-                else
-                if (pCanvas.Pixels[0, y] = clFuchsia) then
+                // the image is visible, so rasterize it first if still pending
+                PromotePending(pPictureItem);
+
+                // lazily loaded picture waiting to be parsed in the background? Draw its stored
+                // base image meanwhile, the list will change once the picture is rasterized
+                if ((Length(pPictureItem.m_Data) > 0) and pPictureItem.m_Dirty and (index < Count)) then
                 begin
-                    pCanvas.Brush.Color := clBtnFace;
-                    pCanvas.Brush.Style := bsSolid;
-                    pCanvas.FillRect(TRect.Create(x, y, x + Width, y + Height));
+                    inherited DoDraw(index, pCanvas, x, y, style, enabled);
+                    Exit;
                 end;
 
-                // update the image size before painting it
-                pPictureItem.m_pPicture.Graphic.Width  := Width  - 1;
-                pPictureItem.m_pPicture.Graphic.Height := Height - 1;
+                // rasterize the premultiplied image once at the current size. NOTE it is reused by
+                // the pending queue to replace the base image placeholder
+                if (not IsImageReady(pPictureItem)) then
+                begin
+                    if (not Assigned(pPictureItem.m_pImage)) then
+                        pPictureItem.m_pImage := Vcl.Graphics.TBitmap.Create;
+
+                    RasterizeItem(pPictureItem, pPictureItem.m_pImage);
+                end;
 
-                // draw the SVG image above
-                pCanvas.Draw(x, y, pPictureItem.m_pPicture.Graphic);
+                // draw the image above the canvas content in a single blit
+                TWGDIHelper.AlphaBlendImage(pPictureItem.m_pImage, Width, Height, pCanvas, x, y, Width,
+                        Height);
                 Exit;
             end;
     end;
@@ -1101,6 +1738,10 @@ procedure TWSVGImageList.Clear;
 begin
     inherited Clear;
 
+    // nothing remains to rasterize
+    ClearPending;
+    UpdateScheduling;
+
     // clear all pictures. NOTE the object dictionary will take care to also delete the picture items
     m_pPictures.Clear;
 end;
@@ -1135,11 +1776,19 @@ begin
 
             // add copied item to local list
             m_pPictures.Add(pPictureItem);
+
+            // the source image was still pending, so the copied base image is a placeholder
+            if (pPictureItem.m_Dirty) then
+                EnqueuePending(pPictureItem);
+
             pPictureItem := nil;
         finally
             pPictureItem.Free;
         end;
     end;
+
+    // rasterize the copied placeholders later
+    UpdateScheduling;
 end;
 //---------------------------------------------------------------------------
 procedure TWSVGImageList.SetSize(newWidth, newHeight: Integer);
@@ -1160,19 +1809,13 @@ begin
 
     // something to change?
     if (((m_RefWidth = newWidth) and (Width = w))
-            and ((m_RefWidth = newWidth) and (Height = h)))
+            and ((m_RefHeight = newHeight) and (Height = h)))
     then
         Exit;
 
-    try
-        Backup;
-        Clear;
-        m_RefWidth  := newWidth;
-        m_RefHeight := newHeight;
-        inherited SetSize(w, h);
-    finally
-        Restore;
-    end;
+    m_RefWidth  := newWidth;
+    m_RefHeight := newHeight;
+    ResizeImages(w, h);
 end;
 //---------------------------------------------------------------------------
 function TWSVGImageList.AddSVG(pSVG: TWSVGGraphic; colorKey: TColor): Integer;
@@ -1197,7 +1840,10 @@ begin
 
     // also delete it in the picture list
     if (index < m_pPictures.Count) then
+    begin
+        RemovePending(m_pPictures[index]);
         m_pPictures.Delete(index);
+    end;
 end;
 //---------------------------------------------------------------------------
 function TWSVGImageList.GetSVG(index: Integer): TWSVGGraphic;
@@ -1216,13 +1862,77 @@ begin
     if (not Assigned(pPictureItem)) then
         Exit(nil);
 
+    // parse the picture first if it was lazily loaded
+    Materialize(pPictureItem);
+
     // is picture something else than a SVG?
     if (not(pPictureItem.m_pPicture.Graphic is TWSVGGraphic)) then
         Exit(nil);
 
+    // the image was requested, so rasterize it first if still pending
+    PromotePending(pPictureItem);
+
     Result := pPictureItem.m_pPicture.Graphic as TWSVGGraphic;
 end;
 //---------------------------------------------------------------------------
+procedure TWSVGImageList.RasterizePending;
+begin
+    while (RasterizeNextPending) do;
+
+    UpdateScheduling;
+end;
+//---------------------------------------------------------------------------
+function TWSVGImageList.HasPending: Boolean;
+begin
+    Result := ((m_QueueHead < m_pRasterizeQueue.Count) or (m_pPromotedQueue.Count > 0));
+end;
+//---------------------------------------------------------------------------
+function TWSVGImageList.GetMemorySize: NativeUInt;
+var
+    pItem: IWPictureItem;
+begin
+    Result := InstanceSize;
+
+    if (Assigned(m_pPictures)) then
+    begin
+        Inc(Result, m_pPictures.InstanceSize + NativeUInt(m_pPictures.Capacity) * SizeOf(Pointer));
+
+        for pItem in m_pPictures do
+        begin
+            Inc(Result, pItem.InstanceSize);
+
+            if (Assigned(pItem.m_pImage)) then
+                Inc(Result, TWMemoryHelper.GetBitmapSize(pItem.m_pImage));
+
+            Inc(Result, NativeUInt(Length(pItem.m_Data)));
+
+            if (not Assigned(pItem.m_pPicture)) then
+                continue;
+
+            Inc(Result, pItem.m_pPicture.InstanceSize);
+
+            if (pItem.m_pPicture.Graphic is TWSVGGraphic) then
+                Inc(Result, TWSVGGraphic(pItem.m_pPicture.Graphic).GetMemorySize)
+            else
+            if (pItem.m_pPicture.Graphic is Vcl.Graphics.TBitmap) then
+                Inc(Result, TWMemoryHelper.GetBitmapSize(Vcl.Graphics.TBitmap(pItem.m_pPicture.Graphic)))
+            else
+            if (Assigned(pItem.m_pPicture.Graphic)) then
+                Inc(Result, pItem.m_pPicture.Graphic.InstanceSize);
+        end;
+    end;
+
+    if (Assigned(m_pRasterizeQueue)) then
+        Inc(Result, m_pRasterizeQueue.InstanceSize + NativeUInt(m_pRasterizeQueue.Capacity) * SizeOf(Pointer));
+
+    if (Assigned(m_pPromotedQueue)) then
+        Inc(Result, m_pPromotedQueue.InstanceSize + NativeUInt(m_pPromotedQueue.Capacity) * SizeOf(Pointer));
+
+    // the native image list keeps a 32 bit copy of each image
+    if (HandleAllocated) then
+        Inc(Result, NativeUInt(Count) * NativeUInt(Width) * NativeUInt(Height) * 4);
+end;
+//---------------------------------------------------------------------------
 function TWSVGImageList.GetSVGColorKey(index: Integer): TWColor;
 var
     pPictureItem: IWPictureItem;
@@ -1259,6 +1969,9 @@ begin
         Exit;
 
     pPictureItem.m_ColorKey.Assign(colorKey);
+
+    // the premultiplied image should be rasterized again with the new background
+    pPictureItem.m_Outdated := True;
 end;
 //---------------------------------------------------------------------------
 
@@ -7,7 +7,9 @@ unit UTWSVGItems;
 
 interface
 
-uses System.Generics.Collections,
+uses System.Classes,
+     System.SysUtils,
+     System.Generics.Collections,
      {$ifdef USE_VERYSIMPLEXML}
          Xml.VerySimple,
      {$else}
@@ -37,6 +39,121 @@ type
 
     PWSVGOptions = ^TWSVGOptions;
 
+    {**
+     Buffered xml writer, streams a SVG tree as UTF-8 encoded xml without building the whole
+     document in memory
+     @br @bold(NOTE) The written content is buffered and only flushed to the target stream when the
+                     buffer is full, when Flush is called or when the writer is destroyed
+    }
+    TWSVGXmlWriter = class
+        private
+            m_pStream: TStream;
+            m_Buffer:  TBytes;
+            m_Offset:  NativeInt;
+            m_Flushed: Int64;
+            m_Depth:   Integer;
+            m_Pretty:  Boolean;
+            m_TagOpen: Boolean;
+            m_HasText: Boolean;
+
+            {**
+             Write an unicode code point to the buffer, encoded as UTF-8
+             @param(code Code point to write)
+            }
+            procedure WriteCodePoint(code: Cardinal);
+
+            {**
+             Write a string to the buffer, optionally escaping the xml reserved chars
+             @param(str String to write)
+             @param(escape If @true, the xml reserved chars will be replaced by their entities)
+            }
+            procedure WriteStr(const str: UnicodeString; escape: Boolean);
+
+            {**
+             Begin a new line and indent it at the current depth, in pretty mode only
+            }
+            procedure NewLine;
+
+            {**
+             Close the start tag of the current element, if still open
+            }
+            procedure CloseStartTag;
+
+            {**
+             Get the number of bytes written so far, including the buffered ones
+             @returns(Written byte count)
+            }
+            function GetBytesWritten: Int64;
+
+        public
+            {**
+             Constructor
+             @param(pStream Stream to write to)
+             @param(pretty If @true, the elements will be written on separate and indented lines,
+                           otherwise the output will be minified)
+             @param(bufferSize Write buffer size, in bytes)
+            }
+            constructor Create(pStream: TStream; pretty: Boolean; bufferSize: NativeInt = 65536); virtual;
+
+            {**
+             Destructor
+            }
+            destructor Destroy; override;
+
+            {**
+             Write the xml declaration
+            }
+            procedure WriteDeclaration; virtual;
+
+            {**
+             Begin a new element
+             @param(name Element tag name)
+            }
+            procedure BeginElement(const name: UnicodeString); virtual;
+
+            {**
+             End the current element
+             @param(name Element tag name)
+             @br @bold(NOTE) An element without content is closed as an empty tag
+            }
+            procedure EndElement(const name: UnicodeString); virtual;
+
+            {**
+             Write an attribute in the current element start tag
+             @param(name Attribute name)
+             @param(value Attribute value, will be escaped)
+            }
+            procedure WriteAttribute(const name, value: UnicodeString); overload; virtual;
+
+            {**
+             Write an already formatted attribute in the current element start tag
+             @param(attribute Formatted attribute, e.g. name="value", ignored if empty)
+            }
+            procedure WriteAttribute(const attribute: UnicodeString); overload; virtual;
+
+            {**
+             Write a text content in the current element
+             @param(text Text to write, will be escaped)
+            }
+            procedure WriteText(const text: UnicodeString); virtual;
+
+            {**
+             Flush the buffered content to the target stream
+            }
+            procedure Flush; virtual;
+
+        public
+            {**
+             Get if the output is pretty printed
+            }
+            property Pretty: Boolean read m_Pretty;
+
+            {**
+             Get the number of bytes written so far, including the still buffered ones
+            }
+            property BytesWritten: Int64 read GetBytesWritten;
+    end;
+
     {**
      Scalable Vector Graphics (SVG) item
     }
@@ -98,6 +215,19 @@ type
             }
             function ToXml: UnicodeString; virtual; abstract;
 
+            {**
+             Write the item as xml
+             @param(pWriter Xml writer to write to)
+            }
+            procedure WriteXml(pWriter: TWSVGXmlWriter); virtual; abstract;
+
+            {**
+             Get the memory retained by the item, including its children and properties, if any
+             @returns(Retained memory size, in bytes)
+             @br @bold(NOTE) The returned size is an estimation, the memory manager overhead is ignored
+            }
+            function GetMemorySize: NativeUInt; virtual;
+
         public
             {**
              Get or set the item name
@@ -110,9 +240,12 @@ type
             property ItemID: UnicodeString read m_ID write m_ID;
 
             {**
-             Get the parent item
+             Get or set the parent item
+             @br @bold(NOTE) Changing the parent doesn't move the item in the parent lists, this should
+                             only be used while an item is moved from a parent to another, e.g. while
+                             the tree is optimized
             }
-            property Parent: TWSVGItem read m_pParent;
+            property Parent: TWSVGItem read m_pParent write m_pParent;
 
             {**
              Get the global defines table linked with this item
@@ -172,6 +305,13 @@ type
              @returns(@true on success, otherwise @false)
             }
             function Parse(const data: UnicodeString): Boolean; virtual; abstract;
+
+            {**
+             Write the property as xml attribute
+             @param(pWriter Xml writer to write to)
+             @br @bold(NOTE) Unlike ToXml, the written value is escaped
+            }
+            procedure WriteXml(pWriter: TWSVGXmlWriter); override;
     end;
 
     {**
@@ -206,6 +346,18 @@ type
             }
             function GetPropertyCount: Integer; virtual;
 
+            {**
+             Write the element attributes as xml
+             @param(pWriter Xml writer to write to)
+            }
+            procedure WriteXmlAttributes(pWriter: TWSVGXmlWriter); virtual;
+
+            {**
+             Write the element content (i.e. text or children) as xml
+             @param(pWriter Xml writer to write to)
+            }
+            procedure WriteXmlContent(pWriter: TWSVGXmlWriter); virtual;
+
         public
             {**
              Constructor
@@ -261,18 +413,37 @@ type
             }
             function Print(margin: Cardinal): UnicodeString; override;
 
+            {**
+             Get the memory retained by the element, including its properties
+             @returns(Retained memory size, in bytes)
+            }
+            function GetMemorySize: NativeUInt; override;
+
             {**
              Get xml formatted string
              @returns(String)
             }
             function ToXml: UnicodeString; override;
 
+            {**
+             Write the element, its attributes and its content as xml
+             @param(pWriter Xml writer to write to)
+            }
+            procedure WriteXml(pWriter: TWSVGXmlWriter); override;
+
             {**
              Add a property
              @param(pProperty Property to add)
             }
             procedure AddProperty(const pProperty: TWSVGProperty); virtual;
 
+            {**
+             Delete a property
+             @param(index Index of the property to delete)
+             @br @bold(NOTE) Nothing will happen if index is out of bounds
+            }
+            procedure DeleteProperty(index: Integer); virtual;
+
         public
             {**
              Get the property at index. Example: property := Properties[0];
@@ -287,6 +458,233 @@ type
     end;
 
 implementation
+
+uses
+  UTWHelpers;
+
+//---------------------------------------------------------------------------
+// TWSVGXmlWriter
+//---------------------------------------------------------------------------
+constructor TWSVGXmlWriter.Create(pStream: TStream; pretty: Boolean; bufferSize: NativeInt);
+begin
+    inherited Create;
+
+    m_pStream := pStream;
+    m_Offset  := 0;
+    m_Flushed := 0;
+    m_Depth   := 0;
+    m_Pretty  := pretty;
+    m_TagOpen := False;
+    m_HasText := False;
+
+    // the buffer should at least be able to contain the longest UTF-8 sequence
+    if (bufferSize < 4) then
+        bufferSize := 4;
+
+    SetLength(m_Buffer, bufferSize);
+end;
+//---------------------------------------------------------------------------
+destructor TWSVGXmlWriter.Destroy;
+begin
+    Flush;
+
+    inherited Destroy;
+end;
+//---------------------------------------------------------------------------
+procedure TWSVGXmlWriter.WriteCodePoint(code: Cardinal);
+begin
+    // not enough room to write the longest UTF-8 sequence?
+    if ((m_Offset + 4) > Length(m_Buffer)) then
+        Flush;
+
+    if (code < $80) then
+    begin
+        m_Buffer[m_Offset] := Byte(code);
+        Inc(m_Offset);
+    end
+    else
+    if (code < $800) then
+    begin
+        m_Buffer[m_Offset]     := Byte($C0 or (code shr 6));
+        m_Buffer[m_Offset + 1] := Byte($80 or (code and $3F));
+        Inc(m_Offset, 2);
+    end
+    else
+    if (code < $10000) then
+    begin
+        m_Buffer[m_Offset]     := Byte($E0 or (code shr 12));
+        m_Buffer[m_Offset + 1] := Byte($80 or ((code shr 6) and $3F));
+        m_Buffer[m_Offset + 2] := Byte($80 or (code and $3F));
+        Inc(m_Offset, 3);
+    end
+    else
+    begin
+        m_Buffer[m_Offset]     := Byte($F0 or (code shr 18));
+        m_Buffer[m_Offset + 1] := Byte($80 or ((code shr 12) and $3F));
+        m_Buffer[m_Offset + 2] := Byte($80 or ((code shr 6) and $3F));
+        m_Buffer[m_Offset + 3] := Byte($80 or (code and $3F));
+        Inc(m_Offset, 4);
+    end;
+end;
+//---------------------------------------------------------------------------
+procedure TWSVGXmlWriter.WriteStr(const str: UnicodeString; escape: Boolean);
+var
+    len, i: NativeInt;
+    code:   Cardinal;
+begin
+    len := Length(str);
+    i   := 1;
+
+    while (i <= len) do
+    begin
+        code := Cardinal(str[i]);
+
+        // is a surrogate pair? (in this case the code point is spread on 2 UTF-16 chars)
+        if ((code >= $D800) and (code <= $DBFF) and (i < len) and (Cardinal(str[i + 1]) >= $DC00)
+                and (Cardinal(str[i + 1]) <= $DFFF))
+        then
+        begin
+            code := $10000 + ((code - $D800) shl 10) + (Cardinal(str[i + 1]) - $DC00);
+            Inc(i);
+        end;
+
+        Inc(i);
+
+        // xml reserved char to escape?
+        if (escape and ((code = Ord('&')) or (code = Ord('<')) or (code = Ord('>')) or (code = Ord('"'))))
+        then
+        begin
+            case (code) of
+                Ord('&'): WriteStr('&amp;',  False);
+                Ord('<'): WriteStr('&lt;',   False);
+                Ord('>'): WriteStr('&gt;',   False);
+            else
+                WriteStr('&quot;', False);
+            end;
+
+            continue;
+        end;
+
+        WriteCodePoint(code);
+    end;
+end;
+//---------------------------------------------------------------------------
+procedure TWSVGXmlWriter.NewLine;
+var
+    i: Integer;
+begin
+    if (not m_Pretty) then
+        Exit;
+
+    // nothing written yet? (i.e. no line to break)
+    if (GetBytesWritten = 0) then
+        Exit;
+
+    WriteCodePoint(13);
+    WriteCodePoint(10);
+
+    for i := 1 to m_Depth do
+    begin
+        WriteCodePoint(Ord(' '));
+        WriteCodePoint(Ord(' '));
+    end;
+end;
+//---------------------------------------------------------------------------
+procedure TWSVGXmlWriter.CloseStartTag;
+begin
+    if (not m_TagOpen) then
+        Exit;
+
+    WriteCodePoint(Ord('>'));
+    m_TagOpen := False;
+end;
+//---------------------------------------------------------------------------
+function TWSVGXmlWriter.GetBytesWritten: Int64;
+begin
+    Result := m_Flushed + m_Offset;
+end;
+//---------------------------------------------------------------------------
+procedure TWSVGXmlWriter.WriteDeclaration;
+begin
+    WriteStr('<?xml version="1.0" encoding="UTF-8" standalone="no"?>', False);
+end;
+//---------------------------------------------------------------------------
+procedure TWSVGXmlWriter.BeginElement(const name: UnicodeString);
+begin
+    CloseStartTag;
+    NewLine;
+
+    WriteCodePoint(Ord('<'));
+    WriteStr(name, False);
+
+    Inc(m_Depth);
+    m_TagOpen := True;
+    m_HasText := False;
+end;
+//---------------------------------------------------------------------------
+procedure TWSVGXmlWriter.EndElement(const name: UnicodeString);
+begin
+    Dec(m_Depth);
+
+    // no content was written in the element? Close it as an empty tag
+    if (m_TagOpen) then
+    begin
+        WriteStr('/>', False);
+        m_TagOpen := False;
+        Exit;
+    end;
+
+    // the closing tag of an element containing a text should stick to the text
+    if (not m_HasText) then
+        NewLine;
+
+    WriteStr('</', False);
+    WriteStr(name, False);
+    WriteCodePoint(Ord('>'));
+
+    m_HasText := False;
+end;
+//---------------------------------------------------------------------------
+procedure TWSVGXmlWriter.WriteAttribute(const name, value: UnicodeString);
+begin
+    WriteCodePoint(Ord(' '));
+    WriteStr(name, False);
+    WriteStr('="', False);
+    WriteStr(value, True);
+    WriteCodePoint(Ord('"'));
+end;
+//---------------------------------------------------------------------------
+procedure TWSVGXmlWriter.WriteAttribute(const attribute: UnicodeString);
+begin
+    if (Length(attribute) = 0) then
+        Exit;
+
+    WriteCodePoint(Ord(' '));
+    WriteStr(attribute, False);
+end;
+//---------------------------------------------------------------------------
+procedure TWSVGXmlWriter.WriteText(const text: UnicodeString);
+begin
+    if (Length(text) = 0) then
+        Exit;
+
+    CloseStartTag;
+    WriteStr(text, True);
+
+    m_HasText := True;
+end;
+//---------------------------------------------------------------------------
+procedure TWSVGXmlWriter.Flush;
+begin
+    if (m_Offset = 0) then
+        Exit;
+
+    if (Assigned(m_pStream)) then
+        m_pStream.WriteBuffer(m_Buffer[0], m_Offset);
+
+    Inc(m_Flushed, m_Offset);
+    m_Offset := 0;
+end;
 //---------------------------------------------------------------------------
 // TWSVGItem
 //---------------------------------------------------------------------------
@@ -327,6 +725,11 @@ begin
     m_ID   := '';
 end;
 //---------------------------------------------------------------------------
+function TWSVGItem.GetMemorySize: NativeUInt;
+begin
+    Result := InstanceSize + TWMemoryHelper.GetStringSize(m_Name) + TWMemoryHelper.GetStringSize(m_ID);
+end;
+//---------------------------------------------------------------------------
 // TWSVGProperty
 //---------------------------------------------------------------------------
 constructor TWSVGProperty.Create(pParent: TWSVGItem; pOptions: PWSVGOptions);
@@ -374,6 +777,31 @@ begin
         Result := Parse(TWSVGCommon.PrepareStr(value));
 end;
 //---------------------------------------------------------------------------
+procedure TWSVGProperty.WriteXml(pWriter: TWSVGXmlWriter);
+var
+    xml, prefix: UnicodeString;
+    valueLength: Integer;
+begin
+    xml    := ToXml;
+    prefix := m_Name + '="';
+
+    // is a single name="value" attribute? If yes, write its value escaped
+    if ((Length(m_Name) > 0) and (Length(xml) > Length(prefix)) and (Copy(xml, 1, Length(prefix)) = prefix)
+            and (xml[Length(xml)] = '"'))
+    then
+    begin
+        valueLength := Length(xml) - Length(prefix) - 1;
+        pWriter.WriteAttribute(m_Name, Copy(xml, Length(prefix) + 1, valueLength));
+        Exit;
+    end;
+
+    // otherwise the quotes cannot be told apart from the delimiters, escape the other reserved chars
+    xml := StringReplace(xml, '&', '&amp;', [rfReplaceAll]);
+    xml := StringReplace(xml, '<', '&lt;',  [rfReplaceAll]);
+
+    pWriter.WriteAttribute(xml);
+end;
+//---------------------------------------------------------------------------
 // TWSVGElement
 //---------------------------------------------------------------------------
 constructor TWSVGElement.Create(pParent: TWSVGItem; pOptions: PWSVGOptions);
@@ -412,6 +840,20 @@ begin
     Result := m_pProperties.Count;
 end;
 //---------------------------------------------------------------------------
+procedure TWSVGElement.WriteXmlAttributes(pWriter: TWSVGXmlWriter);
+var
+    pProperty: TWSVGProperty;
+begin
+    // iterate through properties to write
+    for pProperty in m_pProperties do
+        pProperty.WriteXml(pWriter);
+end;
+//---------------------------------------------------------------------------
+procedure TWSVGElement.WriteXmlContent(pWriter: TWSVGXmlWriter);
+begin
+    // basic element has no content
+end;
+//---------------------------------------------------------------------------
 procedure TWSVGElement.Assign(const pOther: TWSVGItem);
 var
     pSource:             TWSVGElement;
@@ -464,24 +906,74 @@ end;
 //---------------------------------------------------------------------------
 function TWSVGElement.Print(margin: Cardinal): UnicodeString;
 var
+    pBuilder:  TStringBuilder;
     pProperty: TWSVGProperty;
 begin
-    Result := '';
+    pBuilder := TStringBuilder.Create;
+
+    try
+        // iterate through properties to print
+        for pProperty in m_pProperties do
+            pBuilder.Append(pProperty.Print(margin));
+
+        Result := pBuilder.ToString;
+    finally
+        pBuilder.Free;
+    end;
+end;
+//---------------------------------------------------------------------------
+function TWSVGElement.GetMemorySize: NativeUInt;
+var
+    pProperty: TWSVGProperty;
+begin
+    Result := inherited GetMemorySize;
+
+    if (not Assigned(m_pProperties)) then
+        Exit;
+
+    Inc(Result, m_pProperties.InstanceSize + (NativeUInt(m_pProperties.Capacity) * SizeOf(Pointer)));
 
-    // iterate through properties to log
     for pProperty in m_pProperties do
-        Result := Result + pProperty.Print(margin);
+        Inc(Result, pProperty.GetMemorySize);
 end;
 //---------------------------------------------------------------------------
 function TWSVGElement.ToXml: UnicodeString;
 var
+    pBuilder:  TStringBuilder;
     pProperty: TWSVGProperty;
+    attribute: UnicodeString;
 begin
-    Result := '';
+    pBuilder := TStringBuilder.Create;
 
-    // iterate through properties to log
-    for pProperty in m_pProperties do
-        Result := Result + pProperty.ToXml;
+    try
+        // iterate through properties to convert to xml
+        for pProperty in m_pProperties do
+        begin
+            attribute := pProperty.ToXml;
+
+            // property has nothing to export?
+            if (Length(attribute) = 0) then
+                continue;
+
+            // separate the attributes
+            if (pBuilder.Length > 0) then
+                pBuilder.Append(' ');
+
+            pBuilder.Append(attribute);
+        end;
+
+        Result := pBuilder.ToString;
+    finally
+        pBuilder.Free;
+    end;
+end;
+//---------------------------------------------------------------------------
+procedure TWSVGElement.WriteXml(pWriter: TWSVGXmlWriter);
+begin
+    pWriter.BeginElement(ItemName);
+    WriteXmlAttributes(pWriter);
+    WriteXmlContent(pWriter);
+    pWriter.EndElement(ItemName);
 end;
 //---------------------------------------------------------------------------
 procedure TWSVGElement.AddProperty(const pProperty: TWSVGProperty);
@@ -500,5 +992,13 @@ begin
     end;
 end;
 //---------------------------------------------------------------------------
+procedure TWSVGElement.DeleteProperty(index: Integer);
+begin
+    if ((index < 0) or (index >= m_pProperties.Count)) then
+        Exit;
+
+    m_pProperties.Delete(index);
+end;
+//---------------------------------------------------------------------------
 
 end.
@@ -398,7 +398,7 @@ begin
                 valStr := IntToStr(value.AsInt64);
 
         tkFloat:
-            valStr := FloatToStr(value.AsExtended);
+            valStr := FloatToStr(value.AsExtended, g_InternationalFormatSettings);
     else
         raise Exception.CreateFmt('Unsupported type - %d', [Integer(value.Kind)]);
     end;
@@ -422,9 +422,9 @@ begin
     {$else}
         if (m_Unit = IE_UN_None) then
     {$ifend}
-        Result := Result + '=\"' + valStr + '\"'
+        Result := Result + '="' + valStr + '"'
     else
-        Result := Result + '=\"' + valStr + UnitToStr(m_Unit, '') + '\"';
+        Result := Result + '="' + valStr + UnitToStr(m_Unit, '') + '"';
 end;
 //---------------------------------------------------------------------------
 class function TWSVGMeasure<T>.StrToUnit(const unitStr: UnicodeString): IEUnit;
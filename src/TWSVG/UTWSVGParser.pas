@@ -7,7 +7,8 @@ unit UTWSVGParser;
 
 interface
 
-uses System.SysUtils,
+uses System.Classes,
+     System.SysUtils,
      System.Generics.Collections,
      Vcl.Graphics,
      {$ifdef USE_VERYSIMPLEXML}
@@ -182,12 +183,34 @@ type
             }
             function Print(margin: Cardinal): UnicodeString; override;
 
+            {**
+             Get the memory retained by the parser, including the whole SVG tree
+             @returns(Retained memory size, in bytes)
+            }
+            function GetMemorySize: NativeUInt; override;
+
             {**
              Get xml formatted string
              @returns(String)
             }
             function ToXml: UnicodeString; override;
 
+            {**
+             Write the whole SVG document as xml
+             @param(pWriter Xml writer to write to)
+            }
+            procedure WriteXml(pWriter: TWSVGXmlWriter); override;
+
+            {**
+             Save the SVG document to a stream, as UTF-8 encoded xml
+             @param(pStream Stream to save to)
+             @param(pretty If @true, the elements will be written on separate and indented lines,
+                           otherwise the output will be minified)
+             @br @bold(NOTE) The document is built from the parsed tree, for that any change applied
+                             on it will be saved, but the data the parser doesn't support will be lost
+            }
+            procedure SaveToStream(pStream: TStream; pretty: Boolean = True); virtual;
+
         public
             {**
              Get element contained in the defs dictionary at the key. Example: element := Defs['key'];
@@ -1041,9 +1064,111 @@ begin
         PrintDefs(margin, Result);
 end;
 //---------------------------------------------------------------------------
+function TWSVGParser.GetMemorySize: NativeUInt;
+var
+    key: UnicodeString;
+begin
+    Result := inherited GetMemorySize;
+
+    if (not Assigned(m_pDefsTable)) then
+        Exit;
+
+    // the defines table only references the items, which are owned by the tree, so only its keys
+    // and slots are measured
+    Inc(Result, m_pDefsTable.InstanceSize + (NativeUInt(m_pDefsTable.Count) * 3 * SizeOf(Pointer)));
+
+    for key in m_pDefsTable.Keys do
+        Inc(Result, TWMemoryHelper.GetStringSize(key));
+end;
+//---------------------------------------------------------------------------
 function TWSVGParser.ToXml: UnicodeString;
+var
+    pStream: TStringStream;
+begin
+    pStream := TStringStream.Create('', TEncoding.UTF8);
+
+    try
+        SaveToStream(pStream, True);
+        Result := pStream.DataString;
+    finally
+        pStream.Free;
+    end;
+end;
+//---------------------------------------------------------------------------
+procedure TWSVGParser.WriteXml(pWriter: TWSVGXmlWriter);
+var
+    pProperty: TWSVGProperty;
+    pElement:  TWSVGElement;
+    index, i:  NativeInt;
 begin
-    raise Exception.Create('NOT IMPLEMENTED');
+    pWriter.WriteDeclaration;
+    pWriter.BeginElement(C_SVG_Tag_Name);
+    pWriter.WriteAttribute(C_SVG_Prop_XMLNS,       C_SVG_Namespace_SVG);
+    pWriter.WriteAttribute(C_SVG_Prop_XMLNS_XLink, C_SVG_Namespace_XLink);
+
+    // iterate through properties to write
+    for pProperty in m_pProperties do
+        pProperty.WriteXml(pWriter);
+
+    // the first element should always be the header, its properties are the root element attributes
+    if ((m_pElements.Count > 0) and (m_pElements[0] is IHeader)) then
+    begin
+        pElement := m_pElements[0];
+
+        for i := 0 to pElement.Count - 1 do
+            pElement.Properties[i].WriteXml(pWriter);
+
+        index := 1;
+    end
+    else
+        index := 0;
+
+    // write the defines section
+    if (m_pDefsElements.Count > 0) then
+    begin
+        pWriter.BeginElement(C_SVG_Tag_Defs);
+
+        for pElement in m_pDefsElements do
+            pElement.WriteXml(pWriter);
+
+        pWriter.EndElement(C_SVG_Tag_Defs);
+    end;
+
+    // iterate through the remaining elements to write
+    while (index < m_pElements.Count) do
+    begin
+        m_pElements[index].WriteXml(pWriter);
+        Inc(index);
+    end;
+
+    // iterate through animations to write
+    for pElement in m_pAnimations do
+        pElement.WriteXml(pWriter);
+
+    pWriter.EndElement(C_SVG_Tag_Name);
+end;
+//---------------------------------------------------------------------------
+procedure TWSVGParser.SaveToStream(pStream: TStream; pretty: Boolean);
+var
+    pWriter:    TWSVGXmlWriter;
+    traceStart: Int64;
+begin
+    // no stream?
+    if (not Assigned(pStream)) then
+        Exit;
+
+    traceStart := TWTraceHelper.Start;
+    pWriter    := nil;
+
+    try
+        pWriter := TWSVGXmlWriter.Create(pStream, pretty);
+        WriteXml(pWriter);
+    finally
+        // NOTE the writer flushes its remaining content while destroyed
+        pWriter.Free;
+
+        TWTraceHelper.Stop('Serialize', 'svg', traceStart);
+    end;
 end;
 //---------------------------------------------------------------------------
 
@@ -652,6 +652,13 @@ type
             }
             function Print(margin: Cardinal): UnicodeString; override;
 
+            {**
+             Get the memory retained by the link, including its value (which may contain a whole
+             encoded image)
+             @returns(Retained memory size, in bytes)
+            }
+            function GetMemorySize: NativeUInt; override;
+
             {**
              Get xml formatted string
              @returns(String)
@@ -984,12 +991,25 @@ type
             }
             function Print(margin: Cardinal): UnicodeString; override;
 
+            {**
+             Get the memory retained by the text, including its value
+             @returns(Retained memory size, in bytes)
+            }
+            function GetMemorySize: NativeUInt; override;
+
             {**
              Get xml formatted string
              @returns(String)
             }
             function ToXml: UnicodeString; override;
 
+            {**
+             Write the text as xml attribute
+             @param(pWriter Xml writer to write to)
+             @br @bold(NOTE) Unlike ToXml, the written value is escaped
+            }
+            procedure WriteXml(pWriter: TWSVGXmlWriter); override;
+
         public
             {**
              Get or set the text value
@@ -1392,20 +1412,20 @@ begin
         Exit ('');
 
     // format property name
-    Result := ItemName + '=\"';
+    Result := ItemName + '="';
 
     // iterate through values
     for i := 0 to count - 1 do
     begin
-        // first value?
-        if (i = 0) then
+        // not the first value?
+        if (i <> 0) then
             Result := Result + ';';
 
         Result := Result + ValueToStr(m_Values[i]);
     end;
 
     // close the formatted string
-    Result := Result + '\"';
+    Result := Result + '"';
 end;
 //---------------------------------------------------------------------------
 // TWSVGPropAspectRatio
@@ -1562,7 +1582,7 @@ end;
 //---------------------------------------------------------------------------
 function TWSVGPropAspectRatio.ToXml: UnicodeString;
 begin
-    Result := ItemName + '=\"' + ToStr(m_AspectRatio) + ' ' + ToStr(m_Reference) + '\"';
+    Result := ItemName + '="' + ToStr(m_AspectRatio) + ' ' + ToStr(m_Reference) + '"';
 end;
 //---------------------------------------------------------------------------
 class function TWSVGPropAspectRatio.ToStr(aspectRatio: IEAspectRatio): UnicodeString;
@@ -1718,8 +1738,11 @@ end;
 function TWSVGPropBackground.ToXml: UnicodeString;
 begin
     // format string
-    Result := ItemName + '=\"' + BgModeToStr(m_BgMode, '') + ' ' + FloatToStr(m_X) + ' '
-            + FloatToStr(m_Y) + ' ' + FloatToStr(m_Width) + ' ' + FloatToStr(m_Height) + '\"';
+    Result := ItemName + '="' + BgModeToStr(m_BgMode, '') + ' '
+            + FloatToStr(m_X,      g_InternationalFormatSettings) + ' '
+            + FloatToStr(m_Y,      g_InternationalFormatSettings) + ' '
+            + FloatToStr(m_Width,  g_InternationalFormatSettings) + ' '
+            + FloatToStr(m_Height, g_InternationalFormatSettings) + '"';
 end;
 //---------------------------------------------------------------------------
 class function TWSVGPropBackground.StrToBgMode(const bgMode: UnicodeString): IEBgMode;
@@ -1912,20 +1935,20 @@ begin
         Exit ('');
 
     // format property name
-    Result := ItemName + '=\"';
+    Result := ItemName + '="';
 
     // iterate through color values
     for i := 0 to colorCount - 1 do
     begin
-        // first value?
-        if (i = 0) then
+        // not the first value?
+        if (i <> 0) then
             Result := Result + ';';
 
         Result := Result + m_Values[i].ToHex(False);
     end;
 
     // close the formatted string
-    Result := Result + '\"';
+    Result := Result + '"';
 end;
 //---------------------------------------------------------------------------
 class function TWSVGPropColor.ParseColor(const value: UnicodeString): TWColor;
@@ -2186,14 +2209,45 @@ begin
             + TWStringHelper.BoolToStr(m_Local, True) + #13 + #10;
 end;
 //---------------------------------------------------------------------------
+function TWSVGPropLink.GetMemorySize: NativeUInt;
+begin
+    Result := inherited GetMemorySize + TWMemoryHelper.GetStringSize(m_Value);
+end;
+//---------------------------------------------------------------------------
 function TWSVGPropLink.ToXml: UnicodeString;
+var
+    value: UnicodeString;
 begin
+    // search for embedded data type
+    case (m_DataType) of
+        IE_DT_PNG: value := C_SVG_Global_Data + ':image/png';
+        IE_DT_JPG: value := C_SVG_Global_Data + ':image/jpeg';
+        IE_DT_SVG: value := C_SVG_Global_Data + ':image/svg+xml';
+    else
+        value := '';
+    end;
+
     // format string
+    if (Length(value) > 0) then
+    begin
+        if (m_Encoding = IE_E_Base64) then
+            value := value + ';base64';
+
+        value := value + ',' + m_Value;
+    end
+    else
     if (m_Local) then
-        Result := ItemName + '=\"' + C_SVG_Link_URL + '(#' + m_Value + ')\"'
+    begin
+        // hyperlink references are written as raw local links, all other links are urls
+        if ((ItemName = C_SVG_Prop_XLink_HRef) or (ItemName = C_SVG_Prop_HRef)) then
+            value := '#' + m_Value
+        else
+            value := C_SVG_Link_URL + '(#' + m_Value + ')';
+    end
     else
-        TWLogHelper.LogToCompiler('Log SVG link to XML - non-local values are not supported for now - '
-                + m_Value);
+        value := m_Value;
+
+    Result := ItemName + '="' + value + '"';
 end;
 //---------------------------------------------------------------------------
 // TWSVGPropMatrix
@@ -2640,36 +2694,46 @@ end;
 function TWSVGPropMatrix.ToXml: UnicodeString;
 begin
     // format string
-    Result := ItemName + '=\"';
+    Result := ItemName + '="';
 
     case (m_Type) of
         IE_Translate:
-            Result := Result + C_SVG_Matrix_Translate + '(' + FloatToStr(m_Matrix.Table[2, 0]) + ','
-                    + FloatToStr(m_Matrix.Table[2, 1]) + ')';
+            Result := Result + C_SVG_Matrix_Translate + '('
+                    + FloatToStr(m_Matrix.Table[2, 0], g_InternationalFormatSettings) + ','
+                    + FloatToStr(m_Matrix.Table[2, 1], g_InternationalFormatSettings) + ')';
 
         IE_Scale:
-            Result := Result + C_SVG_Matrix_Scale + '(' + FloatToStr(m_Matrix.Table[0, 0]) + ','
-                    + FloatToStr(m_Matrix.Table[1, 1]) + ')';
+            Result := Result + C_SVG_Matrix_Scale + '('
+                    + FloatToStr(m_Matrix.Table[0, 0], g_InternationalFormatSettings) + ','
+                    + FloatToStr(m_Matrix.Table[1, 1], g_InternationalFormatSettings) + ')';
 
         IE_Rotate:
-            Result := Result + C_SVG_Matrix_Rotate + '(' + FloatToStr(m_Matrix.Table[0, 0]) + ','
-                    + FloatToStr(m_Matrix.Table[0, 1]) + ')';
+            Result := Result + C_SVG_Matrix_Rotate + '('
+                    + FloatToStr(m_Matrix.Table[0, 0], g_InternationalFormatSettings) + ','
+                    + FloatToStr(m_Matrix.Table[0, 1], g_InternationalFormatSettings) + ')';
 
-        IE_SkewX: Result := Result + C_SVG_Matrix_SkewX + '(' + FloatToStr(m_Matrix.Table[1, 0]) + ')';
-        IE_SkewY: Result := Result + C_SVG_Matrix_SkewY + '(' + FloatToStr(m_Matrix.Table[0, 1]) + ')';
+        IE_SkewX:
+            Result := Result + C_SVG_Matrix_SkewX + '('
+                    + FloatToStr(m_Matrix.Table[1, 0], g_InternationalFormatSettings) + ')';
+
+        IE_SkewY:
+            Result := Result + C_SVG_Matrix_SkewY + '('
+                    + FloatToStr(m_Matrix.Table[0, 1], g_InternationalFormatSettings) + ')';
 
         IE_Custom:
             Result := Result + C_SVG_Matrix_Matrix + '('
-                    + FloatToStr(m_Matrix.Table[0, 0]) + ',' + FloatToStr(m_Matrix.Table[0, 1]) + ','
-                    + FloatToStr(m_Matrix.Table[1, 0]) + ',' + FloatToStr(m_Matrix.Table[1, 1]) + ','
-                    + FloatToStr(m_Matrix.Table[2, 0]) + ',' + FloatToStr(m_Matrix.Table[2, 1])
-                    + ')';
+                    + FloatToStr(m_Matrix.Table[0, 0], g_InternationalFormatSettings) + ','
+                    + FloatToStr(m_Matrix.Table[0, 1], g_InternationalFormatSettings) + ','
+                    + FloatToStr(m_Matrix.Table[1, 0], g_InternationalFormatSettings) + ','
+                    + FloatToStr(m_Matrix.Table[1, 1], g_InternationalFormatSettings) + ','
+                    + FloatToStr(m_Matrix.Table[2, 0], g_InternationalFormatSettings) + ','
+                    + FloatToStr(m_Matrix.Table[2, 1], g_InternationalFormatSettings) + ')';
     else
         raise Exception.CreateFmt('Unknown matrix type - %d', [Integer(m_Type)]);
     end;
 
     // close string
-    Result := Result + '\"';
+    Result := Result + '"';
 end;
 //---------------------------------------------------------------------------
 // TWSVGPropRect
@@ -2761,8 +2825,11 @@ end;
 function TWSVGPropRect.ToXml: UnicodeString;
 begin
     // format string
-    Result := ItemName + '=\"' + FloatToStr(m_X) + ' ' + FloatToStr(m_Y) + ' ' + FloatToStr(m_Width)
-            + ' ' + FloatToStr(m_Height) + '\"';
+    Result := ItemName + '="'
+            + FloatToStr(m_X,      g_InternationalFormatSettings) + ' '
+            + FloatToStr(m_Y,      g_InternationalFormatSettings) + ' '
+            + FloatToStr(m_Width,  g_InternationalFormatSettings) + ' '
+            + FloatToStr(m_Height, g_InternationalFormatSettings) + '"';
 end;
 //---------------------------------------------------------------------------
 // TWSVGPropText
@@ -2825,10 +2892,20 @@ begin
     Result := TWStringHelper.FillStrRight(ItemName, margin, ' ') + ' - ' + m_Value + #13 + #10;
 end;
 //---------------------------------------------------------------------------
+function TWSVGPropText.GetMemorySize: NativeUInt;
+begin
+    Result := inherited GetMemorySize + TWMemoryHelper.GetStringSize(m_Value);
+end;
+//---------------------------------------------------------------------------
 function TWSVGPropText.ToXml: UnicodeString;
 begin
     // format string
-    Result := ItemName + '=\"' + m_Value + '\"';
+    Result := ItemName + '="' + m_Value + '"';
+end;
+//---------------------------------------------------------------------------
+procedure TWSVGPropText.WriteXml(pWriter: TWSVGXmlWriter);
+begin
+    pWriter.WriteAttribute(ItemName, m_Value);
 end;
 //---------------------------------------------------------------------------
 // TWSVGPropTime
@@ -2943,7 +3020,7 @@ end;
 //---------------------------------------------------------------------------
 function TWSVGPropTime.ToXml: UnicodeString;
 begin
-    Result := ItemName + '=\"';
+    Result := ItemName + '="';
 
     // is time indefinite?
     if (m_Indefinite) then
@@ -2951,7 +3028,7 @@ begin
     else
         Result := Result + m_Value.ToSMIL;
 
-    Result := Result + '\"';
+    Result := Result + '"';
 end;
 //---------------------------------------------------------------------------
 // TWSVGPropUnit
@@ -3031,7 +3108,7 @@ end;
 function TWSVGPropUnit.ToXml: UnicodeString;
 begin
     // format string
-    Result := ItemName + '=\"' + UnitTypeToStr(m_Type, '') + '\"';
+    Result := ItemName + '="' + UnitTypeToStr(m_Type, '') + '"';
 end;
 //---------------------------------------------------------------------------
 class function TWSVGPropUnit.StrToUnitType(const unitType: UnicodeString): IEType;
@@ -3127,7 +3204,7 @@ end;
 function TWSVGPropVersion.ToXml: UnicodeString;
 begin
     // format string
-    Result := ItemName + '=\"' + m_Version.ToStr(2) + '\"';
+    Result := ItemName + '="' + m_Version.ToStr(2) + '"';
 end;
 //---------------------------------------------------------------------------
 
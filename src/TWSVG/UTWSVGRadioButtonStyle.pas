@@ -643,7 +643,7 @@ begin
                 Exit;
 
             FillBg(bgRect, pRadioButton, m_pCanvas);
-            m_pCanvas.StretchDraw(cbRect, m_pDisabledCheckedGlyph.Picture.Graphic);
+            DrawGlyph(m_pDisabledCheckedGlyph, cbRect, IEGlyphState.IE_GS_DisabledChecked);
         end
         else
         begin
@@ -652,7 +652,7 @@ begin
                 Exit;
 
             FillBg(bgRect, pRadioButton, m_pCanvas);
-            m_pCanvas.StretchDraw(cbRect, m_pDisabledUncheckedGlyph.Picture.Graphic);
+            DrawGlyph(m_pDisabledUncheckedGlyph, cbRect, IEGlyphState.IE_GS_DisabledUnchecked);
         end;
 
         Exit;
@@ -666,7 +666,7 @@ begin
             Exit;
 
         FillBg(bgRect, pRadioButton, m_pCanvas);
-        m_pCanvas.StretchDraw(cbRect, m_pCheckedGlyph.Picture.Graphic);
+        DrawGlyph(m_pCheckedGlyph, cbRect, IEGlyphState.IE_GS_Checked);
     end
     else
     begin
@@ -675,7 +675,7 @@ begin
             Exit;
 
         FillBg(bgRect, pRadioButton, m_pCanvas);
-        m_pCanvas.StretchDraw(cbRect, m_pUncheckedGlyph.Picture.Graphic);
+        DrawGlyph(m_pUncheckedGlyph, cbRect, IEGlyphState.IE_GS_Unchecked);
     end;
 end;
 //---------------------------------------------------------------------------
@@ -6,11 +6,16 @@
 unit UTWSVGRasterizer;
 
 interface
+    // uncomment line below to enable the render profiling (never in release)
+    {$ifdef WTCONTROLS_DEBUG}
+        {$define ENABLE_SVG_RENDER_PROFILING}
+    {$endif}
 
 uses System.SysUtils,
      System.Classes,
      System.Math,
      System.Generics.Collections,
+     System.Diagnostics,
      System.UITypes,
      Soap.EncdDecd,
      Vcl.Graphics,
@@ -23,6 +28,7 @@ uses System.SysUtils,
      UTWRect,
      UTWGeometryTools,
      UTWDateTime,
+     UTWCacheHit,
      UTWSmartPointer,
      UTWSVGTags,
      UTWSVGCommon,
@@ -46,6 +52,7 @@ const
     C_SVG_Default_Color:      TColor                             = clBlack;
     C_SVG_Default_Display:    TWSVGStyle.IPropDisplay.IEValue    = TWSVGStyle.IPropDisplay.IEValue.IE_V_Inline;
     C_SVG_Default_Visibility: TWSVGStyle.IPropVisibility.IEValue = TWSVGStyle.IPropVisibility.IEValue.IE_V_Visible;
+    C_SVG_Draft_Flatness:     Single                             = 1.0; // max curve flattening error, in device pixels
     //---------------------------------------------------------------------------
 
 type
@@ -109,6 +116,19 @@ type
                 IE_TD_LineThrough
             );
 
+            {**
+             Render quality
+             @value(IE_RQ_Full The SVG is rendered with the full quality)
+             @value(IE_RQ_Draft The SVG is rendered faster but with a lower quality, e.g. while the user
+                                is resizing or zooming the image. A full quality pass should be rendered
+                                once the interaction ends)
+            }
+            IERenderQuality =
+            (
+                IE_RQ_Full,
+                IE_RQ_Draft
+            );
+
             {**
              Animation parameters structure. Custom data will be transmitted in OnAnimate callback
             }
@@ -117,6 +137,31 @@ type
                 m_pCustomData: Pointer;
             end;
 
+            {**
+             Render buffer pixel format
+             @value(IE_PF_PremultipliedBGRA 32 bit pixels stored as blue, green, red and alpha bytes, the
+                                            colors being premultiplied by the alpha, as expected e.g. by
+                                            the GDI and the VCL bitmaps)
+             @value(IE_PF_StraightRGBA 32 bit pixels stored as red, green, blue and alpha bytes, the colors
+                                       not being premultiplied, as expected e.g. by the OpenGL textures)
+            }
+            IEPixelFormat =
+            (
+                IE_PF_PremultipliedBGRA,
+                IE_PF_StraightRGBA
+            );
+
+            {**
+             Render buffer, i.e. a memory block provided by the caller to draw on
+            }
+            IRenderBuffer = record
+                m_pBits:       Pointer;       // first pixel of the top row
+                m_Width:       Integer;       // width in pixels
+                m_Height:      Integer;       // height in pixels
+                m_Stride:      Integer;       // offset in bytes between two rows, negative if bottom-up
+                m_PixelFormat: IEPixelFormat;
+            end;
+
             {**
              Called while animation is running
              @param(pAnimDesc Animation description)
@@ -136,6 +181,116 @@ type
             ITfGetImageEvent = function (pSender: TObject; pStream: TMemoryStream; imageType: IEImageType;
                     var pGraphic: TGraphic): Boolean of object;
 
+            {**
+             Render profiling stage
+             @value(IE_PS_Element Whole element drawing, including its children if it's a container)
+             @value(IE_PS_Props Properties and style resolution)
+             @value(IE_PS_Geometry Geometry conversion, e.g. from path commands to a renderer path)
+             @value(IE_PS_Clipping Clip path resolution and application)
+             @value(IE_PS_Fill Fill painting)
+             @value(IE_PS_Stroke Stroke painting)
+             @value(IE_PS_Effect Raster effects painting, e.g. the embedded images)
+            }
+            IEProfileStage =
+            (
+                IE_PS_Element,
+                IE_PS_Props,
+                IE_PS_Geometry,
+                IE_PS_Clipping,
+                IE_PS_Fill,
+                IE_PS_Stroke,
+                IE_PS_Effect
+            );
+
+            {**
+             Render profiler, accumulates the count and the elapsed time per element type and per
+             rendering stage
+             @br @bold(NOTE) The rasterizer feeds the profiler only if ENABLE_SVG_RENDER_PROFILING is
+                             defined, otherwise the statistics always remain empty
+            }
+            IProfiler = class
+                private type
+                    {**
+                     Statistics of an element type
+                    }
+                    IEntry = class
+                        private
+                            m_Count: array [IEProfileStage] of NativeUInt;
+                            m_Ticks: array [IEProfileStage] of Int64;
+                    end;
+
+                    IEntries = TObjectDictionary<TClass, IEntry>;
+
+                private
+                    m_pEntries: IEntries;
+                    m_Enabled:  Boolean;
+
+                public
+                    {**
+                     Constructor
+                    }
+                    constructor Create; virtual;
+
+                    {**
+                     Destructor
+                    }
+                    destructor Destroy; override;
+
+                    {**
+                     Clear the statistics
+                    }
+                    procedure Clear; virtual;
+
+                    {**
+                     Start to measure a stage
+                     @returns(Time stamp to pass to Stop() once the stage is done)
+                    }
+                    function Start: Int64; inline;
+
+                    {**
+                     Stop to measure a stage, and accumulate its elapsed time
+                     @param(pElement Element for which the stage was measured)
+                     @param(stage Measured stage)
+                     @param(startTime Time stamp returned by Start())
+                    }
+                    procedure Stop(const pElement: TWSVGElement; stage: IEProfileStage; startTime: Int64); virtual;
+
+                    {**
+                     Add a measure to the statistics
+                     @param(elementType Element type, e.g. TWSVGPath)
+                     @param(stage Measured stage)
+                     @param(ticks Elapsed time, in stopwatch ticks)
+                    }
+                    procedure Add(elementType: TClass; stage: IEProfileStage; ticks: Int64); virtual;
+
+                    {**
+                     Get the element types for which statistics were accumulated
+                     @returns(Element types)
+                    }
+                    function GetElementTypes: TArray<TClass>; virtual;
+
+                    {**
+                     Get the statistics of an element type for a stage
+                     @param(elementType Element type, e.g. TWSVGPath)
+                     @param(stage Stage)
+                     @param(count @bold([out]) Number of times the stage was measured)
+                     @param(time @bold([out]) Accumulated elapsed time, in milliseconds)
+                     @returns(@true if statistics exist for this element type, otherwise @false)
+                    }
+                    function GetStats(elementType: TClass; stage: IEProfileStage; out count: NativeUInt;
+                            out time: Double): Boolean; virtual;
+
+                    {**
+                     Log the statistics in compiler event logs
+                    }
+                    procedure Log; virtual;
+
+                    {**
+                     Get or set if the profiler is enabled. If disabled, the measures are ignored
+                    }
+                    property Enabled: Boolean read m_Enabled write m_Enabled;
+            end;
+
         protected type
             IValuesF = TWSVGAttribute<Single>.IValues;
 
@@ -363,10 +518,12 @@ type
 
             {**
              Matrix property item
+             @br @bold(NOTE) SVG transforms are always affine, so the matrix is kept as a 2x3
+                             matrix, which is cheaper to merge with the parent matrices
             }
             IPropMatrixItem = class(IPropItem)
                 private
-                    m_Value: TWMatrix3x3;
+                    m_Value: TWMatrix2x3;
                     m_Type:  TWSVGPropMatrix.IEType;
 
                 protected
@@ -374,7 +531,7 @@ type
                      Get value
                      @returns(Value)
                     }
-                    function GetValue: PWMatrix3x3; virtual;
+                    function GetValue: PWMatrix2x3; virtual;
 
                 public
                     {**
@@ -384,7 +541,7 @@ type
 
                     {**
                      Constructor
-                     @param(pValue Item value)
+                     @param(pValue Item value, its affine part is kept)
                      @param(matrixType Matrix type (translate, ...))
                      @param(rule Rule to apply to item)
                     }
@@ -411,7 +568,7 @@ type
                      Set value
                      @param(pValue Value)
                     }
-                    procedure SetValue(const pValue: PWMatrix3x3); virtual;
+                    procedure SetValue(const pValue: PWMatrix2x3); virtual;
 
                     {**
                      Merge property with another property
@@ -423,7 +580,7 @@ type
                     {**
                      Get value
                     }
-                    property Value: PWMatrix3x3 read GetValue;
+                    property Value: PWMatrix2x3 read GetValue;
             end;
 
             {**
@@ -1634,6 +1791,8 @@ type
                     m_LastPos:       Double;
                     m_Started:       Boolean;
                     m_Ended:         Boolean;
+                    m_pCompiled:     TWSVGAnimationDescriptor;
+                    m_AttribName:    UnicodeString;
 
                 public
                     {**
@@ -1647,7 +1806,10 @@ type
                     destructor Destroy; override;
             end;
 
-            IAnimCache = TObjectDictionary<TWSVGAnimation, IAnimCacheItem>;
+            {**
+             Animation cache, the items are identified by the animation key
+            }
+            IAnimCache = TObjectDictionary<Integer, IAnimCacheItem>;
 
             {**
              SVG cache item
@@ -1672,9 +1834,163 @@ type
 
             ICache = TObjectDictionary<UnicodeString, ICacheItem>;
 
+            {**
+             Cached document key list
+            }
+            IDocumentKeys = TList<UnicodeString>;
+
+        public type
+            {**
+             Animation state cache statistics
+            }
+            ICacheStats = record
+                m_Count:    NativeUInt; // documents currently cached
+                m_Peak:     NativeUInt; // highest document count reached
+                m_Hits:     NativeUInt; // draws which found their document in cache
+                m_Misses:   NativeUInt; // draws which added their document to cache
+                m_Evicted:  NativeUInt; // documents removed because the cache was full
+                m_Released: NativeUInt; // documents removed because they were cleared, reloaded or deleted
+            end;
+
+            {**
+             Render context, contains the mutable state of a draw, e.g. the animation caches, the
+             dirty rect or the render profiler. A rasterizer and a document may be drawn concurrently
+             from several threads, provided that each thread draws with its own context
+             @br @bold(NOTE) A context belongs to the rasterizer which created it, and should never
+                             be shared between concurrent draws
+            }
+            IRenderContext = class
+                private
+                    m_pOwner:       TWSVGRasterizer;
+                    m_UUID:         UnicodeString;
+                    m_pCache:       ICache;
+                    m_LastDrawTime: Double;
+                    m_NextChange:   Double;
+                    m_DirtyRect:    TRect;
+                    m_ClipRect:     TRect;
+                    m_DirtyAll:     Boolean;
+                    m_MeasureOnly:  Boolean;
+                    m_ElemAnimated: Boolean;
+                    m_ElemMeasured: Boolean;
+                    m_pProfiler:    IProfiler;
+                    m_pLRU:         IDocumentKeys; // cached documents, least recently used first
+                    m_pReleased:    IDocumentKeys; // released documents, still to remove from cache
+                    m_Stats:        ICacheStats;
+
+                    {**
+                     Called when a document unique identifier is released
+                     @param(uuid Released unique identifier)
+                     @br @bold(NOTE) This function may be called from any thread, the released
+                                     document is only removed from cache on the next draw
+                    }
+                    procedure OnReleaseUUID(const uuid: UnicodeString);
+
+                    {**
+                     Clear the animation states of all the documents
+                    }
+                    procedure ClearAnimStates;
+
+                    {**
+                     Remove the released documents from cache
+                    }
+                    procedure PurgeReleased;
+
+                    {**
+                     Mark a document as the most recently used
+                     @param(uuid Document unique identifier)
+                     @returns(@true if the document is cached, otherwise @false)
+                    }
+                    function UseCacheItem(const uuid: UnicodeString): Boolean;
+
+                    {**
+                     Add a document to cache, evicting the least recently used documents if full
+                     @param(uuid Document unique identifier)
+                     @param(pItem Document cache item, owned by the cache on function ends)
+                     @param(maxCount Maximum document count the cache may contain)
+                    }
+                    procedure AddCacheItem(const uuid: UnicodeString; pItem: ICacheItem; maxCount: NativeUInt);
+
+                    {**
+                     Get the animation state cache statistics
+                     @returns(Cache statistics)
+                    }
+                    function GetCacheStats: ICacheStats;
+
+                public
+                    {**
+                     Constructor
+                     @param(pOwner Rasterizer owning the context)
+                    }
+                    constructor Create(pOwner: TWSVGRasterizer); virtual;
+
+                    {**
+                     Destructor
+                    }
+                    destructor Destroy; override;
+
+                    {**
+                     Clear the context, i.e. reset the animation states and the profiler
+                    }
+                    procedure Clear; virtual;
+
+                public
+                    {**
+                     Get the rasterizer owning the context
+                    }
+                    property Owner: TWSVGRasterizer read m_pOwner;
+
+                    {**
+                     Get or set the time, in milliseconds, the last draw took
+                    }
+                    property LastDrawTime: Double read m_LastDrawTime write m_LastDrawTime;
+
+                    {**
+                     Get the animation position, in percent, at which the last drawn frame will change next
+                     @br @bold(NOTE) See TWSVGRasterizer.NextChange
+                    }
+                    property NextChange: Double read m_NextChange;
+
+                    {**
+                     Get the union of the device bounds of the animated elements of the last drawn frame
+                     @br @bold(NOTE) See TWSVGRasterizer.DirtyRect
+                    }
+                    property DirtyRect: TRect read m_DirtyRect;
+
+                    {**
+                     Get if the animated elements of the last drawn frame may cover the whole drawing
+                    }
+                    property DirtyAll: Boolean read m_DirtyAll;
+
+                    {**
+                     Get or set the clip rect, in device coordinates
+                     @br @bold(NOTE) See TWSVGRasterizer.ClipRect
+                    }
+                    property ClipRect: TRect read m_ClipRect write m_ClipRect;
+
+                    {**
+                     Get or set the measure only mode
+                     @br @bold(NOTE) See TWSVGRasterizer.MeasureOnly
+                    }
+                    property MeasureOnly: Boolean read m_MeasureOnly write m_MeasureOnly;
+
+                    {**
+                     Get if the element currently drawn is animated
+                    }
+                    property ElemAnimated: Boolean read m_ElemAnimated;
+
+                    {**
+                     Get the render profiler fed while drawing with this context
+                    }
+                    property Profiler: IProfiler read m_pProfiler;
+
+                    {**
+                     Get the animation state cache statistics
+                    }
+                    property CacheStats: ICacheStats read GetCacheStats;
+            end;
+
         private
-            m_UUID:           UnicodeString;
-            m_pCache:         ICache;
+            m_pContext:       IRenderContext;
             m_fOnAnimate:     ITfAnimateEvent;
             m_fGetImageEvent: ITfGetImageEvent;
 
@@ -1696,8 +2012,85 @@ type
             }
             function GetLinkedElement(const pLink: TWSVGPropLink): TWSVGElement;
 
+            {**
+             Get the cache item of an animation belonging to the SVG currently rasterized
+             @param(pAnimation Animation for which the cache item should be get)
+             @returns(Animation cache item, created if not exists, @nil if no SVG cache is available)
+            }
+            function GetAnimCacheItem(const pAnimation: TWSVGAnimation): IAnimCacheItem;
+
+            {**
+             Get the time the last draw took, using the default context
+             @returns(Draw time in milliseconds)
+            }
+            function GetLastDrawTime: Double;
+
+            {**
+             Get the position at which the last drawn frame will change next, using the default context
+             @returns(Next change position, in percent)
+            }
+            function GetNextChange: Double;
+
+            {**
+             Get the dirty rect of the last drawn frame, using the default context
+             @returns(Dirty rect)
+            }
+            function GetDirtyRect: TRect;
+
+            {**
+             Get if the whole last drawn frame is dirty, using the default context
+             @returns(@true if the whole frame is dirty, otherwise @false)
+            }
+            function GetDirtyAll: Boolean;
+
+            {**
+             Get the clip rect of the default context
+             @returns(Clip rect)
+            }
+            function GetClipRect: TRect;
+
+            {**
+             Set the clip rect of the default context
+             @param(rect Clip rect)
+            }
+            procedure SetClipRect(const rect: TRect);
+
+            {**
+             Get the measure only mode of the default context
+             @returns(@true if the measure only mode is enabled, otherwise @false)
+            }
+            function GetMeasureOnly: Boolean;
+
+            {**
+             Set the measure only mode of the default context
+             @param(value If @true, the measure only mode is enabled)
+            }
+            procedure SetMeasureOnly(value: Boolean);
+
+            {**
+             Get the render profiler of the default context
+             @returns(Render profiler)
+            }
+            function GetProfiler: IProfiler;
+
+            {**
+             Get the animation state cache statistics of the default context
+             @returns(Cache statistics)
+            }
+            function GetCacheStats: ICacheStats;
+
         protected
-            m_Animate: Boolean;
+            m_Animate:            Boolean;
+            m_Quality:            IERenderQuality;
+            m_MinElementSize:     Single;
+            m_MaxCachedDocuments: NativeUInt;
+
+            {**
+             Get the render context of the draw running in the calling thread
+             @returns(Render context, the default context if this rasterizer isn't drawing with an
+                      explicit context in the calling thread)
+            }
+            function GetContext: IRenderContext;
 
             {**
              Initialize SVG to rasterize
@@ -1705,6 +2098,26 @@ type
             }
             procedure Initialize(const pSVG: TWSVG); virtual;
 
+            {**
+             Begin to collect the device bounds of the animated elements, should be called before
+             the elements are drawn
+            }
+            procedure BeginDirtyRect; virtual;
+
+            {**
+             End to collect the device bounds of the animated elements, should be called once all
+             the elements were drawn
+            }
+            procedure EndDirtyRect; virtual;
+
+            {**
+             Add the device bounds of the element currently drawn to the dirty rect, if animated
+             @param(bounds Element bounds, in device coordinates)
+             @br @bold(NOTE) An animated element for which no bounds are added, e.g. because its
+                             type cannot be measured, marks the whole drawing as dirty
+            }
+            procedure AddDirtyBounds(const bounds: TRect); virtual;
+
             {**
              Set the combine mode to use for a color with animated opacity
              @param(colorItem @bold([in, out]) Color item containing the properties to update)
@@ -2041,6 +2454,135 @@ type
             function Draw(const pSVG: TWSVG; const rect: TRect; proportional, antialiasing: Boolean;
                     const animation: IAnimation; pCanvas: TCustomCanvas): Boolean; overload; virtual; abstract;
 
+            {**
+             Draw SVG on canvas, using a render context
+             @param(pSVG SVG to draw)
+             @param(pos Draw position in pixels)
+             @param(scale Scale factor)
+             @param(antialiasing If @true, antialiasing should be used (if possible))
+             @param(animation Animation params, containing e.g. position in percent (between 0 and 100))
+             @param(pCanvas Canvas to draw on)
+             @param(pContext Render context to draw with, should have been created by this rasterizer)
+             @returns(@true on success, otherwise @false)
+             @br @bold(NOTE) This function may be called concurrently from several threads, each
+                             drawing with its own context and on its own canvas
+            }
+            function Draw(const pSVG: TWSVG; const pos: TPoint; scale: Single; antialiasing: Boolean;
+                    const animation: IAnimation; pCanvas: TCustomCanvas;
+                    pContext: IRenderContext): Boolean; overload; virtual;
+
+            {**
+             Draw SVG on canvas, using a render context
+             @param(pSVG SVG to draw)
+             @param(rect Rect in which svg will be drawn)
+             @param(proportional If @true, svg proportions will be conserved)
+             @param(antialiasing If @true, antialiasing should be used (if possible))
+             @param(animation Animation params, containing e.g. position in percent (between 0 and 100))
+             @param(pCanvas Canvas to draw on)
+             @param(pContext Render context to draw with, should have been created by this rasterizer)
+             @returns(@true on success, otherwise @false)
+             @br @bold(NOTE) This function may be called concurrently from several threads, each
+                             drawing with its own context and on its own canvas
+            }
+            function Draw(const pSVG: TWSVG; const rect: TRect; proportional, antialiasing: Boolean;
+                    const animation: IAnimation; pCanvas: TCustomCanvas;
+                    pContext: IRenderContext): Boolean; overload; virtual;
+
+            {**
+             Draw SVG directly in a memory buffer provided by the caller, without intermediate bitmap
+             @param(pSVG SVG to draw)
+             @param(rect Rect in which svg will be drawn, in buffer coordinates)
+             @param(proportional If @true, svg proportions will be conserved)
+             @param(antialiasing If @true, antialiasing should be used (if possible))
+             @param(animation Animation params, containing e.g. position in percent (between 0 and 100))
+             @param(buffer Buffer to draw on)
+             @returns(@true on success, otherwise @false)
+             @br @bold(NOTE) The SVG is drawn above the buffer content, which is not cleared
+            }
+            function DrawToBuffer(const pSVG: TWSVG; const rect: TRect; proportional, antialiasing: Boolean;
+                    const animation: IAnimation; const buffer: IRenderBuffer): Boolean; overload;
+
+            {**
+             Draw a part of a SVG directly in a memory buffer provided by the caller, without
+             intermediate bitmap
+             @param(pSVG SVG to draw)
+             @param(rect Rect in which svg will be drawn, in buffer coordinates)
+             @param(proportional If @true, svg proportions will be conserved)
+             @param(antialiasing If @true, antialiasing should be used (if possible))
+             @param(animation Animation params, containing e.g. position in percent (between 0 and 100))
+             @param(buffer Buffer to draw on)
+             @param(subRect Buffer area to draw, in buffer coordinates, the pixels outside it remain
+                            unchanged. If empty the whole buffer is drawn)
+             @returns(@true on success, otherwise @false)
+             @br @bold(NOTE) The SVG is drawn above the buffer content, which is not cleared
+            }
+            function DrawToBuffer(const pSVG: TWSVG; const rect: TRect; proportional, antialiasing: Boolean;
+                    const animation: IAnimation; const buffer: IRenderBuffer;
+                    const subRect: TRect): Boolean; overload; virtual; abstract;
+
+            {**
+             Draw a part of a SVG directly in a memory buffer provided by the caller, using a render
+             context
+             @param(pSVG SVG to draw)
+             @param(rect Rect in which svg will be drawn, in buffer coordinates)
+             @param(proportional If @true, svg proportions will be conserved)
+             @param(antialiasing If @true, antialiasing should be used (if possible))
+             @param(animation Animation params, containing e.g. position in percent (between 0 and 100))
+             @param(buffer Buffer to draw on)
+             @param(subRect Buffer area to draw, in buffer coordinates, the pixels outside it remain
+                            unchanged. If empty the whole buffer is drawn)
+             @param(pContext Render context to draw with, should have been created by this rasterizer)
+             @returns(@true on success, otherwise @false)
+             @br @bold(NOTE) This function may be called concurrently from several threads, each
+                             drawing with its own context and in its own buffer
+            }
+            function DrawToBuffer(const pSVG: TWSVG; const rect: TRect; proportional, antialiasing: Boolean;
+                    const animation: IAnimation; const buffer: IRenderBuffer; const subRect: TRect;
+                    pContext: IRenderContext): Boolean; overload; virtual;
+
+            {**
+             Create a new render context, to draw with this rasterizer
+             @returns(Render context, which belongs to the caller)
+             @br @bold(NOTE) The context should be deleted before the rasterizer
+            }
+            function CreateContext: IRenderContext; virtual;
+
+            {**
+             Get the topmost element drawn at a point
+             @param(pSVG SVG to hit-test)
+             @param(rect Rect in which svg is drawn)
+             @param(proportional If @true, svg proportions are conserved)
+             @param(animation Animation params, containing e.g. position in percent (between 0 and 100))
+             @param(point Point to test, in the same coordinates as the rect)
+             @param(pAncestors List to populate with the element ancestors, from its parent to the
+                               root, ignored if @nil)
+             @returns(Topmost element drawn at point, @nil if no element was hit or if the
+                      rasterizer does not support the hit-testing)
+             @br @bold(NOTE) The elements are hit on their painted fill and stroke, inside their
+                             clip path, and only if they are displayed and visible
+            }
+            function HitTest(const pSVG: TWSVG; const rect: TRect; proportional: Boolean;
+                    const animation: IAnimation; const point: TPoint;
+                    pAncestors: TList<TWSVGElement>): TWSVGElement; overload; virtual;
+
+            {**
+             Get the topmost element drawn at a point, using a render context
+             @param(pSVG SVG to hit-test)
+             @param(rect Rect in which svg is drawn)
+             @param(proportional If @true, svg proportions are conserved)
+             @param(animation Animation params, containing e.g. position in percent (between 0 and 100))
+             @param(point Point to test, in the same coordinates as the rect)
+             @param(pAncestors List to populate with the element ancestors, from its parent to the
+                               root, ignored if @nil)
+             @param(pContext Render context to hit-test with, should have been created by this rasterizer)
+             @returns(Topmost element drawn at point, @nil if no element was hit)
+             @br @bold(NOTE) The hit index is kept in the context, so a context dedicated to the
+                             hit-testing keeps it valid while the document is drawn at other positions
+            }
+            function HitTest(const pSVG: TWSVG; const rect: TRect; proportional: Boolean;
+                    const animation: IAnimation; const point: TPoint; pAncestors: TList<TWSVGElement>;
+                    pContext: IRenderContext): TWSVGElement; overload;
+
             {**
              Get SVG size
              @param(pSVG SVG to measure)
@@ -2069,6 +2611,8 @@ type
             {**
              Enable or disable animation
              @param(value If @true, animation will be enabled, disabled otherwise)
+             @br @bold(NOTE) Enabling the animation resets the animation states of the default
+                             context, the other contexts should be cleared by their owner
             }
             procedure EnableAnimation(value: Boolean); virtual;
 
@@ -2078,6 +2622,15 @@ type
             }
             function IsAnimationEnabled: Boolean; virtual;
 
+            {**
+             Get the cache hit counters used by the rasterizer
+             @param(pCounters List to which the counters should be added)
+             @br @bold(NOTE) The rasterizer counters, e.g. the text layouts one, are always
+                             available. The renderer counters only exist if the cache logging is
+                             enabled. The counters belong to their caches and should not be deleted
+            }
+            procedure GetCacheCounters(pCounters: TList<TWCacheHit>); virtual;
+
         public
             {**
              Get or set the OnAnimate event
@@ -2088,6 +2641,83 @@ type
              Get or set the OnGetImage event
             }
             property OnGetImage: ITfGetImageEvent read m_fGetImageEvent write m_fGetImageEvent;
+
+            {**
+             Get or set the render quality
+            }
+            property Quality: IERenderQuality read m_Quality write m_Quality;
+
+            {**
+             Get or set the minimum size, in device pixels, an element should have to be drawn. Elements
+             smaller than this size on both axis, once transformed, are skipped
+             @br @bold(NOTE) Set to 0 to draw all the elements, whatever their size
+            }
+            property MinElementSize: Single read m_MinElementSize write m_MinElementSize;
+
+            {**
+             Get the time, in milliseconds, the last draw took
+            }
+            property LastDrawTime: Double read GetLastDrawTime;
+
+            {**
+             Get the animation position, in percent, at which the last drawn frame will change next.
+             This value is equal to the drawn position if an animation was running, and to 1.0 if
+             nothing changes until the end of the animation cycle
+             @br @bold(NOTE) Only the animations evaluated while drawing are considered, e.g. the
+                             elements skipped in draft quality are ignored
+            }
+            property NextChange: Double read GetNextChange;
+
+            {**
+             Get the union of the device bounds of the animated elements, measured while the last
+             frame was drawn. This rect is meaningful only if DirtyAll is @false
+            }
+            property DirtyRect: TRect read GetDirtyRect;
+
+            {**
+             Get if the animated elements of the last drawn frame may cover the whole drawing, e.g.
+             because an animated group or an element which cannot be measured was found
+            }
+            property DirtyAll: Boolean read GetDirtyAll;
+
+            {**
+             Get or set the clip rect, in device coordinates. If not empty, the elements measured
+             outside this rect are skipped while drawing
+            }
+            property ClipRect: TRect read GetClipRect write SetClipRect;
+
+            {**
+             Get or set the measure only mode. In this mode the measured elements are skipped
+             instead of drawn, thus drawing only calculates the dirty rect and the next change
+             @br @bold(NOTE) The elements which cannot be measured are still drawn, so the target
+                             canvas should be a scratch one
+            }
+            property MeasureOnly: Boolean read GetMeasureOnly write SetMeasureOnly;
+
+            {**
+             Get the render profiler, containing the count and the elapsed time per element type and
+             per stage accumulated while drawing
+             @br @bold(NOTE) The profiler is only fed if ENABLE_SVG_RENDER_PROFILING is defined
+            }
+            property Profiler: IProfiler read GetProfiler;
+
+            {**
+             Get or set the maximum document count for which the animation states are kept. When
+             more documents are drawn, the least recently drawn ones are removed from cache
+             @br @bold(NOTE) The animation states of a document are also removed when it is cleared,
+                             reloaded, optimized or deleted
+            }
+            property MaxCachedDocuments: NativeUInt read m_MaxCachedDocuments write m_MaxCachedDocuments;
+
+            {**
+             Get the animation state cache statistics of the default context
+            }
+            property CacheStats: ICacheStats read GetCacheStats;
+
+            {**
+             Get the default render context, used by the draw functions called without context
+            }
+            property DefaultContext: IRenderContext read m_pContext;
     end;
 
 implementation
@@ -2097,6 +2727,13 @@ uses
   System.NetEncoding;
 {$ifend}
 
+threadvar
+    {**
+     Render context of the draw running in the current thread, @nil if none
+     @exclude(From PasDoc documentation)
+    }
+    g_pDrawContext: TWSVGRasterizer.IRenderContext;
+
 //---------------------------------------------------------------------------
 // TWSVGRasterizer.IPropItem
 //---------------------------------------------------------------------------
@@ -2402,12 +3039,12 @@ begin
     m_Value.Assign(pSource.m_Value);
 end;
 //---------------------------------------------------------------------------
-function TWSVGRasterizer.IPropMatrixItem.GetValue: PWMatrix3x3;
+function TWSVGRasterizer.IPropMatrixItem.GetValue: PWMatrix2x3;
 begin
     Result := @m_Value;
 end;
 //---------------------------------------------------------------------------
-procedure TWSVGRasterizer.IPropMatrixItem.SetValue(const pValue: PWMatrix3x3);
+procedure TWSVGRasterizer.IPropMatrixItem.SetValue(const pValue: PWMatrix2x3);
 begin
     m_Value.Assign(pValue^);
 end;
@@ -3718,6 +4355,118 @@ begin
     inherited Destroy;
 end;
 //---------------------------------------------------------------------------
+// TWSVGRasterizer.IProfiler
+//---------------------------------------------------------------------------
+constructor TWSVGRasterizer.IProfiler.Create;
+begin
+    inherited Create;
+
+    m_pEntries := IEntries.Create([doOwnsValues]);
+    m_Enabled  := True;
+end;
+//---------------------------------------------------------------------------
+destructor TWSVGRasterizer.IProfiler.Destroy;
+begin
+    m_pEntries.Free;
+
+    inherited Destroy;
+end;
+//---------------------------------------------------------------------------
+procedure TWSVGRasterizer.IProfiler.Clear;
+begin
+    m_pEntries.Clear;
+end;
+//---------------------------------------------------------------------------
+function TWSVGRasterizer.IProfiler.Start: Int64;
+begin
+    Result := TStopwatch.GetTimeStamp;
+end;
+//---------------------------------------------------------------------------
+procedure TWSVGRasterizer.IProfiler.Stop(const pElement: TWSVGElement; stage: IEProfileStage;
+        startTime: Int64);
+begin
+    if (not m_Enabled) then
+        Exit;
+
+    if (not Assigned(pElement)) then
+        Exit;
+
+    Add(pElement.ClassType, stage, TStopwatch.GetTimeStamp - startTime);
+end;
+//---------------------------------------------------------------------------
+procedure TWSVGRasterizer.IProfiler.Add(elementType: TClass; stage: IEProfileStage; ticks: Int64);
+var
+    pEntry: IEntry;
+begin
+    if (not m_Enabled) then
+        Exit;
+
+    // get the element type statistics, create them if still not exist
+    if (not m_pEntries.TryGetValue(elementType, pEntry)) then
+    begin
+        pEntry := IEntry.Create;
+        m_pEntries.Add(elementType, pEntry);
+    end;
+
+    Inc(pEntry.m_Count[stage]);
+    Inc(pEntry.m_Ticks[stage], ticks);
+end;
+//---------------------------------------------------------------------------
+function TWSVGRasterizer.IProfiler.GetElementTypes: TArray<TClass>;
+begin
+    Result := m_pEntries.Keys.ToArray;
+end;
+//---------------------------------------------------------------------------
+function TWSVGRasterizer.IProfiler.GetStats(elementType: TClass; stage: IEProfileStage;
+        out count: NativeUInt; out time: Double): Boolean;
+var
+    pEntry: IEntry;
+begin
+    count := 0;
+    time  := 0.0;
+
+    if (not m_pEntries.TryGetValue(elementType, pEntry)) then
+        Exit(False);
+
+    count := pEntry.m_Count[stage];
+    time  := (pEntry.m_Ticks[stage] * 1000.0) / TStopwatch.Frequency;
+
+    Result := True;
+end;
+//---------------------------------------------------------------------------
+procedure TWSVGRasterizer.IProfiler.Log;
+const
+    stageNames: array [IEProfileStage] of UnicodeString =
+    (
+        'element',
+        'props',
+        'geometry',
+        'clipping',
+        'fill',
+        'stroke',
+        'effect'
+    );
+var
+    elementType: TClass;
+    stage:       IEProfileStage;
+    count:       NativeUInt;
+    time:        Double;
+begin
+    for elementType in GetElementTypes do
+        for stage := Low(IEProfileStage) to High(IEProfileStage) do
+        begin
+            if (not GetStats(elementType, stage, count, time)) then
+                continue;
+
+            // nothing measured for this stage?
+            if (count = 0) then
+                continue;
+
+            OutputDebugString(PWideChar(elementType.ClassName + ' - ' + stageNames[stage] + ' - count - '
+                    + IntToStr(count) + ' - time - ' + FormatFloat('0.000', time) + 'ms'));
+        end;
+end;
+//---------------------------------------------------------------------------
 // TWSVGRasterizer.IAnimCacheItem
 //---------------------------------------------------------------------------
 constructor TWSVGRasterizer.IAnimCacheItem.Create;
@@ -3728,10 +4477,13 @@ begin
     m_LastPos       := 0.0;
     m_Started       := False;
     m_Ended         := False;
+    m_pCompiled     := nil;
 end;
 //---------------------------------------------------------------------------
 destructor TWSVGRasterizer.IAnimCacheItem.Destroy;
 begin
+    m_pCompiled.Free;
+
     inherited Destroy;
 end;
 //---------------------------------------------------------------------------
@@ -3753,21 +4505,185 @@ begin
     inherited Destroy;
 end;
 //---------------------------------------------------------------------------
+// TWSVGRasterizer.IRenderContext
+//---------------------------------------------------------------------------
+constructor TWSVGRasterizer.IRenderContext.Create(pOwner: TWSVGRasterizer);
+begin
+    inherited Create;
+
+    m_pOwner       := pOwner;
+    m_pCache       := ICache.Create([doOwnsValues]);
+    m_LastDrawTime := 0.0;
+    m_NextChange   := 0.0;
+    m_DirtyRect    := Default(TRect);
+    m_ClipRect     := Default(TRect);
+    m_DirtyAll     := False;
+    m_MeasureOnly  := False;
+    m_ElemAnimated := False;
+    m_ElemMeasured := False;
+    m_pProfiler    := IProfiler.Create;
+    m_pLRU         := IDocumentKeys.Create;
+    m_pReleased    := IDocumentKeys.Create;
+    m_Stats        := Default(ICacheStats);
+
+    // be notified when a document is released, to remove its animation states from cache
+    TWSVG.AddReleaseListener(OnReleaseUUID);
+end;
+//---------------------------------------------------------------------------
+destructor TWSVGRasterizer.IRenderContext.Destroy;
+begin
+    TWSVG.RemoveReleaseListener(OnReleaseUUID);
+
+    m_pCache.Free;
+    m_pProfiler.Free;
+    m_pLRU.Free;
+    m_pReleased.Free;
+
+    inherited Destroy;
+end;
+//---------------------------------------------------------------------------
+procedure TWSVGRasterizer.IRenderContext.OnReleaseUUID(const uuid: UnicodeString);
+begin
+    TMonitor.Enter(m_pLRU);
+
+    try
+        // only the cached documents are remembered, thus the released list remains bounded
+        if (m_pLRU.Contains(uuid) and not m_pReleased.Contains(uuid)) then
+            m_pReleased.Add(uuid);
+    finally
+        TMonitor.Exit(m_pLRU);
+    end;
+end;
+//---------------------------------------------------------------------------
+procedure TWSVGRasterizer.IRenderContext.ClearAnimStates;
+begin
+    TMonitor.Enter(m_pLRU);
+
+    try
+        m_pCache.Clear;
+        m_pLRU.Clear;
+        m_pReleased.Clear;
+    finally
+        TMonitor.Exit(m_pLRU);
+    end;
+end;
+//---------------------------------------------------------------------------
+procedure TWSVGRasterizer.IRenderContext.PurgeReleased;
+var
+    uuid: UnicodeString;
+begin
+    TMonitor.Enter(m_pLRU);
+
+    try
+        for uuid in m_pReleased do
+        begin
+            m_pCache.Remove(uuid);
+            m_pLRU.Remove(uuid);
+            Inc(m_Stats.m_Released);
+        end;
+
+        m_pReleased.Clear;
+    finally
+        TMonitor.Exit(m_pLRU);
+    end;
+end;
+//---------------------------------------------------------------------------
+function TWSVGRasterizer.IRenderContext.UseCacheItem(const uuid: UnicodeString): Boolean;
+begin
+    if (not m_pCache.ContainsKey(uuid)) then
+        Exit(False);
+
+    Inc(m_Stats.m_Hits);
+
+    // already the most recently used? NOTE the list is only modified by the drawing thread, thus
+    // it may be read here without lock
+    if (m_pLRU[m_pLRU.Count - 1] = uuid) then
+        Exit(True);
+
+    TMonitor.Enter(m_pLRU);
+
+    try
+        m_pLRU.Remove(uuid);
+        m_pLRU.Add(uuid);
+    finally
+        TMonitor.Exit(m_pLRU);
+    end;
+
+    Result := True;
+end;
+//---------------------------------------------------------------------------
+procedure TWSVGRasterizer.IRenderContext.AddCacheItem(const uuid: UnicodeString; pItem: ICacheItem;
+        maxCount: NativeUInt);
+begin
+    // at least the document to draw should be cached
+    if (maxCount = 0) then
+        maxCount := 1;
+
+    TMonitor.Enter(m_pLRU);
+
+    try
+        // cache is full? Evict the least recently used documents
+        while ((m_pLRU.Count > 0) and (NativeUInt(m_pLRU.Count) >= maxCount)) do
+        begin
+            m_pCache.Remove(m_pLRU[0]);
+            m_pReleased.Remove(m_pLRU[0]);
+            m_pLRU.Delete(0);
+            Inc(m_Stats.m_Evicted);
+
+            TWTraceHelper.Instant('Animation state eviction', 'cache');
+        end;
+
+        m_pCache.Add(uuid, pItem);
+        m_pLRU.Add(uuid);
+    finally
+        TMonitor.Exit(m_pLRU);
+    end;
+
+    Inc(m_Stats.m_Misses);
+
+    if (NativeUInt(m_pCache.Count) > m_Stats.m_Peak) then
+        m_Stats.m_Peak := m_pCache.Count;
+end;
+//---------------------------------------------------------------------------
+function TWSVGRasterizer.IRenderContext.GetCacheStats: ICacheStats;
+begin
+    Result         := m_Stats;
+    Result.m_Count := m_pCache.Count;
+end;
+//---------------------------------------------------------------------------
+procedure TWSVGRasterizer.IRenderContext.Clear;
+begin
+    m_UUID         := '';
+    m_LastDrawTime := 0.0;
+    m_NextChange   := 0.0;
+    m_DirtyRect    := Default(TRect);
+    m_DirtyAll     := False;
+    m_ElemAnimated := False;
+    m_ElemMeasured := False;
+    m_Stats        := Default(ICacheStats);
+
+    ClearAnimStates;
+    m_pProfiler.Clear;
+end;
+//---------------------------------------------------------------------------
 // TWSVGRasterizer
 //---------------------------------------------------------------------------
 constructor TWSVGRasterizer.Create;
 begin
     inherited Create;
 
-    m_pCache         := ICache.Create([doOwnsValues]);
-    m_Animate        := True;
-    m_fOnAnimate     := nil;
-    m_fGetImageEvent := nil;
+    m_Animate            := True;
+    m_Quality            := IE_RQ_Full;
+    m_MinElementSize     := 0.0;
+    m_MaxCachedDocuments := 32;
+    m_fOnAnimate         := nil;
+    m_fGetImageEvent     := nil;
+    m_pContext           := CreateContext;
 end;
 //---------------------------------------------------------------------------
 destructor TWSVGRasterizer.Destroy;
 begin
-    m_pCache.Free;
+    m_pContext.Free;
 
     inherited Destroy;
 end;
@@ -3853,19 +4769,120 @@ begin
     Result := pItem as TWSVGElement
 end;
 //---------------------------------------------------------------------------
+function TWSVGRasterizer.GetAnimCacheItem(const pAnimation: TWSVGAnimation): IAnimCacheItem;
+var
+    pContext:   IRenderContext;
+    pCacheItem: ICacheItem;
+    pNewItem:   IAnimCacheItem;
+begin
+    pContext := GetContext;
+
+    // get current cache to use
+    if (not pContext.m_pCache.TryGetValue(pContext.m_UUID, pCacheItem)) then
+        Exit(nil);
+
+    // get current animation item, create one if not found. NOTE the item is searched by key, so
+    // the animations cloned on each draw, e.g. by a use element, share the item of their source,
+    // and a new animation allocated at the address of a deleted one never gets its item
+    if (pCacheItem.m_pAnimCache.TryGetValue(pAnimation.Key, Result)) then
+        Exit;
+
+    TWTraceHelper.Instant('Animation cache miss', 'cache');
+
+    pNewItem := nil;
+
+    try
+        // create, populate and add new animation item
+        pNewItem := IAnimCacheItem.Create;
+        pCacheItem.m_pAnimCache.Add(pAnimation.Key, pNewItem);
+        Result   := pNewItem;
+        pNewItem := nil;
+    finally
+        pNewItem.Free;
+    end;
+end;
+//---------------------------------------------------------------------------
+function TWSVGRasterizer.GetLastDrawTime: Double;
+begin
+    Result := m_pContext.m_LastDrawTime;
+end;
+//---------------------------------------------------------------------------
+function TWSVGRasterizer.GetNextChange: Double;
+begin
+    Result := m_pContext.m_NextChange;
+end;
+//---------------------------------------------------------------------------
+function TWSVGRasterizer.GetDirtyRect: TRect;
+begin
+    Result := m_pContext.m_DirtyRect;
+end;
+//---------------------------------------------------------------------------
+function TWSVGRasterizer.GetDirtyAll: Boolean;
+begin
+    Result := m_pContext.m_DirtyAll;
+end;
+//---------------------------------------------------------------------------
+function TWSVGRasterizer.GetClipRect: TRect;
+begin
+    Result := m_pContext.m_ClipRect;
+end;
+//---------------------------------------------------------------------------
+procedure TWSVGRasterizer.SetClipRect(const rect: TRect);
+begin
+    m_pContext.m_ClipRect := rect;
+end;
+//---------------------------------------------------------------------------
+function TWSVGRasterizer.GetMeasureOnly: Boolean;
+begin
+    Result := m_pContext.m_MeasureOnly;
+end;
+//---------------------------------------------------------------------------
+procedure TWSVGRasterizer.SetMeasureOnly(value: Boolean);
+begin
+    m_pContext.m_MeasureOnly := value;
+end;
+//---------------------------------------------------------------------------
+function TWSVGRasterizer.GetProfiler: IProfiler;
+begin
+    Result := m_pContext.m_pProfiler;
+end;
+//---------------------------------------------------------------------------
+function TWSVGRasterizer.GetCacheStats: ICacheStats;
+begin
+    Result := m_pContext.GetCacheStats;
+end;
+//---------------------------------------------------------------------------
+function TWSVGRasterizer.GetContext: IRenderContext;
+begin
+    Result := g_pDrawContext;
+
+    // no draw with an explicit context running in the calling thread for this rasterizer?
+    if ((not Assigned(Result)) or (Result.m_pOwner <> Self)) then
+        Result := m_pContext;
+end;
+//---------------------------------------------------------------------------
 procedure TWSVGRasterizer.Initialize(const pSVG: TWSVG);
 var
-    pItem: ICacheItem;
+    pContext: IRenderContext;
+    pItem:    ICacheItem;
 begin
+    pContext := GetContext;
+
+    // nothing changes until an animation reports otherwise while drawing
+    pContext.m_NextChange := 1.0;
+
     // get current SVG UUID instance
-    m_UUID := pSVG.GetUUID;
+    pContext.m_UUID := pSVG.GetUUID;
+
+    // forget the documents released since the previous draw
+    pContext.PurgeReleased;
 
     // no instance?
-    if (Length(m_UUID) = 0) then
+    if (Length(pContext.m_UUID) = 0) then
         Exit;
 
     // is SVG already cached?
-    if (m_pCache.ContainsKey(m_UUID)) then
+    if (pContext.UseCacheItem(pContext.m_UUID)) then
         Exit;
 
     pItem := nil;
@@ -3874,13 +4891,57 @@ begin
         // create and populate new cache item
         pItem                := ICacheItem.Create;
         pItem.m_AnimDuration := GetAnimationDuration(pSVG);
-        m_pCache.Add(m_UUID, pItem);
+        pContext.AddCacheItem(pContext.m_UUID, pItem, m_MaxCachedDocuments);
         pItem                := nil;
     finally
         pItem.Free;
     end;
 end;
 //---------------------------------------------------------------------------
+procedure TWSVGRasterizer.BeginDirtyRect;
+var
+    pContext: IRenderContext;
+begin
+    pContext := GetContext;
+
+    pContext.m_DirtyRect    := Default(TRect);
+    pContext.m_DirtyAll     := False;
+    pContext.m_ElemAnimated := False;
+    pContext.m_ElemMeasured := False;
+end;
+//---------------------------------------------------------------------------
+procedure TWSVGRasterizer.EndDirtyRect;
+var
+    pContext: IRenderContext;
+begin
+    pContext := GetContext;
+
+    // last drawn element was animated but not measured?
+    if (pContext.m_ElemAnimated and not pContext.m_ElemMeasured) then
+        pContext.m_DirtyAll := True;
+
+    pContext.m_ElemAnimated := False;
+    pContext.m_ElemMeasured := False;
+end;
+//---------------------------------------------------------------------------
+procedure TWSVGRasterizer.AddDirtyBounds(const bounds: TRect);
+var
+    pContext: IRenderContext;
+begin
+    pContext := GetContext;
+
+    // not animated?
+    if (not pContext.m_ElemAnimated) then
+        Exit;
+
+    pContext.m_ElemMeasured := True;
+
+    if (pContext.m_DirtyRect.IsEmpty) then
+        pContext.m_DirtyRect := bounds
+    else
+        pContext.m_DirtyRect.Union(bounds);
+end;
+//---------------------------------------------------------------------------
 procedure TWSVGRasterizer.SetAnimatedOpacityCombineMode(pColorItem: IPropColorItem);
 begin
     case (pColorItem.m_Rule) of
@@ -5474,10 +6535,19 @@ var
     pPropMatrixItem:  IWSmartPointer<IPropMatrixItem>;
     pAspectRatio:     TWSVGPropAspectRatio;
     propCount, i:     NativeInt;
+    {$ifdef ENABLE_SVG_RENDER_PROFILING}
+        startTime:    Int64;
+    {$endif}
 begin
     if (not Assigned(pElement)) then
         Exit(False);
 
+    {$ifdef ENABLE_SVG_RENDER_PROFILING}
+        startTime := GetContext.m_pProfiler.Start;
+
+        try
+    {$endif}
+
     propCount := pElement.Count;
 
     // iterate through element properties
@@ -5538,6 +6608,12 @@ begin
         end;
     end;
 
+    {$ifdef ENABLE_SVG_RENDER_PROFILING}
+        finally
+            GetContext.m_pProfiler.Stop(pElement, IE_PS_Props, startTime);
+        end;
+    {$endif}
+
     Result := True;
 end;
 //---------------------------------------------------------------------------
@@ -7338,7 +8414,7 @@ procedure TWSVGRasterizer.GetTransformAnimMatrix(const pAnimationData: IAnimatio
 var
     pAnimation: TWSVGAnimation;
     pAnimDesc:  IWSmartPointer<TWSVGMatrixAnimDesc>;
-    animMatrix: TWMatrix3x3;
+    animMatrix: TWMatrix2x3;
     attribName: UnicodeString;
     position:   Double;
 begin
@@ -7398,40 +8474,41 @@ end;
 //---------------------------------------------------------------------------
 procedure TWSVGRasterizer.GetAnimations(const pContainer: TWSVGContainer; pAnimationData: IAnimationData);
 var
+    pContext:     IRenderContext;
     animCount, i: NativeInt;
     pAnimation:   TWSVGAnimation;
 begin
+    pContext := GetContext;
+
+    // the animations are always read just before the element is drawn, so the previous element is
+    // done. If it was animated but not measured, its bounds are unknown
+    if (pContext.m_ElemAnimated and not pContext.m_ElemMeasured) then
+        pContext.m_DirtyAll := True;
+
+    pContext.m_ElemAnimated := False;
+    pContext.m_ElemMeasured := False;
+
     // do animate shape?
     if (not m_Animate) then
         Exit;
 
-    animCount := pContainer.AnimationCount;
+    animCount               := pContainer.AnimationCount;
+    pContext.m_ElemAnimated := (animCount > 0);
 
     // iterate through animations
     for i := 0 to animCount - 1 do
     begin
         pAnimation := pContainer.Animations[i];
 
-        // search for animation type
-        if (pAnimation.ItemName = C_SVG_Tag_Set) then
-            // add animation to list
-            pAnimationData.m_pSetAnims.Add(pAnimation)
-        else
-        if (pAnimation.ItemName = C_SVG_Tag_Animate) then
-            // add animation to list
-            pAnimationData.m_pAttribAnims.Add(pAnimation)
-        else
-        if (pAnimation.ItemName = C_SVG_Tag_Animate_Color) then
-            // add animation to list
-            pAnimationData.m_pColorAnims.Add(pAnimation)
-        else
-        if (pAnimation.ItemName = C_SVG_Tag_Animate_Transform) then
-            // add animation to list
-            pAnimationData.m_pMatrixAnims.Add(pAnimation)
-        else
-        if ((pAnimation.ItemName = C_SVG_Tag_Set) or (pAnimation.ItemName = C_SVG_Tag_Animate_Motion)) then
-            // add animation to list
-            pAnimationData.m_pUnknownAnims.Add(pAnimation);
+        // search for animation type. NOTE the type was already resolved from the tag name while the
+        // animation was read, so no string comparison is needed here
+        case (pAnimation.AnimationType) of
+            TWSVGAnimation.IEAnimType.IE_AT_Set:               pAnimationData.m_pSetAnims.Add(pAnimation);
+            TWSVGAnimation.IEAnimType.IE_AT_Animate:           pAnimationData.m_pAttribAnims.Add(pAnimation);
+            TWSVGAnimation.IEAnimType.IE_AT_Animate_Color:     pAnimationData.m_pColorAnims.Add(pAnimation);
+            TWSVGAnimation.IEAnimType.IE_AT_Animate_Transform: pAnimationData.m_pMatrixAnims.Add(pAnimation);
+            TWSVGAnimation.IEAnimType.IE_AT_Animate_Motion:    pAnimationData.m_pUnknownAnims.Add(pAnimation);
+        end;
     end;
 end;
 //---------------------------------------------------------------------------
@@ -7454,10 +8531,34 @@ var
     pFromDisplay, pToDisplay, pByDisplay, pValuesDisplay:             TWSVGStyle.IPropDisplay;
     pFromVisibility, pToVisibility, pByVisibility, pValuesVisibility: TWSVGStyle.IPropVisibility;
     pBegin, pEnd, pDuration:                                          TWSVGPropTime;
+    pAnimItem:                                                        IAnimCacheItem;
     propCount, fromCount, toCount, byCount, valueCount, i, j:         NativeInt;
 begin
     attribName := '';
 
+    // get the animation cache item, in which the compiled animation is kept
+    if (m_Animate and callOnAnimate) then
+        pAnimItem := GetAnimCacheItem(pAnimation)
+    else
+        pAnimItem := nil;
+
+    // was animation already compiled? (NOTE the compiled descriptor is copied, so the OnAnimate
+    // event may modify the descriptor content without altering the compiled one)
+    if (Assigned(pAnimItem) and Assigned(pAnimItem.m_pCompiled)
+            and (pAnimItem.m_pCompiled.ClassType = pAnimDesc.ClassType))
+    then
+    begin
+        pAnimDesc.Assign(pAnimItem.m_pCompiled);
+        pAnimDesc.Animation := pAnimation;
+        attribName          := pAnimItem.m_AttribName;
+
+        // notify that animation is running
+        if (Assigned(m_fOnAnimate)) then
+            Exit(m_fOnAnimate(pAnimDesc, pCustomData));
+
+        Exit(True);
+    end;
+
     propCount := pAnimation.Count;
 
     // iterate through animations attributes (i.e. animations linked to a particular shape attribute)
@@ -8261,6 +9362,22 @@ begin
         end;
     end;
 
+    // compile the animation, so its properties will no longer be read again on the next frames
+    if (Assigned(pAnimItem)) then
+    begin
+        FreeAndNil(pAnimItem.m_pCompiled);
+
+        // build the lookup tables before caching, otherwise each copy would build its own
+        pAnimDesc.Compile;
+
+        // the compiled descriptor may be shared by the clones of the animation, which are deleted
+        // after each draw, so it should not keep the animation which compiled it
+        pAnimItem.m_pCompiled := TWSVGAnimationDescriptorClass(pAnimDesc.ClassType).Create;
+        pAnimItem.m_pCompiled.Assign(pAnimDesc);
+        pAnimItem.m_pCompiled.Animation := nil;
+        pAnimItem.m_AttribName          := attribName;
+    end;
+
     // notify that animation is running
     if (callOnAnimate and Assigned(m_fOnAnimate)) then
         Exit(m_fOnAnimate(pAnimDesc, pCustomData));
@@ -8828,11 +9945,14 @@ end;
 function TWSVGRasterizer.GetAnimPos(const pAnimationData: IAnimationData;
         const pAnimDesc: TWSVGAnimationDescriptor; var position: Double): Boolean;
 var
-    pCacheItem:           ICacheItem;
-    pItem, pNewItem:      IAnimCacheItem;
-    beginAtPos, endAtPos: Double;
+    pContext:                            IRenderContext;
+    pCacheItem:                          ICacheItem;
+    pItem:                               IAnimCacheItem;
+    beginAtPos, endAtPos, localToGlobal: Double;
     //cycleRestarted:  Boolean;
 begin
+    pContext := GetContext;
+
     // is animation end or animation duration negative?
     if (pAnimDesc.NegativeEnd or pAnimDesc.NegativeDuration) then
     begin
@@ -8843,8 +9963,11 @@ begin
 
     // get current cache to use. Cache item should always be created for the current running
     // animation, if it's not the case it's an error
-    if (not m_pCache.TryGetValue(m_UUID, pCacheItem)) then
+    if (not pContext.m_pCache.TryGetValue(pContext.m_UUID, pCacheItem)) then
     begin
+        // the animation state is unknown, so consider that it may change at any time
+        pContext.m_NextChange := Min(pContext.m_NextChange, pAnimationData.m_Position);
+
         position := 0.0;
         Exit(False);
     end;
@@ -8856,20 +9979,7 @@ begin
     pCacheItem.m_LastPos := 0.0;//position;
 
     // get current animation item, create one if not found
-    if (not pCacheItem.m_pAnimCache.TryGetValue(pAnimDesc.Animation, pItem)) then
-    begin
-        pNewItem := nil;
-
-        try
-            // create, populate and add new animation item
-            pNewItem := IAnimCacheItem.Create;
-            pCacheItem.m_pAnimCache.Add(pAnimDesc.Animation, pNewItem);
-            pItem    := pNewItem;
-            pNewItem := nil;
-        finally
-            pNewItem.Free;
-        end;
-    end;
+    pItem := GetAnimCacheItem(pAnimDesc.Animation);
 
     Assert(Assigned(pItem));
 
@@ -8879,6 +9989,13 @@ begin
     // position, e.g. a sub-animation of 2s will be repeated 3 times during a total animation of 6s
     position := LocalPosToGlobalPos(pCacheItem.m_AnimDuration, pItem, pAnimationData, pAnimDesc);
 
+    // get the factor to convert a local position distance to a global one, used to predict when
+    // a static animation will change
+    if (pAnimDesc.Duration.IsEmpty or (pCacheItem.m_AnimDuration = 0)) then
+        localToGlobal := 1.0
+    else
+        localToGlobal := pAnimDesc.Duration.ToMilliseconds / pCacheItem.m_AnimDuration;
+
     // do loop animation?
     if (pAnimDesc.DoLoop) then
     begin
@@ -8908,6 +10025,9 @@ begin
         // position value is limited between 0.0 and 1.0, thus it can never be out of bounds
         position        := TWMathHelper.ExtMod(position + (1.0 - beginAtPos), 1.0);
         pItem.m_Started := True;
+
+        // a running animation changes on each frame
+        pContext.m_NextChange := Min(pContext.m_NextChange, pAnimationData.m_Position);
         Exit(True);
     end;
 
@@ -8918,13 +10038,18 @@ begin
     // nothing to check?
     if ((beginAtPos = 0.0) and (endAtPos = 1.0)) then
     begin
-        pItem.m_Started := True;
+        pItem.m_Started       := True;
+        pContext.m_NextChange := Min(pContext.m_NextChange, pAnimationData.m_Position);
         Exit(True);
     end;
 
     // animation started?
     if (position < beginAtPos) then
     begin
+        // the animation remains static until it begins, or until its local cycle restarts
+        pContext.m_NextChange := Min(pContext.m_NextChange,
+                pAnimationData.m_Position + ((Min(beginAtPos, 1.0) - position) * localToGlobal));
+
         position := 0.0;
         Exit(False);
     end;
@@ -8934,10 +10059,16 @@ begin
     // animation stopped?
     if (position > endAtPos) then
     begin
+        // the animation remains static until its local cycle restarts
+        pContext.m_NextChange := Min(pContext.m_NextChange,
+                pAnimationData.m_Position + ((1.0 - position) * localToGlobal));
+
         position := beginAtPos + (position * (endAtPos - beginAtPos));
         Exit(False);
     end;
 
+    pContext.m_NextChange := Min(pContext.m_NextChange, pAnimationData.m_Position);
+
     // calculate real position
     position := beginAtPos + (position * (endAtPos - beginAtPos));
     Result   := True;
@@ -9124,7 +10255,7 @@ begin
 
     // reset cache if animation is enabled
     if (m_Animate) then
-        m_pCache.Clear;
+        m_pContext.ClearAnimStates;
 end;
 //---------------------------------------------------------------------------
 function TWSVGRasterizer.IsAnimationEnabled: Boolean;
@@ -9132,5 +10263,123 @@ begin
     Result := m_Animate;
 end;
 //---------------------------------------------------------------------------
+procedure TWSVGRasterizer.GetCacheCounters(pCounters: TList<TWCacheHit>);
+begin
+end;
+//---------------------------------------------------------------------------
+function TWSVGRasterizer.Draw(const pSVG: TWSVG; const pos: TPoint; scale: Single; antialiasing: Boolean;
+        const animation: IAnimation; pCanvas: TCustomCanvas; pContext: IRenderContext): Boolean;
+var
+    pPrevContext: IRenderContext;
+begin
+    if ((not Assigned(pContext)) or (pContext.m_pOwner <> Self)) then
+    begin
+        TWLogHelper.LogToCompiler('Draw - FAILED - the context does not belong to this rasterizer');
+        Exit(False);
+    end;
+
+    // the context is linked to the calling thread while drawing, thus the other threads may draw
+    // with their own context at the same time. NOTE the previous context is restored in case of
+    // nested draws
+    pPrevContext   := g_pDrawContext;
+    g_pDrawContext := pContext;
+
+    try
+        Result := Draw(pSVG, pos, scale, antialiasing, animation, pCanvas);
+    finally
+        g_pDrawContext := pPrevContext;
+    end;
+end;
+//---------------------------------------------------------------------------
+function TWSVGRasterizer.Draw(const pSVG: TWSVG; const rect: TRect; proportional, antialiasing: Boolean;
+        const animation: IAnimation; pCanvas: TCustomCanvas; pContext: IRenderContext): Boolean;
+var
+    pPrevContext: IRenderContext;
+begin
+    if ((not Assigned(pContext)) or (pContext.m_pOwner <> Self)) then
+    begin
+        TWLogHelper.LogToCompiler('Draw - FAILED - the context does not belong to this rasterizer');
+        Exit(False);
+    end;
+
+    // the context is linked to the calling thread while drawing, thus the other threads may draw
+    // with their own context at the same time. NOTE the previous context is restored in case of
+    // nested draws
+    pPrevContext   := g_pDrawContext;
+    g_pDrawContext := pContext;
+
+    try
+        Result := Draw(pSVG, rect, proportional, antialiasing, animation, pCanvas);
+    finally
+        g_pDrawContext := pPrevContext;
+    end;
+end;
+//---------------------------------------------------------------------------
+function TWSVGRasterizer.DrawToBuffer(const pSVG: TWSVG; const rect: TRect; proportional, antialiasing: Boolean;
+        const animation: IAnimation; const buffer: IRenderBuffer): Boolean;
+begin
+    Result := DrawToBuffer(pSVG, rect, proportional, antialiasing, animation, buffer, Default(TRect));
+end;
+//---------------------------------------------------------------------------
+function TWSVGRasterizer.DrawToBuffer(const pSVG: TWSVG; const rect: TRect; proportional, antialiasing: Boolean;
+        const animation: IAnimation; const buffer: IRenderBuffer; const subRect: TRect;
+        pContext: IRenderContext): Boolean;
+var
+    pPrevContext: IRenderContext;
+begin
+    if ((not Assigned(pContext)) or (pContext.m_pOwner <> Self)) then
+    begin
+        TWLogHelper.LogToCompiler('Draw to buffer - FAILED - the context does not belong to this rasterizer');
+        Exit(False);
+    end;
+
+    // link the context to the calling thread while drawing, see Draw()
+    pPrevContext   := g_pDrawContext;
+    g_pDrawContext := pContext;
+
+    try
+        Result := DrawToBuffer(pSVG, rect, proportional, antialiasing, animation, buffer, subRect);
+    finally
+        g_pDrawContext := pPrevContext;
+    end;
+end;
+//---------------------------------------------------------------------------
+function TWSVGRasterizer.CreateContext: IRenderContext;
+begin
+    Result := IRenderContext.Create(Self);
+end;
+//---------------------------------------------------------------------------
+function TWSVGRasterizer.HitTest(const pSVG: TWSVG; const rect: TRect; proportional: Boolean;
+        const animation: IAnimation; const point: TPoint; pAncestors: TList<TWSVGElement>): TWSVGElement;
+begin
+    if (Assigned(pAncestors)) then
+        pAncestors.Clear;
+
+    Result := nil;
+end;
+//---------------------------------------------------------------------------
+function TWSVGRasterizer.HitTest(const pSVG: TWSVG; const rect: TRect; proportional: Boolean;
+        const animation: IAnimation; const point: TPoint; pAncestors: TList<TWSVGElement>;
+        pContext: IRenderContext): TWSVGElement;
+var
+    pPrevContext: IRenderContext;
+begin
+    if ((not Assigned(pContext)) or (pContext.m_pOwner <> Self)) then
+    begin
+        TWLogHelper.LogToCompiler('Hit test - FAILED - the context does not belong to this rasterizer');
+        Exit(nil);
+    end;
+
+    // link the context to the calling thread while hit-testing, see Draw()
+    pPrevContext   := g_pDrawContext;
+    g_pDrawContext := pContext;
+
+    try
+        Result := HitTest(pSVG, rect, proportional, animation, point, pAncestors);
+    finally
+        g_pDrawContext := pPrevContext;
+    end;
+end;
+//---------------------------------------------------------------------------
 
 end.
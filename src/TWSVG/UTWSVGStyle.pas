@@ -704,6 +704,19 @@ type
             }
             function ParseStyle(const name, value: UnicodeString): Boolean; overload;
 
+            {**
+             Append properties to a style declarations list
+             @param(pProperties Properties to append)
+             @param(pBuilder String builder containing the declarations list to append to)
+            }
+            procedure AppendDeclarations(pProperties: TWSVGElement.IProperties; pBuilder: TStringBuilder);
+
+            {**
+             Get the style content as declarations list, e.g. fill:#0d60ec;stroke:#000000
+             @returns(Declarations list)
+            }
+            function GetDeclarations: UnicodeString;
+
             {**
              Delete and clear all data
             }
@@ -792,6 +805,12 @@ type
             }
             function ToXml: UnicodeString; override;
 
+            {**
+             Write the style as xml attribute
+             @param(pWriter Xml writer to write to)
+            }
+            procedure WriteXml(pWriter: TWSVGXmlWriter); override;
+
         public
             {**
              Get the fill properties
@@ -898,7 +917,7 @@ end;
 //---------------------------------------------------------------------------
 function TWSVGFill.IPropRule.ToXml: UnicodeString;
 begin
-    Result := ItemName + '=\"' + ToStr(m_Rule) + '\"';
+    Result := ItemName + '="' + ToStr(m_Rule) + '"';
 end;
 //---------------------------------------------------------------------------
 class function TWSVGFill.IPropRule.ToStr(rule: IERule): UnicodeString;
@@ -1212,7 +1231,7 @@ end;
 //---------------------------------------------------------------------------
 function TWSVGStroke.IPropLineCap.ToXml: UnicodeString;
 begin
-    Result := ItemName + '=\"' + ToStr(m_Type) + '\"';
+    Result := ItemName + '="' + ToStr(m_Type) + '"';
 end;
 //---------------------------------------------------------------------------
 class function TWSVGStroke.IPropLineCap.ToStr(lineCap: IELineCap): UnicodeString;
@@ -1307,7 +1326,7 @@ end;
 //---------------------------------------------------------------------------
 function TWSVGStroke.IPropLineJoin.ToXml: UnicodeString;
 begin
-    Result := ItemName + '=\"' + ToStr(m_Type) + '\"';
+    Result := ItemName + '="' + ToStr(m_Type) + '"';
 end;
 //---------------------------------------------------------------------------
 class function TWSVGStroke.IPropLineJoin.ToStr(lineJoin: IELineJoin): UnicodeString;
@@ -2124,6 +2143,53 @@ begin
     Result := False;
 end;
 //---------------------------------------------------------------------------
+procedure TWSVGStyle.AppendDeclarations(pProperties: TWSVGElement.IProperties; pBuilder: TStringBuilder);
+var
+    pProperty:    TWSVGProperty;
+    declaration:  UnicodeString;
+    separatorPos: Integer;
+begin
+    // iterate through properties to append
+    for pProperty in pProperties do
+    begin
+        declaration := pProperty.ToXml;
+
+        // property has nothing to export?
+        if (Length(declaration) = 0) then
+            continue;
+
+        separatorPos := System.Pos('="', declaration);
+
+        // is a name="value" attribute? (in this case it should be converted to a name:value declaration)
+        if (separatorPos > 0) then
+            declaration := Copy(declaration, 1, separatorPos - 1) + ':'
+                    + Copy(declaration, separatorPos + 2, Length(declaration) - separatorPos - 2);
+
+        // not the first declaration?
+        if (pBuilder.Length > 0) then
+            pBuilder.Append(';');
+
+        pBuilder.Append(declaration);
+    end;
+end;
+//---------------------------------------------------------------------------
+function TWSVGStyle.GetDeclarations: UnicodeString;
+var
+    pBuilder: TStringBuilder;
+begin
+    pBuilder := TStringBuilder.Create;
+
+    try
+        AppendDeclarations(m_pProperties,           pBuilder);
+        AppendDeclarations(m_pFill.m_pProperties,   pBuilder);
+        AppendDeclarations(m_pStroke.m_pProperties, pBuilder);
+
+        Result := pBuilder.ToString;
+    finally
+        pBuilder.Free;
+    end;
+end;
+//---------------------------------------------------------------------------
 procedure TWSVGStyle.DelAndClear;
 begin
     // clear all properties. NOTE as a TObjectList is used, the list will take care of freeing all
@@ -2404,34 +2470,22 @@ begin
 end;
 //---------------------------------------------------------------------------
 function TWSVGStyle.ToXml: UnicodeString;
-var
-    count:     NativeUInt;
-    pProperty: TWSVGProperty;
 begin
     // format string
-    Result := ItemName + '=\"';
-
-    count := 0;
-
-    // iterate through properties to add
-    for pProperty in m_pProperties do
-    begin
-        // is first property?
-        if (count > 0) then
-            // Add separator
-            Result := Result + ';';
-
-        // get property as string
-        Result := Result + pProperty.ToXml;
-
-        Inc(count);
-    end;
+    Result := C_SVG_Prop_Style + '="' + GetDeclarations + '"';
+end;
+//---------------------------------------------------------------------------
+procedure TWSVGStyle.WriteXml(pWriter: TWSVGXmlWriter);
+var
+    declarations: UnicodeString;
+begin
+    declarations := GetDeclarations;
 
-    Result := Result + m_pFill.ToXml(count);
-    Result := Result + m_pStroke.ToXml(count);
+    // nothing to write?
+    if (Length(declarations) = 0) then
+        Exit;
 
-    // close string
-    Result := Result + '\"';
+    pWriter.WriteAttribute(C_SVG_Prop_Style, declarations);
 end;
 //---------------------------------------------------------------------------
 
@@ -37,6 +37,9 @@ const
     C_SVG_Tag_Radial_Gradient:                         UnicodeString = 'radialGradient';
     C_SVG_Tag_Filter:                                  UnicodeString = 'filter';
     C_SVG_Tag_ClipPath:                                UnicodeString = 'clipPath';
+    C_SVG_Tag_Gradient_Stop:                           UnicodeString = 'stop';
+    C_SVG_Prop_XMLNS:                                  UnicodeString = 'xmlns';
+    C_SVG_Prop_XMLNS_XLink:                            UnicodeString = 'xmlns:xlink';
     C_SVG_Prop_ID:                                     UnicodeString = 'id';
     C_SVG_Prop_Version:                                UnicodeString = 'version';
     C_SVG_Prop_ViewBox:                                UnicodeString = 'viewBox';
@@ -156,6 +159,8 @@ const
     C_SVG_Value_Text_Decoration_Underline:             UnicodeString = 'underline';
     C_SVG_Value_Text_Decoration_Line_Through:          UnicodeString = 'line-through';
     C_SVG_Link_URL:                                    UnicodeString = 'url';
+    C_SVG_Namespace_SVG:                               UnicodeString = 'http://www.w3.org/2000/svg';
+    C_SVG_Namespace_XLink:                             UnicodeString = 'http://www.w3.org/1999/xlink';
     C_SVG_Path_MoveTo_Absolute                                       = 'M';
     C_SVG_Path_MoveTo_Relative                                       = 'm';
     C_SVG_Path_LineTo_Absolute                                       = 'L';